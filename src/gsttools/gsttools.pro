@@ -20,6 +20,7 @@ PRIVATE_HEADERS += \
     qgstreamermessage_p.h \
     qgstutils_p.h \
     qgstvideobuffer_p.h \
+    qgstaudiobuffer_p.h \
     qgstreamerbufferprobe_p.h \
     qgstreamervideorendererinterface_p.h \
     qgstreameraudioinputselector_p.h \
@@ -39,6 +40,7 @@ SOURCES += \
     qgstreamermessage.cpp \
     qgstutils.cpp \
     qgstvideobuffer.cpp \
+    qgstaudiobuffer.cpp \
     qgstreamerbufferprobe.cpp \
     qgstreamervideorendererinterface.cpp \
     qgstreameraudioinputselector.cpp \
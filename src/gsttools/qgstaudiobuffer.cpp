@@ -0,0 +1,133 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qgstaudiobuffer_p.h"
+
+QT_BEGIN_NAMESPACE
+
+QGstAudioBuffer::QGstAudioBuffer(GstBuffer *buffer, const QAudioFormat &format, qint64 startTime)
+    : m_buffer(buffer)
+    , m_format(format)
+    , m_startTime(startTime)
+{
+    gst_buffer_ref(m_buffer);
+    init();
+}
+
+#if GST_CHECK_VERSION(1,0,0)
+QGstAudioBuffer::QGstAudioBuffer(GstSample *sample, const QAudioFormat &format, qint64 startTime)
+    : m_buffer(gst_sample_get_buffer(sample))
+    , m_sample(sample)
+    , m_format(format)
+    , m_startTime(startTime)
+{
+    // The sample owns the buffer
+    gst_sample_ref(m_sample);
+    init();
+}
+#endif
+
+QGstAudioBuffer::~QGstAudioBuffer()
+{
+#if GST_CHECK_VERSION(1,0,0)
+    if (m_mapped)
+        gst_buffer_unmap(m_buffer, &m_info);
+    if (m_sample) {
+        gst_sample_unref(m_sample);
+        return;
+    }
+#endif
+    gst_buffer_unref(m_buffer);
+}
+
+void QGstAudioBuffer::init()
+{
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    if (!m_buffer || bytesPerFrame <= 0)
+        return;
+
+#if GST_CHECK_VERSION(1,0,0)
+    m_frameCount = int(gst_buffer_get_size(m_buffer) / bytesPerFrame);
+#else
+    m_frameCount = int(m_buffer->size / bytesPerFrame);
+#endif
+}
+
+void QGstAudioBuffer::release()
+{
+    delete this;
+}
+
+void *QGstAudioBuffer::constData() const
+{
+    if (m_frameCount == 0)
+        return nullptr;
+
+#if GST_CHECK_VERSION(1,0,0)
+    // Buffers may be shared between threads, map only once
+    QMutexLocker locker(&m_mapMutex);
+    if (!m_mapped)
+        m_mapped = gst_buffer_map(m_buffer, &m_info, GST_MAP_READ);
+    return m_mapped ? m_info.data : nullptr;
+#else
+    return m_buffer->data;
+#endif
+}
+
+/*
+    Returns a QAudioBuffer sharing the memory of \a buffer, or an invalid
+    QAudioBuffer if \a format cannot describe it.
+*/
+QAudioBuffer QGstAudioBuffer::wrap(GstBuffer *buffer, const QAudioFormat &format, qint64 startTime)
+{
+    if (!buffer || !format.isValid())
+        return QAudioBuffer();
+    return QAudioBuffer(new QGstAudioBuffer(buffer, format, startTime));
+}
+
+#if GST_CHECK_VERSION(1,0,0)
+QAudioBuffer QGstAudioBuffer::wrap(GstSample *sample, const QAudioFormat &format, qint64 startTime)
+{
+    if (!sample || !gst_sample_get_buffer(sample) || !format.isValid())
+        return QAudioBuffer();
+    return QAudioBuffer(new QGstAudioBuffer(sample, format, startTime));
+}
+#endif
+
+QT_END_NAMESPACE
@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGSTAUDIOBUFFER_P_H
+#define QGSTAUDIOBUFFER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <private/qgsttools_global_p.h>
+#include <private/qaudiobuffer_p.h>
+#include <qaudiobuffer.h>
+#include <QtCore/qmutex.h>
+
+#include <gst/gst.h>
+
+QT_BEGIN_NAMESPACE
+
+// Exposes the memory of a GstBuffer as a QAudioBuffer without copying.
+// The buffer (or the sample owning it) stays referenced until the last
+// QAudioBuffer sharing it goes away. It is mapped for reading the first
+// time the data is accessed; writable access falls back to a memory copy.
+class Q_GSTTOOLS_EXPORT QGstAudioBuffer : public QAbstractAudioBuffer
+{
+public:
+    QGstAudioBuffer(GstBuffer *buffer, const QAudioFormat &format, qint64 startTime);
+#if GST_CHECK_VERSION(1,0,0)
+    QGstAudioBuffer(GstSample *sample, const QAudioFormat &format, qint64 startTime);
+#endif
+    ~QGstAudioBuffer();
+
+    GstBuffer *buffer() const { return m_buffer; }
+
+    void release() override;
+
+    QAudioFormat format() const override { return m_format; }
+    qint64 startTime() const override { return m_startTime; }
+    int frameCount() const override { return m_frameCount; }
+
+    void *constData() const override;
+
+    void *writableData() override { return nullptr; }
+    QAbstractAudioBuffer *clone() const override { return nullptr; }
+
+    static QAudioBuffer wrap(GstBuffer *buffer, const QAudioFormat &format, qint64 startTime);
+#if GST_CHECK_VERSION(1,0,0)
+    static QAudioBuffer wrap(GstSample *sample, const QAudioFormat &format, qint64 startTime);
+#endif
+
+private:
+    void init();
+
+    GstBuffer *m_buffer = nullptr;
+#if GST_CHECK_VERSION(1,0,0)
+    GstSample *m_sample = nullptr;
+    mutable QMutex m_mapMutex;
+    mutable GstMapInfo m_info;
+    mutable bool m_mapped = false;
+#endif
+    QAudioFormat m_format;
+    qint64 m_startTime = -1;
+    int m_frameCount = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -39,9 +39,11 @@
 
 #include "qgstreameraudioprobecontrol_p.h"
 #include <private/qgstutils_p.h>
+#include <private/qgstaudiobuffer_p.h>
 
 QGstreamerAudioProbeControl::QGstreamerAudioProbeControl(QObject *parent)
     : QMediaAudioProbeControl(parent)
+    , m_queueLimit(qMax(0, qEnvironmentVariableIntValue("QT_GSTREAMER_AUDIO_PROBE_QUEUE")))
 {
 }
 
@@ -49,6 +51,75 @@ QGstreamerAudioProbeControl::~QGstreamerAudioProbeControl()
 {
 }
 
+/*
+    With a queue limit of zero only the most recent buffer is delivered
+    when the receiving thread falls behind. A positive limit queues up to
+    that many buffers; a buffer arriving while the queue is full drops the
+    oldest queued one, so the most recent buffers are delivered in order.
+    Both replaced and dropped buffers are counted by droppedBufferCount().
+
+    The limit is a tuning of the GStreamer backend and is not part of
+    QAudioProbe. It is set with the queueLimit property of the control or
+    the QT_GSTREAMER_AUDIO_PROBE_QUEUE environment variable.
+*/
+int QGstreamerAudioProbeControl::queueLimit() const
+{
+    QMutexLocker locker(&m_bufferMutex);
+    return m_queueLimit;
+}
+
+void QGstreamerAudioProbeControl::setQueueLimit(int limit)
+{
+    QMutexLocker locker(&m_bufferMutex);
+    m_queueLimit = qMax(0, limit);
+
+    // Move undelivered buffers to the storage of the new mode
+    if (m_queueLimit > 0) {
+        if (m_pendingBuffer.isValid()) {
+            m_queuedBuffers.enqueue(m_pendingBuffer);
+            m_pendingBuffer = QAudioBuffer();
+        }
+        while (m_queuedBuffers.size() > m_queueLimit) {
+            m_queuedBuffers.dequeue();
+            ++m_droppedBuffers;
+        }
+    } else if (!m_queuedBuffers.isEmpty()) {
+        m_droppedBuffers += m_queuedBuffers.size() - 1;
+        m_pendingBuffer = m_queuedBuffers.last();
+        m_queuedBuffers.clear();
+    }
+}
+
+quint64 QGstreamerAudioProbeControl::droppedBufferCount() const
+{
+    QMutexLocker locker(&m_bufferMutex);
+    return m_droppedBuffers;
+}
+
+/*
+    Delivers probed buffers by calling \a callback synchronously on the
+    GStreamer streaming thread, bypassing the queued audioBufferProbed()
+    delivery and its queue. Pass an empty callback to return to queued
+    delivery.
+
+    The buffer shares the mapped GstBuffer memory. Copies of it may be kept,
+    but they keep the GstBuffer referenced and mapped until released.
+
+    The callback must not block and must not call back into the control.
+    This function waits for a running callback to return, so once it has
+    returned the previous callback is not invoked again and whatever it
+    captured can be destroyed.
+
+    This is not reachable through QAudioProbe, which always receives the
+    queued audioBufferProbed() signal; only code holding the backend control
+    can install a callback.
+*/
+void QGstreamerAudioProbeControl::setDirectCallback(const DirectCallback &callback)
+{
+    QMutexLocker locker(&m_callbackMutex);
+    m_directCallback = callback;
+}
+
 void QGstreamerAudioProbeControl::probeCaps(GstCaps *caps)
 {
     QAudioFormat format = QGstUtils::audioFormatForCaps(caps);
@@ -64,24 +135,40 @@ bool QGstreamerAudioProbeControl::probeBuffer(GstBuffer *buffer)
             ? position / G_GINT64_CONSTANT(1000) // microseconds
             : -1;
 
-    QByteArray data;
-#if GST_CHECK_VERSION(1,0,0)
-    GstMapInfo info;
-    if (gst_buffer_map(buffer, &info, GST_MAP_READ)) {
-        data = QByteArray(reinterpret_cast<const char *>(info.data), info.size);
-        gst_buffer_unmap(buffer, &info);
-    } else {
+    QMutexLocker locker(&m_bufferMutex);
+    if (!m_format.isValid())
         return true;
+
+    {
+        QMutexLocker callbackLocker(&m_callbackMutex);
+        if (m_directCallback) {
+            const QAudioBuffer audioBuffer = QGstAudioBuffer::wrap(buffer, m_format, position);
+            locker.unlock();
+            if (audioBuffer.isValid())
+                m_directCallback(audioBuffer);
+            return true;
+        }
     }
-#else
-    data = QByteArray(reinterpret_cast<const char *>(buffer->data), buffer->size);
-#endif
 
-    QMutexLocker locker(&m_bufferMutex);
-    if (m_format.isValid()) {
-        if (!m_pendingBuffer.isValid())
-            QMetaObject::invokeMethod(this, "bufferProbed", Qt::QueuedConnection);
-        m_pendingBuffer = QAudioBuffer(data, m_format, position);
+    const QAudioBuffer audioBuffer = QGstAudioBuffer::wrap(buffer, m_format, position);
+    if (!audioBuffer.isValid())
+        return true;
+
+    if (!m_pendingBuffer.isValid() && m_queuedBuffers.isEmpty())
+        QMetaObject::invokeMethod(this, "bufferProbed", Qt::QueuedConnection);
+
+    if (m_queueLimit > 0) {
+        // Make room by dropping the oldest buffer that was not delivered yet
+        if (m_queuedBuffers.size() >= m_queueLimit) {
+            m_queuedBuffers.dequeue();
+            ++m_droppedBuffers;
+        }
+        m_queuedBuffers.enqueue(audioBuffer);
+    } else {
+        // Not delivered yet, replace it with the latest one
+        if (m_pendingBuffer.isValid())
+            ++m_droppedBuffers;
+        m_pendingBuffer = audioBuffer;
     }
 
     return true;
@@ -89,13 +176,17 @@ bool QGstreamerAudioProbeControl::probeBuffer(GstBuffer *buffer)
 
 void QGstreamerAudioProbeControl::bufferProbed()
 {
-    QAudioBuffer audioBuffer;
+    QAudioBuffer pendingBuffer;
+    QQueue<QAudioBuffer> queuedBuffers;
     {
         QMutexLocker locker(&m_bufferMutex);
-        if (!m_pendingBuffer.isValid())
-            return;
-        audioBuffer = m_pendingBuffer;
+        pendingBuffer = m_pendingBuffer;
         m_pendingBuffer = QAudioBuffer();
+        queuedBuffers.swap(m_queuedBuffers);
     }
-    emit audioBufferProbed(audioBuffer);
+
+    if (pendingBuffer.isValid())
+        emit audioBufferProbed(pendingBuffer);
+    for (const QAudioBuffer &audioBuffer : qAsConst(queuedBuffers))
+        emit audioBufferProbed(audioBuffer);
 }
@@ -55,9 +55,12 @@
 #include <gst/gst.h>
 #include <qmediaaudioprobecontrol.h>
 #include <QtCore/qmutex.h>
+#include <QtCore/qqueue.h>
 #include <qaudiobuffer.h>
 #include <qshareddata.h>
 
+#include <functional>
+
 #include <private/qgstreamerbufferprobe_p.h>
 
 QT_BEGIN_NAMESPACE
@@ -68,10 +71,20 @@ class Q_GSTTOOLS_EXPORT QGstreamerAudioProbeControl
     , public QSharedData
 {
     Q_OBJECT
+    Q_PROPERTY(int queueLimit READ queueLimit WRITE setQueueLimit)
+    Q_PROPERTY(quint64 droppedBufferCount READ droppedBufferCount)
 public:
     explicit QGstreamerAudioProbeControl(QObject *parent);
     virtual ~QGstreamerAudioProbeControl();
 
+    int queueLimit() const;
+    void setQueueLimit(int limit);
+
+    quint64 droppedBufferCount() const;
+
+    typedef std::function<void(const QAudioBuffer &)> DirectCallback;
+    void setDirectCallback(const DirectCallback &callback);
+
 protected:
     void probeCaps(GstCaps *caps) override;
     bool probeBuffer(GstBuffer *buffer) override;
@@ -81,8 +94,13 @@ private slots:
 
 private:
     QAudioBuffer m_pendingBuffer;
+    QQueue<QAudioBuffer> m_queuedBuffers;
     QAudioFormat m_format;
-    QMutex m_bufferMutex;
+    mutable QMutex m_bufferMutex;
+    QMutex m_callbackMutex;
+    DirectCallback m_directCallback;
+    int m_queueLimit = 0;
+    quint64 m_droppedBuffers = 0;
 };
 
 QT_END_NAMESPACE
@@ -158,6 +158,16 @@ void QGstreamerPlayerControl::setPlaybackRate(qreal rate)
     m_session->setPlaybackRate(rate);
 }
 
+QMediaPlayer::SeekMode QGstreamerPlayerControl::seekMode() const
+{
+    return m_session->seekMode();
+}
+
+void QGstreamerPlayerControl::setSeekMode(QMediaPlayer::SeekMode mode)
+{
+    m_session->setSeekMode(mode);
+}
+
 void QGstreamerPlayerControl::setPosition(qint64 pos)
 {
 #ifdef DEBUG_PLAYBIN
@@ -309,6 +319,12 @@ void QGstreamerPlayerControl::stop()
     popAndNotifyState();
 }
 
+bool QGstreamerPlayerControl::setPositionUpdateInterval(int milliseconds)
+{
+    m_session->setPositionUpdateInterval(milliseconds);
+    return true;
+}
+
 void QGstreamerPlayerControl::setVolume(int volume)
 {
     m_session->setVolume(volume);
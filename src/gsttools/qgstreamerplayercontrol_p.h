@@ -90,10 +90,15 @@ public:
     qreal playbackRate() const override;
     void setPlaybackRate(qreal rate) override;
 
+    QMediaPlayer::SeekMode seekMode() const override;
+    void setSeekMode(QMediaPlayer::SeekMode mode) override;
+
     QMediaContent media() const override;
     const QIODevice *mediaStream() const override;
     void setMedia(const QMediaContent&, QIODevice *) override;
 
+    bool setPositionUpdateInterval(int milliseconds) override;
+
     QMediaPlayerResourceSetInterface* resources() const;
 
 public Q_SLOTS:
@@ -114,6 +114,8 @@ QGstreamerPlayerSession::QGstreamerPlayerSession(QObject *parent)
     : QObject(parent)
 {
     initPlaybin();
+
+    connect(this, &QGstreamerPlayerSession::stateChanged, this, &QGstreamerPlayerSession::updatePositionClock);
 }
 
 void QGstreamerPlayerSession::initPlaybin()
@@ -239,8 +241,31 @@ void QGstreamerPlayerSession::initPlaybin()
     }
 }
 
+/*
+    The clock callback gets this context rather than the session, since
+    unscheduling the wait does not wait for a callback that is already
+    running. The session detaches itself under the mutex when destroyed.
+*/
+struct QGstreamerPlayerSession::PositionClockContext
+{
+    QAtomicInt ref;
+    QMutex mutex;
+    QGstreamerPlayerSession *session;
+};
+
 QGstreamerPlayerSession::~QGstreamerPlayerSession()
 {
+    stopPositionClock();
+    if (m_positionClockContext) {
+        // The clock thread may still be running handlePositionClock()
+        {
+            QMutexLocker locker(&m_positionClockContext->mutex);
+            m_positionClockContext->session = nullptr;
+        }
+        releasePositionClockContext(m_positionClockContext);
+        m_positionClockContext = nullptr;
+    }
+
     if (m_pipeline) {
         stop();
 
@@ -313,6 +338,7 @@ void QGstreamerPlayerSession::loadFromStream(const QNetworkRequest &request, QIO
     m_request = request;
     m_duration = 0;
     m_lastPosition = 0;
+    resetSeek();
 
     if (!m_appSrc)
         m_appSrc = new QGstAppSrc(this);
@@ -342,6 +368,7 @@ void QGstreamerPlayerSession::loadFromUri(const QNetworkRequest &request)
     m_request = request;
     m_duration = 0;
     m_lastPosition = 0;
+    resetSeek();
 
 #if QT_CONFIG(gstreamer_app)
     if (m_appSrc) {
@@ -489,6 +516,105 @@ qint64 QGstreamerPlayerSession::position() const
     return m_lastPosition;
 }
 
+/*
+    Emits positionChanged() every \a milliseconds while playing, timed by
+    the pipeline clock rather than by polling. A value of 0 stops it.
+*/
+void QGstreamerPlayerSession::setPositionUpdateInterval(int milliseconds)
+{
+    milliseconds = qMax(0, milliseconds);
+    if (m_positionUpdateInterval == milliseconds)
+        return;
+
+    m_positionUpdateInterval = milliseconds;
+    updatePositionClock();
+}
+
+void QGstreamerPlayerSession::releasePositionClockContext(gpointer data)
+{
+    PositionClockContext *context = static_cast<PositionClockContext *>(data);
+    if (!context->ref.deref())
+        delete context;
+}
+
+void QGstreamerPlayerSession::updatePositionClock()
+{
+    stopPositionClock();
+
+    if (m_positionUpdateInterval <= 0 || m_state != QMediaPlayer::PlayingState || !m_pipeline)
+        return;
+
+    GstClock *clock = gst_element_get_clock(m_pipeline);
+    if (!clock)
+        return;
+
+    if (!m_positionClockContext) {
+        m_positionClockContext = new PositionClockContext;
+        m_positionClockContext->ref.storeRelaxed(1);
+        m_positionClockContext->session = this;
+    }
+
+    // Report the first position even if it was already queried
+    m_lastClockPosition = -1;
+
+    const GstClockTime interval = GstClockTime(m_positionUpdateInterval) * GST_MSECOND;
+    m_positionClockId = gst_clock_new_periodic_id(clock, gst_clock_get_time(clock) + interval, interval);
+#if GST_CHECK_VERSION(1,0,0)
+    // Released once the clock drops the entry
+    m_positionClockContext->ref.ref();
+    gst_clock_id_wait_async(m_positionClockId, handlePositionClock, m_positionClockContext,
+                            releasePositionClockContext);
+#else
+    // There is no notification when the clock is done with the entry, so
+    // the context is never released once it has been handed to a clock
+    m_positionClockContext->ref.ref();
+    gst_clock_id_wait_async(m_positionClockId, handlePositionClock, m_positionClockContext);
+#endif
+    gst_object_unref(GST_OBJECT(clock));
+}
+
+void QGstreamerPlayerSession::stopPositionClock()
+{
+    if (!m_positionClockId)
+        return;
+
+    gst_clock_id_unschedule(m_positionClockId);
+    gst_clock_id_unref(m_positionClockId);
+    m_positionClockId = nullptr;
+}
+
+// Called on the clock thread. At most one update is queued at a time, so a
+// busy event loop does not accumulate stale positions.
+gboolean QGstreamerPlayerSession::handlePositionClock(GstClock *clock, GstClockTime time, GstClockID id, gpointer user_data)
+{
+    Q_UNUSED(clock);
+    Q_UNUSED(id);
+
+    if (time == GST_CLOCK_TIME_NONE)
+        return TRUE;
+
+    PositionClockContext *context = static_cast<PositionClockContext *>(user_data);
+    QMutexLocker locker(&context->mutex);
+    QGstreamerPlayerSession *session = context->session;
+    if (session && session->m_positionUpdatePending.testAndSetRelaxed(0, 1))
+        QMetaObject::invokeMethod(session, "emitClockPosition", Qt::QueuedConnection);
+    return TRUE;
+}
+
+void QGstreamerPlayerSession::emitClockPosition()
+{
+    m_positionUpdatePending.storeRelaxed(0);
+    if (!m_positionClockId)
+        return;
+
+    // position() also updates m_lastPosition when the application polls it
+    const qint64 current = position();
+    if (current != m_lastClockPosition) {
+        m_lastClockPosition = current;
+        emit positionChanged(current);
+    }
+}
+
 qreal QGstreamerPlayerSession::playbackRate() const
 {
     return m_playbackRate;
@@ -502,12 +628,11 @@ void QGstreamerPlayerSession::setPlaybackRate(qreal rate)
     if (!qFuzzyCompare(m_playbackRate, rate)) {
         m_playbackRate = rate;
         if (m_pipeline && m_seekable) {
-            qint64 from = rate > 0 ? position() : 0;
-            qint64 to = rate > 0 ? duration() : position();
-            gst_element_seek(m_pipeline, rate, GST_FORMAT_TIME,
-                             GstSeekFlags(GST_SEEK_FLAG_FLUSH),
-                             GST_SEEK_TYPE_SET, from * 1000000,
-                             GST_SEEK_TYPE_SET, to * 1000000);
+            // A seek still in flight is followed by one with the new rate
+            if (!isSeekInProgress())
+                startSeek(position());
+            else if (m_pendingSeekPosition < 0)
+                m_pendingSeekPosition = m_lastPosition;
         }
         emit playbackRateChanged(m_playbackRate);
     }
@@ -1068,6 +1193,7 @@ void QGstreamerPlayerSession::stop()
         gst_element_set_state(m_pipeline, GST_STATE_NULL);
 
         m_lastPosition = 0;
+        resetSeek();
         QMediaPlayer::State oldState = m_state;
         m_pendingState = m_state = QMediaPlayer::StoppedState;
 
@@ -1088,22 +1214,97 @@ bool QGstreamerPlayerSession::seek(qint64 ms)
     //seek locks when the video output sink is changing and pad is blocked
     if (m_pipeline && !m_pendingVideoSink && m_state != QMediaPlayer::StoppedState && m_seekable) {
         ms = qMax(ms,qint64(0));
-        qint64 from = m_playbackRate > 0 ? ms : 0;
-        qint64 to = m_playbackRate > 0 ? duration() : ms;
-
-        bool isSeeking = gst_element_seek(m_pipeline, m_playbackRate, GST_FORMAT_TIME,
-                                          GstSeekFlags(GST_SEEK_FLAG_FLUSH),
-                                          GST_SEEK_TYPE_SET, from * 1000000,
-                                          GST_SEEK_TYPE_SET, to * 1000000);
-        if (isSeeking)
+
+        // Each flushing seek restarts the pipeline preroll, so while one is
+        // still in flight only the latest target is kept and issued on ASYNC_DONE.
+        if (isSeekInProgress()) {
+            m_pendingSeekPosition = ms;
             m_lastPosition = ms;
+            return true;
+        }
+
+        return startSeek(ms);
+    }
+
+    return false;
+}
+
+static GstSeekFlags seekFlags(QMediaPlayer::SeekMode mode)
+{
+    int flags = GST_SEEK_FLAG_FLUSH;
+
+    switch (mode) {
+    case QMediaPlayer::DefaultSeek:
+        break;
+    case QMediaPlayer::AccurateSeek:
+        flags |= GST_SEEK_FLAG_ACCURATE;
+        break;
+#if GST_CHECK_VERSION(1,0,0)
+    case QMediaPlayer::NearestKeyFrameSeek:
+        flags |= GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_NEAREST;
+        break;
+    case QMediaPlayer::PreviousKeyFrameSeek:
+        flags |= GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_BEFORE;
+        break;
+    case QMediaPlayer::NextKeyFrameSeek:
+        flags |= GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_AFTER;
+        break;
+#else
+    // Snapping needs GStreamer 1.0, the nearest key frame is the best we can do
+    case QMediaPlayer::NearestKeyFrameSeek:
+    case QMediaPlayer::PreviousKeyFrameSeek:
+    case QMediaPlayer::NextKeyFrameSeek:
+        flags |= GST_SEEK_FLAG_KEY_UNIT;
+        break;
+#endif
+    }
+
+    return GstSeekFlags(flags);
+}
+
+bool QGstreamerPlayerSession::startSeek(qint64 ms)
+{
+    qint64 from = m_playbackRate > 0 ? ms : 0;
+    qint64 to = m_playbackRate > 0 ? duration() : ms;
 
-        return isSeeking;
+    bool isSeeking = gst_element_seek(m_pipeline, m_playbackRate, GST_FORMAT_TIME,
+                                      seekFlags(m_seekMode),
+                                      GST_SEEK_TYPE_SET, from * 1000000,
+                                      GST_SEEK_TYPE_SET, to * 1000000);
+    if (isSeeking) {
+        m_lastPosition = ms;
+#if GST_CHECK_VERSION(0,10,13)
+        // Cleared again when the pipeline posts ASYNC_DONE
+        m_seekInProgress = true;
+#endif
     }
 
+    return isSeeking;
+}
+
+/*
+    A seek counts as in flight only while the pipeline is still changing state
+    asynchronously. If its ASYNC_DONE never arrived, the next seek is issued
+    right away instead of waiting for it.
+*/
+bool QGstreamerPlayerSession::isSeekInProgress()
+{
+    if (!m_seekInProgress)
+        return false;
+
+    if (gst_element_get_state(m_pipeline, nullptr, nullptr, 0) == GST_STATE_CHANGE_ASYNC)
+        return true;
+
+    resetSeek();
     return false;
 }
 
+void QGstreamerPlayerSession::resetSeek()
+{
+    m_seekInProgress = false;
+    m_pendingSeekPosition = -1;
+}
+
 void QGstreamerPlayerSession::setVolume(int volume)
 {
 #ifdef DEBUG_PLAYBIN
@@ -1273,6 +1474,8 @@ bool QGstreamerPlayerSession::processBusMessage(const QGstreamerMessage &message
                 break;
 
             case GST_MESSAGE_EOS:
+                // No ASYNC_DONE follows a seek which ran into the end of the stream
+                resetSeek();
                 emit playbackFinished();
                 break;
 
@@ -1284,6 +1487,7 @@ bool QGstreamerPlayerSession::processBusMessage(const QGstreamerMessage &message
                     GError *err;
                     gchar *debug;
                     gst_message_parse_error(gm, &err, &debug);
+                    resetSeek();
                     if (err->domain == GST_STREAM_ERROR && err->code == GST_STREAM_ERROR_CODEC_NOT_FOUND)
                         processInvalidMedia(QMediaPlayer::FormatError, tr("Cannot play stream of type: <unknown>"));
                     else
@@ -1320,7 +1524,11 @@ bool QGstreamerPlayerSession::processBusMessage(const QGstreamerMessage &message
             case GST_MESSAGE_STEP_DONE:
             case GST_MESSAGE_CLOCK_PROVIDE:
             case GST_MESSAGE_CLOCK_LOST:
+                break;
             case GST_MESSAGE_NEW_CLOCK:
+                // The periodic id belongs to the previous clock
+                updatePositionClock();
+                break;
             case GST_MESSAGE_STRUCTURE_CHANGE:
             case GST_MESSAGE_APPLICATION:
             case GST_MESSAGE_ELEMENT:
@@ -1331,6 +1539,7 @@ bool QGstreamerPlayerSession::processBusMessage(const QGstreamerMessage &message
                     qint64 position = g_value_get_int64(gst_structure_get_value(structure, "position"));
                     position /= 1000000;
                     m_lastPosition = position;
+                    m_lastClockPosition = position;
                     emit positionChanged(position);
                 }
                 break;
@@ -1346,8 +1555,16 @@ bool QGstreamerPlayerSession::processBusMessage(const QGstreamerMessage &message
                 if (qt_gst_element_query_position(m_pipeline, GST_FORMAT_TIME, &position)) {
                     position /= 1000000;
                     m_lastPosition = position;
+                    m_lastClockPosition = position;
                     emit positionChanged(position);
                 }
+
+                if (m_seekInProgress) {
+                    const qint64 pendingPosition = m_pendingSeekPosition;
+                    resetSeek();
+                    if (pendingPosition >= 0)
+                        seek(pendingPosition);
+                }
                 break;
             }
 #if GST_CHECK_VERSION(0,10,23)
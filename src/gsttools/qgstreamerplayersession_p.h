@@ -54,6 +54,7 @@
 #include <QtMultimedia/private/qtmultimediaglobal_p.h>
 #include <QObject>
 #include <QtCore/qmutex.h>
+#include <QtCore/qatomic.h>
 #include <QtNetwork/qnetworkrequest.h>
 #include <private/qgstreamerplayercontrol_p.h>
 #include <private/qgstreamerbushelper_p.h>
@@ -119,6 +120,9 @@ public:
     qreal playbackRate() const;
     void setPlaybackRate(qreal rate);
 
+    QMediaPlayer::SeekMode seekMode() const { return m_seekMode; }
+    void setSeekMode(QMediaPlayer::SeekMode mode) { m_seekMode = mode; }
+
     QMediaTimeRange availablePlaybackRanges() const;
 
     QMap<QByteArray ,QVariant> tags() const { return m_tags; }
@@ -146,6 +150,9 @@ public:
 
     void endOfMediaReset();
 
+    int positionUpdateInterval() const { return m_positionUpdateInterval; }
+    void setPositionUpdateInterval(int milliseconds);
+
 public slots:
     void loadFromUri(const QNetworkRequest &url);
     void loadFromStream(const QNetworkRequest &url, QIODevice *stream);
@@ -188,6 +195,8 @@ private slots:
     void updateVolume();
     void updateMuted();
     void updateDuration();
+    void updatePositionClock();
+    void emitClockPosition();
 
 private:
     static void playbinNotifySource(GObject *o, GParamSpec *p, gpointer d);
@@ -198,10 +207,14 @@ private:
 #endif
     static void handleElementAdded(GstBin *bin, GstElement *element, QGstreamerPlayerSession *session);
     static void handleStreamsChange(GstBin *bin, gpointer user_data);
+    static gboolean handlePositionClock(GstClock *clock, GstClockTime time, GstClockID id, gpointer user_data);
+    static void releasePositionClockContext(gpointer data);
     static GstAutoplugSelectResult handleAutoplugSelect(GstBin *bin, GstPad *pad, GstCaps *caps, GstElementFactory *factory, QGstreamerPlayerSession *session);
 
     void processInvalidMedia(QMediaPlayer::Error errorCode, const QString& errorString);
 
+    void stopPositionClock();
+
     void removeVideoBufferProbe();
     void addVideoBufferProbe();
     void removeAudioBufferProbe();
@@ -213,6 +226,9 @@ private:
     void resetElements();
     void initPlaybin();
     void setBus(GstBus *bus);
+    bool startSeek(qint64 ms);
+    bool isSeekInProgress();
+    void resetSeek();
 
     QNetworkRequest m_request;
     QMediaPlayer::State m_state = QMediaPlayer::StoppedState;
@@ -257,8 +273,17 @@ private:
     bool m_audioAvailable = false;
     bool m_videoAvailable = false;
     bool m_seekable = false;
+    QMediaPlayer::SeekMode m_seekMode = QMediaPlayer::DefaultSeek;
+    bool m_seekInProgress = false;
+    qint64 m_pendingSeekPosition = -1;
 
     mutable qint64 m_lastPosition = 0;
+    qint64 m_lastClockPosition = -1;
+    int m_positionUpdateInterval = 0;
+    struct PositionClockContext;
+    PositionClockContext *m_positionClockContext = nullptr;
+    GstClockID m_positionClockId = nullptr;
+    QAtomicInt m_positionUpdatePending;
     qint64 m_duration = 0;
     int m_durationQueries = 0;
 
@@ -70,6 +70,30 @@ void QGstreamerVideoProbeControl::stopFlushing()
     m_flushing = false;
 }
 
+/*
+    Delivers probed frames by calling \a callback synchronously on the
+    GStreamer streaming thread instead of emitting videoFrameProbed() through
+    a queued invocation. Pass an empty callback to return to queued delivery.
+
+    The frame is mapped for reading while the callback runs. Copies of it may
+    be kept, but they hold a reference to the GstBuffer and must be mapped
+    again; holding on to them stalls upstream buffer pools.
+
+    The callback must not block and must not call back into the control.
+    This function waits for a running callback to return, so once it has
+    returned the previous callback is not invoked again and whatever it
+    captured can be destroyed.
+
+    Direct delivery is internal to the GStreamer backend. QVideoProbe keeps
+    using the queued signal; the callback is for code that owns the control,
+    such as other gsttools elements.
+*/
+void QGstreamerVideoProbeControl::setDirectCallback(const DirectCallback &callback)
+{
+    QMutexLocker locker(&m_callbackMutex);
+    m_directCallback = callback;
+}
+
 void QGstreamerVideoProbeControl::probeCaps(GstCaps *caps)
 {
 #if GST_CHECK_VERSION(1,0,0)
@@ -108,6 +132,18 @@ bool QGstreamerVideoProbeControl::probeBuffer(GstBuffer *buffer)
 
     m_frameProbed = true;
 
+    {
+        QMutexLocker callbackLocker(&m_callbackMutex);
+        if (m_directCallback) {
+            locker.unlock();
+            const bool mapped = frame.map(QAbstractVideoBuffer::ReadOnly);
+            m_directCallback(frame);
+            if (mapped)
+                frame.unmap();
+            return true;
+        }
+    }
+
     if (!m_pendingFrame.isValid())
         QMetaObject::invokeMethod(this, "frameProbed", Qt::QueuedConnection);
     m_pendingFrame = frame;
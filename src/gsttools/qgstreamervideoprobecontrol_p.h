@@ -59,6 +59,8 @@
 #include <qvideoframe.h>
 #include <qvideosurfaceformat.h>
 
+#include <functional>
+
 #include <private/qgstreamerbufferprobe_p.h>
 
 QT_BEGIN_NAMESPACE
@@ -79,6 +81,9 @@ public:
     void startFlushing();
     void stopFlushing();
 
+    typedef std::function<void(const QVideoFrame &)> DirectCallback;
+    void setDirectCallback(const DirectCallback &callback);
+
 private slots:
     void frameProbed();
 
@@ -86,6 +91,8 @@ private:
     QVideoSurfaceFormat m_format;
     QVideoFrame m_pendingFrame;
     QMutex m_frameMutex;
+    QMutex m_callbackMutex;
+    DirectCallback m_directCallback;
 #if GST_CHECK_VERSION(1,0,0)
     GstVideoInfo m_videoInfo;
 #else
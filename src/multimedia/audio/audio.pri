@@ -20,6 +20,8 @@ PRIVATE_HEADERS += \
            audio/qwavedecoder_p.h \
            audio/qsamplecache_p.h \
            audio/qaudiohelpers_p.h \
+           audio/qaudioringbuffer_p.h \
+           audio/qaudioresampler_p.h \
            audio/qaudiosystempluginext_p.h
 
 SOURCES += \
@@ -38,7 +40,9 @@ SOURCES += \
            audio/qaudiobuffer.cpp \
            audio/qaudioprobe.cpp \
            audio/qaudiodecoder.cpp \
-           audio/qaudiohelpers.cpp
+           audio/qaudiohelpers.cpp \
+           audio/qaudioresampler.cpp \
+           audio/qaudioringbuffer.cpp
 
 qtConfig(pulseaudio) {
     QMAKE_USE_FOR_PRIVATE += pulseaudio
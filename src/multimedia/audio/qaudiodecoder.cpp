@@ -42,6 +42,7 @@
 #include "qmediaobject_p.h"
 #include <qmediaservice.h>
 #include "qaudiodecodercontrol.h"
+#include "qaudioresampler_p.h"
 #include <private/qmediaserviceprovider_p.h>
 
 #include <QtCore/qcoreevent.h>
@@ -49,6 +50,7 @@
 #include <QtCore/qtimer.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qpointer.h>
+#include <QtCore/qscopedpointer.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -88,6 +90,9 @@ public:
         , control(nullptr)
         , state(QAudioDecoder::StoppedState)
         , error(QAudioDecoder::NoError)
+        , conversionQuality(QAudioDecoder::BalancedConversion)
+        , streamStart(-1)
+        , finishPending(false)
     {}
 
     QMediaServiceProvider *provider;
@@ -96,10 +101,77 @@ public:
     QAudioDecoder::Error error;
     QString errorString;
 
+    // Converts buffers the backend could not decode to the requested format
+    QAudioDecoder::ConversionQuality conversionQuality;
+    mutable QScopedPointer<QAudioResampler> resampler;
+    mutable qint64 streamStart;
+    mutable QAudioBuffer tail;
+    bool finishPending;
+
+    QAudioBuffer convert(const QAudioBuffer &buffer) const;
+    QAudioBuffer takeTail();
+    void resetConversion();
+
     void _q_stateChanged(QAudioDecoder::State state);
     void _q_error(int error, const QString &errorString);
+    void _q_bufferAvailableChanged(bool available);
+    void _q_finished();
+    void _q_flushTail();
 };
 
+/*
+    Returns \a buffer in the format requested with setAudioFormat(). Only
+    needed for backends that deliver another format, which is then converted
+    by a resampler kept for the whole stream. The resampler delays its output
+    by a few frames, so the first buffer may come back empty.
+*/
+QAudioBuffer QAudioDecoderPrivate::convert(const QAudioBuffer &buffer) const
+{
+    const QAudioFormat target = control->audioFormat();
+    if (!buffer.isValid() || !target.isValid() || buffer.format() == target
+            || !QAudioResampler::canConvert(buffer.format(), target)) {
+        return buffer;
+    }
+
+    if (!resampler || resampler->sourceFormat() != buffer.format() || resampler->targetFormat() != target) {
+        resampler.reset(new QAudioResampler(buffer.format(), target,
+                                            QAudioResampler::Quality(conversionQuality)));
+        streamStart = buffer.startTime();
+    }
+
+    const qint64 startTime = streamStart < 0
+            ? -1 : streamStart + target.durationForFrames(resampler->outputFrames());
+    const QByteArray data = resampler->process(buffer.constData(), buffer.byteCount());
+    if (data.isEmpty())
+        return QAudioBuffer();
+    return QAudioBuffer(data, target, startTime);
+}
+
+/*
+    Returns the frames the resampler held back when the stream finished.
+*/
+QAudioBuffer QAudioDecoderPrivate::takeTail()
+{
+    if (!resampler)
+        return QAudioBuffer();
+
+    const QAudioFormat target = resampler->targetFormat();
+    const qint64 startTime = streamStart < 0
+            ? -1 : streamStart + target.durationForFrames(resampler->outputFrames());
+    const QByteArray data = resampler->flush();
+    if (data.isEmpty())
+        return QAudioBuffer();
+    return QAudioBuffer(data, target, startTime);
+}
+
+void QAudioDecoderPrivate::resetConversion()
+{
+    resampler.reset();
+    streamStart = -1;
+    tail = QAudioBuffer();
+    finishPending = false;
+}
+
 void QAudioDecoderPrivate::_q_stateChanged(QAudioDecoder::State ps)
 {
     Q_Q(QAudioDecoder);
@@ -121,6 +193,57 @@ void QAudioDecoderPrivate::_q_error(int error, const QString &errorString)
     emit q->error(this->error);
 }
 
+void QAudioDecoderPrivate::_q_bufferAvailableChanged(bool available)
+{
+    Q_Q(QAudioDecoder);
+
+    emit q->bufferAvailableChanged(available);
+
+    if (!available && finishPending)
+        QMetaObject::invokeMethod(q, "_q_flushTail", Qt::QueuedConnection);
+}
+
+/*
+    While converting, finished() is held back until the backend's buffers
+    have been read and the resampler tail has been handed out. The tail is
+    flushed from a queued call, since backends may report the end of the
+    stream from within read(), before the last buffer went through convert().
+*/
+void QAudioDecoderPrivate::_q_finished()
+{
+    Q_Q(QAudioDecoder);
+
+    if (resampler) {
+        finishPending = true;
+        if (!control->bufferAvailable())
+            QMetaObject::invokeMethod(q, "_q_flushTail", Qt::QueuedConnection);
+        return;
+    }
+
+    emit q->finished();
+}
+
+void QAudioDecoderPrivate::_q_flushTail()
+{
+    Q_Q(QAudioDecoder);
+
+    // Stopped or restarted meanwhile, or more buffers to read first
+    if (!finishPending || control->bufferAvailable())
+        return;
+    finishPending = false;
+
+    tail = takeTail();
+    if (tail.isValid()) {
+        emit q->bufferAvailableChanged(true);
+        emit q->bufferReady();
+        // Usually read from a slot connected to bufferReady()
+        if (!tail.isValid())
+            emit q->bufferAvailableChanged(false);
+    }
+
+    emit q->finished();
+}
+
 /*!
     Construct an QAudioDecoder instance
     parented to \a parent.
@@ -142,8 +265,8 @@ QAudioDecoder::QAudioDecoder(QObject *parent)
             connect(d->control, SIGNAL(formatChanged(QAudioFormat)), SIGNAL(formatChanged(QAudioFormat)));
             connect(d->control, SIGNAL(sourceChanged()), SIGNAL(sourceChanged()));
             connect(d->control, SIGNAL(bufferReady()), this, SIGNAL(bufferReady()));
-            connect(d->control ,SIGNAL(bufferAvailableChanged(bool)), this, SIGNAL(bufferAvailableChanged(bool)));
-            connect(d->control ,SIGNAL(finished()), this, SIGNAL(finished()));
+            connect(d->control ,SIGNAL(bufferAvailableChanged(bool)), this, SLOT(_q_bufferAvailableChanged(bool)));
+            connect(d->control ,SIGNAL(finished()), this, SLOT(_q_finished()));
             connect(d->control ,SIGNAL(positionChanged(qint64)), this, SIGNAL(positionChanged(qint64)));
             connect(d->control ,SIGNAL(durationChanged(qint64)), this, SIGNAL(durationChanged(qint64)));
         }
@@ -215,6 +338,7 @@ void QAudioDecoder::start()
     // Reset error conditions
     d->error = NoError;
     d->errorString.clear();
+    d->resetConversion();
 
     d->control->start();
 }
@@ -226,6 +350,7 @@ void QAudioDecoder::stop()
 {
     Q_D(QAudioDecoder);
 
+    d->resetConversion();
     if (d->control != nullptr)
         d->control->stop();
 }
@@ -315,7 +440,9 @@ QAudioFormat QAudioDecoder::audioFormat() const
 
     If you do not specify a format, the format of the decoded
     audio itself will be used.  Otherwise, some format conversion
-    will be applied.
+    will be applied.  PCM formats the backend does not produce itself
+    are converted by QAudioDecoder, including the sample rate and
+    channel count; see \l conversionQuality.
 
     If you wish to reset the decoded format to that of the original
     audio file, you can specify an invalid \a format.
@@ -331,6 +458,148 @@ void QAudioDecoder::setAudioFormat(const QAudioFormat &format)
         d_func()->control->setAudioFormat(format);
 }
 
+/*!
+    \property QAudioDecoder::bufferQueueLimit
+    \since 6.0
+
+    \brief the maximum number of decoded buffers kept ready ahead of read().
+
+    A deeper queue lets the decoder run further ahead of the application,
+    which helps when buffers are read in bursts. The default value of 0
+    lets the backend choose.
+
+    This property can only be set while the decoder is stopped.
+    Setting this property at other times will be ignored.
+*/
+int QAudioDecoder::bufferQueueLimit() const
+{
+    Q_D(const QAudioDecoder);
+    if (d->control)
+        return d->control->bufferQueueLimit();
+    return 0;
+}
+
+void QAudioDecoder::setBufferQueueLimit(int buffers)
+{
+    Q_D(QAudioDecoder);
+
+    if (state() != QAudioDecoder::StoppedState)
+        return;
+
+    if (d->control != nullptr)
+        d->control->setBufferQueueLimit(qMax(0, buffers));
+}
+
+/*!
+    \property QAudioDecoder::framesPerBuffer
+    \since 6.0
+
+    \brief the number of frames each decoded buffer holds.
+
+    When set, decoded audio is coalesced so every buffer returned by read()
+    holds exactly this many frames, except for the last buffer of a stream.
+    Larger buffers mean fewer read() calls when processing long files. The
+    default value of 0 returns buffers as the decoder produces them.
+
+    This property can only be set while the decoder is stopped.
+    Setting this property at other times will be ignored.
+*/
+int QAudioDecoder::framesPerBuffer() const
+{
+    Q_D(const QAudioDecoder);
+    if (d->control)
+        return d->control->framesPerBuffer();
+    return 0;
+}
+
+void QAudioDecoder::setFramesPerBuffer(int frames)
+{
+    Q_D(QAudioDecoder);
+
+    if (state() != QAudioDecoder::StoppedState)
+        return;
+
+    if (d->control != nullptr)
+        d->control->setFramesPerBuffer(qMax(0, frames));
+}
+
+/*!
+    \property QAudioDecoder::fastDecoding
+    \since 6.0
+
+    \brief whether audio is decoded as fast as possible.
+
+    By default bufferReady() is emitted once for every decoded buffer.
+    With fast decoding, bufferReady() is emitted once when buffers become
+    available and the application is expected to call read() until
+    bufferAvailable() returns false. This saves an event loop round trip
+    per buffer when decoding offline. Backends may also queue more buffers
+    unless \l bufferQueueLimit is set.
+
+    This property can only be set while the decoder is stopped.
+    Setting this property at other times will be ignored.
+*/
+bool QAudioDecoder::fastDecoding() const
+{
+    Q_D(const QAudioDecoder);
+    if (d->control)
+        return d->control->fastDecoding();
+    return false;
+}
+
+void QAudioDecoder::setFastDecoding(bool enabled)
+{
+    Q_D(QAudioDecoder);
+
+    if (state() != QAudioDecoder::StoppedState)
+        return;
+
+    if (d->control != nullptr)
+        d->control->setFastDecoding(enabled);
+}
+
+/*!
+    \enum QAudioDecoder::ConversionQuality
+    \since 6.0
+
+    Selects the sample rate converter used when decoded audio has to be
+    converted to the requested \l audioFormat().
+
+    \value FastConversion     Linear interpolation. Cheapest, but
+                              downsampling may alias.
+    \value BalancedConversion A 16 tap windowed sinc filter, good enough for
+                              playback.
+    \value BestConversion     A 64 tap windowed sinc filter, for analysis or
+                              transcoding.
+*/
+
+/*!
+    \property QAudioDecoder::conversionQuality
+    \since 6.0
+
+    \brief the quality of the sample rate conversion applied to decoded audio.
+
+    Channel layout and sample type conversions are exact at any quality.
+    The default is \c BalancedConversion.
+
+    This property can only be set while the decoder is stopped.
+    Setting this property at other times will be ignored.
+*/
+QAudioDecoder::ConversionQuality QAudioDecoder::conversionQuality() const
+{
+    return d_func()->conversionQuality;
+}
+
+void QAudioDecoder::setConversionQuality(ConversionQuality quality)
+{
+    Q_D(QAudioDecoder);
+
+    if (state() != QAudioDecoder::StoppedState)
+        return;
+
+    d->conversionQuality = quality;
+}
+
 /*!
     \internal
 */
@@ -369,7 +638,7 @@ bool QAudioDecoder::bufferAvailable() const
 {
     Q_D(const QAudioDecoder);
     if (d->control)
-        return d->control->bufferAvailable();
+        return d->control->bufferAvailable() || d->tail.isValid();
     return false;
 }
 
@@ -407,6 +676,11 @@ qint64 QAudioDecoder::duration() const
     You should either respond to the \l bufferReady() signal or check the
     \l bufferAvailable() function before calling read() to make sure
     you get useful data.
+
+    When QAudioDecoder converts the sample rate itself, the first buffer
+    may be invalid while the filter fills, and the last frames are returned
+    by an extra buffer. It becomes available once the backend's buffers have
+    all been read, and \l finished() is emitted right after it.
 */
 
 QAudioBuffer QAudioDecoder::read() const
@@ -414,7 +688,12 @@ QAudioBuffer QAudioDecoder::read() const
     Q_D(const QAudioDecoder);
 
     if (d->control) {
-        return d->control->read();
+        if (d->tail.isValid() && !d->control->bufferAvailable()) {
+            const QAudioBuffer tail = d->tail;
+            d->tail = QAudioBuffer();
+            return tail;
+        }
+        return d->convert(d->control->read());
     } else {
         return QAudioBuffer();
     }
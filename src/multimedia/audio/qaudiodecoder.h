@@ -55,9 +55,14 @@ class Q_MULTIMEDIA_EXPORT QAudioDecoder : public QMediaObject
     Q_PROPERTY(State state READ state NOTIFY stateChanged)
     Q_PROPERTY(QString error READ errorString)
     Q_PROPERTY(bool bufferAvailable READ bufferAvailable NOTIFY bufferAvailableChanged)
+    Q_PROPERTY(int bufferQueueLimit READ bufferQueueLimit WRITE setBufferQueueLimit)
+    Q_PROPERTY(int framesPerBuffer READ framesPerBuffer WRITE setFramesPerBuffer)
+    Q_PROPERTY(bool fastDecoding READ fastDecoding WRITE setFastDecoding)
+    Q_PROPERTY(ConversionQuality conversionQuality READ conversionQuality WRITE setConversionQuality)
 
     Q_ENUMS(State)
     Q_ENUMS(Error)
+    Q_ENUMS(ConversionQuality)
 
 public:
     enum State
@@ -75,6 +80,13 @@ public:
         ServiceMissingError
     };
 
+    enum ConversionQuality
+    {
+        FastConversion,
+        BalancedConversion,
+        BestConversion
+    };
+
     explicit QAudioDecoder(QObject *parent = nullptr);
     ~QAudioDecoder();
 
@@ -91,6 +103,18 @@ public:
     QAudioFormat audioFormat() const;
     void setAudioFormat(const QAudioFormat &format);
 
+    int bufferQueueLimit() const;
+    void setBufferQueueLimit(int buffers);
+
+    int framesPerBuffer() const;
+    void setFramesPerBuffer(int frames);
+
+    bool fastDecoding() const;
+    void setFastDecoding(bool enabled);
+
+    ConversionQuality conversionQuality() const;
+    void setConversionQuality(ConversionQuality quality);
+
     Error error() const;
     QString errorString() const;
 
@@ -128,6 +152,9 @@ private:
     Q_DECLARE_PRIVATE(QAudioDecoder)
     Q_PRIVATE_SLOT(d_func(), void _q_stateChanged(QAudioDecoder::State))
     Q_PRIVATE_SLOT(d_func(), void _q_error(int, const QString &))
+    Q_PRIVATE_SLOT(d_func(), void _q_bufferAvailableChanged(bool))
+    Q_PRIVATE_SLOT(d_func(), void _q_finished())
+    Q_PRIVATE_SLOT(d_func(), void _q_flushTail())
 };
 
 QT_END_NAMESPACE
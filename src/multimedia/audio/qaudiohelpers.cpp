@@ -39,52 +39,14 @@
 
 #include "qaudiohelpers_p.h"
 
-#include <QDebug>
-
-QT_BEGIN_NAMESPACE
+#include <private/qsimd_p.h>
 
-// Base implementation of 24 bits number.
-// Used to adjust 3 bytes values by a factor.
-// TODO: Uses little-endian only.
-class Int24
-{
-public:
-    quint8 data[3];
-    Int24(qint32 v) {
-        data[0] = v & 0xFF;
-        data[1] = (v & 0xFF00) >> 8;
-        data[2] = (v & 0xFF0000) >> 16;
-    }
-    template<class T>
-    T multiply(qreal factor, T v = 0) const {
-        v |= data[0];
-        v |= data[1] << 8;
-        v |= data[2] << 16;
-        v *= factor;
-        return v;
-    }
-};
+#include <QDebug>
+#include <QtCore/qmath.h>
 
-class qint24: public Int24
-{
-public:
-    qint24(qint32 v): Int24(v) {}
-    qint24 operator*(qreal factor) const {
-        // Checks if it is a signed value.
-        qint32 v = (data[2] & 0x80) ? 0xFF000000 : 0;
-        return multiply(factor, v);
-    }
-};
-
-class quint24: public Int24
-{
-public:
-    quint24(quint32 v): Int24(v) {}
-    quint24 operator*(qreal factor) const {
-        return multiply<quint32>(factor);
-    }
-};
+#include <algorithm>
 
+QT_BEGIN_NAMESPACE
 
 namespace QAudioHelperInternal
 {
@@ -112,12 +74,6 @@ template<> struct signedVersion<quint16>
     enum {offset = 0x8000};
 };
 
-template<> struct signedVersion<quint32>
-{
-    typedef qint32 TS;
-    enum {offset = 0x80000000};
-};
-
 template<class T> void adjustUnsignedSamples(qreal factor, const void *src, void *dst, int samples)
 {
     const T *pSrc = (const T *)src;
@@ -127,38 +83,617 @@ template<class T> void adjustUnsignedSamples(qreal factor, const void *src, void
     }
 }
 
+// Attenuation of 8 and 16 bit samples is done in Q15 fixed point.
+// Unsigned samples are flipped to signed ones by xor-ing the bias.
+enum { FixedPointShift = 15 };
+
+static inline bool fixedPointGain(qreal factor, int *gain)
+{
+    *gain = qRound(factor * (1 << FixedPointShift));
+    return factor > 0 && *gain < (1 << FixedPointShift);
+}
+
+static void scale8BitSamples(int gain, quint8 bias, const void *src, void *dst, int samples)
+{
+    const quint8 *pSrc = static_cast<const quint8 *>(src);
+    quint8 *pDst = static_cast<quint8 *>(dst);
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i vgain = _mm_set1_epi16(gain);
+    const __m128i vbias = _mm_set1_epi8(char(bias));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i < samples - 15; i += 16) {
+        const __m128i s = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + i)), vbias);
+        // (s << 8) * gain >> 16 >> 7 == s * gain >> 15
+        const __m128i lo = _mm_srai_epi16(_mm_mulhi_epi16(_mm_unpacklo_epi8(zero, s), vgain), 7);
+        const __m128i hi = _mm_srai_epi16(_mm_mulhi_epi16(_mm_unpackhi_epi8(zero, s), vgain), 7);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + i), _mm_xor_si128(_mm_packs_epi16(lo, hi), vbias));
+    }
+#elif defined(__ARM_NEON__)
+    const uint8x16_t vbias = vdupq_n_u8(bias);
+    for (; i < samples - 15; i += 16) {
+        const int8x16_t s = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(pSrc + i), vbias));
+        const int16x8_t lo = vqdmulhq_n_s16(vmovl_s8(vget_low_s8(s)), qint16(gain));
+        const int16x8_t hi = vqdmulhq_n_s16(vmovl_s8(vget_high_s8(s)), qint16(gain));
+        const int8x16_t r = vcombine_s8(vmovn_s16(lo), vmovn_s16(hi));
+        vst1q_u8(pDst + i, veorq_u8(vreinterpretq_u8_s8(r), vbias));
+    }
+#endif
+    for (; i < samples; ++i)
+        pDst[i] = quint8((qint8(pSrc[i] ^ bias) * gain) >> FixedPointShift) ^ bias;
+}
+
+static void scale16BitSamples(int gain, quint16 bias, const void *src, void *dst, int samples)
+{
+    const quint16 *pSrc = static_cast<const quint16 *>(src);
+    quint16 *pDst = static_cast<quint16 *>(dst);
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i vgain = _mm_set1_epi16(gain);
+    const __m128i vbias = _mm_set1_epi16(qint16(bias));
+    for (; i < samples - 7; i += 8) {
+        const __m128i s = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + i)), vbias);
+        const __m128i lo = _mm_mullo_epi16(s, vgain);
+        const __m128i hi = _mm_mulhi_epi16(s, vgain);
+        const __m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), FixedPointShift);
+        const __m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), FixedPointShift);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + i), _mm_xor_si128(_mm_packs_epi32(p0, p1), vbias));
+    }
+#elif defined(__ARM_NEON__)
+    const uint16x8_t vbias = vdupq_n_u16(bias);
+    for (; i < samples - 7; i += 8) {
+        const int16x8_t s = vreinterpretq_s16_u16(veorq_u16(vld1q_u16(pSrc + i), vbias));
+        const int16x8_t r = vqdmulhq_n_s16(s, qint16(gain));
+        vst1q_u16(pDst + i, veorq_u16(vreinterpretq_u16_s16(r), vbias));
+    }
+#endif
+    for (; i < samples; ++i)
+        pDst[i] = quint16((qint16(pSrc[i] ^ bias) * gain) >> FixedPointShift) ^ bias;
+}
+
+// TODO: Uses little-endian only.
+static void scale24BitSamples(qreal factor, bool isSigned, const void *src, void *dst, int samples)
+{
+    const quint8 *pSrc = static_cast<const quint8 *>(src);
+    quint8 *pDst = static_cast<quint8 *>(dst);
+    for (int i = 0; i < samples; ++i, pSrc += 3, pDst += 3) {
+        qint32 v = pSrc[0] | (pSrc[1] << 8) | (pSrc[2] << 16);
+        // Unsigned samples are biased around 0x800000, like the other unsigned sizes
+        if (!isSigned)
+            v -= 0x800000;
+        else if (v & 0x800000)
+            v -= 0x1000000;
+        v = qint32(v * factor);
+        if (!isSigned)
+            v += 0x800000;
+        pDst[0] = v & 0xFF;
+        pDst[1] = (v >> 8) & 0xFF;
+        pDst[2] = (v >> 16) & 0xFF;
+    }
+}
+
+// 32 bit integer samples need the precision of a double.
+static void scale32BitSamples(double factor, quint32 bias, const void *src, void *dst, int samples)
+{
+    const quint32 *pSrc = static_cast<const quint32 *>(src);
+    quint32 *pDst = static_cast<quint32 *>(dst);
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128d vfactor = _mm_set1_pd(factor);
+    const __m128i vbias = _mm_set1_epi32(qint32(bias));
+    for (; i < samples - 3; i += 4) {
+        const __m128i s = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + i)), vbias);
+        const __m128i r0 = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(s), vfactor));
+        const __m128i r1 = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(s, 8)), vfactor));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + i), _mm_xor_si128(_mm_unpacklo_epi64(r0, r1), vbias));
+    }
+#endif
+    for (; i < samples; ++i)
+        pDst[i] = quint32(qint32(qint32(pSrc[i] ^ bias) * factor)) ^ bias;
+}
+
+static void scaleFloatSamples(float factor, const void *src, void *dst, int samples)
+{
+    const float *pSrc = static_cast<const float *>(src);
+    float *pDst = static_cast<float *>(dst);
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 vfactor = _mm_set1_ps(factor);
+    for (; i < samples - 3; i += 4)
+        _mm_storeu_ps(pDst + i, _mm_mul_ps(_mm_loadu_ps(pSrc + i), vfactor));
+#elif defined(__ARM_NEON__)
+    for (; i < samples - 3; i += 4)
+        vst1q_f32(pDst + i, vmulq_n_f32(vld1q_f32(pSrc + i), factor));
+#endif
+    for (; i < samples; ++i)
+        pDst[i] = pSrc[i] * factor;
+}
+
+static void fillSilence(const QAudioFormat &format, void *dest, int samples)
+{
+    if (format.sampleType() != QAudioFormat::UnSignedInt) {
+        memset(dest, 0, samples * (format.sampleSize() / 8));
+        return;
+    }
+
+    // Unsigned silence is the middle of the range, not zero
+    switch (format.sampleSize()) {
+    case 8:
+        memset(dest, 0x80, samples);
+        break;
+    case 16:
+        std::fill_n(static_cast<quint16 *>(dest), samples, quint16(0x8000));
+        break;
+    case 24: {
+        // TODO: Uses little-endian only.
+        quint8 *p = static_cast<quint8 *>(dest);
+        for (int i = 0; i < samples; ++i, p += 3) {
+            p[0] = 0x00;
+            p[1] = 0x00;
+            p[2] = 0x80;
+        }
+        break;
+    }
+    default:
+        std::fill_n(static_cast<quint32 *>(dest), samples, quint32(0x80000000));
+        break;
+    }
+}
+
 void qMultiplySamples(qreal factor, const QAudioFormat &format, const void* src, void* dest, int len)
 {
     int samplesCount = len / (format.sampleSize()/8);
 
+    // Unity and mute are the common volumes, and need no arithmetic at all
+    if (factor == 1.0) {
+        if (src != dest)
+            memmove(dest, src, samplesCount * (format.sampleSize() / 8));
+        return;
+    }
+
+    if (factor == 0.0) {
+        fillSilence(format, dest, samplesCount);
+        return;
+    }
+
+    int gain = 0;
+
     switch ( format.sampleSize() ) {
     case 8:
-        if (format.sampleType() == QAudioFormat::SignedInt)
-            QAudioHelperInternal::adjustSamples<qint8>(factor,src,dest,samplesCount);
-        else if (format.sampleType() == QAudioFormat::UnSignedInt)
-            QAudioHelperInternal::adjustUnsignedSamples<quint8>(factor,src,dest,samplesCount);
+        if (format.sampleType() == QAudioFormat::SignedInt) {
+            if (fixedPointGain(factor, &gain))
+                scale8BitSamples(gain, 0, src, dest, samplesCount);
+            else
+                QAudioHelperInternal::adjustSamples<qint8>(factor,src,dest,samplesCount);
+        } else if (format.sampleType() == QAudioFormat::UnSignedInt) {
+            if (fixedPointGain(factor, &gain))
+                scale8BitSamples(gain, 0x80, src, dest, samplesCount);
+            else
+                QAudioHelperInternal::adjustUnsignedSamples<quint8>(factor,src,dest,samplesCount);
+        }
         break;
     case 16:
-        if (format.sampleType() == QAudioFormat::SignedInt)
-            QAudioHelperInternal::adjustSamples<qint16>(factor,src,dest,samplesCount);
-        else if (format.sampleType() == QAudioFormat::UnSignedInt)
-            QAudioHelperInternal::adjustUnsignedSamples<quint16>(factor,src,dest,samplesCount);
+        if (format.sampleType() == QAudioFormat::SignedInt) {
+            if (fixedPointGain(factor, &gain))
+                scale16BitSamples(gain, 0, src, dest, samplesCount);
+            else
+                QAudioHelperInternal::adjustSamples<qint16>(factor,src,dest,samplesCount);
+        } else if (format.sampleType() == QAudioFormat::UnSignedInt) {
+            if (fixedPointGain(factor, &gain))
+                scale16BitSamples(gain, 0x8000, src, dest, samplesCount);
+            else
+                QAudioHelperInternal::adjustUnsignedSamples<quint16>(factor,src,dest,samplesCount);
+        }
         break;
     case 24:
         if (format.sampleType() == QAudioFormat::SignedInt)
-            QAudioHelperInternal::adjustSamples<qint24>(factor,src,dest,samplesCount);
+            scale24BitSamples(factor, true, src, dest, samplesCount);
         else if (format.sampleType() == QAudioFormat::UnSignedInt)
-            QAudioHelperInternal::adjustSamples<quint24>(factor,src,dest,samplesCount);
+            scale24BitSamples(factor, false, src, dest, samplesCount);
         break;
     default:
         if (format.sampleType() == QAudioFormat::SignedInt)
-            QAudioHelperInternal::adjustSamples<qint32>(factor,src,dest,samplesCount);
+            scale32BitSamples(factor, 0, src, dest, samplesCount);
         else if (format.sampleType() == QAudioFormat::UnSignedInt)
-            QAudioHelperInternal::adjustUnsignedSamples<quint32>(factor,src,dest,samplesCount);
+            scale32BitSamples(factor, 0x80000000, src, dest, samplesCount);
         else if (format.sampleType() == QAudioFormat::Float)
-            QAudioHelperInternal::adjustSamples<float>(factor,src,dest,samplesCount);
+            scaleFloatSamples(float(factor), src, dest, samplesCount);
     }
 }
+
+// Mixing adds scaled samples to the destination, saturating integer formats.
+// A Q15 gain of 1 << 15 is unity, which does not fit a 16 bit lane.
+static void mix8BitSamples(int gain, quint8 bias, const void *src, void *dst, int samples)
+{
+    const quint8 *pSrc = static_cast<const quint8 *>(src);
+    quint8 *pDst = static_cast<quint8 *>(dst);
+    for (int i = 0; i < samples; ++i) {
+        const int value = qint8(pDst[i] ^ bias) + ((qint8(pSrc[i] ^ bias) * gain) >> FixedPointShift);
+        pDst[i] = quint8(qBound(-128, value, 127)) ^ bias;
+    }
+}
+
+static void mix16BitSamples(int gain, quint16 bias, const void *src, void *dst, int samples)
+{
+    const quint16 *pSrc = static_cast<const quint16 *>(src);
+    quint16 *pDst = static_cast<quint16 *>(dst);
+    const bool unity = gain == (1 << FixedPointShift);
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i vgain = _mm_set1_epi16(gain);
+    const __m128i vbias = _mm_set1_epi16(qint16(bias));
+    for (; i < samples - 7; i += 8) {
+        __m128i s = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + i)), vbias);
+        const __m128i d = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pDst + i)), vbias);
+        if (!unity) {
+            const __m128i lo = _mm_mullo_epi16(s, vgain);
+            const __m128i hi = _mm_mulhi_epi16(s, vgain);
+            s = _mm_packs_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), FixedPointShift),
+                                _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), FixedPointShift));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + i), _mm_xor_si128(_mm_adds_epi16(d, s), vbias));
+    }
+#elif defined(__ARM_NEON__)
+    const uint16x8_t vbias = vdupq_n_u16(bias);
+    for (; i < samples - 7; i += 8) {
+        int16x8_t s = vreinterpretq_s16_u16(veorq_u16(vld1q_u16(pSrc + i), vbias));
+        const int16x8_t d = vreinterpretq_s16_u16(veorq_u16(vld1q_u16(pDst + i), vbias));
+        if (!unity)
+            s = vqdmulhq_n_s16(s, qint16(gain));
+        vst1q_u16(pDst + i, veorq_u16(vreinterpretq_u16_s16(vqaddq_s16(d, s)), vbias));
+    }
+#else
+    Q_UNUSED(unity);
+#endif
+    for (; i < samples; ++i) {
+        const int value = qint16(pDst[i] ^ bias) + ((qint16(pSrc[i] ^ bias) * gain) >> FixedPointShift);
+        pDst[i] = quint16(qBound(-32768, value, 32767)) ^ bias;
+    }
+}
+
+static void mixFloatSamples(float factor, const void *src, void *dst, int samples)
+{
+    const float *pSrc = static_cast<const float *>(src);
+    float *pDst = static_cast<float *>(dst);
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 vfactor = _mm_set1_ps(factor);
+    for (; i < samples - 3; i += 4) {
+        const __m128 s = _mm_mul_ps(_mm_loadu_ps(pSrc + i), vfactor);
+        _mm_storeu_ps(pDst + i, _mm_add_ps(_mm_loadu_ps(pDst + i), s));
+    }
+#elif defined(__ARM_NEON__)
+    for (; i < samples - 3; i += 4)
+        vst1q_f32(pDst + i, vmlaq_n_f32(vld1q_f32(pDst + i), vld1q_f32(pSrc + i), factor));
+#endif
+    for (; i < samples; ++i)
+        pDst[i] += pSrc[i] * factor;
+}
+
+bool qCanMixSamples(const QAudioFormat &format)
+{
+    switch (format.sampleType()) {
+    case QAudioFormat::SignedInt:
+    case QAudioFormat::UnSignedInt:
+        return format.sampleSize() == 8 || format.sampleSize() == 16;
+    case QAudioFormat::Float:
+        return format.sampleSize() == 32;
+    default:
+        return false;
+    }
+}
+
+void qMixSamples(qreal factor, const QAudioFormat &format, const void *src, void *dest, int len)
+{
+    if (factor <= 0.0 || !qCanMixSamples(format))
+        return;
+
+    const int samplesCount = len / (format.sampleSize() / 8);
+    const int gain = qRound(qMin(factor, qreal(1)) * (1 << FixedPointShift));
+    const bool isSigned = format.sampleType() == QAudioFormat::SignedInt;
+
+    switch (format.sampleSize()) {
+    case 8:
+        mix8BitSamples(gain, isSigned ? 0 : 0x80, src, dest, samplesCount);
+        break;
+    case 16:
+        mix16BitSamples(gain, isSigned ? 0 : 0x8000, src, dest, samplesCount);
+        break;
+    default:
+        mixFloatSamples(float(factor), src, dest, samplesCount);
+        break;
+    }
+}
+
+static bool isConvertibleFormat(const QAudioFormat &format)
+{
+    if (!format.isValid() || format.byteOrder() != QAudioFormat::Endian(QSysInfo::ByteOrder))
+        return false;
+
+    switch (format.sampleType()) {
+    case QAudioFormat::SignedInt:
+    case QAudioFormat::UnSignedInt:
+        return format.sampleSize() == 8 || format.sampleSize() == 16
+                || format.sampleSize() == 24 || format.sampleSize() == 32;
+    case QAudioFormat::Float:
+        return format.sampleSize() == 32;
+    default:
+        return false;
+    }
+}
+
+// Reads a sample as a float in [-1, 1]
+static float readSample(const QAudioFormat &format, const uchar *p)
+{
+    const bool isSigned = format.sampleType() == QAudioFormat::SignedInt;
+    switch (format.sampleSize()) {
+    case 8:
+        return (isSigned ? *reinterpret_cast<const qint8 *>(p) : int(*p) - 0x80) / 128.0f;
+    case 16: {
+        const quint16 v = *reinterpret_cast<const quint16 *>(p);
+        return (isSigned ? qint16(v) : int(v) - 0x8000) / 32768.0f;
+    }
+    case 24: {
+        // TODO: Uses little-endian only.
+        qint32 v = p[0] | (p[1] << 8) | (p[2] << 16);
+        if (isSigned && (v & 0x800000))
+            v -= 0x1000000;
+        else if (!isSigned)
+            v -= 0x800000;
+        return v / 8388608.0f;
+    }
+    default:
+        if (format.sampleType() == QAudioFormat::Float)
+            return *reinterpret_cast<const float *>(p);
+        const quint32 v = *reinterpret_cast<const quint32 *>(p);
+        return float((isSigned ? qint64(qint32(v)) : qint64(v) - 0x80000000LL) / 2147483648.0);
+    }
+}
+
+static void writeSample(const QAudioFormat &format, uchar *p, float value)
+{
+    if (format.sampleType() == QAudioFormat::Float) {
+        *reinterpret_cast<float *>(p) = value;
+        return;
+    }
+
+    const bool isSigned = format.sampleType() == QAudioFormat::SignedInt;
+    const double clamped = qBound(-1.0, double(value), 1.0);
+    switch (format.sampleSize()) {
+    case 8: {
+        const int v = qBound(-128, qRound(clamped * 128), 127);
+        *p = isSigned ? quint8(qint8(v)) : quint8(v + 0x80);
+        break;
+    }
+    case 16: {
+        const int v = qBound(-32768, qRound(clamped * 32768), 32767);
+        *reinterpret_cast<quint16 *>(p) = isSigned ? quint16(qint16(v)) : quint16(v + 0x8000);
+        break;
+    }
+    case 24: {
+        const qint32 v = qBound(-8388608, qRound(clamped * 8388608), 8388607) + (isSigned ? 0 : 0x800000);
+        p[0] = v & 0xFF;
+        p[1] = (v >> 8) & 0xFF;
+        p[2] = (v >> 16) & 0xFF;
+        break;
+    }
+    default: {
+        const qint64 v = qBound(Q_INT64_C(-2147483648), qRound64(clamped * 2147483648.0), Q_INT64_C(2147483647));
+        *reinterpret_cast<quint32 *>(p) = isSigned ? quint32(qint32(v)) : quint32(v + 0x80000000LL);
+        break;
+    }
+    }
+}
+
+bool qCanConvertSamples(const QAudioFormat &sourceFormat, const QAudioFormat &targetFormat)
+{
+    return isConvertibleFormat(sourceFormat) && isConvertibleFormat(targetFormat);
+}
+
+/*
+    Converts \a data from \a sourceFormat to \a targetFormat, including the
+    sample type, channel count and sample rate, using a QAudioResampler of
+    the given \a quality. This is meant for converting whole sounds at load
+    time; streams should keep a QAudioResampler instead.
+*/
+QByteArray qConvertSamples(const QAudioFormat &sourceFormat, const QAudioFormat &targetFormat,
+                           const QByteArray &data, QAudioResampler::Quality quality)
+{
+    if (sourceFormat == targetFormat || !qCanConvertSamples(sourceFormat, targetFormat))
+        return data;
+
+    QAudioResampler resampler(sourceFormat, targetFormat, quality);
+    QByteArray result = resampler.process(data);
+    result += resampler.flush();
+    return result;
+}
+
+void qSamplesToFloat(const QAudioFormat &format, const void *src, float *dest, int samples)
+{
+    if (format.sampleType() == QAudioFormat::Float) {
+        memcpy(dest, src, samples * sizeof(float));
+        return;
+    }
+
+    int i = 0;
+    if (format.sampleSize() == 16 && format.sampleType() == QAudioFormat::SignedInt) {
+        const qint16 *pSrc = static_cast<const qint16 *>(src);
+#if defined(__SSE2__)
+        const __m128 scale = _mm_set1_ps(1.0f / 32768);
+        for (; i < samples - 7; i += 8) {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + i));
+            // Sign extend by moving each sample to the high half of a 32 bit lane
+            const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+            const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+            _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+#elif defined(__ARM_NEON__)
+        for (; i < samples - 7; i += 8) {
+            const int16x8_t s = vld1q_s16(pSrc + i);
+            vst1q_f32(dest + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), 1.0f / 32768));
+            vst1q_f32(dest + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), 1.0f / 32768));
+        }
+#endif
+        for (; i < samples; ++i)
+            dest[i] = pSrc[i] / 32768.0f;
+        return;
+    }
+
+    const uchar *pSrc = static_cast<const uchar *>(src);
+    const int sampleBytes = format.sampleSize() / 8;
+    for (; i < samples; ++i)
+        dest[i] = readSample(format, pSrc + i * sampleBytes);
+}
+
+void qFloatToSamples(const QAudioFormat &format, const float *src, void *dest, int samples)
+{
+    if (format.sampleType() == QAudioFormat::Float) {
+        memcpy(dest, src, samples * sizeof(float));
+        return;
+    }
+
+    int i = 0;
+    if (format.sampleSize() == 16 && format.sampleType() == QAudioFormat::SignedInt) {
+        qint16 *pDst = static_cast<qint16 *>(dest);
+#if defined(__SSE2__)
+        const __m128 scale = _mm_set1_ps(32768.0f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 minusOne = _mm_set1_ps(-1.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        // Rounds half away from zero like qRound(); _mm_cvtps_epi32() would round half to even
+        const auto round = [&](__m128 v) {
+            v = _mm_mul_ps(_mm_min_ps(_mm_max_ps(v, minusOne), one), scale);
+            return _mm_cvttps_epi32(_mm_add_ps(v, _mm_or_ps(half, _mm_and_ps(v, signMask))));
+        };
+        for (; i < samples - 7; i += 8) {
+            // Packing saturates 32768 to 32767
+            const __m128i v = _mm_packs_epi32(round(_mm_loadu_ps(src + i)),
+                                              round(_mm_loadu_ps(src + i + 4)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + i), v);
+        }
+#elif defined(__ARM_NEON__)
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        const float32x4_t minusHalf = vdupq_n_f32(-0.5f);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        for (; i < samples - 3; i += 4) {
+            // Conversion truncates, round half away from zero first
+            const float32x4_t v = vmulq_n_f32(vld1q_f32(src + i), 32768.0f);
+            const float32x4_t rounded = vaddq_f32(v, vbslq_f32(vcltq_f32(v, zero), minusHalf, half));
+            vst1_s16(pDst + i, vqmovn_s32(vcvtq_s32_f32(rounded)));
+        }
+#endif
+        for (; i < samples; ++i)
+            pDst[i] = qint16(qBound(-32768, qRound(qBound(-1.0f, src[i], 1.0f) * 32768), 32767));
+        return;
+    }
+
+    uchar *pDst = static_cast<uchar *>(dest);
+    const int sampleBytes = format.sampleSize() / 8;
+    for (; i < samples; ++i)
+        writeSample(format, pDst + i * sampleBytes, src[i]);
+}
+
+// Gains are interpolated in steps of this many frames, which is short enough to be inaudible
+enum { RampStepFrames = 16 };
+
+// Exponential ramps cannot reach zero, so they bottom out at -60 dB
+static const qreal ExponentialRampFloor = 0.001;
+
+static qreal rampGain(qreal from, qreal to, RampShape shape, qreal progress)
+{
+    if (progress >= 1.0)
+        return to;
+    if (shape == LinearRamp)
+        return from + (to - from) * progress;
+
+    const qreal start = qMax(from, ExponentialRampFloor);
+    const qreal end = qMax(to, ExponentialRampFloor);
+    return start * qPow(end / start, progress);
+}
+
+void qMultiplySamples(qreal startFactor, qreal endFactor, RampShape shape,
+                      const QAudioFormat &format, const void *src, void *dest, int len)
+{
+    const int bytesPerFrame = format.bytesPerFrame();
+    const int frames = bytesPerFrame > 0 ? len / bytesPerFrame : 0;
+    if (startFactor == endFactor || frames == 0) {
+        qMultiplySamples(endFactor, format, src, dest, len);
+        return;
+    }
+
+    const char *pSrc = static_cast<const char *>(src);
+    char *pDst = static_cast<char *>(dest);
+    for (int frame = 0; frame < frames; frame += RampStepFrames) {
+        const int stepFrames = qMin(int(RampStepFrames), frames - frame);
+        const qreal progress = qreal(frame + stepFrames) / frames;
+        const int offset = frame * bytesPerFrame;
+        qMultiplySamples(rampGain(startFactor, endFactor, shape, progress), format,
+                         pSrc + offset, pDst + offset, stepFrames * bytesPerFrame);
+    }
+
+    // A trailing partial frame is left at the final gain
+    const int tail = frames * bytesPerFrame;
+    if (tail < len)
+        qMultiplySamples(endFactor, format, pSrc + tail, pDst + tail, len - tail);
+}
+
+void VolumeRamp::setVolume(qreal volume)
+{
+    m_from = m_target = volume;
+    m_ramping = false;
+}
+
+void VolumeRamp::rampTo(qreal volume)
+{
+    if (volume == m_target)
+        return;
+
+    m_from = currentVolume();
+    m_target = volume;
+    m_position = 0;
+    // Resolved from the sample rate by the next process() call
+    m_length = 0;
+    m_ramping = m_duration > 0 && m_from != m_target;
+}
+
+qreal VolumeRamp::currentVolume() const
+{
+    if (!m_ramping)
+        return m_target;
+    if (m_length == 0)
+        return m_from;
+    return rampGain(m_from, m_target, m_shape, qreal(m_position) / m_length);
+}
+
+void VolumeRamp::process(const QAudioFormat &format, const void *src, void *dest, int len)
+{
+    const int bytesPerFrame = format.bytesPerFrame();
+    if (m_ramping && bytesPerFrame > 0) {
+        if (m_length == 0)
+            m_length = qMax<qint64>(1, format.framesForDuration(qint64(m_duration) * 1000));
+
+        const int frames = int(qMin<qint64>(m_length - m_position, len / bytesPerFrame));
+        if (frames > 0) {
+            const qreal startFactor = currentVolume();
+            m_position += frames;
+            const qreal endFactor = currentVolume();
+
+            const int bytes = frames * bytesPerFrame;
+            qMultiplySamples(startFactor, endFactor, m_shape, format, src, dest, bytes);
+            src = static_cast<const char *>(src) + bytes;
+            dest = static_cast<char *>(dest) + bytes;
+            len -= bytes;
+        }
+
+        if (m_position >= m_length)
+            m_ramping = false;
+    }
+
+    if (len > 0)
+        qMultiplySamples(m_target, format, src, dest, len);
+}
 }
 
 QT_END_NAMESPACE
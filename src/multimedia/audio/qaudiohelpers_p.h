@@ -52,12 +52,63 @@
 //
 
 #include <qaudioformat.h>
+#include "qaudioresampler_p.h"
 
 QT_BEGIN_NAMESPACE
 
 namespace QAudioHelperInternal
 {
 Q_MULTIMEDIA_EXPORT void qMultiplySamples(qreal factor, const QAudioFormat& format, const void *src, void* dest, int len);
+
+Q_MULTIMEDIA_EXPORT bool qCanMixSamples(const QAudioFormat &format);
+Q_MULTIMEDIA_EXPORT void qMixSamples(qreal factor, const QAudioFormat &format, const void *src, void *dest, int len);
+
+Q_MULTIMEDIA_EXPORT bool qCanConvertSamples(const QAudioFormat &sourceFormat, const QAudioFormat &targetFormat);
+Q_MULTIMEDIA_EXPORT QByteArray qConvertSamples(const QAudioFormat &sourceFormat, const QAudioFormat &targetFormat,
+                                               const QByteArray &data,
+                                               QAudioResampler::Quality quality = QAudioResampler::MediumQuality);
+
+// Both require a format accepted by qCanConvertSamples()
+Q_MULTIMEDIA_EXPORT void qSamplesToFloat(const QAudioFormat &format, const void *src, float *dest, int samples);
+Q_MULTIMEDIA_EXPORT void qFloatToSamples(const QAudioFormat &format, const float *src, void *dest, int samples);
+
+enum RampShape {
+    LinearRamp,
+    ExponentialRamp
+};
+
+Q_MULTIMEDIA_EXPORT void qMultiplySamples(qreal startFactor, qreal endFactor, RampShape shape,
+                                          const QAudioFormat &format, const void *src, void *dest, int len);
+
+// Applies a software volume to consecutive buffers of a stream, fading
+// smoothly to a new volume instead of jumping to it.
+class Q_MULTIMEDIA_EXPORT VolumeRamp
+{
+public:
+    void setVolume(qreal volume);
+    void rampTo(qreal volume);
+    qreal volume() const { return m_target; }
+    qreal currentVolume() const;
+
+    void setDuration(int msecs) { m_duration = msecs; }
+    int duration() const { return m_duration; }
+    void setShape(RampShape shape) { m_shape = shape; }
+    RampShape shape() const { return m_shape; }
+
+    bool isRamping() const { return m_ramping; }
+    bool isUnity() const { return !m_ramping && m_target == 1.0; }
+
+    void process(const QAudioFormat &format, const void *src, void *dest, int len);
+
+private:
+    RampShape m_shape = LinearRamp;
+    int m_duration = 20;
+    qreal m_from = 1.0;
+    qreal m_target = 1.0;
+    qint64 m_position = 0;
+    qint64 m_length = 0;
+    bool m_ramping = false;
+};
 }
 
 QT_END_NAMESPACE
@@ -0,0 +1,435 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudioresampler_p.h"
+#include "qaudiohelpers_p.h"
+
+#include <private/qsimd_p.h>
+
+#include <QtCore/qmath.h>
+
+QT_BEGIN_NAMESPACE
+
+// Rate ratios with more phases than this interpolate between table rows
+enum { MaxTablePhases = 256 };
+// Longest filter, reached when downsampling by large factors
+enum { MaxHalfLength = 256 };
+
+struct FilterParameters
+{
+    int halfLength;     // Taps on either side of the output position at unity ratio
+    double beta;        // Kaiser window shape
+    double rolloff;     // Cutoff as a fraction of the lower Nyquist frequency
+};
+
+static FilterParameters filterParameters(QAudioResampler::Quality quality)
+{
+    switch (quality) {
+    case QAudioResampler::FastQuality:
+        return { 1, 0.0, 1.0 };
+    case QAudioResampler::HighQuality:
+        return { 32, 8.6, 0.94 };
+    case QAudioResampler::MediumQuality:
+    default:
+        return { 8, 6.0, 0.85 };
+    }
+}
+
+static int greatestCommonDivisor(int a, int b)
+{
+    while (b) {
+        const int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Modified Bessel function of the first kind, order zero
+static double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64; ++k) {
+        const double f = x / (2 * k);
+        term *= f * f;
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+static inline float dotProduct(const float *a, const float *b, int n)
+{
+    float sum = 0.0f;
+    int i = 0;
+#if defined(__SSE2__)
+    __m128 acc = _mm_setzero_ps();
+    for (; i < n - 3; i += 4)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__ARM_NEON__)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i < n - 3; i += 4)
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    float lanes[4];
+    vst1q_f32(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+/*
+    Creates a resampler converting from \a sourceFormat to \a targetFormat.
+    The filter length and window depend on \a quality:
+
+    FastQuality interpolates linearly between neighbouring frames. It costs
+    two multiplications per sample but does not filter, so downsampling
+    aliases.
+
+    MediumQuality and HighQuality use a Kaiser windowed sinc with 16 and 64
+    taps respectively. When downsampling, the cutoff follows the target
+    Nyquist frequency and the filter is stretched by the same ratio.
+*/
+QAudioResampler::QAudioResampler(const QAudioFormat &sourceFormat, const QAudioFormat &targetFormat,
+                                 Quality quality)
+    : m_sourceFormat(sourceFormat)
+    , m_targetFormat(targetFormat)
+    , m_quality(quality)
+{
+    m_valid = canConvert(sourceFormat, targetFormat)
+            && sourceFormat.channelCount() > 0 && targetFormat.channelCount() > 0
+            && sourceFormat.sampleRate() > 0 && targetFormat.sampleRate() > 0;
+    if (!m_valid)
+        return;
+
+    m_sourceChannels = sourceFormat.channelCount();
+    m_channels = targetFormat.channelCount();
+    setupMatrix();
+    setupFilter();
+    reset();
+}
+
+QAudioResampler::~QAudioResampler()
+{
+}
+
+bool QAudioResampler::canConvert(const QAudioFormat &sourceFormat, const QAudioFormat &targetFormat)
+{
+    return qCanConvertSamples(sourceFormat, targetFormat);
+}
+
+/*
+    Standard downmixes for mono and 5.1 sources and targets; other layouts
+    fold the extra channels onto the available ones, or leave the extra
+    target channels silent.
+*/
+void QAudioResampler::setupMatrix()
+{
+    m_matrix.clear();
+    if (m_sourceChannels == m_channels)
+        return;
+
+    m_matrix.fill(0.0f, m_channels * m_sourceChannels);
+    float *gains = m_matrix.data();
+
+    if (m_sourceChannels == 1) {
+        for (int c = 0; c < m_channels; ++c)
+            gains[c] = 1.0f;
+    } else if (m_channels == 1) {
+        for (int c = 0; c < m_sourceChannels; ++c)
+            gains[c] = 1.0f / m_sourceChannels;
+    } else if (m_sourceChannels == 6 && m_channels == 2) {
+        // FL FR C LFE SL SR, ITU-R BS.775 with the LFE dropped, scaled so a
+        // full scale signal on all channels cannot clip
+        const float centre = float(M_SQRT1_2);
+        const float scale = 1.0f / (1.0f + 2 * centre);
+        float *left = gains;
+        float *right = gains + m_sourceChannels;
+        left[0] = scale;
+        left[2] = centre * scale;
+        left[4] = centre * scale;
+        right[1] = scale;
+        right[2] = centre * scale;
+        right[5] = centre * scale;
+    } else if (m_sourceChannels > m_channels) {
+        for (int c = 0; c < m_sourceChannels; ++c)
+            gains[(c % m_channels) * m_sourceChannels + c] = 1.0f;
+        for (int row = 0; row < m_channels; ++row) {
+            const int inputs = (m_sourceChannels - row + m_channels - 1) / m_channels;
+            for (int c = 0; c < m_sourceChannels; ++c)
+                gains[row * m_sourceChannels + c] /= inputs;
+        }
+    } else {
+        for (int c = 0; c < m_sourceChannels; ++c)
+            gains[c * m_sourceChannels + c] = 1.0f;
+    }
+}
+
+/*
+    Builds a polyphase table for the reduced ratio m_phases / m_step. Each
+    row holds the taps for one fractional output position, normalised to
+    unity gain. Ratios that need too many rows keep MaxTablePhases + 1 rows
+    and interpolate between them.
+*/
+void QAudioResampler::setupFilter()
+{
+    const int sourceRate = m_sourceFormat.sampleRate();
+    const int targetRate = m_targetFormat.sampleRate();
+    m_resample = sourceRate != targetRate;
+    m_table.clear();
+    m_kernel.clear();
+    if (!m_resample) {
+        m_phases = m_step = m_halfLength = 1;
+        m_tablePhases = 0;
+        return;
+    }
+
+    const int divisor = greatestCommonDivisor(sourceRate, targetRate);
+    m_phases = targetRate / divisor;
+    m_step = sourceRate / divisor;
+
+    const FilterParameters params = filterParameters(m_quality);
+    const bool linear = m_quality == FastQuality;
+    const double ratio = qMin(1.0, double(targetRate) / sourceRate);
+    const double cutoff = params.rolloff * ratio;
+    m_halfLength = linear ? 1 : qMin(int(MaxHalfLength), qCeil(params.halfLength / ratio));
+    const double windowScale = 1.0 / besselI0(params.beta);
+
+    const int taps = 2 * m_halfLength;
+    m_tablePhases = qMin(m_phases, int(MaxTablePhases));
+    const int rows = m_tablePhases == m_phases ? m_phases : m_tablePhases + 1;
+    m_table.resize(rows * taps);
+    if (m_tablePhases != m_phases)
+        m_kernel.resize(taps);
+
+    for (int row = 0; row < rows; ++row) {
+        const double fraction = double(row) / m_tablePhases;
+        float *kernel = m_table.data() + row * taps;
+        double sum = 0.0;
+        for (int t = 0; t < taps; ++t) {
+            // Distance from the output position to this tap, in input frames
+            const double d = fraction + (m_halfLength - 1 - t);
+            double h;
+            if (linear) {
+                h = qMax(0.0, 1.0 - qAbs(d));
+            } else {
+                const double x = d / m_halfLength;
+                const double window = qAbs(x) < 1.0
+                        ? besselI0(params.beta * qSqrt(1.0 - x * x)) * windowScale : 0.0;
+                const double arg = M_PI * cutoff * d;
+                h = (qFuzzyIsNull(arg) ? 1.0 : qSin(arg) / arg) * window;
+            }
+            kernel[t] = float(h);
+            sum += h;
+        }
+        if (sum != 0.0) {
+            for (int t = 0; t < taps; ++t)
+                kernel[t] = float(kernel[t] / sum);
+        }
+    }
+}
+
+/*
+    Discards any buffered input and starts a new stream.
+*/
+void QAudioResampler::reset()
+{
+    m_history.clear();
+    if (m_resample) {
+        // Prime with silence so the first output is centred on the first input frame
+        m_history.resize(m_channels);
+        for (QVector<float> &channel : m_history)
+            channel.fill(0.0f, m_halfLength - 1);
+    }
+    m_index = 0;
+    m_phase = 0;
+    m_inputFrames = 0;
+    m_outputFrames = 0;
+}
+
+/*
+    Returns true if flush() would produce more frames.
+*/
+bool QAudioResampler::hasPendingFrames() const
+{
+    return m_resample && m_outputFrames < m_inputFrames * m_phases / m_step;
+}
+
+const float *QAudioResampler::kernelFor(int phase)
+{
+    const int taps = 2 * m_halfLength;
+    if (m_tablePhases == m_phases)
+        return m_table.constData() + phase * taps;
+
+    const qint64 scaled = qint64(phase) * m_tablePhases;
+    const int row = int(scaled / m_phases);
+    const float weight = float(scaled % m_phases) / m_phases;
+    const float *a = m_table.constData() + row * taps;
+    const float *b = a + taps;
+    float *kernel = m_kernel.data();
+    for (int t = 0; t < taps; ++t)
+        kernel[t] = a[t] + (b[t] - a[t]) * weight;
+    return kernel;
+}
+
+void QAudioResampler::appendFrames(const float *samples, int frames)
+{
+    for (int c = 0; c < m_channels; ++c) {
+        QVector<float> &channel = m_history[c];
+        const int offset = channel.size();
+        channel.resize(offset + frames);
+        float *dst = channel.data() + offset;
+        const float *src = samples + c;
+        for (int i = 0; i < frames; ++i, src += m_channels)
+            dst[i] = src[0];
+    }
+}
+
+/*
+    Produces as many interleaved frames in m_output as the buffered input
+    allows and drops the input no longer needed. The output never runs
+    ahead of the input duration, so the total matches it after flush().
+*/
+int QAudioResampler::resample()
+{
+    const int taps = 2 * m_halfLength;
+    const int available = m_history.isEmpty() ? 0 : m_history.at(0).size();
+    const qint64 limit = m_inputFrames * m_phases / m_step;
+
+    const int maxFrames = available - taps - m_index >= 0
+            ? int(qint64(available - taps - m_index + 1) * m_phases / m_step + 1) : 0;
+    m_output.resize(maxFrames * m_channels);
+    float *out = m_output.data();
+
+    int frames = 0;
+    while (m_index + taps <= available && m_outputFrames < limit) {
+        const float *kernel = kernelFor(m_phase);
+        for (int c = 0; c < m_channels; ++c)
+            *out++ = dotProduct(m_history.at(c).constData() + m_index, kernel, taps);
+        ++frames;
+        ++m_outputFrames;
+        m_phase += m_step;
+        m_index += m_phase / m_phases;
+        m_phase %= m_phases;
+    }
+    m_output.resize(frames * m_channels);
+
+    const int consumed = qMin(m_index, available);
+    if (consumed > 0) {
+        for (QVector<float> &channel : m_history)
+            channel.remove(0, consumed);
+        m_index -= consumed;
+    }
+    return frames;
+}
+
+QByteArray QAudioResampler::takeOutput(const float *samples, int frames)
+{
+    QByteArray result(frames * m_targetFormat.bytesPerFrame(), Qt::Uninitialized);
+    qFloatToSamples(m_targetFormat, samples, result.data(), frames * m_channels);
+    return result;
+}
+
+/*
+    Converts \a len bytes of \a data and returns the frames that are ready
+    in the target format. A trailing partial frame is ignored. When
+    resampling, the filter holds back the last few frames until more input
+    arrives or flush() is called.
+*/
+QByteArray QAudioResampler::process(const void *data, int len)
+{
+    if (!m_valid || len <= 0)
+        return QByteArray();
+
+    const int frames = m_sourceFormat.framesForBytes(len);
+    if (frames <= 0)
+        return QByteArray();
+
+    m_input.resize(frames * m_sourceChannels);
+    qSamplesToFloat(m_sourceFormat, data, m_input.data(), frames * m_sourceChannels);
+
+    const float *mixed = m_input.constData();
+    if (!m_matrix.isEmpty()) {
+        m_output.resize(frames * m_channels);
+        float *out = m_output.data();
+        const float *in = m_input.constData();
+        for (int i = 0; i < frames; ++i, in += m_sourceChannels) {
+            const float *gains = m_matrix.constData();
+            for (int c = 0; c < m_channels; ++c, gains += m_sourceChannels)
+                *out++ = dotProduct(in, gains, m_sourceChannels);
+        }
+        mixed = m_output.constData();
+    }
+
+    m_inputFrames += frames;
+    if (!m_resample) {
+        m_outputFrames += frames;
+        return takeOutput(mixed, frames);
+    }
+
+    appendFrames(mixed, frames);
+    const int produced = resample();
+    return takeOutput(m_output.constData(), produced);
+}
+
+/*
+    Ends the stream, returning the frames held back by the filter, and
+    resets the resampler. The total output matches the input duration,
+    rounded down to a whole target frame.
+*/
+QByteArray QAudioResampler::flush()
+{
+    QByteArray result;
+    if (m_valid && m_resample && hasPendingFrames()) {
+        const QVector<float> silence(m_halfLength * m_channels, 0.0f);
+        appendFrames(silence.constData(), m_halfLength);
+        const int produced = resample();
+        result = takeOutput(m_output.constData(), produced);
+    }
+    reset();
+    return result;
+}
+
+QT_END_NAMESPACE
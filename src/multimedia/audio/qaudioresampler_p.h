@@ -0,0 +1,131 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIORESAMPLER_P_H
+#define QAUDIORESAMPLER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtMultimedia/qaudioformat.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+// Converts a stream of samples between formats, including the sample type,
+// channel count and sample rate. Channels are remapped through a mixing
+// matrix and rates converted by a windowed-sinc polyphase filter. The filter
+// keeps its history between calls to process(); flush() ends the stream.
+class Q_MULTIMEDIA_EXPORT QAudioResampler
+{
+public:
+    enum Quality {
+        FastQuality,    // Linear interpolation, no anti-aliasing
+        MediumQuality,  // Windowed sinc, 16 taps at unity ratio
+        HighQuality     // Windowed sinc, 64 taps at unity ratio
+    };
+
+    QAudioResampler(const QAudioFormat &sourceFormat, const QAudioFormat &targetFormat,
+                    Quality quality = MediumQuality);
+    ~QAudioResampler();
+
+    static bool canConvert(const QAudioFormat &sourceFormat, const QAudioFormat &targetFormat);
+
+    bool isValid() const { return m_valid; }
+    QAudioFormat sourceFormat() const { return m_sourceFormat; }
+    QAudioFormat targetFormat() const { return m_targetFormat; }
+    Quality quality() const { return m_quality; }
+
+    QByteArray process(const void *data, int len);
+    QByteArray process(const QByteArray &data) { return process(data.constData(), data.size()); }
+    QByteArray flush();
+    void reset();
+
+    bool hasPendingFrames() const;
+    qint64 outputFrames() const { return m_outputFrames; }
+
+private:
+    void setupMatrix();
+    void setupFilter();
+    void appendFrames(const float *samples, int frames);
+    int resample();
+    const float *kernelFor(int phase);
+    QByteArray takeOutput(const float *samples, int frames);
+
+    QAudioFormat m_sourceFormat;
+    QAudioFormat m_targetFormat;
+    Quality m_quality;
+    bool m_valid = false;
+
+    int m_sourceChannels = 0;
+    int m_channels = 0;
+    QVector<float> m_matrix;        // m_channels rows of m_sourceChannels gains, empty for identity
+
+    // Rate conversion moves by m_step / m_phases input frames per output frame
+    bool m_resample = false;
+    int m_phases = 1;
+    int m_step = 1;
+    int m_halfLength = 1;           // Taps on either side of the output position
+    int m_tablePhases = 0;          // Kernel rows in m_table; interpolated if not m_phases
+    QVector<float> m_table;
+    QVector<float> m_kernel;
+
+    QVector<QVector<float>> m_history;  // Planar input, centred on m_index
+    int m_index = 0;
+    int m_phase = 0;
+    qint64 m_inputFrames = 0;
+    qint64 m_outputFrames = 0;
+
+    QVector<float> m_input;
+    QVector<float> m_output;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIORESAMPLER_P_H
@@ -0,0 +1,186 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qaudioringbuffer_p.h"
+
+#include <QtCore/qglobal.h>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+QAudioRingBuffer::QAudioRingBuffer(int bufferSize)
+    : m_bufferSize(qMax(bufferSize, 1))
+{
+    m_buffer = new char[m_bufferSize];
+    reset();
+}
+
+QAudioRingBuffer::~QAudioRingBuffer()
+{
+    delete[] m_buffer;
+}
+
+QAudioRingBuffer::Region QAudioRingBuffer::acquireReadRegion(int size)
+{
+    const int used = int(m_writeCount.loadAcquire() - m_readCount.loadRelaxed());
+    const int readSize = qMin(size, qMin(m_bufferSize - m_readPos, used));
+
+    return readSize > 0 ? Region(m_buffer + m_readPos, readSize) : Region(nullptr, 0);
+}
+
+void QAudioRingBuffer::releaseReadRegion(const Region &region)
+{
+    m_readPos = (m_readPos + region.second) % m_bufferSize;
+
+    m_readCount.storeRelease(m_readCount.loadRelaxed() + quint32(region.second));
+}
+
+int QAudioRingBuffer::read(char *data, int size)
+{
+    int total = 0;
+
+    // At most two regions, the second one starts at the beginning of the buffer
+    while (total < size) {
+        const Region region = acquireReadRegion(size - total);
+        if (region.second <= 0)
+            break;
+        memcpy(data + total, region.first, region.second);
+        releaseReadRegion(region);
+        total += region.second;
+    }
+    return total;
+}
+
+QAudioRingBuffer::Region QAudioRingBuffer::acquireWriteRegion(int size)
+{
+    const int free = m_bufferSize - int(m_writeCount.loadRelaxed() - m_readCount.loadAcquire());
+    const int writeSize = qMin(size, qMin(m_bufferSize - m_writePos, free));
+
+    return writeSize > 0 ? Region(m_buffer + m_writePos, writeSize) : Region(nullptr, 0);
+}
+
+void QAudioRingBuffer::releaseWriteRegion(const Region &region)
+{
+    m_writePos = (m_writePos + region.second) % m_bufferSize;
+
+    m_writeCount.storeRelease(m_writeCount.loadRelaxed() + quint32(region.second));
+}
+
+int QAudioRingBuffer::write(const char *data, int size)
+{
+    int total = 0;
+
+    while (total < size) {
+        const Region region = acquireWriteRegion(size - total);
+        if (region.second <= 0)
+            break;
+        memcpy(region.first, data + total, region.second);
+        releaseWriteRegion(region);
+        total += region.second;
+    }
+    return total;
+}
+
+// Exact on either side, the caller's own count cannot change under it
+int QAudioRingBuffer::used() const
+{
+    return int(m_writeCount.loadAcquire() - m_readCount.loadAcquire());
+}
+
+int QAudioRingBuffer::free() const
+{
+    return m_bufferSize - used();
+}
+
+int QAudioRingBuffer::size() const
+{
+    return m_bufferSize;
+}
+
+void QAudioRingBuffer::reset()
+{
+    m_readPos = 0;
+    m_writePos = 0;
+    m_readCount.storeRelaxed(0);
+    m_writeCount.storeRelaxed(0);
+}
+
+QAudioRingBufferDevice::QAudioRingBufferDevice(QAudioRingBuffer *buffer, QObject *parent)
+    : QIODevice(parent)
+    , m_buffer(buffer)
+{
+}
+
+QAudioRingBufferDevice::~QAudioRingBufferDevice()
+{
+}
+
+QAudioRingBuffer *QAudioRingBufferDevice::ringBuffer() const
+{
+    return m_buffer;
+}
+
+qint64 QAudioRingBufferDevice::readData(char *data, qint64 len)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+
+    return 0;
+}
+
+qint64 QAudioRingBufferDevice::writeData(const char *data, qint64 len)
+{
+    if (!m_buffer)
+        return 0;
+
+    const int written = m_buffer->write(data, int(qMin<qint64>(len, m_buffer->size())));
+    if (written > 0)
+        dataWritten(written);
+    return written;
+}
+
+void QAudioRingBufferDevice::dataWritten(qint64 len)
+{
+    Q_UNUSED(len);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qaudioringbuffer_p.cpp"
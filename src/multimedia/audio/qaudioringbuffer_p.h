@@ -0,0 +1,129 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QAUDIORINGBUFFER_P_H
+#define QAUDIORINGBUFFER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qpair.h>
+
+QT_BEGIN_NAMESPACE
+
+// Single producer, single consumer byte ring. One thread may write while
+// another one reads without any locking. Each side owns its position and
+// publishes a running byte count on its own cache line, so the fill level
+// is exact and reading it never waits.
+class Q_MULTIMEDIA_EXPORT QAudioRingBuffer
+{
+public:
+    typedef QPair<char *, int> Region;
+
+    explicit QAudioRingBuffer(int bufferSize);
+    ~QAudioRingBuffer();
+
+    // Consumer side
+    Region acquireReadRegion(int size);
+    void releaseReadRegion(const Region &region);
+    int read(char *data, int size);
+
+    // Producer side
+    Region acquireWriteRegion(int size);
+    void releaseWriteRegion(const Region &region);
+    int write(const char *data, int size);
+
+    int used() const;
+    int free() const;
+    int size() const;
+
+    // Not thread safe, neither side may be active
+    void reset();
+
+private:
+    Q_DISABLE_COPY(QAudioRingBuffer)
+
+    enum { CacheLineSize = 64 };
+
+    char *m_buffer;
+    int m_bufferSize;
+
+    alignas(CacheLineSize) QAtomicInteger<quint32> m_readCount;
+    int m_readPos;
+
+    alignas(CacheLineSize) QAtomicInteger<quint32> m_writeCount;
+    int m_writePos;
+};
+
+// Push mode QIODevice of the audio outputs. Writes never block, they take
+// what fits into the ring buffer and dataWritten() lets the output know.
+class Q_MULTIMEDIA_EXPORT QAudioRingBufferDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit QAudioRingBufferDevice(QAudioRingBuffer *buffer, QObject *parent = nullptr);
+    ~QAudioRingBufferDevice();
+
+    QAudioRingBuffer *ringBuffer() const;
+
+protected:
+    qint64 readData(char *data, qint64 len) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+    // Called on the writing thread after len bytes were added
+    virtual void dataWritten(qint64 len);
+
+private:
+    QAudioRingBuffer *m_buffer;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIORINGBUFFER_P_H
@@ -39,12 +39,15 @@
 
 #include "qsamplecache_p.h"
 #include "qwavedecoder_p.h"
+#include "qaudiohelpers_p.h"
 
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
 
 #include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QScopedPointer>
 //#define QT_SAMPLECACHE_DEBUG
 
 #include <mutex>
@@ -102,9 +105,11 @@ QSampleCache::QSampleCache(QObject *parent)
     , m_networkAccessManager(nullptr)
     , m_capacity(0)
     , m_usage(0)
+    , m_conversionQuality(QAudioResampler::MediumQuality)
     , m_loadingRefCount(0)
 {
     m_loadingThread.setObjectName(QLatin1String("QSampleCache::LoadingThread"));
+    m_loaderPool.setObjectName(QLatin1String("QSampleCache::LoaderPool"));
     connect(&m_loadingThread, SIGNAL(finished()), this, SIGNAL(isLoadingChanged()));
     connect(&m_loadingThread, SIGNAL(started()), this, SIGNAL(isLoadingChanged()));
 }
@@ -118,6 +123,15 @@ QNetworkAccessManager& QSampleCache::networkAccessManager()
 
 QSampleCache::~QSampleCache()
 {
+    // Loader tasks take the lock, so wait for them without holding it
+    {
+        const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+        m_pendingLoads.clear();
+        m_poolLoads.clear();
+    }
+    qt_samplecache_set_loading_paused(this, false);
+    m_loaderPool.waitForDone();
+
     const std::lock_guard<QRecursiveMutex> locker(m_mutex);
 
     m_loadingThread.quit();
@@ -162,7 +176,7 @@ bool QSampleCache::isCached(const QUrl &url) const
     return m_samples.contains(url);
 }
 
-QSample* QSampleCache::requestSample(const QUrl& url)
+QSample* QSampleCache::requestSample(const QUrl& url, LoadPriority priority)
 {
     //lock and add first to make sure live loadingThread will not be killed during this function call
     m_loadingMutex.lock();
@@ -180,10 +194,12 @@ QSample* QSampleCache::requestSample(const QUrl& url)
     QSample* sample;
     if (it == m_samples.end()) {
         sample = new QSample(url, this);
+        sample->m_priority = priority;
         m_samples.insert(url, sample);
         sample->moveToThread(&m_loadingThread);
     } else {
         sample = *it;
+        sample->m_priority = qMax(sample->m_priority, int(priority));
     }
 
     sample->addRef();
@@ -193,6 +209,87 @@ QSample* QSampleCache::requestSample(const QUrl& url)
     return sample;
 }
 
+/*
+    Changes the priority of a sample that is still waiting to be loaded, for
+    instance to load a sound that is about to be played before sounds which
+    are only preloaded. Only local files are loaded in priority order.
+*/
+void QSampleCache::setLoadPriority(const QUrl& url, LoadPriority priority)
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    QMap<QUrl, QSample*>::const_iterator it = m_samples.constFind(url);
+    if (it != m_samples.constEnd())
+        (*it)->m_priority = priority;
+}
+
+/*
+    Local files are loaded in parallel by up to \a count threads, which
+    defaults to QThread::idealThreadCount().
+*/
+void QSampleCache::setMaxLoadingThreads(int count)
+{
+    m_loaderPool.setMaxThreadCount(count);
+}
+
+int QSampleCache::maxLoadingThreads() const
+{
+    return m_loaderPool.maxThreadCount();
+}
+
+// Called in loading thread
+void QSampleCache::queueLoad(QSample *sample)
+{
+    {
+        const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+        m_pendingLoads.append(sample);
+        m_poolLoads.insert(sample);
+    }
+    m_loaderPool.start([this]() { loadNextPending(); });
+}
+
+// Called in loader pool threads. Every queued load starts one task, but the
+// task picks whichever pending sample has the highest priority at that time.
+void QSampleCache::loadNextPending()
+{
+    QSample *sample = nullptr;
+    {
+        const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+        if (m_pendingLoads.isEmpty())
+            return;
+        auto next = m_pendingLoads.begin();
+        for (auto it = next + 1; it != m_pendingLoads.end(); ++it) {
+            if ((*it)->m_priority > (*next)->m_priority)
+                next = it;
+        }
+        sample = *next;
+        m_pendingLoads.erase(next);
+    }
+    sample->loadLocalFile();
+
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    m_poolLoads.remove(sample);
+}
+
+/*
+    Holds the loads queued for the loader pool until called again with
+    \a paused set to false, by reserving every thread the pool may run.
+    Lets the auto tests reorder queued loads before any of them starts.
+*/
+void qt_samplecache_set_loading_paused(QSampleCache *cache, bool paused)
+{
+    if (paused == (cache->m_pausedLoaderThreads > 0))
+        return;
+
+    if (paused) {
+        cache->m_pausedLoaderThreads = cache->m_loaderPool.maxThreadCount();
+        for (int i = 0; i < cache->m_pausedLoaderThreads; ++i)
+            cache->m_loaderPool.reserveThread();
+    } else {
+        for (; cache->m_pausedLoaderThreads > 0; --cache->m_pausedLoaderThreads)
+            cache->m_loaderPool.releaseThread();
+    }
+}
+
 void QSampleCache::setCapacity(qint64 capacity)
 {
     const std::lock_guard<QRecursiveMutex> locker(m_mutex);
@@ -204,7 +301,7 @@ void QSampleCache::setCapacity(qint64 capacity)
     if (m_capacity > 0 && capacity <= 0) { //memory management strategy changed
         for (QMap<QUrl, QSample*>::iterator it = m_samples.begin(); it != m_samples.end();) {
             QSample* sample = *it;
-            if (sample->m_ref == 0) {
+            if (sample->m_ref == 0 && !m_poolLoads.contains(sample)) {
                 unloadSample(sample);
                 it = m_samples.erase(it);
             } else {
@@ -217,6 +314,42 @@ void QSampleCache::setCapacity(qint64 capacity)
     refresh(0);
 }
 
+/*
+    Samples loaded after this call are converted to \a format once they have
+    been decoded, so that they can be played back without any conversion.
+    The cache usage then counts the size of the converted data. Samples that
+    cannot be converted keep their original format, which QSample::format()
+    reports either way.
+*/
+void QSampleCache::setSampleFormat(const QAudioFormat &format)
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    m_sampleFormat = format;
+}
+
+QAudioFormat QSampleCache::sampleFormat() const
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    return m_sampleFormat;
+}
+
+/*
+    Sets the \a quality of the sample rate conversion applied when loaded
+    samples are converted to the sample format. Conversion happens once per
+    sample, so the default MediumQuality is rarely worth lowering.
+*/
+void QSampleCache::setConversionQuality(QAudioResampler::Quality quality)
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    m_conversionQuality = quality;
+}
+
+QAudioResampler::Quality QSampleCache::conversionQuality() const
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    return m_conversionQuality;
+}
+
 // Called locked
 void QSampleCache::unloadSample(QSample *sample)
 {
@@ -240,7 +373,8 @@ void QSampleCache::refresh(qint64 usageChange)
     //free unused samples to keep usage under capacity limit.
     for (QMap<QUrl, QSample*>::iterator it = m_samples.begin(); it != m_samples.end();) {
         QSample* sample = *it;
-        if (sample->m_ref > 0) {
+        // Samples still being loaded by the pool cannot be deleted under its feet
+        if (sample->m_ref > 0 || m_poolLoads.contains(sample)) {
             ++it;
             continue;
         }
@@ -282,6 +416,10 @@ QSample::~QSample()
     qDebug() << "~QSample" << this << ": deleted [" << m_url << "]" << QThread::currentThread();
 #endif
     cleanup();
+
+    // Drop the sound data before unmapping it
+    m_soundData.clear();
+    delete m_mappedFile;
 }
 
 // Called in application thread
@@ -381,6 +519,52 @@ void QSample::decoderReady()
         onReady();
 }
 
+/*
+    Local files are parsed and mapped into memory rather than streamed through
+    the loading thread. The sound data then shares the page cache with other
+    processes playing the same file, and is only paged in when played.
+    Called in a loader pool thread.
+*/
+void QSample::loadLocalFile()
+{
+#ifdef QT_SAMPLECACHE_DEBUG
+    qDebug() << "QSample: load local file [" << m_url << "]" << QThread::currentThread();
+#endif
+    QScopedPointer<QFile> file(new QFile(m_url.toLocalFile()));
+    QAudioFormat format;
+    qint64 size = 0;
+    if (file->open(QIODevice::ReadOnly)) {
+        QWaveDecoder decoder(file.data());
+        if (decoder.parseHeader()) {
+            format = decoder.audioFormat();
+            size = qMin(decoder.size(), file->size() - file->pos());
+        }
+    }
+
+    QMutexLocker m(&m_mutex);
+    if (!format.isValid()) {
+        m_state = QSample::Error;
+        m_parent->loadingRelease();
+        emit error();
+        return;
+    }
+
+    // The decoder leaves the file positioned at the start of the sample data
+    uchar *data = size > 0 ? file->map(file->pos(), size) : nullptr;
+    if (data) {
+        // The mapping lives as long as the file
+        m_soundData = QByteArray::fromRawData(reinterpret_cast<const char *>(data), int(size));
+        m_mappedFile = file.take();
+    } else {
+        m_soundData = file->read(size);
+    }
+    m_sampleReadLength = m_soundData.size();
+    m_parent->refresh(m_soundData.size());
+
+    m_audioFormat = format;
+    finishLoading();
+}
+
 // Called in all threads
 QSample::State QSample::state() const
 {
@@ -396,6 +580,12 @@ void QSample::load()
 #ifdef QT_SAMPLECACHE_DEBUG
     qDebug() << "QSample: load [" << m_url << "]";
 #endif
+    // Local files are loaded in parallel by the loader pool
+    if (m_url.isLocalFile()) {
+        m_parent->queueLoad(this);
+        return;
+    }
+
     m_stream = m_parent->networkAccessManager().get(QNetworkRequest(m_url));
     connect(m_stream, SIGNAL(errorOccurred(QNetworkReply::NetworkError)), SLOT(decoderError()));
     m_waveDecoder = new QWaveDecoder(m_stream);
@@ -427,6 +617,26 @@ void QSample::onReady()
 #endif
     m_audioFormat = m_waveDecoder->audioFormat();
     cleanup();
+    finishLoading();
+}
+
+// Called in loading or loader pool thread when sample is done. Locked already.
+void QSample::finishLoading()
+{
+    const QAudioFormat sampleFormat = m_parent->sampleFormat();
+    if (sampleFormat.isValid() && sampleFormat != m_audioFormat
+            && QAudioHelperInternal::qCanConvertSamples(m_audioFormat, sampleFormat)) {
+        const QByteArray converted = QAudioHelperInternal::qConvertSamples(m_audioFormat, sampleFormat, m_soundData,
+                                                                           m_parent->conversionQuality());
+        m_parent->refresh(converted.size() - m_soundData.size());
+        m_soundData = converted;
+        m_audioFormat = sampleFormat;
+
+        // The converted copy replaces the mapped data
+        delete m_mappedFile;
+        m_mappedFile = nullptr;
+    }
+
     m_state = QSample::Ready;
     qobject_cast<QSampleCache*>(m_parent)->loadingRelease();
     emit ready();
@@ -436,11 +646,13 @@ void QSample::onReady()
 QSample::QSample(const QUrl& url, QSampleCache *parent)
     : m_parent(parent)
     , m_stream(nullptr)
+    , m_mappedFile(nullptr)
     , m_waveDecoder(nullptr)
     , m_url(url)
     , m_sampleReadLength(0)
     , m_state(Creating)
     , m_ref(0)
+    , m_priority(QSampleCache::NormalPriority)
 {
 }
 
@@ -57,16 +57,21 @@
 #include <QtCore/qmutex.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qset.h>
+#include <QtCore/qthreadpool.h>
 #include <qaudioformat.h>
+#include "qaudioresampler_p.h"
 
 
 QT_BEGIN_NAMESPACE
 
+class QFile;
 class QIODevice;
 class QNetworkAccessManager;
 class QSampleCache;
 class QWaveDecoder;
 
+Q_AUTOTEST_EXPORT void qt_samplecache_set_loading_paused(QSampleCache *cache, bool paused);
+
 // Lives in application thread
 class Q_MULTIMEDIA_EXPORT QSample : public QObject
 {
@@ -106,6 +111,8 @@ private:
     void cleanup();
     void addRef();
     void loadIfNecessary();
+    void loadLocalFile();
+    void finishLoading();
     QSample();
     ~QSample();
 
@@ -114,11 +121,13 @@ private:
     QByteArray   m_soundData;
     QAudioFormat m_audioFormat;
     QIODevice    *m_stream;
+    QFile        *m_mappedFile;
     QWaveDecoder *m_waveDecoder;
     QUrl         m_url;
     qint64       m_sampleReadLength;
     State        m_state;
     int          m_ref;
+    int          m_priority;
 };
 
 class Q_MULTIMEDIA_EXPORT QSampleCache : public QObject
@@ -126,13 +135,31 @@ class Q_MULTIMEDIA_EXPORT QSampleCache : public QObject
     Q_OBJECT
 public:
     friend class QSample;
+    friend void qt_samplecache_set_loading_paused(QSampleCache *cache, bool paused);
+
+    enum LoadPriority
+    {
+        LowPriority,
+        NormalPriority,
+        HighPriority
+    };
 
     QSampleCache(QObject *parent = nullptr);
     ~QSampleCache();
 
-    QSample* requestSample(const QUrl& url);
+    QSample* requestSample(const QUrl& url, LoadPriority priority = NormalPriority);
+    void setLoadPriority(const QUrl& url, LoadPriority priority);
     void setCapacity(qint64 capacity);
 
+    void setMaxLoadingThreads(int count);
+    int maxLoadingThreads() const;
+
+    void setSampleFormat(const QAudioFormat &format);
+    QAudioFormat sampleFormat() const;
+
+    void setConversionQuality(QAudioResampler::Quality quality);
+    QAudioResampler::Quality conversionQuality() const;
+
     bool isLoading() const;
     bool isCached(const QUrl& url) const;
 
@@ -146,13 +173,21 @@ private:
     mutable QRecursiveMutex m_mutex;
     qint64 m_capacity;
     qint64 m_usage;
+    QAudioFormat m_sampleFormat;
+    QAudioResampler::Quality m_conversionQuality;
     QThread m_loadingThread;
+    QThreadPool m_loaderPool;
+    QList<QSample*> m_pendingLoads;
+    QSet<QSample*> m_poolLoads;
+    int m_pausedLoaderThreads = 0;
 
     QNetworkAccessManager& networkAccessManager();
     void refresh(qint64 usageChange);
     bool notifyUnreferencedSample(QSample* sample);
     void removeUnreferencedSample(QSample* sample);
     void unloadSample(QSample* sample);
+    void queueLoad(QSample* sample);
+    void loadNextPending();
 
     void loadingRelease();
     int m_loadingRefCount;
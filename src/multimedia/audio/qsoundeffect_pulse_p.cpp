@@ -647,6 +647,9 @@ void QSoundEffectPrivate::playAvailable()
 #ifdef QT_PA_DEBUG
         qDebug() << this << "play deferred";
 #endif
+        // Load ahead of sounds which are only preloaded
+        if (m_status == QSoundEffect::Loading)
+            sampleCache()->setLoadPriority(m_source, QSampleCache::HighPriority);
         m_playQueued = true;
     } else {
         if (m_playing) { //restart playing from the beginning
@@ -49,16 +49,37 @@
 //
 
 #include "qsoundeffect_qaudio_p.h"
+#include "qaudiohelpers_p.h"
 
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qvarlengtharray.h>
 
 //#include <QDebug>
 //#define QT_QAUDIO_DEBUG 1
 
 QT_BEGIN_NAMESPACE
 
-Q_GLOBAL_STATIC(QSampleCache, sampleCache)
+class QSoundEffectSampleCache : public QSampleCache
+{
+public:
+    QSoundEffectSampleCache()
+    {
+        // Convert samples to what the default device plays natively once at load time,
+        // which also lets effects decoded from differently encoded files share one mixer
+        const QAudioFormat format = QAudioDeviceInfo::defaultOutputDevice().preferredFormat();
+        if (QAudioHelperInternal::qCanMixSamples(format))
+            setSampleFormat(format);
+    }
+};
+
+Q_GLOBAL_STATIC(QSoundEffectSampleCache, sampleCache)
+
+typedef QList<QSoundEffectMixer *> QSoundEffectMixerList;
+Q_GLOBAL_STATIC(QSoundEffectMixerList, soundEffectMixers)
+Q_GLOBAL_STATIC(QMutex, soundEffectMixersMutex)
 
 QSoundEffectPrivate::QSoundEffectPrivate(QObject *parent):
     QObject(parent),
@@ -79,9 +100,8 @@ QSoundEffectPrivate::~QSoundEffectPrivate()
 void QSoundEffectPrivate::release()
 {
     stop();
-    if (d->m_audioOutput) {
-        d->m_audioOutput->stop();
-        d->m_audioOutput->deleteLater();
+    if (d->m_mixer) {
+        d->releaseMixer();
         d->m_sample->release();
     }
     delete d;
@@ -129,6 +149,8 @@ void QSoundEffectPrivate::setSource(const QUrl &url)
         return;
     }
 
+    d->releaseMixer();
+
     if (d->m_sample) {
         if (!d->m_sampleReady) {
             disconnect(d->m_sample, &QSample::error, d, &PrivateSoundSource::decoderError);
@@ -138,13 +160,6 @@ void QSoundEffectPrivate::setSource(const QUrl &url)
         d->m_sample = nullptr;
     }
 
-    if (d->m_audioOutput) {
-        disconnect(d->m_audioOutput, &QAudioOutput::stateChanged, d, &PrivateSoundSource::stateChanged);
-        d->m_audioOutput->stop();
-        d->m_audioOutput->deleteLater();
-        d->m_audioOutput = nullptr;
-    }
-
     setStatus(QSoundEffect::Loading);
     d->m_sample = sampleCache()->requestSample(url);
     connect(d->m_sample, &QSample::error, d, &PrivateSoundSource::decoderError);
@@ -186,19 +201,13 @@ void QSoundEffectPrivate::setLoopCount(int loopCount)
 
 qreal QSoundEffectPrivate::volume() const
 {
-    if (d->m_audioOutput && !d->m_muted)
-        return d->m_audioOutput->volume();
-
     return d->m_volume;
 }
 
 void QSoundEffectPrivate::setVolume(qreal volume)
 {
+    // Picked up by the mixer on its next pass
     d->m_volume = volume;
-
-    if (d->m_audioOutput && !d->m_muted)
-        d->m_audioOutput->setVolume(volume);
-
     emit volumeChanged();
 }
 
@@ -209,11 +218,6 @@ bool QSoundEffectPrivate::isMuted() const
 
 void QSoundEffectPrivate::setMuted(bool muted)
 {
-    if (muted && d->m_audioOutput)
-        d->m_audioOutput->setVolume(0);
-    else if (!muted && d->m_audioOutput && d->m_muted)
-        d->m_audioOutput->setVolume(d->m_volume);
-
     d->m_muted = muted;
     emit mutedChanged();
 }
@@ -246,8 +250,11 @@ void QSoundEffectPrivate::play()
         return;
     }
     setPlaying(true);
-    if (d->m_audioOutput && d->m_audioOutput->state() == QAudio::StoppedState && d->m_sampleReady)
-        d->m_audioOutput->start(d);
+    // Load ahead of sounds which are only preloaded
+    if (d->m_status == QSoundEffect::Loading)
+        sampleCache()->setLoadPriority(d->m_url, QSampleCache::HighPriority);
+    if (d->m_mixer && d->m_sampleReady)
+        d->m_mixer->addVoice(d);
 }
 
 void QSoundEffectPrivate::stop()
@@ -261,8 +268,8 @@ void QSoundEffectPrivate::stop()
 
     setPlaying(false);
 
-    if (d->m_audioOutput)
-        d->m_audioOutput->stop();
+    if (d->m_mixer)
+        d->m_mixer->removeVoice(d);
 }
 
 void QSoundEffectPrivate::setStatus(QSoundEffect::Status status)
@@ -316,12 +323,11 @@ void QSoundEffectPrivate::setCategory(const QString &category)
 }
 
 PrivateSoundSource::PrivateSoundSource(QSoundEffectPrivate *s, const QAudioDeviceInfo &audioDevice)
-    : QIODevice(s)
+    : QObject(s)
     , m_audioDevice(audioDevice)
 {
     soundeffect = s;
     m_category = QLatin1String("game");
-    open(QIODevice::ReadOnly);
 }
 
 void PrivateSoundSource::sampleReady()
@@ -334,22 +340,13 @@ void PrivateSoundSource::sampleReady()
 #endif
     disconnect(m_sample, &QSample::error, this, &PrivateSoundSource::decoderError);
     disconnect(m_sample, &QSample::ready, this, &PrivateSoundSource::sampleReady);
-    if (!m_audioOutput) {
-        if (m_audioDevice.isNull())
-            m_audioOutput = new QAudioOutput(m_sample->format());
-        else
-            m_audioOutput = new QAudioOutput(m_audioDevice, m_sample->format());
-        connect(m_audioOutput, &QAudioOutput::stateChanged, this, &PrivateSoundSource::stateChanged);
-        if (!m_muted)
-            m_audioOutput->setVolume(m_volume);
-        else
-            m_audioOutput->setVolume(0);
-    }
+    if (!m_mixer)
+        m_mixer = QSoundEffectMixer::acquire(m_audioDevice, m_sample->format());
     m_sampleReady = true;
     soundeffect->setStatus(QSoundEffect::Ready);
 
-    if (m_playing && m_audioOutput->state() == QAudio::StoppedState)
-        m_audioOutput->start(this);
+    if (m_playing)
+        m_mixer->addVoice(this);
 }
 
 void PrivateSoundSource::decoderError()
@@ -361,91 +358,214 @@ void PrivateSoundSource::decoderError()
     soundeffect->setStatus(QSoundEffect::Error);
 }
 
-void PrivateSoundSource::stateChanged(QAudio::State state)
+void PrivateSoundSource::releaseMixer()
+{
+    if (!m_mixer)
+        return;
+
+    m_mixer->removeVoice(this);
+    m_mixer->release();
+    m_mixer = nullptr;
+}
+
+/*
+    Sound effects share one mixer per device, sample format and thread.
+    Formats which cannot be mixed get a mixer of their own, which then
+    plays a single voice just like a dedicated audio output.
+*/
+QSoundEffectMixer *QSoundEffectMixer::acquire(const QAudioDeviceInfo &audioDevice, const QAudioFormat &format)
+{
+    const bool shared = QAudioHelperInternal::qCanMixSamples(format);
+
+    QMutexLocker locker(soundEffectMixersMutex());
+    QSoundEffectMixer *mixer = nullptr;
+    if (shared) {
+        for (QSoundEffectMixer *m : qAsConst(*soundEffectMixers())) {
+            if (m->m_audioDevice == audioDevice && m->m_format == format
+                    && m->thread() == QThread::currentThread()) {
+                mixer = m;
+                break;
+            }
+        }
+    }
+
+    if (!mixer) {
+        mixer = new QSoundEffectMixer(audioDevice, format);
+        if (shared)
+            soundEffectMixers()->append(mixer);
+    }
+
+    ++mixer->m_refCount;
+    return mixer;
+}
+
+void QSoundEffectMixer::release()
+{
+    if (--m_refCount > 0)
+        return;
+
+    {
+        QMutexLocker locker(soundEffectMixersMutex());
+        soundEffectMixers()->removeOne(this);
+    }
+    m_audioOutput->stop();
+    deleteLater();
+}
+
+QSoundEffectMixer::QSoundEffectMixer(const QAudioDeviceInfo &audioDevice, const QAudioFormat &format)
+    : m_audioDevice(audioDevice)
+    , m_format(format)
+{
+    if (audioDevice.isNull())
+        m_audioOutput = new QAudioOutput(format, this);
+    else
+        m_audioOutput = new QAudioOutput(audioDevice, format, this);
+    connect(m_audioOutput, &QAudioOutput::stateChanged, this, &QSoundEffectMixer::stateChanged);
+    open(QIODevice::ReadOnly);
+}
+
+QSoundEffectMixer::~QSoundEffectMixer()
+{
+}
+
+void QSoundEffectMixer::addVoice(PrivateSoundSource *voice)
+{
+    if (!m_voices.contains(voice))
+        m_voices.append(voice);
+
+    // The output is stopped whenever no voice is left, see stateChanged()
+    if (m_audioOutput->state() == QAudio::StoppedState)
+        m_audioOutput->start(this);
+}
+
+void QSoundEffectMixer::removeVoice(PrivateSoundSource *voice)
+{
+    // Stopping the last playing voice silences the output right away. Voices
+    // which finished on their own were already dropped by readData().
+    if (m_voices.removeOne(voice) && m_voices.isEmpty())
+        m_audioOutput->stop();
+}
+
+void QSoundEffectMixer::stateChanged(QAudio::State state)
 {
 #ifdef QT_QAUDIO_DEBUG
     qDebug() << this << "stateChanged " << state;
 #endif
-    if ((state == QAudio::IdleState && m_runningCount == 0)
-         || (state == QAudio::StoppedState && m_audioOutput->error() != QAudio::NoError))
-        emit soundeffect->stop();
+    if (state == QAudio::StoppedState && m_audioOutput->error() != QAudio::NoError) {
+        const QList<PrivateSoundSource *> voices = m_voices;
+        m_voices.clear();
+        for (PrivateSoundSource *voice : voices)
+            voice->soundeffect->stop();
+    } else if (state == QAudio::IdleState && m_voices.isEmpty()) {
+        // Everything mixed has been played, release the device instead of
+        // letting the output keep waking up to pull silence
+        QMetaObject::invokeMethod(this, [this]() {
+            if (m_voices.isEmpty() && m_audioOutput->state() == QAudio::IdleState)
+                m_audioOutput->stop();
+        }, Qt::QueuedConnection);
+    }
 }
 
-qint64 PrivateSoundSource::readData(char *data, qint64 len)
+/*
+    Renders the next \a len bytes of \a count voices into \a data. The first
+    voice replaces what is already there and the others are added on top of
+    it; whatever no voice reaches is filled with silence. Voices which have
+    played all of their loops are left with loopsRemaining at zero.
+*/
+void qt_soundeffect_mix_voices(const QAudioFormat &format, QSoundEffectVoice *voices,
+                               int count, char *data, int len)
 {
-    if ((m_runningCount > 0  || m_runningCount == QSoundEffect::Infinite) && m_playing) {
+    bool mix = false;
+    for (int i = 0; i < count; ++i) {
+        QSoundEffectVoice &voice = voices[i];
+        if (voice.sample.isEmpty())
+            voice.loopsRemaining = 0;
+
+        int rendered = 0;
+        while (rendered < len && (voice.loopsRemaining > 0 || voice.loopsRemaining == QSoundEffect::Infinite)) {
+            const int chunk = int(qMin<qint64>(len - rendered, voice.sample.size() - voice.offset));
+            const char *src = voice.sample.constData() + voice.offset;
+            if (mix)
+                QAudioHelperInternal::qMixSamples(voice.gain, format, src, data + rendered, chunk);
+            else
+                QAudioHelperInternal::qMultiplySamples(voice.gain, format, src, data + rendered, chunk);
+
+            rendered += chunk;
+            voice.offset += chunk;
+
+            if (voice.offset >= voice.sample.size()) {
+                voice.offset = 0;
+                if (voice.loopsRemaining > 0)
+                    --voice.loopsRemaining;
+            }
+        }
 
-        if (m_sample->state() != QSample::Ready)
-            return 0;
+        if (!mix && rendered < len)
+            QAudioHelperInternal::qMultiplySamples(0.0, format, data + rendered, data + rendered, len - rendered);
+        mix = true;
+    }
 
-        qint64 bytesWritten = 0;
+    if (!mix)
+        QAudioHelperInternal::qMultiplySamples(0.0, format, data, data, len);
+}
 
-        const int   periodSize = m_audioOutput->periodSize();
-        const int   sampleSize = m_sample->data().size();
-        const char* sampleData = m_sample->data().constData();
+qint64 QSoundEffectMixer::readData(char *data, qint64 len)
+{
+    if (m_voices.isEmpty())
+        return 0;
 
-        // Some systems can have large buffers we only need a max of three
-        int    periodsFree = qMin(3, (int)(m_audioOutput->bytesFree()/periodSize));
-        int    dataOffset = 0;
+    // Some systems can have large buffers we only need a max of three periods
+    const int periodSize = m_audioOutput->periodSize();
+    if (periodSize > 0)
+        len = qMin(len, qint64(qMin(3, m_audioOutput->bytesFree() / periodSize)) * periodSize);
 
-#ifdef QT_QAUDIO_DEBUG
-        qDebug() << "bytesFree=" << m_audioOutput->bytesFree() << ", can fit " << periodsFree << " periodSize() chunks";
-#endif
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    if (bytesPerFrame > 0)
+        len -= len % bytesPerFrame;
 
-        while ((periodsFree > 0) && (bytesWritten + periodSize <= len)) {
+    if (len <= 0)
+        return 0;
 
-            if (sampleSize - m_offset >= periodSize) {
-                // We can fit a whole period of data
-                memcpy(data + dataOffset, sampleData + m_offset, periodSize);
-                m_offset += periodSize;
-                dataOffset += periodSize;
-                bytesWritten += periodSize;
-#ifdef QT_QAUDIO_DEBUG
-                qDebug() << "WHOLE PERIOD: bytesWritten=" << bytesWritten << ", offset=" << m_offset
-                         << ", filesize=" << sampleSize;
-#endif
-            } else {
-                // We are at end of sound, first write what is left of current sound
-                memcpy(data + dataOffset, sampleData + m_offset, sampleSize - m_offset);
-                bytesWritten += sampleSize - m_offset;
-                int wrapLen = periodSize - (sampleSize - m_offset);
-                if (wrapLen > sampleSize)
-                    wrapLen = sampleSize;
 #ifdef QT_QAUDIO_DEBUG
-                qDebug() << "END OF SOUND: bytesWritten=" << bytesWritten << ", offset=" << m_offset
-                         << ", part1=" << (sampleSize-m_offset);
+    qDebug() << "mixing" << m_voices.size() << "voices into" << len << "bytes";
 #endif
-                dataOffset += (sampleSize - m_offset);
-                m_offset = 0;
-
-                if (m_runningCount > 0 && m_runningCount != QSoundEffect::Infinite)
-                    soundeffect->setLoopsRemaining(m_runningCount-1);
-
-                if (m_runningCount > 0 || m_runningCount == QSoundEffect::Infinite) {
-                    // There are still more loops of this sound to play, append the start of sound to make up full period
-                    memcpy(data + dataOffset, sampleData + m_offset, wrapLen);
-                    m_offset += wrapLen;
-                    dataOffset += wrapLen;
-                    bytesWritten += wrapLen;
-#ifdef QT_QAUDIO_DEBUG
-                    qDebug() << "APPEND START FOR FULL PERIOD: bytesWritten=" << bytesWritten << ", offset=" << m_offset
-                             << ", part2=" << wrapLen;
-                    qDebug() << "part1 + part2 should be a period " << periodSize;
-#endif
-                }
-            }
-            if (m_runningCount == 0)
-                break;
 
-            periodsFree--;
+    QVarLengthArray<PrivateSoundSource *, 8> sources;
+    QVarLengthArray<QSoundEffectVoice, 8> voices;
+    for (PrivateSoundSource *source : qAsConst(m_voices)) {
+        if (source->m_sample->state() != QSample::Ready)
+            continue;
+
+        QSoundEffectVoice voice;
+        voice.sample = source->m_sample->data();
+        voice.offset = source->m_offset;
+        voice.loopsRemaining = source->m_runningCount;
+        voice.gain = source->m_muted ? 0.0 : source->m_volume;
+        sources.append(source);
+        voices.append(voice);
+    }
+
+    qt_soundeffect_mix_voices(m_format, voices.data(), voices.size(), data, int(len));
+
+    for (int i = 0; i < sources.size(); ++i) {
+        PrivateSoundSource *source = sources[i];
+        source->m_offset = voices[i].offset;
+        source->soundeffect->setLoopsRemaining(voices[i].loopsRemaining);
+
+        if (voices[i].loopsRemaining == 0) {
+            m_voices.removeOne(source);
+            // Stop once the mixing pass is over, unless the effect was restarted in the meantime
+            QMetaObject::invokeMethod(source, [source]() {
+                if (source->m_runningCount == 0)
+                    source->soundeffect->stop();
+            }, Qt::QueuedConnection);
         }
-        return bytesWritten;
     }
 
-    return 0;
+    return len;
 }
 
-qint64 PrivateSoundSource::writeData(const char *data, qint64 len)
+qint64 QSoundEffectMixer::writeData(const char *data, qint64 len)
 {
     Q_UNUSED(data);
     Q_UNUSED(len);
@@ -51,6 +51,7 @@
 // We mean it.
 //
 
+#include <QtCore/qlist.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qurl.h>
 #include "qaudiooutput.h"
@@ -60,30 +61,72 @@
 QT_BEGIN_NAMESPACE
 
 class QSoundEffectPrivate;
+class PrivateSoundSource;
 
-class PrivateSoundSource : public QIODevice
+// The mixing state of one playing sound effect, kept apart from
+// PrivateSoundSource so that mixing does not need an audio device.
+struct QSoundEffectVoice
+{
+    QByteArray sample;
+    qint64 offset = 0;
+    int loopsRemaining = 1;
+    qreal gain = 1.0;
+};
+
+Q_MULTIMEDIA_EXPORT void qt_soundeffect_mix_voices(const QAudioFormat &format, QSoundEffectVoice *voices,
+                                                   int count, char *data, int len);
+
+// Mixes all sound effects playing samples of the same format on the same
+// device into a single audio output stream.
+class QSoundEffectMixer : public QIODevice
 {
-    friend class QSoundEffectPrivate;
     Q_OBJECT
 public:
-    PrivateSoundSource(QSoundEffectPrivate *s, const QAudioDeviceInfo &audioDevice = QAudioDeviceInfo());
-    ~PrivateSoundSource() {}
+    static QSoundEffectMixer *acquire(const QAudioDeviceInfo &audioDevice, const QAudioFormat &format);
+    void release();
+
+    void addVoice(PrivateSoundSource *voice);
+    void removeVoice(PrivateSoundSource *voice);
 
     qint64 readData(char *data, qint64 len) override;
     qint64 writeData(const char *data, qint64 len) override;
 
+private Q_SLOTS:
+    void stateChanged(QAudio::State);
+
+private:
+    QSoundEffectMixer(const QAudioDeviceInfo &audioDevice, const QAudioFormat &format);
+    ~QSoundEffectMixer();
+
+    QAudioDeviceInfo m_audioDevice;
+    QAudioFormat m_format;
+    QAudioOutput *m_audioOutput = nullptr;
+    QList<PrivateSoundSource *> m_voices;
+    int m_refCount = 0;
+};
+
+class PrivateSoundSource : public QObject
+{
+    friend class QSoundEffectPrivate;
+    friend class QSoundEffectMixer;
+    Q_OBJECT
+public:
+    PrivateSoundSource(QSoundEffectPrivate *s, const QAudioDeviceInfo &audioDevice = QAudioDeviceInfo());
+    ~PrivateSoundSource() {}
+
 private Q_SLOTS:
     void sampleReady();
     void decoderError();
-    void stateChanged(QAudio::State);
 
 private:
+    void releaseMixer();
+
     QUrl m_url;
     int m_loopCount = 1;
     int m_runningCount = 0;
     bool m_playing = false;
     QSoundEffect::Status  m_status = QSoundEffect::Null;
-    QAudioOutput *m_audioOutput = nullptr;
+    QSoundEffectMixer *m_mixer = nullptr;
     QSample *m_sample = nullptr;
     bool m_muted = false;
     qreal m_volume = 1.0;
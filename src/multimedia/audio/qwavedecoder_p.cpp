@@ -103,6 +103,19 @@ qint64 QWaveDecoder::writeData(const char *data, qint64 len)
     return -1;
 }
 
+/*
+    Parses the header right away instead of from the event loop, for sources
+    like local files where all of it is already available. Returns whether
+    the format is known, in which case the source is positioned at the start
+    of the sample data.
+*/
+bool QWaveDecoder::parseHeader()
+{
+    if (!haveFormat)
+        handleData();
+    return haveFormat;
+}
+
 void QWaveDecoder::parsingFailed()
 {
     Q_ASSERT(source);
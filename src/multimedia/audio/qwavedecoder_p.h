@@ -74,6 +74,8 @@ public:
     bool isSequential() const override;
     qint64 bytesAvailable() const override;
 
+    bool parseHeader();
+
 Q_SIGNALS:
     void formatKnown();
     void parsingError();
@@ -244,6 +244,84 @@ QAudioDecoderControl::QAudioDecoderControl(QObject *parent):
     audio file, you can specify an invalid \a format.
 */
 
+/*!
+    \since 6.0
+
+    Returns the maximum number of decoded buffers the backend keeps ready
+    ahead of read(), or 0 if the backend chooses.
+
+    The default implementation returns 0.
+*/
+int QAudioDecoderControl::bufferQueueLimit() const
+{
+    return 0;
+}
+
+/*!
+    \since 6.0
+
+    Sets the maximum number of decoded buffers kept ready ahead of read()
+    to \a buffers. A value of 0 lets the backend choose.
+
+    The default implementation ignores the value.
+*/
+void QAudioDecoderControl::setBufferQueueLimit(int buffers)
+{
+    Q_UNUSED(buffers);
+}
+
+/*!
+    \since 6.0
+
+    Returns the number of frames each decoded buffer holds, or 0 if buffers
+    are delivered as the decoder produces them.
+
+    The default implementation returns 0.
+*/
+int QAudioDecoderControl::framesPerBuffer() const
+{
+    return 0;
+}
+
+/*!
+    \since 6.0
+
+    Requests that decoded buffers hold \a frames frames each. Only the last
+    buffer of a stream may be shorter. A value of 0 delivers buffers as the
+    decoder produces them.
+
+    The default implementation ignores the value.
+*/
+void QAudioDecoderControl::setFramesPerBuffer(int frames)
+{
+    Q_UNUSED(frames);
+}
+
+/*!
+    \since 6.0
+
+    Returns true if the backend decodes as fast as possible, emitting
+    bufferReady() once for each batch of buffers.
+
+    The default implementation returns false.
+*/
+bool QAudioDecoderControl::fastDecoding() const
+{
+    return false;
+}
+
+/*!
+    \since 6.0
+
+    Enables or disables fast decoding according to \a enabled.
+
+    The default implementation ignores the value.
+*/
+void QAudioDecoderControl::setFastDecoding(bool enabled)
+{
+    Q_UNUSED(enabled);
+}
+
 /*!
     \fn QAudioDecoderControl::read()
     Attempts to read a buffer from the decoder, without blocking. Returns invalid buffer if there are
@@ -71,6 +71,15 @@ public:
     virtual QAudioFormat audioFormat() const = 0;
     virtual void setAudioFormat(const QAudioFormat &format) = 0;
 
+    virtual int bufferQueueLimit() const;
+    virtual void setBufferQueueLimit(int buffers);
+
+    virtual int framesPerBuffer() const;
+    virtual void setFramesPerBuffer(int frames);
+
+    virtual bool fastDecoding() const;
+    virtual void setFastDecoding(bool enabled);
+
     virtual QAudioBuffer read() = 0;
     virtual bool bufferAvailable() const = 0;
 
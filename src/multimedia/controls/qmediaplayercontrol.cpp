@@ -369,6 +369,46 @@ QMediaPlayerControl::QMediaPlayerControl(QObject *parent):
     {stopped} state.
 */
 
+/*!
+    \since 6.0
+
+    Requests that positionChanged() is emitted every \a milliseconds while
+    playing, timed by the media clock of the backend. A value of 0 stops the
+    updates. Returns true if the control supports clock driven updates, in
+    which case QMediaPlayer stops polling position().
+
+    The default implementation returns false.
+*/
+bool QMediaPlayerControl::setPositionUpdateInterval(int milliseconds)
+{
+    Q_UNUSED(milliseconds);
+    return false;
+}
+
+/*!
+    \since 6.0
+
+    Returns how precisely setPosition() is followed.
+
+    The default implementation returns QMediaPlayer::DefaultSeek.
+*/
+QMediaPlayer::SeekMode QMediaPlayerControl::seekMode() const
+{
+    return QMediaPlayer::DefaultSeek;
+}
+
+/*!
+    \since 6.0
+
+    Sets how precisely setPosition() is followed to \a mode.
+
+    The default implementation does nothing.
+*/
+void QMediaPlayerControl::setSeekMode(QMediaPlayer::SeekMode mode)
+{
+    Q_UNUSED(mode);
+}
+
 /*!
     \fn QMediaPlayerControl::error(int error, const QString &errorString)
 
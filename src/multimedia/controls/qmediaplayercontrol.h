@@ -93,6 +93,11 @@ public:
     virtual void pause() = 0;
     virtual void stop() = 0;
 
+    virtual bool setPositionUpdateInterval(int milliseconds);
+
+    virtual QMediaPlayer::SeekMode seekMode() const;
+    virtual void setSeekMode(QMediaPlayer::SeekMode mode);
+
 Q_SIGNALS:
     void mediaChanged(const QMediaContent& content);
     void durationChanged(qint64 duration);
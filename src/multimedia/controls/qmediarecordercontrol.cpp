@@ -146,6 +146,112 @@ QMediaRecorderControl::~QMediaRecorderControl()
     is started.
 */
 
+/*!
+    \since 6.0
+
+    Returns how much media, in milliseconds, the recorder keeps encoded before
+    recording is started, so that a recording begins that long before
+    setState() was called. A value of 0 means no pre-roll is kept.
+
+    The default implementation returns 0.
+*/
+qint64 QMediaRecorderControl::preRollDuration() const
+{
+    return 0;
+}
+
+/*!
+    \since 6.0
+
+    Sets the pre-roll duration to \a milliseconds. A value of 0 disables
+    pre-roll.
+
+    The default implementation does nothing.
+*/
+void QMediaRecorderControl::setPreRollDuration(qint64 milliseconds)
+{
+    Q_UNUSED(milliseconds);
+}
+
+/*!
+    \since 6.0
+
+    Returns the maximum amount of memory, in bytes, used to hold the pre-roll.
+    A value of 0 means the backend chooses the limit.
+
+    The default implementation returns 0.
+*/
+qint64 QMediaRecorderControl::preRollBufferSize() const
+{
+    return 0;
+}
+
+/*!
+    \since 6.0
+
+    Limits the memory used to hold the pre-roll to \a bytes. When the limit is
+    reached the oldest media is dropped, and the pre-roll may be shorter than
+    preRollDuration().
+
+    The default implementation does nothing.
+*/
+void QMediaRecorderControl::setPreRollBufferSize(qint64 bytes)
+{
+    Q_UNUSED(bytes);
+}
+
+/*!
+    \since 6.0
+
+    Returns the duration, in milliseconds, after which a recording continues
+    in a new file. A value of 0 means the recording is not split by duration.
+
+    The default implementation returns 0.
+*/
+qint64 QMediaRecorderControl::segmentDuration() const
+{
+    return 0;
+}
+
+/*!
+    \since 6.0
+
+    Sets the segment duration to \a milliseconds. A value of 0 stops splitting
+    the recording by duration.
+
+    The default implementation does nothing.
+*/
+void QMediaRecorderControl::setSegmentDuration(qint64 milliseconds)
+{
+    Q_UNUSED(milliseconds);
+}
+
+/*!
+    \since 6.0
+
+    Returns the size, in bytes, after which a recording continues in a new
+    file. A value of 0 means the recording is not split by size.
+
+    The default implementation returns 0.
+*/
+qint64 QMediaRecorderControl::segmentSize() const
+{
+    return 0;
+}
+
+/*!
+    \since 6.0
+
+    Sets the segment size to \a bytes. A value of 0 stops splitting the
+    recording by size.
+
+    The default implementation does nothing.
+*/
+void QMediaRecorderControl::setSegmentSize(qint64 bytes)
+{
+    Q_UNUSED(bytes);
+}
+
 /*!
     \fn bool QMediaRecorderControl::isMuted() const
 
@@ -212,6 +318,15 @@ QMediaRecorderControl::~QMediaRecorderControl()
     This signal should be emitted at start of recording.
 */
 
+/*!
+    \fn void QMediaRecorderControl::segmentFinished(const QUrl &location)
+    \since 6.0
+
+    Signals that the segment of a split recording stored at \a location has
+    been completely written. This signal should also be emitted for the last
+    segment when recording stops.
+*/
+
 /*!
     \fn void QMediaRecorderControl::error(int error, const QString &errorString)
 
@@ -73,6 +73,16 @@ public:
 
     virtual void applySettings() = 0;
 
+    virtual qint64 preRollDuration() const;
+    virtual void setPreRollDuration(qint64 milliseconds);
+    virtual qint64 preRollBufferSize() const;
+    virtual void setPreRollBufferSize(qint64 bytes);
+
+    virtual qint64 segmentDuration() const;
+    virtual void setSegmentDuration(qint64 milliseconds);
+    virtual qint64 segmentSize() const;
+    virtual void setSegmentSize(qint64 bytes);
+
 Q_SIGNALS:
     void stateChanged(QMediaRecorder::State state);
     void statusChanged(QMediaRecorder::Status status);
@@ -80,6 +90,7 @@ Q_SIGNALS:
     void mutedChanged(bool muted);
     void volumeChanged(qreal volume);
     void actualLocationChanged(const QUrl &location);
+    void segmentFinished(const QUrl &location);
     void error(int error, const QString &errorString);
 
 public Q_SLOTS:
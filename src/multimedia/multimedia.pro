@@ -18,6 +18,7 @@ PRIVATE_HEADERS += \
     qtmultimediaglobal_p.h \
     qmediacontrol_p.h \
     qmediaobject_p.h \
+    qmedianotifyscheduler_p.h \
     qmediapluginloader_p.h \
     qmediaservice_p.h \
     qmediaserviceprovider_p.h \
@@ -44,6 +45,7 @@ SOURCES += \
     qmediacontrol.cpp \
     qmediametadata.cpp \
     qmediaobject.cpp \
+    qmedianotifyscheduler.cpp \
     qmediapluginloader.cpp \
     qmediaservice.cpp \
     qmediaserviceprovider.cpp \
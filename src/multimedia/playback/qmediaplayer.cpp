@@ -163,6 +163,7 @@ public:
     void _q_handleMediaChanged(const QMediaContent&);
     void _q_handlePlaylistLoaded();
     void _q_handlePlaylistLoadFailed();
+    void _q_updatePositionWatch();
 };
 
 QMediaPlaylist *QMediaPlayerPrivate::parentPlaylist(QMediaPlaylist *pls)
@@ -211,10 +212,7 @@ void QMediaPlayerPrivate::_q_stateChanged(QMediaPlayer::State ps)
     if (ps != state) {
         state = ps;
 
-        if (ps == QMediaPlayer::PlayingState)
-            q->addPropertyWatch("position");
-        else
-            q->removePropertyWatch("position");
+        _q_updatePositionWatch();
 
         emit q->stateChanged(ps);
     }
@@ -235,10 +233,10 @@ void QMediaPlayerPrivate::_q_mediaStatusChanged(QMediaPlayer::MediaStatus s)
         switch (s) {
         case QMediaPlayer::StalledMedia:
         case QMediaPlayer::BufferingMedia:
-            q->addPropertyWatch("bufferStatus");
+            addPropertyWatch("bufferStatus", NotifyOnChange);
             break;
         default:
-            q->removePropertyWatch("bufferStatus");
+            removePropertyWatch("bufferStatus");
             break;
         }
 
@@ -557,6 +555,33 @@ void QMediaPlayerPrivate::_q_handlePlaylistLoadFailed()
         setMedia(QMediaContent(), nullptr);
 }
 
+// Position updates at this interval or faster are driven by the backend clock when possible
+enum { HighRateNotifyInterval = 50 };
+
+/*
+    Polls the position while playing, skipping ticks where it has not moved.
+    Short notify intervals are handed to the control instead if it can emit
+    positionChanged() from the media clock, which is both more accurate and
+    cheaper than polling.
+*/
+void QMediaPlayerPrivate::_q_updatePositionWatch()
+{
+    Q_Q(QMediaPlayer);
+
+    const bool playing = state == QMediaPlayer::PlayingState;
+    const int interval = q->notifyInterval();
+    const bool highRate = playing && interval > 0 && interval <= HighRateNotifyInterval;
+
+    bool clockDriven = false;
+    if (control)
+        clockDriven = control->setPositionUpdateInterval(highRate ? interval : 0) && highRate;
+
+    if (playing && !clockDriven)
+        addPropertyWatch("position", NotifyOnChange);
+    else
+        removePropertyWatch("position");
+}
+
 static QMediaService *playerService(QMediaPlayer::Flags flags)
 {
     QMediaServiceProvider *provider = QMediaServiceProvider::defaultServiceProvider();
@@ -617,10 +642,11 @@ QMediaPlayer::QMediaPlayer(QObject *parent, QMediaPlayer::Flags flags):
             d->status = d->control->mediaStatus();
 
             if (d->state == PlayingState)
-                addPropertyWatch("position");
+                d->_q_updatePositionWatch();
+            connect(this, SIGNAL(notifyIntervalChanged(int)), SLOT(_q_updatePositionWatch()));
 
             if (d->status == StalledMedia || d->status == BufferingMedia)
-                addPropertyWatch("bufferStatus");
+                d->addPropertyWatch("bufferStatus", QMediaPlayerPrivate::NotifyOnChange);
 
             d->hasStreamPlaybackFeature = d->provider->supportedFeatures(d->service).testFlag(QMediaServiceProviderHint::StreamPlayback);
 
@@ -916,7 +942,7 @@ void QMediaPlayer::stop()
     // see QMediaPlayerPrivate::_q_stateChanged()
     if (d->playlist && d->state != QMediaPlayer::StoppedState) {
         d->state = QMediaPlayer::StoppedState;
-        removePropertyWatch("position");
+        d->_q_updatePositionWatch();
         emit stateChanged(QMediaPlayer::StoppedState);
     }
 }
@@ -963,6 +989,24 @@ void QMediaPlayer::setPlaybackRate(qreal rate)
         d->control->setPlaybackRate(rate);
 }
 
+QMediaPlayer::SeekMode QMediaPlayer::seekMode() const
+{
+    Q_D(const QMediaPlayer);
+
+    if (d->control != nullptr)
+        return d->control->seekMode();
+
+    return DefaultSeek;
+}
+
+void QMediaPlayer::setSeekMode(QMediaPlayer::SeekMode mode)
+{
+    Q_D(QMediaPlayer);
+
+    if (d->control != nullptr)
+        d->control->setSeekMode(mode);
+}
+
 /*!
     Sets the current \a media source.
 
@@ -1308,6 +1352,27 @@ QStringList QMediaPlayer::supportedCustomAudioRoles() const
     \omitvalue MediaIsPlaylist
 */
 
+/*!
+    \enum QMediaPlayer::SeekMode
+    \since 6.0
+
+    Defines where playback continues after the position is changed.
+
+    \value DefaultSeek The backend decides, this is usually close to the
+    requested position.
+    \value AccurateSeek Playback continues exactly at the requested position.
+    This can be slow for media with few key frames, because everything from
+    the preceding key frame has to be decoded.
+    \value NearestKeyFrameSeek Playback continues at the key frame closest to
+    the requested position.
+    \value PreviousKeyFrameSeek Playback continues at the last key frame at or
+    before the requested position.
+    \value NextKeyFrameSeek Playback continues at the first key frame at or
+    after the requested position.
+
+    The key frame modes are fast, which makes them suited to scrubbing.
+*/
+
 // Signals
 /*!
     \fn QMediaPlayer::error(QMediaPlayer::Error error)
@@ -1465,7 +1530,9 @@ QStringList QMediaPlayer::supportedCustomAudioRoles() const
     The value is the current playback position, expressed in milliseconds since
     the beginning of the media. Periodically changes in the position will be
     indicated with the signal positionChanged(), the interval between updates
-    can be set with QMediaObject's method setNotifyInterval().
+    can be set with QMediaObject's method setNotifyInterval(). Updates are
+    skipped while the position does not change. Intervals of 50 milliseconds
+    or less are timed by the media clock on backends that support it.
 */
 
 /*!
@@ -1548,6 +1615,20 @@ QStringList QMediaPlayer::supportedCustomAudioRoles() const
     while fast forwarding or rewinding.
 */
 
+/*!
+    \property QMediaPlayer::seekMode
+    \brief how precisely setting the position is followed.
+    \since 6.0
+
+    A key frame mode is much faster than AccurateSeek on media with long
+    intervals between key frames, at the cost of not landing on the exact
+    position. While the player is still busy with a previous seek, backends
+    may skip intermediate positions and go straight to the latest one.
+
+    The default value is DefaultSeek. Backends that do not support seek modes
+    ignore this property.
+*/
+
 /*!
     \property QMediaPlayer::audioRole
     \brief the role of the audio stream played by the media player.
@@ -70,6 +70,7 @@ class Q_MULTIMEDIA_EXPORT QMediaPlayer : public QMediaObject
     Q_PROPERTY(bool videoAvailable READ isVideoAvailable NOTIFY videoAvailableChanged)
     Q_PROPERTY(bool seekable READ isSeekable NOTIFY seekableChanged)
     Q_PROPERTY(qreal playbackRate READ playbackRate WRITE setPlaybackRate NOTIFY playbackRateChanged)
+    Q_PROPERTY(SeekMode seekMode READ seekMode WRITE setSeekMode)
     Q_PROPERTY(State state READ state NOTIFY stateChanged)
     Q_PROPERTY(MediaStatus mediaStatus READ mediaStatus NOTIFY mediaStatusChanged)
     Q_PROPERTY(QAudio::Role audioRole READ audioRole WRITE setAudioRole NOTIFY audioRoleChanged)
@@ -78,6 +79,7 @@ class Q_MULTIMEDIA_EXPORT QMediaPlayer : public QMediaObject
     Q_ENUMS(State)
     Q_ENUMS(MediaStatus)
     Q_ENUMS(Error)
+    Q_ENUMS(SeekMode)
 
 public:
     enum State
@@ -119,6 +121,15 @@ public:
         MediaIsPlaylist
     };
 
+    enum SeekMode
+    {
+        DefaultSeek,
+        AccurateSeek,
+        NearestKeyFrameSeek,
+        PreviousKeyFrameSeek,
+        NextKeyFrameSeek
+    };
+
     explicit QMediaPlayer(QObject *parent = nullptr, Flags flags = Flags());
     ~QMediaPlayer();
 
@@ -153,6 +164,9 @@ public:
     bool isSeekable() const;
     qreal playbackRate() const;
 
+    SeekMode seekMode() const;
+    void setSeekMode(SeekMode mode);
+
     Error error() const;
     QString errorString() const;
 
@@ -219,6 +233,7 @@ private:
     Q_PRIVATE_SLOT(d_func(), void _q_handleMediaChanged(const QMediaContent&))
     Q_PRIVATE_SLOT(d_func(), void _q_handlePlaylistLoaded())
     Q_PRIVATE_SLOT(d_func(), void _q_handlePlaylistLoadFailed())
+    Q_PRIVATE_SLOT(d_func(), void _q_updatePositionWatch())
 };
 
 QT_END_NAMESPACE
@@ -226,6 +241,7 @@ QT_END_NAMESPACE
 Q_DECLARE_METATYPE(QMediaPlayer::State)
 Q_DECLARE_METATYPE(QMediaPlayer::MediaStatus)
 Q_DECLARE_METATYPE(QMediaPlayer::Error)
+Q_DECLARE_METATYPE(QMediaPlayer::SeekMode)
 
 Q_MEDIA_ENUM_DEBUG(QMediaPlayer, State)
 Q_MEDIA_ENUM_DEBUG(QMediaPlayer, MediaStatus)
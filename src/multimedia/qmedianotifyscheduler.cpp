@@ -0,0 +1,192 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qmedianotifyscheduler_p.h"
+
+#include <QtCore/qcoreevent.h>
+#include <QtCore/qthreadstorage.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Media objects watching properties used to run a timer each, so an
+    application with many players woke up once per player and interval.
+    The scheduler keeps one timer per distinct interval and thread instead,
+    so all clients with the same interval are notified on the same tick.
+
+    Clients are notified in the thread they subscribed from. When the
+    QObject owning a client moves to another thread, the client leaves the
+    scheduler of the old thread and subscribes to the one of the new thread
+    once the owner is running there.
+*/
+
+QMediaNotifyClient::~QMediaNotifyClient()
+{
+    unsubscribeNotify();
+}
+
+/*
+    Unsubscribes from the scheduler this client subscribed to, if any.
+*/
+void QMediaNotifyClient::unsubscribeNotify()
+{
+    m_movedInterval = -1;
+    if (m_scheduler)
+        m_scheduler->unsubscribe(this);
+}
+
+QMediaNotifyScheduler::~QMediaNotifyScheduler()
+{
+    for (auto it = m_intervals.cbegin(); it != m_intervals.cend(); ++it) {
+        it.key()->m_scheduler = nullptr;
+        it.key()->m_owner = nullptr;
+    }
+}
+
+/*
+    Returns the scheduler of the current thread, creating it on first use.
+*/
+QMediaNotifyScheduler *QMediaNotifyScheduler::instance()
+{
+    static QThreadStorage<QMediaNotifyScheduler *> schedulers;
+    if (!schedulers.hasLocalData())
+        schedulers.setLocalData(new QMediaNotifyScheduler);
+    return schedulers.localData();
+}
+
+/*
+    Calls QMediaNotifyClient::scheduledNotify() on \a client every
+    \a interval milliseconds, together with all other clients using the
+    same interval. Subscribing again moves the client to the new interval.
+*/
+void QMediaNotifyScheduler::subscribe(QMediaNotifyClient *client, int interval)
+{
+    interval = qMax(0, interval);
+    client->m_movedInterval = -1;
+    const auto current = m_intervals.constFind(client);
+    if (current != m_intervals.cend()) {
+        if (*current == interval)
+            return;
+        unsubscribe(client);
+    }
+
+    Group &group = m_groups[interval];
+    if (group.clients.isEmpty()) {
+        group.timerId = startTimer(interval);
+        m_timers.insert(group.timerId, interval);
+    }
+    group.clients.append(client);
+    m_intervals.insert(client, interval);
+    client->m_scheduler = this;
+
+    if (QObject *owner = client->notifyOwner()) {
+        client->m_owner = owner;
+        m_owners.insert(owner, client);
+        owner->installEventFilter(this);
+    }
+}
+
+void QMediaNotifyScheduler::unsubscribe(QMediaNotifyClient *client)
+{
+    const auto current = m_intervals.constFind(client);
+    if (current == m_intervals.cend())
+        return;
+
+    const int interval = *current;
+    m_intervals.erase(current);
+    client->m_scheduler = nullptr;
+
+    if (client->m_owner) {
+        client->m_owner->removeEventFilter(this);
+        m_owners.remove(client->m_owner);
+        client->m_owner = nullptr;
+    }
+
+    const auto group = m_groups.find(interval);
+    group->clients.removeOne(client);
+    if (group->clients.isEmpty()) {
+        killTimer(group->timerId);
+        m_timers.remove(group->timerId);
+        m_groups.erase(group);
+    }
+}
+
+/*
+    Hands clients over to the scheduler of the thread their owner moves to.
+    ThreadChange is sent before the move, so the queued call runs in the new
+    thread; it is dropped if the owner goes away first.
+*/
+bool QMediaNotifyScheduler::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::ThreadChange) {
+        QMediaNotifyClient *client = m_owners.value(watched);
+        if (client) {
+            const int interval = m_intervals.value(client);
+            unsubscribe(client);
+            client->m_movedInterval = interval;
+            QMetaObject::invokeMethod(watched, [client] {
+                if (client->m_movedInterval >= 0)
+                    QMediaNotifyScheduler::instance()->subscribe(client, client->m_movedInterval);
+            }, Qt::QueuedConnection);
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void QMediaNotifyScheduler::timerEvent(QTimerEvent *event)
+{
+    const auto timer = m_timers.constFind(event->timerId());
+    if (timer == m_timers.cend()) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    // Notifications may subscribe, unsubscribe or destroy other clients, so
+    // only notify those still registered on this tick
+    const int interval = *timer;
+    const QList<QMediaNotifyClient *> clients = m_groups.value(interval).clients;
+    for (QMediaNotifyClient *client : clients) {
+        if (m_intervals.value(client, -1) == interval)
+            client->scheduledNotify();
+    }
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qmedianotifyscheduler_p.cpp"
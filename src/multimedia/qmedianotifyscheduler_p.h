@@ -0,0 +1,115 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QMEDIANOTIFYSCHEDULER_P_H
+#define QMEDIANOTIFYSCHEDULER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+
+QT_BEGIN_NAMESPACE
+
+class QMediaNotifyScheduler;
+
+class Q_MULTIMEDIA_EXPORT QMediaNotifyClient
+{
+public:
+    virtual ~QMediaNotifyClient();
+
+    virtual void scheduledNotify() = 0;
+    virtual QObject *notifyOwner() const = 0;
+
+    void unsubscribeNotify();
+
+private:
+    friend class QMediaNotifyScheduler;
+    QMediaNotifyScheduler *m_scheduler = nullptr;
+    QObject *m_owner = nullptr;
+    int m_movedInterval = -1;   // Interval to subscribe with again after moving threads
+};
+
+class Q_MULTIMEDIA_EXPORT QMediaNotifyScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    ~QMediaNotifyScheduler();
+
+    static QMediaNotifyScheduler *instance();
+
+    void subscribe(QMediaNotifyClient *client, int interval);
+    void unsubscribe(QMediaNotifyClient *client);
+
+    int clientCount() const { return m_intervals.size(); }
+    int timerCount() const { return m_groups.size(); }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void timerEvent(QTimerEvent *event) override;
+
+private:
+    QMediaNotifyScheduler() = default;
+
+    struct Group
+    {
+        int timerId = 0;
+        QList<QMediaNotifyClient *> clients;
+    };
+
+    QHash<int, Group> m_groups;                     // By interval
+    QHash<int, int> m_timers;                       // Timer id to interval
+    QHash<QMediaNotifyClient *, int> m_intervals;   // Client to interval
+    QHash<QObject *, QMediaNotifyClient *> m_owners;
+};
+
+QT_END_NAMESPACE
+
+#endif // QMEDIANOTIFYSCHEDULER_P_H
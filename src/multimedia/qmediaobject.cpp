@@ -63,11 +63,71 @@ void QMediaObjectPrivate::_q_notify()
 
     for (int pi : qAsConst(properties)) {
         QMetaProperty p = m->property(pi);
+        const QVariant value = p.read(q);
+
+        const auto last = notifiedValues.find(pi);
+        if (last != notifiedValues.end()) {
+            if (last->isValid() && *last == value)
+                continue;
+            *last = value;
+        }
+
         p.notifySignal().invoke(
-            q, QGenericArgument(p.metaType().name(), p.read(q).data()));
+            q, QGenericArgument(p.metaType().name(), value.data()));
     }
 }
 
+/*
+    Watches the property \a name. With NotifyOnChange, the notify signal is
+    only emitted on ticks where the value differs from the one last emitted;
+    adding the watch again forces the next tick to emit.
+*/
+void QMediaObjectPrivate::addPropertyWatch(const QByteArray &name, NotifyMode mode)
+{
+    Q_Q(QMediaObject);
+
+    const QMetaObject* m = q->metaObject();
+
+    int index = m->indexOfProperty(name.constData());
+
+    if (index != -1 && m->property(index).hasNotifySignal()) {
+        notifyProperties.insert(index);
+
+        if (mode == NotifyOnChange)
+            notifiedValues.insert(index, QVariant());
+        else
+            notifiedValues.remove(index);
+
+        updateNotifySchedule();
+    }
+}
+
+void QMediaObjectPrivate::removePropertyWatch(const QByteArray &name)
+{
+    Q_Q(QMediaObject);
+
+    int index = q->metaObject()->indexOfProperty(name.constData());
+
+    if (index != -1) {
+        notifyProperties.remove(index);
+        notifiedValues.remove(index);
+
+        updateNotifySchedule();
+    }
+}
+
+/*
+    Watched properties share the tick of every other media object in this
+    thread using the same notify interval.
+*/
+void QMediaObjectPrivate::updateNotifySchedule()
+{
+    if (notifyProperties.isEmpty())
+        unsubscribeNotify();
+    else
+        QMediaNotifyScheduler::instance()->subscribe(this, notifyInterval);
+}
+
 void QMediaObjectPrivate::_q_availabilityChanged()
 {
     Q_Q(QMediaObject);
@@ -113,6 +173,10 @@ void QMediaObjectPrivate::_q_availabilityChanged()
 
 QMediaObject::~QMediaObject()
 {
+    Q_D(QMediaObject);
+
+    // Stop notifications before the subclass data goes away
+    d->unsubscribeNotify();
 }
 
 /*!
@@ -155,15 +219,16 @@ QMediaService* QMediaObject::service() const
 
 int QMediaObject::notifyInterval() const
 {
-    return d_func()->notifyTimer->interval();
+    return d_func()->notifyInterval;
 }
 
 void QMediaObject::setNotifyInterval(int milliSeconds)
 {
     Q_D(QMediaObject);
 
-    if (d->notifyTimer->interval() != milliSeconds) {
-        d->notifyTimer->setInterval(milliSeconds);
+    if (d->notifyInterval != milliSeconds) {
+        d->notifyInterval = milliSeconds;
+        d->updateNotifySchedule();
 
         emit notifyIntervalChanged(milliSeconds);
     }
@@ -234,10 +299,6 @@ QMediaObject::QMediaObject(QObject *parent, QMediaService *service)
 {
     Q_D(QMediaObject);
 
-    d->notifyTimer = new QTimer(this);
-    d->notifyTimer->setInterval(1000);
-    connect(d->notifyTimer, SIGNAL(timeout()), SLOT(_q_notify()));
-
     d->service = service;
 
     setupControls();
@@ -252,10 +313,6 @@ QMediaObject::QMediaObject(QMediaObjectPrivate &dd, QObject *parent, QMediaServi
 {
     Q_D(QMediaObject);
 
-    d->notifyTimer = new QTimer(this);
-    d->notifyTimer->setInterval(1000);
-    connect(d->notifyTimer, SIGNAL(timeout()), SLOT(_q_notify()));
-
     d->service = service;
 
     setupControls();
@@ -272,16 +329,7 @@ void QMediaObject::addPropertyWatch(QByteArray const &name)
 {
     Q_D(QMediaObject);
 
-    const QMetaObject* m = metaObject();
-
-    int index = m->indexOfProperty(name.constData());
-
-    if (index != -1 && m->property(index).hasNotifySignal()) {
-        d->notifyProperties.insert(index);
-
-        if (!d->notifyTimer->isActive())
-            d->notifyTimer->start();
-    }
+    d->addPropertyWatch(name, QMediaObjectPrivate::NotifyAlways);
 }
 
 /*!
@@ -295,14 +343,7 @@ void QMediaObject::removePropertyWatch(QByteArray const &name)
 {
     Q_D(QMediaObject);
 
-    int index = metaObject()->indexOfProperty(name.constData());
-
-    if (index != -1) {
-        d->notifyProperties.remove(index);
-
-        if (d->notifyProperties.isEmpty())
-            d->notifyTimer->stop();
-    }
+    d->removePropertyWatch(name);
 }
 
 /*!
@@ -311,6 +352,8 @@ void QMediaObject::removePropertyWatch(QByteArray const &name)
     The interval at which notifiable properties will update.
 
     The interval is expressed in milliseconds, the default value is 1000.
+    Media objects in the same thread with the same interval are notified
+    on a shared timer.
 
     \sa addPropertyWatch(), removePropertyWatch()
 */
@@ -52,11 +52,13 @@
 //
 
 #include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qset.h>
-#include <QtCore/qtimer.h>
+#include <QtCore/qvariant.h>
 
 #include "qmediaobject.h"
 #include "private/qobject_p.h"
+#include "private/qmedianotifyscheduler_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -69,14 +71,29 @@ class QMediaAvailabilityControl;
     friend class Class;
 
 
-class QMediaObjectPrivate : public QObjectPrivate
+class Q_MULTIMEDIA_EXPORT QMediaObjectPrivate : public QObjectPrivate, public QMediaNotifyClient
 {
     Q_DECLARE_PUBLIC(QMediaObject)
 
 public:
-    QMediaObjectPrivate() : service(nullptr), metaDataControl(nullptr), availabilityControl(nullptr), notifyTimer(nullptr) {}
+    enum NotifyMode
+    {
+        NotifyAlways,
+        NotifyOnChange  // Skip ticks where the value is the one last notified
+    };
+
+    QMediaObjectPrivate() : service(nullptr), metaDataControl(nullptr), availabilityControl(nullptr), notifyInterval(1000) {}
     virtual ~QMediaObjectPrivate() {}
 
+    static QMediaObjectPrivate *get(QMediaObject *object) { return object->d_func(); }
+
+    void addPropertyWatch(const QByteArray &name, NotifyMode mode);
+    void removePropertyWatch(const QByteArray &name);
+    void updateNotifySchedule();
+
+    void scheduledNotify() override { _q_notify(); }
+    QObject *notifyOwner() const override { return q_ptr; }
+
     void _q_notify();
     void _q_availabilityChanged();
 
@@ -84,8 +101,9 @@ public:
     QMetaDataReaderControl *metaDataControl;
     QMediaAvailabilityControl *availabilityControl;
 
-    QTimer* notifyTimer;
+    int notifyInterval;
     QSet<int> notifyProperties;
+    QHash<int, QVariant> notifiedValues;    // Last values of NotifyOnChange properties
 };
 
 QT_END_NAMESPACE
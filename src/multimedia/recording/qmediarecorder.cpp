@@ -97,7 +97,7 @@ QMediaRecorderPrivate::QMediaRecorderPrivate():
      metaDataControl(nullptr),
      availabilityControl(nullptr),
      settingsChanged(false),
-     notifyTimer(nullptr),
+     notifyInterval(1000),
      state(QMediaRecorder::StoppedState),
      error(QMediaRecorder::NoError)
 {
@@ -110,9 +110,9 @@ void QMediaRecorderPrivate::_q_stateChanged(QMediaRecorder::State ps)
     Q_Q(QMediaRecorder);
 
     if (ps == QMediaRecorder::RecordingState)
-        notifyTimer->start();
+        QMediaNotifyScheduler::instance()->subscribe(this, notifyInterval);
     else
-        notifyTimer->stop();
+        unsubscribeNotify();
 
 //    qDebug() << "Recorder state changed:" << ENUM_NAME(QMediaRecorder,"State",ps);
     if (state != ps) {
@@ -160,7 +160,9 @@ void QMediaRecorderPrivate::_q_notify()
 
 void QMediaRecorderPrivate::_q_updateNotifyInterval(int ms)
 {
-    notifyTimer->setInterval(ms);
+    notifyInterval = ms;
+    if (state == QMediaRecorder::RecordingState)
+        QMediaNotifyScheduler::instance()->subscribe(this, notifyInterval);
 }
 
 void QMediaRecorderPrivate::applySettingsLater()
@@ -219,9 +221,6 @@ QMediaRecorder::QMediaRecorder(QMediaObject *mediaObject, QObject *parent):
     Q_D(QMediaRecorder);
     d->q_ptr = this;
 
-    d->notifyTimer = new QTimer(this);
-    connect(d->notifyTimer, SIGNAL(timeout()), SLOT(_q_notify()));
-
     setMediaObject(mediaObject);
 }
 
@@ -235,9 +234,6 @@ QMediaRecorder::QMediaRecorder(QMediaRecorderPrivate &dd, QMediaObject *mediaObj
     Q_D(QMediaRecorder);
     d->q_ptr = this;
 
-    d->notifyTimer = new QTimer(this);
-    connect(d->notifyTimer, SIGNAL(timeout()), SLOT(_q_notify()));
-
     setMediaObject(mediaObject);
 }
 
@@ -289,6 +285,9 @@ bool QMediaRecorder::setMediaObject(QMediaObject *object)
             disconnect(d->control, SIGNAL(actualLocationChanged(QUrl)),
                        this, SLOT(_q_updateActualLocation(QUrl)));
 
+            disconnect(d->control, SIGNAL(segmentFinished(QUrl)),
+                       this, SIGNAL(segmentFinished(QUrl)));
+
             disconnect(d->control, SIGNAL(error(int,QString)),
                        this, SLOT(_q_error(int,QString)));
         }
@@ -340,7 +339,7 @@ bool QMediaRecorder::setMediaObject(QMediaObject *object)
     if (d->mediaObject) {
         QMediaService *service = d->mediaObject->service();
 
-        d->notifyTimer->setInterval(d->mediaObject->notifyInterval());
+        d->_q_updateNotifyInterval(d->mediaObject->notifyInterval());
         connect(d->mediaObject, SIGNAL(notifyIntervalChanged(int)), SLOT(_q_updateNotifyInterval(int)));
 
         if (service) {
@@ -395,6 +394,9 @@ bool QMediaRecorder::setMediaObject(QMediaObject *object)
                 connect(d->control, SIGNAL(actualLocationChanged(QUrl)),
                         this, SLOT(_q_updateActualLocation(QUrl)));
 
+                connect(d->control, SIGNAL(segmentFinished(QUrl)),
+                        this, SIGNAL(segmentFinished(QUrl)));
+
                 connect(d->control, SIGNAL(error(int,QString)),
                         this, SLOT(_q_error(int,QString)));
 
@@ -584,6 +586,135 @@ void QMediaRecorder::setVolume(qreal volume)
     }
 }
 
+/*!
+    \property QMediaRecorder::preRollDuration
+    \since 6.0
+
+    \brief how much media, in milliseconds, is kept before record() is called.
+
+    While the media object is active, a recorder with a pre-roll keeps the most
+    recent media encoded in memory. A recording then starts with that history,
+    so it begins up to this long before record() was called. The pre-roll
+    starts at a key frame, so it can be somewhat longer than requested.
+
+    The default value is \c 0, which keeps no pre-roll. The value stays \c 0
+    if the backend does not support pre-roll.
+
+    \sa preRollBufferSize
+*/
+
+qint64 QMediaRecorder::preRollDuration() const
+{
+    return d_func()->control ? d_func()->control->preRollDuration() : 0;
+}
+
+void QMediaRecorder::setPreRollDuration(qint64 milliseconds)
+{
+    Q_D(QMediaRecorder);
+
+    if (!d->control)
+        return;
+
+    const qint64 previous = d->control->preRollDuration();
+    d->control->setPreRollDuration(qMax(qint64(0), milliseconds));
+    const qint64 duration = d->control->preRollDuration();
+    if (duration != previous)
+        emit preRollDurationChanged(duration);
+}
+
+/*!
+    \property QMediaRecorder::preRollBufferSize
+    \since 6.0
+
+    \brief the maximum memory, in bytes, used to hold the pre-roll.
+
+    When the encoded pre-roll grows beyond this size the oldest media is
+    dropped, so the pre-roll may be shorter than preRollDuration. A value of
+    \c 0 lets the backend choose the limit.
+
+    \sa preRollDuration
+*/
+
+qint64 QMediaRecorder::preRollBufferSize() const
+{
+    return d_func()->control ? d_func()->control->preRollBufferSize() : 0;
+}
+
+void QMediaRecorder::setPreRollBufferSize(qint64 bytes)
+{
+    Q_D(QMediaRecorder);
+
+    if (!d->control)
+        return;
+
+    const qint64 previous = d->control->preRollBufferSize();
+    d->control->setPreRollBufferSize(qMax(qint64(0), bytes));
+    const qint64 size = d->control->preRollBufferSize();
+    if (size != previous)
+        emit preRollBufferSizeChanged(size);
+}
+
+/*!
+    \property QMediaRecorder::segmentDuration
+    \since 6.0
+
+    \brief the duration, in milliseconds, after which recording continues in a
+    new file.
+
+    A split recording is written to a sequence of files next to the output
+    location, with a running number appended to the file name. The recording
+    moves on to the next file at a key frame, without losing any media in
+    between, and segmentFinished() is emitted for every completed file. The
+    actualLocation property holds the file of the first segment.
+
+    The default value is \c 0, which records to a single file. The value stays
+    \c 0 if the backend does not support split recordings. A new value takes
+    effect when the next recording starts.
+
+    \sa segmentSize
+*/
+
+qint64 QMediaRecorder::segmentDuration() const
+{
+    return d_func()->control ? d_func()->control->segmentDuration() : 0;
+}
+
+void QMediaRecorder::setSegmentDuration(qint64 milliseconds)
+{
+    Q_D(QMediaRecorder);
+
+    if (d->control)
+        d->control->setSegmentDuration(qMax(qint64(0), milliseconds));
+}
+
+/*!
+    \property QMediaRecorder::segmentSize
+    \since 6.0
+
+    \brief the size, in bytes, after which recording continues in a new file.
+
+    The file is split at the first key frame after the limit is reached, so
+    segments can be somewhat larger. When both segmentDuration and segmentSize
+    are set, whichever limit is reached first starts a new file.
+
+    The default value is \c 0, which doesn't split the recording by size.
+
+    \sa segmentDuration
+*/
+
+qint64 QMediaRecorder::segmentSize() const
+{
+    return d_func()->control ? d_func()->control->segmentSize() : 0;
+}
+
+void QMediaRecorder::setSegmentSize(qint64 bytes)
+{
+    Q_D(QMediaRecorder);
+
+    if (d->control)
+        d->control->setSegmentSize(qMax(qint64(0), bytes));
+}
+
 /*!
     Returns a list of supported container formats.
 */
@@ -983,6 +1114,35 @@ void QMediaRecorder::stop()
     This signal is usually emitted when recording starts.
 */
 
+/*!
+    \fn QMediaRecorder::preRollDurationChanged(qint64 milliseconds)
+    \since 6.0
+
+    Signals that the pre-roll duration has changed to \a milliseconds.
+
+    \sa preRollDuration
+*/
+
+/*!
+    \fn QMediaRecorder::preRollBufferSizeChanged(qint64 bytes)
+    \since 6.0
+
+    Signals that the maximum size of the pre-roll has changed to \a bytes.
+
+    \sa preRollBufferSize
+*/
+
+/*!
+    \fn QMediaRecorder::segmentFinished(const QUrl &location)
+    \since 6.0
+
+    Signals that the segment of a split recording at \a location has been
+    completely written and can be used. The last segment is reported when
+    recording stops.
+
+    \sa segmentDuration, segmentSize
+*/
+
 /*!
     \fn QMediaRecorder::error(QMediaRecorder::Error error)
 
@@ -76,6 +76,10 @@ class Q_MULTIMEDIA_EXPORT QMediaRecorder : public QObject, public QMediaBindable
     Q_PROPERTY(QUrl actualLocation READ actualLocation NOTIFY actualLocationChanged)
     Q_PROPERTY(bool muted READ isMuted WRITE setMuted NOTIFY mutedChanged)
     Q_PROPERTY(qreal volume READ volume WRITE setVolume NOTIFY volumeChanged)
+    Q_PROPERTY(qint64 preRollDuration READ preRollDuration WRITE setPreRollDuration NOTIFY preRollDurationChanged)
+    Q_PROPERTY(qint64 preRollBufferSize READ preRollBufferSize WRITE setPreRollBufferSize NOTIFY preRollBufferSizeChanged)
+    Q_PROPERTY(qint64 segmentDuration READ segmentDuration WRITE setSegmentDuration)
+    Q_PROPERTY(qint64 segmentSize READ segmentSize WRITE setSegmentSize)
     Q_PROPERTY(bool metaDataAvailable READ isMetaDataAvailable NOTIFY metaDataAvailableChanged)
     Q_PROPERTY(bool metaDataWritable READ isMetaDataWritable NOTIFY metaDataWritableChanged)
 public:
@@ -130,6 +134,16 @@ public:
     bool isMuted() const;
     qreal volume() const;
 
+    qint64 preRollDuration() const;
+    void setPreRollDuration(qint64 milliseconds);
+    qint64 preRollBufferSize() const;
+    void setPreRollBufferSize(qint64 bytes);
+
+    qint64 segmentDuration() const;
+    void setSegmentDuration(qint64 milliseconds);
+    qint64 segmentSize() const;
+    void setSegmentSize(qint64 bytes);
+
     QStringList supportedContainers() const;
     QString containerDescription(const QString &format) const;
 
@@ -181,6 +195,9 @@ Q_SIGNALS:
     void mutedChanged(bool muted);
     void volumeChanged(qreal volume);
     void actualLocationChanged(const QUrl &location);
+    void preRollDurationChanged(qint64 milliseconds);
+    void preRollBufferSizeChanged(qint64 bytes);
+    void segmentFinished(const QUrl &location);
 
     void error(QMediaRecorder::Error error);
 
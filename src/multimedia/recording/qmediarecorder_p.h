@@ -63,9 +63,8 @@ class QAudioEncoderSettingsControl;
 class QVideoEncoderSettingsControl;
 class QMetaDataWriterControl;
 class QMediaAvailabilityControl;
-class QTimer;
 
-class QMediaRecorderPrivate
+class QMediaRecorderPrivate : public QMediaNotifyClient
 {
     Q_DECLARE_NON_CONST_PUBLIC(QMediaRecorder)
 
@@ -87,7 +86,7 @@ public:
 
     bool settingsChanged;
 
-    QTimer* notifyTimer;
+    int notifyInterval;
 
     QMediaRecorder::State state;
     QMediaRecorder::Error error;
@@ -98,6 +97,9 @@ public:
     void _q_error(int error, const QString &errorString);
     void _q_serviceDestroyed();
     void _q_updateActualLocation(const QUrl &);
+    void scheduledNotify() override { _q_notify(); }
+    QObject *notifyOwner() const override { return q_ptr; }
+
     void _q_notify();
     void _q_updateNotifyInterval(int ms);
     void _q_applySettings();
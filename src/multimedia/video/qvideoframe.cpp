@@ -46,8 +46,11 @@
 #include <qimage.h>
 #include <qmutex.h>
 #include <qpair.h>
+#include <qsemaphore.h>
 #include <qsize.h>
+#include <qthreadpool.h>
 #include <qvariant.h>
+#include <qvarlengtharray.h>
 
 #include <QDebug>
 
@@ -650,7 +653,7 @@ bool QVideoFrame::map(QAbstractVideoBuffer::MapMode mode)
         // have a correct stride.
         const int height = d->size.height();
         const int yStride = d->bytesPerLine[0];
-        const int uvHeight = d->pixelFormat == Format_YUV422P ? height : height / 2;
+        const int uvHeight = d->pixelFormat == Format_YUV422P ? height : (height + 1) / 2;
         const int uvStride = (d->mappedBytes - (yStride * height)) / uvHeight / 2;
 
         // Three planes, the second and third vertically (and horizontally for other than Format_YUV422P formats) subsampled.
@@ -1030,18 +1033,39 @@ QImage::Format QVideoFrame::imageFormatFromPixelFormat(PixelFormat format)
 }
 
 
-extern void QT_FASTCALL qt_convert_BGRA32_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_BGR24_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_BGR565_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_BGR555_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_AYUV444_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_YUV444_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_YV12_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_NV12_to_ARGB32(const QVideoFrame&, uchar*);
-extern void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame&, uchar*);
+extern void QT_FASTCALL qt_convert_BGRA32_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_BGR24_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_BGR565_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_BGR555_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_AYUV444_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_YUV444_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_YV12_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_NV12_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_IMC4_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_Y8_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_Y16_to_ARGB32(const QVideoFrame&, uchar*, int, int, int);
+extern void QT_FASTCALL qt_convert_luma_to_Grayscale8(const QVideoFrame&, uchar*, int, int, int);
+
+extern void QT_FASTCALL qt_store_ARGB32_to_RGB32(uchar*, const quint32*, int);
+extern void QT_FASTCALL qt_store_ARGB32_to_ARGB32_Premultiplied(uchar*, const quint32*, int);
+extern void QT_FASTCALL qt_store_ARGB32_to_RGB888(uchar*, const quint32*, int);
+extern void QT_FASTCALL qt_store_ARGB32_to_BGR888(uchar*, const quint32*, int);
+extern void QT_FASTCALL qt_store_ARGB32_to_RGBA8888(uchar*, const quint32*, int);
+extern void QT_FASTCALL qt_store_ARGB32_to_RGBX8888(uchar*, const quint32*, int);
+extern void QT_FASTCALL qt_store_ARGB32_to_RGBA8888_Premultiplied(uchar*, const quint32*, int);
+extern void QT_FASTCALL qt_store_ARGB32_to_RGB16(uchar*, const quint32*, int);
+extern void QT_FASTCALL qt_store_ARGB32_to_Grayscale8(uchar*, const quint32*, int);
+
+extern void QT_FASTCALL qt_accumulate_ARGB32_box(quint64*, const quint32*, const int*, int);
+extern void QT_FASTCALL qt_average_box_to_ARGB32(quint32*, const quint64*, const int*, int, int);
 
 static VideoFrameConvertFunc qConvertFuncs[QVideoFrame::NPixelFormats] = {
     /* Format_Invalid */                nullptr, // Not needed
@@ -1064,35 +1088,53 @@ static VideoFrameConvertFunc qConvertFuncs[QVideoFrame::NPixelFormats] = {
     /* Format_AYUV444_Premultiplied */  nullptr,
     /* Format_YUV444 */                 qt_convert_YUV444_to_ARGB32,
     /* Format_YUV420P */                qt_convert_YUV420P_to_ARGB32,
-    /* Format_YUV422P */                nullptr,
+    /* Format_YUV422P */                qt_convert_YUV422P_to_ARGB32,
     /* Format_YV12 */                   qt_convert_YV12_to_ARGB32,
     /* Format_UYVY */                   qt_convert_UYVY_to_ARGB32,
     /* Format_YUYV */                   qt_convert_YUYV_to_ARGB32,
     /* Format_NV12 */                   qt_convert_NV12_to_ARGB32,
     /* Format_NV21 */                   qt_convert_NV21_to_ARGB32,
-    /* Format_IMC1 */                   nullptr,
-    /* Format_IMC2 */                   nullptr,
-    /* Format_IMC3 */                   nullptr,
-    /* Format_IMC4 */                   nullptr,
-    /* Format_Y8 */                     nullptr,
-    /* Format_Y16 */                    nullptr,
+    /* Format_IMC1 */                   qt_convert_IMC1_to_ARGB32,
+    /* Format_IMC2 */                   qt_convert_IMC2_to_ARGB32,
+    /* Format_IMC3 */                   qt_convert_IMC3_to_ARGB32,
+    /* Format_IMC4 */                   qt_convert_IMC4_to_ARGB32,
+    /* Format_Y8 */                     qt_convert_Y8_to_ARGB32,
+    /* Format_Y16 */                    qt_convert_Y16_to_ARGB32,
     /* Format_Jpeg */                   nullptr, // Not needed
     /* Format_CameraRaw */              nullptr,
     /* Format_AdobeDng */               nullptr,
 };
 
+static VideoFrameAccumulateFunc qAccumulateFunc = qt_accumulate_ARGB32_box;
+
 static void qInitConvertFuncsAsm()
 {
 #ifdef QT_COMPILER_SUPPORTS_SSE2
-    extern void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_sse2(const QVideoFrame&, uchar*);
+    extern void QT_FASTCALL qt_accumulate_ARGB32_box_sse2(quint64*, const quint32*, const int*, int);
+    extern void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_sse2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_sse2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_YV12_to_ARGB32_sse2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_UYVY_to_ARGB32_sse2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_YUYV_to_ARGB32_sse2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_NV12_to_ARGB32_sse2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_NV21_to_ARGB32_sse2(const QVideoFrame&, uchar*, int, int, int);
     if (qCpuHasFeature(SSE2)){
         qConvertFuncs[QVideoFrame::Format_BGRA32] = qt_convert_BGRA32_to_ARGB32_sse2;
         qConvertFuncs[QVideoFrame::Format_BGRA32_Premultiplied] = qt_convert_BGRA32_to_ARGB32_sse2;
         qConvertFuncs[QVideoFrame::Format_BGR32] = qt_convert_BGRA32_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrame::Format_YUV420P] = qt_convert_YUV420P_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrame::Format_IMC1] = qt_convert_YUV420P_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrame::Format_YV12] = qt_convert_YV12_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrame::Format_IMC3] = qt_convert_YV12_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrame::Format_UYVY] = qt_convert_UYVY_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrame::Format_YUYV] = qt_convert_YUYV_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrame::Format_NV12] = qt_convert_NV12_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrame::Format_NV21] = qt_convert_NV21_to_ARGB32_sse2;
+        qAccumulateFunc = qt_accumulate_ARGB32_box_sse2;
     }
 #endif
 #ifdef QT_COMPILER_SUPPORTS_SSSE3
-    extern void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_ssse3(const QVideoFrame&, uchar*);
+    extern void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_ssse3(const QVideoFrame&, uchar*, int, int, int);
     if (qCpuHasFeature(SSSE3)){
         qConvertFuncs[QVideoFrame::Format_BGRA32] = qt_convert_BGRA32_to_ARGB32_ssse3;
         qConvertFuncs[QVideoFrame::Format_BGRA32_Premultiplied] = qt_convert_BGRA32_to_ARGB32_ssse3;
@@ -1100,17 +1142,361 @@ static void qInitConvertFuncsAsm()
     }
 #endif
 #ifdef QT_COMPILER_SUPPORTS_AVX2
-    extern void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_avx2(const QVideoFrame&, uchar*);
+    extern void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_avx2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_avx2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_YV12_to_ARGB32_avx2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_UYVY_to_ARGB32_avx2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_YUYV_to_ARGB32_avx2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_NV12_to_ARGB32_avx2(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_NV21_to_ARGB32_avx2(const QVideoFrame&, uchar*, int, int, int);
     if (qCpuHasFeature(AVX2)){
         qConvertFuncs[QVideoFrame::Format_BGRA32] = qt_convert_BGRA32_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrame::Format_BGRA32_Premultiplied] = qt_convert_BGRA32_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrame::Format_BGR32] = qt_convert_BGRA32_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrame::Format_YUV420P] = qt_convert_YUV420P_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrame::Format_IMC1] = qt_convert_YUV420P_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrame::Format_YV12] = qt_convert_YV12_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrame::Format_IMC3] = qt_convert_YV12_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrame::Format_UYVY] = qt_convert_UYVY_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrame::Format_YUYV] = qt_convert_YUYV_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrame::Format_NV12] = qt_convert_NV12_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrame::Format_NV21] = qt_convert_NV21_to_ARGB32_avx2;
     }
 #endif
+#ifdef __ARM_NEON__
+    extern void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_neon(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_YV12_to_ARGB32_neon(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_UYVY_to_ARGB32_neon(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_YUYV_to_ARGB32_neon(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_NV12_to_ARGB32_neon(const QVideoFrame&, uchar*, int, int, int);
+    extern void QT_FASTCALL qt_convert_NV21_to_ARGB32_neon(const QVideoFrame&, uchar*, int, int, int);
+    qConvertFuncs[QVideoFrame::Format_YUV420P] = qt_convert_YUV420P_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrame::Format_IMC1] = qt_convert_YUV420P_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrame::Format_YV12] = qt_convert_YV12_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrame::Format_IMC3] = qt_convert_YV12_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrame::Format_UYVY] = qt_convert_UYVY_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrame::Format_YUYV] = qt_convert_YUYV_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrame::Format_NV12] = qt_convert_NV12_to_ARGB32_neon;
+    qConvertFuncs[QVideoFrame::Format_NV21] = qt_convert_NV21_to_ARGB32_neon;
+#endif
+}
+
+static VideoFrameConvertFunc qConvertFuncForPixelFormat(QVideoFrame::PixelFormat format)
+{
+    static bool initAsmFuncsDone = false;
+    if (!initAsmFuncsDone) {
+        qInitConvertFuncsAsm();
+        initAsmFuncsDone = true;
+    }
+    return format < QVideoFrame::NPixelFormats ? qConvertFuncs[format] : nullptr;
+}
+
+static VideoFrameStoreFunc qStoreFuncForImageFormat(QImage::Format format)
+{
+    switch (format) {
+    case QImage::Format_RGB32:
+        return qt_store_ARGB32_to_RGB32;
+    case QImage::Format_ARGB32_Premultiplied:
+        return qt_store_ARGB32_to_ARGB32_Premultiplied;
+    case QImage::Format_RGB888:
+        return qt_store_ARGB32_to_RGB888;
+    case QImage::Format_BGR888:
+        return qt_store_ARGB32_to_BGR888;
+    case QImage::Format_RGBA8888:
+        return qt_store_ARGB32_to_RGBA8888;
+    case QImage::Format_RGBX8888:
+        return qt_store_ARGB32_to_RGBX8888;
+    case QImage::Format_RGBA8888_Premultiplied:
+        return qt_store_ARGB32_to_RGBA8888_Premultiplied;
+    case QImage::Format_RGB16:
+        return qt_store_ARGB32_to_RGB16;
+    case QImage::Format_Grayscale8:
+        return qt_store_ARGB32_to_Grayscale8;
+    default:
+        return nullptr;
+    }
+}
+
+// Whether the ARGB32 output of the format's conversion function can be translucent.
+static bool pixelFormatHasAlpha(QVideoFrame::PixelFormat format)
+{
+    switch (format) {
+    case QVideoFrame::Format_BGRA32:
+    case QVideoFrame::Format_BGRA32_Premultiplied:
+    case QVideoFrame::Format_AYUV444:
+    case QVideoFrame::Format_AYUV444_Premultiplied:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Whether the format stores video range luma, which can be expanded to grey directly.
+static bool pixelFormatHasLuma(QVideoFrame::PixelFormat format)
+{
+    switch (format) {
+    case QVideoFrame::Format_AYUV444:
+    case QVideoFrame::Format_AYUV444_Premultiplied:
+    case QVideoFrame::Format_YUV444:
+    case QVideoFrame::Format_YUV420P:
+    case QVideoFrame::Format_YUV422P:
+    case QVideoFrame::Format_YV12:
+    case QVideoFrame::Format_UYVY:
+    case QVideoFrame::Format_YUYV:
+    case QVideoFrame::Format_NV12:
+    case QVideoFrame::Format_NV21:
+    case QVideoFrame::Format_IMC1:
+    case QVideoFrame::Format_IMC2:
+    case QVideoFrame::Format_IMC3:
+    case QVideoFrame::Format_IMC4:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool qCanConvertInPlace(QVideoFrame::PixelFormat pixelFormat, QImage::Format format)
+{
+    return format == QImage::Format_ARGB32
+            || (!pixelFormatHasAlpha(pixelFormat)
+                && (format == QImage::Format_RGB32 || format == QImage::Format_ARGB32_Premultiplied));
+}
+
+static int qConversionBandHeight(int width)
+{
+    // Keep the band even so that vertically sub-sampled chroma rows are not split
+    return qMax(2, (64 * 1024 / (width * 4)) & ~1);
+}
+
+// Below this many pixels per stripe the thread hand-off costs more than it saves
+static const int qDefaultMinimumStripePixels = 256 * 1024;
+
+static QBasicAtomicInt qt_videoframe_conversion_threads = Q_BASIC_ATOMIC_INITIALIZER(-1);
+static QBasicAtomicInt qt_videoframe_minimum_stripe_pixels = Q_BASIC_ATOMIC_INITIALIZER(qDefaultMinimumStripePixels);
+static QBasicAtomicInt qt_videoframe_stripe_count = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+/*
+    Overrides the maximum number of threads a single conversion may use and
+    the minimum number of pixels per stripe, -1 restores the default. Also
+    resets the count returned by qt_videoframe_conversion_stripe_count().
+    Used by the auto tests to force the striped path on small frames.
+*/
+Q_AUTOTEST_EXPORT void qt_videoframe_set_conversion_striping(int maximumThreads, int minimumStripePixels)
+{
+    qt_videoframe_conversion_threads.storeRelaxed(maximumThreads);
+    qt_videoframe_minimum_stripe_pixels.storeRelaxed(minimumStripePixels > 0
+                                                     ? minimumStripePixels
+                                                     : qDefaultMinimumStripePixels);
+    qt_videoframe_stripe_count.storeRelaxed(0);
+}
+
+/*
+    Returns the number of stripes converted since the last call to
+    qt_videoframe_set_conversion_striping(). A frame converted in a
+    single pass counts as one stripe.
+*/
+Q_AUTOTEST_EXPORT int qt_videoframe_conversion_stripe_count()
+{
+    return qt_videoframe_stripe_count.loadRelaxed();
+}
+
+static int qConversionThreadCount()
+{
+    const int overridden = qt_videoframe_conversion_threads.loadRelaxed();
+    if (overridden >= 0)
+        return overridden;
+
+    // Striping is opt-in, QT_VIDEOFRAME_CONVERSION_THREADS sets how many threads
+    // a single conversion may use. Unset, 0 or 1 keeps it on the calling thread.
+    static const int requestedThreads = qEnvironmentVariableIntValue("QT_VIDEOFRAME_CONVERSION_THREADS");
+    if (requestedThreads <= 1)
+        return 1;
+
+    // The pool may be resized by the application at any time
+    return qMin(requestedThreads, QThreadPool::globalInstance()->maxThreadCount());
+}
+
+/*
+    Calls \a convertRows for horizontal stripes covering \a height rows.
+    Frames of at least two stripes worth of pixels are split across the
+    global thread pool; the calling thread converts the first stripe and
+    waits for the others. Stripes that cannot get a pool thread are
+    converted on the calling thread, so a saturated pool never blocks the
+    conversion.
+*/
+template <typename ConvertRows>
+static void qConvertInStripes(int width, int height, const ConvertRows &convertRows)
+{
+    const qint64 minimumStripePixels = qt_videoframe_minimum_stripe_pixels.loadRelaxed();
+
+    const int threadCount = qConversionThreadCount();
+    const int stripeCount = threadCount > 1
+            ? int(qBound<qint64>(1, qint64(width) * height / minimumStripePixels,
+                                 qMin(threadCount, height / 2)))
+            : 1;
+
+    if (stripeCount == 1) {
+        qt_videoframe_stripe_count.fetchAndAddRelaxed(1);
+        convertRows(0, height);
+        return;
+    }
+
+    // Stripes start on even rows so that vertically sub-sampled chroma rows are not split
+    const int stripeHeight = ((height + stripeCount - 1) / stripeCount + 1) & ~1;
+
+    QSemaphore finished;
+    int started = 0;
+    int stripes = 1;
+    for (int y = stripeHeight; y < height; y += stripeHeight, ++stripes) {
+        const int rowCount = qMin(stripeHeight, height - y);
+        const bool queued = QThreadPool::globalInstance()->tryStart([&convertRows, &finished, y, rowCount]() {
+            convertRows(y, rowCount);
+            finished.release();
+        });
+        if (queued)
+            ++started;
+        else
+            convertRows(y, rowCount);
+    }
+
+    convertRows(0, qMin(stripeHeight, height));
+    finished.acquire(started);
+    qt_videoframe_stripe_count.fetchAndAddRelaxed(stripes);
+}
+
+/*
+    Converts a mapped frame, whose pixel format is not supported by QImage,
+    to \a format in \a output. Formats other than ARGB32 are produced from
+    bands of ARGB32 rows small enough to stay in the cache, so the frame
+    is only read once.
+*/
+static bool qConvertMappedFrame(const QVideoFrame &frame, QImage::Format format,
+                                uchar *output, int bytesPerLine)
+{
+    const QVideoFrame::PixelFormat pixelFormat = frame.pixelFormat();
+    const int width = frame.width();
+    const int height = frame.height();
+
+    if (format == QImage::Format_Grayscale8 && pixelFormatHasLuma(pixelFormat)) {
+        qConvertInStripes(width, height, [&](int firstRow, int rowCount) {
+            qt_convert_luma_to_Grayscale8(frame, output + firstRow * bytesPerLine, bytesPerLine,
+                                          firstRow, rowCount);
+        });
+        return true;
+    }
+
+    VideoFrameConvertFunc convert = qConvertFuncForPixelFormat(pixelFormat);
+    if (!convert)
+        return false;
+
+    if (qCanConvertInPlace(pixelFormat, format)) {
+        qConvertInStripes(width, height, [&](int firstRow, int rowCount) {
+            convert(frame, output + firstRow * bytesPerLine, bytesPerLine, firstRow, rowCount);
+        });
+        return true;
+    }
+
+    VideoFrameStoreFunc store = qStoreFuncForImageFormat(format);
+    if (!store)
+        return false;
+
+    qConvertInStripes(width, height, [&](int firstRow, int rowCount) {
+        const int bandHeight = qConversionBandHeight(width);
+        QVarLengthArray<quint32, 4096> band(width * bandHeight);
+
+        const int lastRow = firstRow + rowCount;
+        for (int y = firstRow; y < lastRow; y += bandHeight) {
+            const int bandRows = qMin(bandHeight, lastRow - y);
+            convert(frame, reinterpret_cast<uchar*>(band.data()), width * 4, y, bandRows);
+            for (int i = 0; i < bandRows; ++i)
+                store(output + (y + i) * bytesPerLine, band.constData() + i * width, width);
+        }
+    });
+
+    return true;
+}
+
+/*
+    Converts a mapped frame, whose pixel format is not supported by QImage,
+    to \a format and downscales it to \a size with a box filter. Each band of
+    converted rows is accumulated into the output boxes while it is still in
+    the cache, so the full resolution frame is never written to memory.
+*/
+static bool qScaleMappedFrame(const QVideoFrame &frame, const QSize &size, QImage::Format format,
+                              uchar *output, int bytesPerLine)
+{
+    const QVideoFrame::PixelFormat pixelFormat = frame.pixelFormat();
+    const int width = frame.width();
+    const int height = frame.height();
+    const int outputWidth = size.width();
+    const int outputHeight = size.height();
+
+    Q_ASSERT(outputWidth <= width && outputHeight <= height);
+
+    VideoFrameConvertFunc convert = qConvertFuncForPixelFormat(pixelFormat);
+    if (!convert)
+        return false;
+
+    VideoFrameStoreFunc store = nullptr;
+    if (!qCanConvertInPlace(pixelFormat, format)) {
+        store = qStoreFuncForImageFormat(format);
+        if (!store)
+            return false;
+    }
+
+    QVarLengthArray<int, 512> xOffsets(outputWidth + 1);
+    for (int x = 0; x <= outputWidth; ++x)
+        xOffsets[x] = int(qint64(x) * width / outputWidth);
+
+    QVarLengthArray<quint64, 1024> sums(outputWidth * 4);
+    QVarLengthArray<quint32, 512> line(outputWidth);
+    memset(sums.data(), 0, sums.size() * sizeof(quint64));
+
+    const int bandHeight = qConversionBandHeight(width);
+    QVarLengthArray<quint32, 4096> band(width * bandHeight);
+
+    int outputY = 0;
+    int boxTop = 0;
+    int boxBottom = height / outputHeight;
+
+    for (int y = 0; y < height; y += bandHeight) {
+        const int rowCount = qMin(bandHeight, height - y);
+        convert(frame, reinterpret_cast<uchar*>(band.data()), width * 4, y, rowCount);
+
+        for (int i = 0; i < rowCount; ++i) {
+            qAccumulateFunc(sums.data(), band.constData() + i * width, xOffsets.constData(), outputWidth);
+            if (y + i + 1 < boxBottom)
+                continue;
+
+            uchar *outputLine = output + outputY * bytesPerLine;
+            if (store) {
+                qt_average_box_to_ARGB32(line.data(), sums.constData(), xOffsets.constData(),
+                                         boxBottom - boxTop, outputWidth);
+                store(outputLine, line.constData(), outputWidth);
+            } else {
+                qt_average_box_to_ARGB32(reinterpret_cast<quint32*>(outputLine), sums.constData(),
+                                         xOffsets.constData(), boxBottom - boxTop, outputWidth);
+            }
+            memset(sums.data(), 0, sums.size() * sizeof(quint64));
+
+            ++outputY;
+            boxTop = boxBottom;
+            boxBottom = int(qint64(outputY + 1) * height / outputHeight);
+        }
+    }
+
+    return true;
 }
 
 /*!
     Based on the pixel format converts current video frame to image.
+
+    Conversions run on the calling thread by default. Setting the
+    \c QT_VIDEOFRAME_CONVERSION_THREADS environment variable to a value
+    greater than 1 lets large frames be converted on up to that many
+    threads of the global QThreadPool. Small frames are always converted
+    on the calling thread.
+
     \since 5.15
 */
 QImage QVideoFrame::image() const
@@ -1134,17 +1520,103 @@ QImage QVideoFrame::image() const
 
     // Need conversion
     else {
-        static bool initAsmFuncsDone = false;
-        if (!initAsmFuncsDone) {
-            qInitConvertFuncsAsm();
-            initAsmFuncsDone = true;
-        }
-        VideoFrameConvertFunc convert = qConvertFuncs[frame.pixelFormat()];
-        if (!convert) {
+        result = QImage(frame.width(), frame.height(), QImage::Format_ARGB32);
+        if (!qConvertMappedFrame(frame, QImage::Format_ARGB32, result.bits(), result.bytesPerLine())) {
             qWarning() << Q_FUNC_INFO << ": unsupported pixel format" << frame.pixelFormat();
-        } else {
-            result = QImage(frame.width(), frame.height(), QImage::Format_ARGB32);
-            convert(frame, result.bits());
+            result = QImage();
+        }
+    }
+
+    frame.unmap();
+
+    return result;
+}
+
+/*!
+    Converts the current video frame to an image of the given \a format.
+
+    Unlike calling convertToFormat() on the result of image(), frames whose
+    pixel format is not supported by QImage are converted in a single pass.
+
+    Returns a null image if the frame cannot be mapped or converted.
+
+    \since 6.0
+    \sa convertTo()
+*/
+QImage QVideoFrame::image(QImage::Format format) const
+{
+    QVideoFrame frame = *this;
+    QImage result;
+
+    if (format == QImage::Format_Invalid || !frame.isValid() || !frame.map(QAbstractVideoBuffer::ReadOnly))
+        return result;
+
+    QImage::Format imageFormat = QVideoFrame::imageFormatFromPixelFormat(frame.pixelFormat());
+    if (imageFormat != QImage::Format_Invalid) {
+        const QImage source(frame.bits(), frame.width(), frame.height(), frame.bytesPerLine(), imageFormat);
+        result = imageFormat == format ? source.copy() : source.convertToFormat(format);
+    } else if (frame.pixelFormat() == QVideoFrame::Format_Jpeg) {
+        result.loadFromData(frame.bits(), frame.mappedBytes(), "JPG");
+        result = result.convertToFormat(format);
+    } else {
+        result = QImage(frame.width(), frame.height(), format);
+        if (!qConvertMappedFrame(frame, format, result.bits(), result.bytesPerLine())) {
+            qWarning() << Q_FUNC_INFO << ": unsupported conversion from" << frame.pixelFormat()
+                       << "to" << format;
+            result = QImage();
+        }
+    }
+
+    frame.unmap();
+
+    return result;
+}
+
+/*!
+    Converts the current video frame to an image of the given \a format,
+    scaled to \a size without keeping the aspect ratio.
+
+    When the frame is downscaled and its pixel format is not supported by
+    QImage, the conversion and a box filter are applied in the same pass.
+    This is considerably cheaper than scaling the result of image(), which
+    makes it suitable for generating thumbnails.
+
+    Returns a null image if the frame cannot be mapped or converted, or if
+    \a size is empty.
+
+    \since 6.0
+    \sa image()
+*/
+QImage QVideoFrame::scaledImage(const QSize &size, QImage::Format format) const
+{
+    QVideoFrame frame = *this;
+    QImage result;
+
+    if (size.isEmpty() || format == QImage::Format_Invalid || !frame.isValid())
+        return result;
+
+    if (size == frame.size())
+        return frame.image(format);
+
+    if (size.width() > frame.width() || size.height() > frame.height())
+        return frame.image(format).scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    if (!frame.map(QAbstractVideoBuffer::ReadOnly))
+        return result;
+
+    QImage::Format imageFormat = QVideoFrame::imageFormatFromPixelFormat(frame.pixelFormat());
+    if (imageFormat != QImage::Format_Invalid) {
+        const QImage source(frame.bits(), frame.width(), frame.height(), frame.bytesPerLine(), imageFormat);
+        result = source.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation).convertToFormat(format);
+    } else if (frame.pixelFormat() == QVideoFrame::Format_Jpeg) {
+        result.loadFromData(frame.bits(), frame.mappedBytes(), "JPG");
+        result = result.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation).convertToFormat(format);
+    } else {
+        result = QImage(size, format);
+        if (!qScaleMappedFrame(frame, size, format, result.bits(), result.bytesPerLine())) {
+            qWarning() << Q_FUNC_INFO << ": unsupported conversion from" << frame.pixelFormat()
+                       << "to" << format;
+            result = QImage();
         }
     }
 
@@ -1153,6 +1625,58 @@ QImage QVideoFrame::image() const
     return result;
 }
 
+/*!
+    Converts the current video frame to the given image \a format, writing
+    the pixels directly to the caller owned memory at \a data. Each line of
+    the output is \a bytesPerLine bytes apart, which must be enough to hold
+    width() pixels of \a format.
+
+    This avoids allocating an intermediate image, for example when frames are
+    converted into a buffer that is reused or shared with other APIs.
+
+    Returns true if the frame was converted and false otherwise.
+
+    \since 6.0
+    \sa image()
+*/
+bool QVideoFrame::convertTo(QImage::Format format, uchar *data, int bytesPerLine) const
+{
+    if (!data || format == QImage::Format_Invalid || !isValid())
+        return false;
+
+    const int bitsPerPixel = QImage::toPixelFormat(format).bitsPerPixel();
+    const int lineLength = (width() * bitsPerPixel + 7) / 8;
+    if (bytesPerLine < lineLength)
+        return false;
+
+    QVideoFrame frame = *this;
+    if (!frame.map(QAbstractVideoBuffer::ReadOnly))
+        return false;
+
+    bool converted = false;
+    QImage::Format imageFormat = QVideoFrame::imageFormatFromPixelFormat(frame.pixelFormat());
+    if (imageFormat != QImage::Format_Invalid || frame.pixelFormat() == QVideoFrame::Format_Jpeg) {
+        QImage source;
+        if (imageFormat != QImage::Format_Invalid)
+            source = QImage(frame.bits(), frame.width(), frame.height(), frame.bytesPerLine(), imageFormat);
+        else
+            source.loadFromData(frame.bits(), frame.mappedBytes(), "JPG");
+
+        if (source.format() != format)
+            source = source.convertToFormat(format);
+
+        converted = !source.isNull() && source.size() == frame.size();
+        for (int y = 0; converted && y < source.height(); ++y)
+            memcpy(data + y * bytesPerLine, source.constScanLine(y), lineLength);
+    } else {
+        converted = qConvertMappedFrame(frame, format, data, bytesPerLine);
+    }
+
+    frame.unmap();
+
+    return converted;
+}
+
 #ifndef QT_NO_DEBUG_STREAM
 QDebug operator<<(QDebug dbg, QVideoFrame::PixelFormat pf)
 {
@@ -167,6 +167,9 @@ public:
     void setMetaData(const QString &key, const QVariant &value);
 
     QImage image() const;
+    QImage image(QImage::Format format) const;
+    QImage scaledImage(const QSize &size, QImage::Format format = QImage::Format_ARGB32) const;
+    bool convertTo(QImage::Format format, uchar *data, int bytesPerLine) const;
 
     static PixelFormat pixelFormatFromImageFormat(QImage::Format format);
     static QImage::Format imageFormatFromPixelFormat(PixelFormat format);
@@ -41,92 +41,134 @@
 
 QT_BEGIN_NAMESPACE
 
-#define CLAMP(n) (n > 255 ? 255 : (n < 0 ? 0 : n))
-
-#define EXPAND_UV(u, v) \
-    int uu = u - 128; \
-    int vv = v - 128; \
-    int rv = 409 * vv + 128; \
-    int guv = 100 * uu + 208 * vv + 128; \
-    int bu = 516 * uu + 128; \
-
-static inline quint32 qYUVToARGB32(int y, int rv, int guv, int bu, int a = 0xff)
-{
-    int yy = (y - 16) * 298;
-    return (a << 24)
-            | CLAMP((yy + rv) >> 8) << 16
-            | CLAMP((yy - guv) >> 8) << 8
-            | CLAMP((yy + bu) >> 8);
-}
-
 static inline void planarYUV420_to_ARGB32(const uchar *y, int yStride,
                                           const uchar *u, int uStride,
                                           const uchar *v, int vStride,
                                           int uvPixelStride,
-                                          quint32 *rgb,
+                                          uchar *output, int outputStride,
                                           int width, int height)
 {
-    quint32 *rgb0 = rgb;
-    quint32 *rgb1 = rgb + width;
-
     for (int j = 0; j < height; j += 2) {
-        const uchar *lineY0 = y;
-        const uchar *lineY1 = y + yStride;
-        const uchar *lineU = u;
-        const uchar *lineV = v;
+        // The last row of an odd height has no partner, it is converted twice in place
+        const bool lastRow = j + 1 == height;
+        quint32 *rgb0 = reinterpret_cast<quint32*>(output);
+        quint32 *rgb1 = lastRow ? rgb0 : reinterpret_cast<quint32*>(output + outputStride);
 
-        for (int i = 0; i < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
-            lineU += uvPixelStride;
-            lineV += uvPixelStride;
-
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb1++ = qYUVToARGB32(*lineY1++, rv, guv, bu);
-            *rgb1++ = qYUVToARGB32(*lineY1++, rv, guv, bu);
-        }
+        qYUV420PixelsToARGB32(y, lastRow ? y : y + yStride, u, v, uvPixelStride,
+                              rgb0, rgb1, width);
 
         y += yStride << 1; // stride * 2
         u += uStride;
         v += vStride;
-        rgb0 += width;
-        rgb1 += width;
+        output += outputStride << 1;
     }
 }
 
-
-
-void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                              int outputStride, int firstRow, int rowCount)
 {
-    FETCH_INFO_TRIPLANAR(frame)
+    FETCH_INFO_TRIPLANAR(frame, 2)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2, plane2Stride,
                            plane3, plane3Stride,
                            1,
-                           reinterpret_cast<quint32*>(output),
+                           output, outputStride,
                            width, height);
 }
 
-void QT_FASTCALL qt_convert_YV12_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_YV12_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                           int outputStride, int firstRow, int rowCount)
 {
-    FETCH_INFO_TRIPLANAR(frame)
+    FETCH_INFO_TRIPLANAR(frame, 2)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane3, plane3Stride,
                            plane2, plane2Stride,
                            1,
-                           reinterpret_cast<quint32*>(output),
+                           output, outputStride,
+                           width, height);
+}
+
+void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                           int outputStride, int firstRow, int rowCount)
+{
+    // Same layout as YUV420P, the chroma planes are just padded to the luma stride
+    qt_convert_YUV420P_to_ARGB32(frame, output, outputStride, firstRow, rowCount);
+}
+
+void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                           int outputStride, int firstRow, int rowCount)
+{
+    // Same layout as YV12, the chroma planes are just padded to the luma stride
+    qt_convert_YV12_to_ARGB32(frame, output, outputStride, firstRow, rowCount);
+}
+
+void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                           int outputStride, int firstRow, int rowCount)
+{
+    // Each chroma line holds a line of U followed by a line of V
+    FETCH_INFO_BIPLANAR(frame)
+    planarYUV420_to_ARGB32(plane1, plane1Stride,
+                           plane2, plane2Stride,
+                           plane2 + plane2Stride / 2, plane2Stride,
+                           1,
+                           output, outputStride,
+                           width, height);
+}
+
+void QT_FASTCALL qt_convert_IMC4_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                           int outputStride, int firstRow, int rowCount)
+{
+    // Each chroma line holds a line of V followed by a line of U
+    FETCH_INFO_BIPLANAR(frame)
+    planarYUV420_to_ARGB32(plane1, plane1Stride,
+                           plane2 + plane2Stride / 2, plane2Stride,
+                           plane2, plane2Stride,
+                           1,
+                           output, outputStride,
                            width, height);
 }
 
-void QT_FASTCALL qt_convert_AYUV444_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                              int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_TRIPLANAR(frame, 1)
+
+    for (int j = 0; j < height; ++j) {
+        const uchar *lineY = plane1;
+        const uchar *lineU = plane2;
+        const uchar *lineV = plane3;
+        quint32 *rgb = reinterpret_cast<quint32*>(output);
+
+        int i = 0;
+        for (; i < width - 1; i += 2) {
+            EXPAND_UV(*lineU++, *lineV++);
+
+            *rgb++ = qYUVToARGB32(*lineY++, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(*lineY++, rv, guv, bu);
+        }
+
+        // The last column of an odd width
+        if (i < width) {
+            EXPAND_UV(*lineU, *lineV);
+            *rgb = qYUVToARGB32(*lineY, rv, guv, bu);
+        }
+
+        plane1 += plane1Stride;
+        plane2 += plane2Stride;
+        plane3 += plane3Stride;
+        output += outputStride;
+    }
+}
+
+void QT_FASTCALL qt_convert_AYUV444_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                              int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
 
-    quint32 *rgb = reinterpret_cast<quint32*>(output);
-
     for (int i = 0; i < height; ++i) {
         const uchar *lineSrc = src;
+        quint32 *rgb = reinterpret_cast<quint32*>(output);
 
         for (int j = 0; j < width; ++j) {
             int a = *lineSrc++;
@@ -140,18 +182,19 @@ void QT_FASTCALL qt_convert_AYUV444_to_ARGB32(const QVideoFrame &frame, uchar *o
         }
 
         src += stride;
+        output += outputStride;
     }
 }
 
-void QT_FASTCALL qt_convert_YUV444_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_YUV444_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                             int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 3)
 
-    quint32 *rgb = reinterpret_cast<quint32*>(output);
-
     for (int i = 0; i < height; ++i) {
         const uchar *lineSrc = src;
+        quint32 *rgb = reinterpret_cast<quint32*>(output);
 
         for (int j = 0; j < width; ++j) {
             int y = *lineSrc++;
@@ -164,92 +207,110 @@ void QT_FASTCALL qt_convert_YUV444_to_ARGB32(const QVideoFrame &frame, uchar *ou
         }
 
         src += stride;
+        output += outputStride;
     }
 }
 
-void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                           int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
-    quint32 *rgb = reinterpret_cast<quint32*>(output);
-
     for (int i = 0; i < height; ++i) {
-        const uchar *lineSrc = src;
-
-        for (int j = 0; j < width; j += 2) {
-            int u = *lineSrc++;
-            int y0 = *lineSrc++;
-            int v = *lineSrc++;
-            int y1 = *lineSrc++;
-
-            EXPAND_UV(u, v);
-
-            *rgb++ = qYUVToARGB32(y0, rv, guv, bu);
-            *rgb++ = qYUVToARGB32(y1, rv, guv, bu);
-        }
+        qPackedYUV422PixelsToARGB32(src, 1, reinterpret_cast<quint32*>(output), width);
 
         src += stride;
+        output += outputStride;
     }
 }
 
-void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                           int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
-    quint32 *rgb = reinterpret_cast<quint32*>(output);
-
     for (int i = 0; i < height; ++i) {
-        const uchar *lineSrc = src;
-
-        for (int j = 0; j < width; j += 2) {
-            int y0 = *lineSrc++;
-            int u = *lineSrc++;
-            int y1 = *lineSrc++;
-            int v = *lineSrc++;
-
-            EXPAND_UV(u, v);
-
-            *rgb++ = qYUVToARGB32(y0, rv, guv, bu);
-            *rgb++ = qYUVToARGB32(y1, rv, guv, bu);
-        }
+        qPackedYUV422PixelsToARGB32(src, 0, reinterpret_cast<quint32*>(output), width);
 
         src += stride;
+        output += outputStride;
     }
 }
 
-void QT_FASTCALL qt_convert_NV12_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_NV12_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                           int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_BIPLANAR(frame)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2, plane2Stride,
                            plane2 + 1, plane2Stride,
                            2,
-                           reinterpret_cast<quint32*>(output),
+                           output, outputStride,
                            width, height);
 }
 
-void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                           int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_BIPLANAR(frame)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
                            plane2 + 1, plane2Stride,
                            plane2, plane2Stride,
                            2,
-                           reinterpret_cast<quint32*>(output),
+                           output, outputStride,
                            width, height);
 }
 
-void QT_FASTCALL qt_convert_BGRA32_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_Y8_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                         int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
-    MERGE_LOOPS(width, height, stride, 4)
+    MERGE_LOOPS(width, height, stride, 1)
+
+    for (int i = 0; i < height; ++i) {
+        const uchar *lineSrc = src;
+        quint32 *rgb = reinterpret_cast<quint32*>(output);
+
+        for (int j = 0; j < width; ++j)
+            *rgb++ = 0xff000000 | (*lineSrc++ * 0x010101);
+
+        src += stride;
+        output += outputStride;
+    }
+}
+
+void QT_FASTCALL qt_convert_Y16_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                          int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_PACKED(frame)
+    MERGE_LOOPS(width, height, stride, 2)
+
+    for (int i = 0; i < height; ++i) {
+        // Little endian, the high byte is the second one
+        const uchar *lineSrc = src + 1;
+        quint32 *rgb = reinterpret_cast<quint32*>(output);
+
+        for (int j = 0; j < width; ++j) {
+            *rgb++ = 0xff000000 | (*lineSrc * 0x010101);
+            lineSrc += 2;
+        }
+
+        src += stride;
+        output += outputStride;
+    }
+}
 
-    quint32 *argb = reinterpret_cast<quint32*>(output);
+void QT_FASTCALL qt_convert_BGRA32_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                             int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_PACKED(frame)
+    MERGE_LOOPS(width, height, stride, 4)
 
     for (int y = 0; y < height; ++y) {
         const quint32 *bgra = reinterpret_cast<const quint32*>(src);
+        quint32 *argb = reinterpret_cast<quint32*>(output);
 
         int x = 0;
         for (; x < width - 3; x += 4) {
@@ -264,18 +325,19 @@ void QT_FASTCALL qt_convert_BGRA32_to_ARGB32(const QVideoFrame &frame, uchar *ou
             *argb++ = qConvertBGRA32ToARGB32(*bgra++);
 
         src += stride;
+        output += outputStride;
     }
 }
 
-void QT_FASTCALL qt_convert_BGR24_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_BGR24_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                            int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 3)
 
-    quint32 *argb = reinterpret_cast<quint32*>(output);
-
     for (int y = 0; y < height; ++y) {
         const uchar *bgr = src;
+        quint32 *argb = reinterpret_cast<quint32*>(output);
 
         int x = 0;
         for (; x < width - 3; x += 4) {
@@ -296,18 +358,19 @@ void QT_FASTCALL qt_convert_BGR24_to_ARGB32(const QVideoFrame &frame, uchar *out
         }
 
         src += stride;
+        output += outputStride;
     }
 }
 
-void QT_FASTCALL qt_convert_BGR565_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_BGR565_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                             int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
-    quint32 *argb = reinterpret_cast<quint32*>(output);
-
     for (int y = 0; y < height; ++y) {
         const quint16 *bgr = reinterpret_cast<const quint16*>(src);
+        quint32 *argb = reinterpret_cast<quint32*>(output);
 
         int x = 0;
         for (; x < width - 3; x += 4) {
@@ -322,18 +385,19 @@ void QT_FASTCALL qt_convert_BGR565_to_ARGB32(const QVideoFrame &frame, uchar *ou
             *argb++ = qConvertBGR565ToARGB32(*bgr++);
 
         src += stride;
+        output += outputStride;
     }
 }
 
-void QT_FASTCALL qt_convert_BGR555_to_ARGB32(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_BGR555_to_ARGB32(const QVideoFrame &frame, uchar *output,
+                                             int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
-    quint32 *argb = reinterpret_cast<quint32*>(output);
-
     for (int y = 0; y < height; ++y) {
         const quint16 *bgr = reinterpret_cast<const quint16*>(src);
+        quint32 *argb = reinterpret_cast<quint32*>(output);
 
         int x = 0;
         for (; x < width - 3; x += 4) {
@@ -348,6 +412,186 @@ void QT_FASTCALL qt_convert_BGR555_to_ARGB32(const QVideoFrame &frame, uchar *ou
             *argb++ = qConvertBGR555ToARGB32(*bgr++);
 
         src += stride;
+        output += outputStride;
+    }
+}
+
+// Expands limited range (16-235) luma to full range grey.
+static inline uchar qLumaToGray(int y)
+{
+    const int gray = ((y - 16) * 298 + 128) >> 8;
+    return uchar(CLAMP(gray));
+}
+
+void QT_FASTCALL qt_convert_luma_to_Grayscale8(const QVideoFrame &frame, uchar *output,
+                                               int outputStride, int firstRow, int rowCount)
+{
+    // Only the luma plane, or the luma bytes of packed formats, are read
+    int offset = 0;
+    int pixelStride = 1;
+    switch (frame.pixelFormat()) {
+    case QVideoFrame::Format_AYUV444:
+    case QVideoFrame::Format_AYUV444_Premultiplied:
+        offset = 1;
+        pixelStride = 4;
+        break;
+    case QVideoFrame::Format_YUV444:
+        pixelStride = 3;
+        break;
+    case QVideoFrame::Format_UYVY:
+        offset = 1;
+        pixelStride = 2;
+        break;
+    case QVideoFrame::Format_YUYV:
+        pixelStride = 2;
+        break;
+    default:
+        break;
+    }
+
+    static const struct LumaToGrayTable {
+        LumaToGrayTable()
+        {
+            for (int i = 0; i < 256; ++i)
+                table[i] = qLumaToGray(i);
+        }
+        uchar table[256];
+    } lumaToGray;
+
+    FETCH_INFO_PACKED(frame)
+    src += offset;
+
+    for (int i = 0; i < height; ++i) {
+        const uchar *lineSrc = src;
+        uchar *gray = output;
+
+        for (int j = 0; j < width; ++j) {
+            *gray++ = lumaToGray.table[*lineSrc];
+            lineSrc += pixelStride;
+        }
+
+        src += stride;
+        output += outputStride;
+    }
+}
+
+void QT_FASTCALL qt_store_ARGB32_to_RGB32(uchar *output, const quint32 *argb, int count)
+{
+    quint32 *rgb = reinterpret_cast<quint32*>(output);
+    for (int i = 0; i < count; ++i)
+        *rgb++ = 0xff000000 | *argb++;
+}
+
+void QT_FASTCALL qt_store_ARGB32_to_ARGB32_Premultiplied(uchar *output, const quint32 *argb, int count)
+{
+    quint32 *argbPM = reinterpret_cast<quint32*>(output);
+    for (int i = 0; i < count; ++i)
+        *argbPM++ = qPremultiply(*argb++);
+}
+
+void QT_FASTCALL qt_store_ARGB32_to_RGB888(uchar *output, const quint32 *argb, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const quint32 pixel = *argb++;
+        *output++ = uchar(pixel >> 16);
+        *output++ = uchar(pixel >> 8);
+        *output++ = uchar(pixel);
+    }
+}
+
+void QT_FASTCALL qt_store_ARGB32_to_BGR888(uchar *output, const quint32 *argb, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const quint32 pixel = *argb++;
+        *output++ = uchar(pixel);
+        *output++ = uchar(pixel >> 8);
+        *output++ = uchar(pixel >> 16);
+    }
+}
+
+void QT_FASTCALL qt_store_ARGB32_to_RGBA8888(uchar *output, const quint32 *argb, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const quint32 pixel = *argb++;
+        *output++ = uchar(pixel >> 16);
+        *output++ = uchar(pixel >> 8);
+        *output++ = uchar(pixel);
+        *output++ = uchar(pixel >> 24);
+    }
+}
+
+void QT_FASTCALL qt_store_ARGB32_to_RGBX8888(uchar *output, const quint32 *argb, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const quint32 pixel = *argb++;
+        *output++ = uchar(pixel >> 16);
+        *output++ = uchar(pixel >> 8);
+        *output++ = uchar(pixel);
+        *output++ = 0xff;
+    }
+}
+
+void QT_FASTCALL qt_store_ARGB32_to_RGBA8888_Premultiplied(uchar *output, const quint32 *argb, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const quint32 pixel = qPremultiply(*argb++);
+        *output++ = uchar(pixel >> 16);
+        *output++ = uchar(pixel >> 8);
+        *output++ = uchar(pixel);
+        *output++ = uchar(pixel >> 24);
+    }
+}
+
+void QT_FASTCALL qt_store_ARGB32_to_RGB16(uchar *output, const quint32 *argb, int count)
+{
+    quint16 *rgb = reinterpret_cast<quint16*>(output);
+    for (int i = 0; i < count; ++i) {
+        const quint32 pixel = *argb++;
+        *rgb++ = quint16(((pixel >> 8) & 0xf800) | ((pixel >> 5) & 0x07e0) | ((pixel >> 3) & 0x001f));
+    }
+}
+
+void QT_FASTCALL qt_store_ARGB32_to_Grayscale8(uchar *output, const quint32 *argb, int count)
+{
+    for (int i = 0; i < count; ++i)
+        *output++ = uchar(qGray(*argb++));
+}
+
+void QT_FASTCALL qt_accumulate_ARGB32_box(quint64 *sums, const quint32 *argb,
+                                         const int *xOffsets, int outputWidth)
+{
+    for (int x = 0; x < outputWidth; ++x) {
+        quint32 b = 0;
+        quint32 g = 0;
+        quint32 r = 0;
+        quint32 a = 0;
+        for (int i = xOffsets[x]; i < xOffsets[x + 1]; ++i) {
+            const quint32 pixel = argb[i];
+            b += pixel & 0xff;
+            g += (pixel >> 8) & 0xff;
+            r += (pixel >> 16) & 0xff;
+            a += pixel >> 24;
+        }
+        *sums++ += b;
+        *sums++ += g;
+        *sums++ += r;
+        *sums++ += a;
+    }
+}
+
+// Divides the sums of boxes spanning rowCount rows by their area.
+void QT_FASTCALL qt_average_box_to_ARGB32(quint32 *output, const quint64 *sums,
+                                         const int *xOffsets, int rowCount, int outputWidth)
+{
+    for (int x = 0; x < outputWidth; ++x) {
+        const quint64 count = quint64(xOffsets[x + 1] - xOffsets[x]) * quint64(rowCount);
+        const quint64 half = count / 2;
+        const quint32 b = quint32((sums[0] + half) / count);
+        const quint32 g = quint32((sums[1] + half) / count);
+        const quint32 r = quint32((sums[2] + half) / count);
+        const quint32 a = quint32((sums[3] + half) / count);
+        *output++ = (a << 24) | (r << 16) | (g << 8) | b;
+        sums += 4;
     }
 }
 
@@ -43,17 +43,18 @@
 
 QT_BEGIN_NAMESPACE
 
-void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output,
+                                                  int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
-    quint32 *argb = reinterpret_cast<quint32*>(output);
 
     const __m256i shuffleMask = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
                                                 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
 
     for (int y = 0; y < height; ++y) {
         const quint32 *bgra = reinterpret_cast<const quint32*>(src);
+        quint32 *argb = reinterpret_cast<quint32*>(output);
 
         int x = 0;
         ALIGN(32, argb, x, width) {
@@ -81,9 +82,226 @@ void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_avx2(const QVideoFrame &frame, ucha
         }
 
         src += stride;
+        output += outputStride;
     }
 }
 
+// Computes the rv, guv and bu terms of EXPAND_UV as 32-bit lanes for eight
+// (u, v) pairs stored as interleaved 16-bit lanes, four per 128-bit lane.
+static inline void qExpandUV_avx2(__m256i uv, __m256i &rv, __m256i &guv, __m256i &bu)
+{
+    const __m256i round = _mm256_set1_epi32(128);
+    uv = _mm256_sub_epi16(uv, _mm256_set1_epi16(128));
+    rv = _mm256_add_epi32(_mm256_madd_epi16(uv, _mm256_set1_epi32(409 << 16)), round);
+    guv = _mm256_add_epi32(_mm256_madd_epi16(uv, _mm256_set1_epi32((208 << 16) | 100)), round);
+    bu = _mm256_add_epi32(_mm256_madd_epi16(uv, _mm256_set1_epi32(516)), round);
+}
+
+// Converts sixteen luma samples stored as 16-bit lanes to ARGB32, each pair of
+// pixels sharing one lane of the chroma terms. AVX2 unpacks operate within
+// 128-bit lanes, so pixels 0-7 are computed in the low lane and 8-15 in the
+// high lane and only reordered on store. Matches qYUVToARGB32() exactly.
+static inline void qYUVToARGB32x16_avx2(__m256i y, __m256i rv, __m256i guv, __m256i bu, quint32 *rgb)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i yCoeff = _mm256_set1_epi32(298);
+
+    y = _mm256_sub_epi16(y, _mm256_set1_epi16(16));
+    const __m256i yyLo = _mm256_madd_epi16(_mm256_unpacklo_epi16(y, zero), yCoeff);
+    const __m256i yyHi = _mm256_madd_epi16(_mm256_unpackhi_epi16(y, zero), yCoeff);
+
+    const __m256i rvLo = _mm256_unpacklo_epi32(rv, rv);
+    const __m256i rvHi = _mm256_unpackhi_epi32(rv, rv);
+    const __m256i guvLo = _mm256_unpacklo_epi32(guv, guv);
+    const __m256i guvHi = _mm256_unpackhi_epi32(guv, guv);
+    const __m256i buLo = _mm256_unpacklo_epi32(bu, bu);
+    const __m256i buHi = _mm256_unpackhi_epi32(bu, bu);
+
+    const __m256i r = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yyLo, rvLo), 8),
+                                         _mm256_srai_epi32(_mm256_add_epi32(yyHi, rvHi), 8));
+    const __m256i g = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_sub_epi32(yyLo, guvLo), 8),
+                                         _mm256_srai_epi32(_mm256_sub_epi32(yyHi, guvHi), 8));
+    const __m256i b = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yyLo, buLo), 8),
+                                         _mm256_srai_epi32(_mm256_add_epi32(yyHi, buHi), 8));
+
+    // Clamp to [0, 255] and interleave to B, G, R, A bytes
+    __m256i bg = _mm256_packus_epi16(b, g);
+    __m256i ra = _mm256_packus_epi16(r, _mm256_set1_epi16(0xff));
+    bg = _mm256_unpacklo_epi8(bg, _mm256_srli_si256(bg, 8));
+    ra = _mm256_unpacklo_epi8(ra, _mm256_srli_si256(ra, 8));
+    const __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+    const __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgb), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgb + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+static inline void planarYUV420_to_ARGB32_avx2(const uchar *y, int yStride,
+                                               const uchar *u, int uStride,
+                                               const uchar *v, int vStride,
+                                               int uvPixelStride,
+                                               uchar *output, int outputStride,
+                                               int width, int height)
+{
+    // For semi-planar formats u and v point into the same interleaved plane
+    const bool swapUV = uvPixelStride == 2 && v < u;
+    const __m256i swapMask = _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+                                             13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+
+    for (int j = 0; j < height; j += 2) {
+        const uchar *lineY0 = y;
+        // The last row of an odd height has no partner, it is converted twice in place
+        const bool lastRow = j + 1 == height;
+        const uchar *lineY1 = lastRow ? y : y + yStride;
+        const uchar *lineU = u;
+        const uchar *lineV = v;
+        quint32 *rgb0 = reinterpret_cast<quint32*>(output);
+        quint32 *rgb1 = lastRow ? rgb0 : reinterpret_cast<quint32*>(output + outputStride);
+
+        int i = 0;
+        for (; i < width - 15; i += 16) {
+            __m256i uv;
+            if (uvPixelStride == 1) {
+                const __m128i uu = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(lineU)));
+                const __m128i vv = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(lineV)));
+                uv = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(uu, vv)),
+                                             _mm_unpackhi_epi16(uu, vv), 1);
+            } else {
+                uv = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(swapUV ? lineV : lineU)));
+                if (swapUV)
+                    uv = _mm256_shuffle_epi8(uv, swapMask);
+            }
+            lineU += 8 * uvPixelStride;
+            lineV += 8 * uvPixelStride;
+
+            const __m256i y0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lineY0)));
+            const __m256i y1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lineY1)));
+            lineY0 += 16;
+            lineY1 += 16;
+
+            __m256i rv, guv, bu;
+            qExpandUV_avx2(uv, rv, guv, bu);
+            qYUVToARGB32x16_avx2(y0, rv, guv, bu, rgb0);
+            qYUVToARGB32x16_avx2(y1, rv, guv, bu, rgb1);
+            rgb0 += 16;
+            rgb1 += 16;
+        }
+
+        // leftovers
+        qYUV420PixelsToARGB32(lineY0, lineY1, lineU, lineV, uvPixelStride, rgb0, rgb1, width - i);
+
+        y += yStride << 1; // stride * 2
+        u += uStride;
+        v += vStride;
+        output += outputStride << 1;
+    }
+}
+
+// Packed 4:2:2, lumaShift selects whether luma is in the low (YUYV) or the
+// high (UYVY) byte of each 16-bit word.
+static inline void packedYUV422_to_ARGB32_avx2(const uchar *src, int stride,
+                                               int lumaShift,
+                                               uchar *output, int outputStride,
+                                               int width, int height)
+{
+    const __m256i lowBytes = _mm256_set1_epi16(0xff);
+
+    for (int i = 0; i < height; ++i) {
+        const uchar *lineSrc = src;
+        quint32 *rgb = reinterpret_cast<quint32*>(output);
+
+        int j = 0;
+        for (; j < width - 15; j += 16) {
+            const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lineSrc));
+            lineSrc += 32;
+
+            __m256i y;
+            __m256i uv;
+            if (lumaShift) {
+                y = _mm256_srli_epi16(data, 8);
+                uv = _mm256_and_si256(data, lowBytes);
+            } else {
+                y = _mm256_and_si256(data, lowBytes);
+                uv = _mm256_srli_epi16(data, 8);
+            }
+
+            __m256i rv, guv, bu;
+            qExpandUV_avx2(uv, rv, guv, bu);
+            qYUVToARGB32x16_avx2(y, rv, guv, bu, rgb);
+            rgb += 16;
+        }
+
+        // leftovers
+        qPackedYUV422PixelsToARGB32(lineSrc, lumaShift ? 1 : 0, rgb, width - j);
+
+        src += stride;
+        output += outputStride;
+    }
+}
+
+void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output,
+                                                   int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_TRIPLANAR(frame, 2)
+    planarYUV420_to_ARGB32_avx2(plane1, plane1Stride,
+                                plane2, plane2Stride,
+                                plane3, plane3Stride,
+                                1,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_YV12_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_TRIPLANAR(frame, 2)
+    planarYUV420_to_ARGB32_avx2(plane1, plane1Stride,
+                                plane3, plane3Stride,
+                                plane2, plane2Stride,
+                                1,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_NV12_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    planarYUV420_to_ARGB32_avx2(plane1, plane1Stride,
+                                plane2, plane2Stride,
+                                plane2 + 1, plane2Stride,
+                                2,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_NV21_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    planarYUV420_to_ARGB32_avx2(plane1, plane1Stride,
+                                plane2 + 1, plane2Stride,
+                                plane2, plane2Stride,
+                                2,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_UYVY_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_PACKED(frame)
+    MERGE_LOOPS(width, height, stride, 2)
+    packedYUV422_to_ARGB32_avx2(src, stride, 8, output, outputStride, width, height);
+}
+
+void QT_FASTCALL qt_convert_YUYV_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_PACKED(frame)
+    MERGE_LOOPS(width, height, stride, 2)
+    packedYUV422_to_ARGB32_avx2(src, stride, 0, output, outputStride, width, height);
+}
+
 QT_END_NAMESPACE
 
 #endif
@@ -0,0 +1,268 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qvideoframeconversionhelper_p.h"
+
+#ifdef __ARM_NEON__
+
+QT_BEGIN_NAMESPACE
+
+struct QNeonChromaTerms
+{
+    int32x4x2_t rv;
+    int32x4x2_t guv;
+    int32x4x2_t bu;
+};
+
+// Computes the rv, guv and bu terms of EXPAND_UV for four chroma samples,
+// duplicated so that each term covers the two pixels sharing it.
+static inline QNeonChromaTerms qExpandUV_neon(int16x4_t u, int16x4_t v)
+{
+    const int32x4_t round = vdupq_n_s32(128);
+    const int16x4_t uu = vsub_s16(u, vdup_n_s16(128));
+    const int16x4_t vv = vsub_s16(v, vdup_n_s16(128));
+
+    const int32x4_t rv = vaddq_s32(vmull_n_s16(vv, 409), round);
+    const int32x4_t guv = vaddq_s32(vmlal_n_s16(vmull_n_s16(uu, 100), vv, 208), round);
+    const int32x4_t bu = vaddq_s32(vmull_n_s16(uu, 516), round);
+
+    QNeonChromaTerms terms;
+    terms.rv = vzipq_s32(rv, rv);
+    terms.guv = vzipq_s32(guv, guv);
+    terms.bu = vzipq_s32(bu, bu);
+    return terms;
+}
+
+// Converts eight luma samples to ARGB32. Matches qYUVToARGB32() exactly.
+static inline void qYUVToARGB32x8_neon(uint8x8_t y, const QNeonChromaTerms &c, quint32 *rgb)
+{
+    const int16x8_t y16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), vdupq_n_s16(16));
+    const int32x4_t yyLo = vmull_n_s16(vget_low_s16(y16), 298);
+    const int32x4_t yyHi = vmull_n_s16(vget_high_s16(y16), 298);
+
+    const int16x8_t r = vcombine_s16(vqshrn_n_s32(vaddq_s32(yyLo, c.rv.val[0]), 8),
+                                     vqshrn_n_s32(vaddq_s32(yyHi, c.rv.val[1]), 8));
+    const int16x8_t g = vcombine_s16(vqshrn_n_s32(vsubq_s32(yyLo, c.guv.val[0]), 8),
+                                     vqshrn_n_s32(vsubq_s32(yyHi, c.guv.val[1]), 8));
+    const int16x8_t b = vcombine_s16(vqshrn_n_s32(vaddq_s32(yyLo, c.bu.val[0]), 8),
+                                     vqshrn_n_s32(vaddq_s32(yyHi, c.bu.val[1]), 8));
+
+    uint8x8x4_t pixels;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    pixels.val[0] = vqmovun_s16(b);
+    pixels.val[1] = vqmovun_s16(g);
+    pixels.val[2] = vqmovun_s16(r);
+    pixels.val[3] = vdup_n_u8(0xff);
+#else
+    pixels.val[0] = vdup_n_u8(0xff);
+    pixels.val[1] = vqmovun_s16(r);
+    pixels.val[2] = vqmovun_s16(g);
+    pixels.val[3] = vqmovun_s16(b);
+#endif
+    vst4_u8(reinterpret_cast<uint8_t*>(rgb), pixels);
+}
+
+static inline void planarYUV420_to_ARGB32_neon(const uchar *y, int yStride,
+                                               const uchar *u, int uStride,
+                                               const uchar *v, int vStride,
+                                               int uvPixelStride,
+                                               uchar *output, int outputStride,
+                                               int width, int height)
+{
+    // For semi-planar formats u and v point into the same interleaved plane
+    const bool swapUV = uvPixelStride == 2 && v < u;
+
+    for (int j = 0; j < height; j += 2) {
+        const uchar *lineY0 = y;
+        // The last row of an odd height has no partner, it is converted twice in place
+        const bool lastRow = j + 1 == height;
+        const uchar *lineY1 = lastRow ? y : y + yStride;
+        const uchar *lineU = u;
+        const uchar *lineV = v;
+        quint32 *rgb0 = reinterpret_cast<quint32*>(output);
+        quint32 *rgb1 = lastRow ? rgb0 : reinterpret_cast<quint32*>(output + outputStride);
+
+        int i = 0;
+        for (; i < width - 15; i += 16) {
+            uint8x8_t u8;
+            uint8x8_t v8;
+            if (uvPixelStride == 1) {
+                u8 = vld1_u8(lineU);
+                v8 = vld1_u8(lineV);
+            } else {
+                const uint8x8x2_t uv = vld2_u8(swapUV ? lineV : lineU);
+                u8 = uv.val[swapUV ? 1 : 0];
+                v8 = uv.val[swapUV ? 0 : 1];
+            }
+            lineU += 8 * uvPixelStride;
+            lineV += 8 * uvPixelStride;
+
+            const int16x8_t u16 = vreinterpretq_s16_u16(vmovl_u8(u8));
+            const int16x8_t v16 = vreinterpretq_s16_u16(vmovl_u8(v8));
+            const uint8x16_t y0 = vld1q_u8(lineY0);
+            const uint8x16_t y1 = vld1q_u8(lineY1);
+            lineY0 += 16;
+            lineY1 += 16;
+
+            QNeonChromaTerms c = qExpandUV_neon(vget_low_s16(u16), vget_low_s16(v16));
+            qYUVToARGB32x8_neon(vget_low_u8(y0), c, rgb0);
+            qYUVToARGB32x8_neon(vget_low_u8(y1), c, rgb1);
+            c = qExpandUV_neon(vget_high_s16(u16), vget_high_s16(v16));
+            qYUVToARGB32x8_neon(vget_high_u8(y0), c, rgb0 + 8);
+            qYUVToARGB32x8_neon(vget_high_u8(y1), c, rgb1 + 8);
+            rgb0 += 16;
+            rgb1 += 16;
+        }
+
+        // leftovers
+        qYUV420PixelsToARGB32(lineY0, lineY1, lineU, lineV, uvPixelStride, rgb0, rgb1, width - i);
+
+        y += yStride << 1; // stride * 2
+        u += uStride;
+        v += vStride;
+        output += outputStride << 1;
+    }
+}
+
+// Packed 4:2:2, lumaFirst selects YUYV (true) or UYVY (false) byte order.
+static inline void packedYUV422_to_ARGB32_neon(const uchar *src, int stride,
+                                               bool lumaFirst,
+                                               uchar *output, int outputStride,
+                                               int width, int height)
+{
+    for (int i = 0; i < height; ++i) {
+        const uchar *lineSrc = src;
+        quint32 *rgb = reinterpret_cast<quint32*>(output);
+
+        int j = 0;
+        for (; j < width - 15; j += 16) {
+            // De-interleaves to YUYV: y0, u, y1, v or UYVY: u, y0, v, y1
+            const uint8x8x4_t data = vld4_u8(lineSrc);
+            lineSrc += 32;
+
+            const uint8x8_t y0 = data.val[lumaFirst ? 0 : 1];
+            const uint8x8_t u = data.val[lumaFirst ? 1 : 0];
+            const uint8x8_t y1 = data.val[lumaFirst ? 2 : 3];
+            const uint8x8_t v = data.val[lumaFirst ? 3 : 2];
+
+            // Restore the pixel order of the luma samples
+            const uint8x8x2_t y = vzip_u8(y0, y1);
+            const int16x8_t u16 = vreinterpretq_s16_u16(vmovl_u8(u));
+            const int16x8_t v16 = vreinterpretq_s16_u16(vmovl_u8(v));
+
+            qYUVToARGB32x8_neon(y.val[0], qExpandUV_neon(vget_low_s16(u16), vget_low_s16(v16)), rgb);
+            qYUVToARGB32x8_neon(y.val[1], qExpandUV_neon(vget_high_s16(u16), vget_high_s16(v16)), rgb + 8);
+            rgb += 16;
+        }
+
+        // leftovers
+        qPackedYUV422PixelsToARGB32(lineSrc, lumaFirst ? 0 : 1, rgb, width - j);
+
+        src += stride;
+        output += outputStride;
+    }
+}
+
+void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_neon(const QVideoFrame &frame, uchar *output,
+                                                   int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_TRIPLANAR(frame, 2)
+    planarYUV420_to_ARGB32_neon(plane1, plane1Stride,
+                                plane2, plane2Stride,
+                                plane3, plane3Stride,
+                                1,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_YV12_to_ARGB32_neon(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_TRIPLANAR(frame, 2)
+    planarYUV420_to_ARGB32_neon(plane1, plane1Stride,
+                                plane3, plane3Stride,
+                                plane2, plane2Stride,
+                                1,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_NV12_to_ARGB32_neon(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    planarYUV420_to_ARGB32_neon(plane1, plane1Stride,
+                                plane2, plane2Stride,
+                                plane2 + 1, plane2Stride,
+                                2,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_NV21_to_ARGB32_neon(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    planarYUV420_to_ARGB32_neon(plane1, plane1Stride,
+                                plane2 + 1, plane2Stride,
+                                plane2, plane2Stride,
+                                2,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_UYVY_to_ARGB32_neon(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_PACKED(frame)
+    MERGE_LOOPS(width, height, stride, 2)
+    packedYUV422_to_ARGB32_neon(src, stride, false, output, outputStride, width, height);
+}
+
+void QT_FASTCALL qt_convert_YUYV_to_ARGB32_neon(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_PACKED(frame)
+    MERGE_LOOPS(width, height, stride, 2)
+    packedYUV422_to_ARGB32_neon(src, stride, true, output, outputStride, width, height);
+}
+
+QT_END_NAMESPACE
+
+#endif
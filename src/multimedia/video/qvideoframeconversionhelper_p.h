@@ -54,7 +54,20 @@
 #include <qvideoframe.h>
 #include <private/qsimd_p.h>
 
-typedef void (QT_FASTCALL *VideoFrameConvertFunc)(const QVideoFrame &frame, uchar *output);
+// Converts rowCount rows of a mapped frame, starting at firstRow, to ARGB32.
+// Output rows are outputStride bytes apart. firstRow must be even for formats
+// with vertically sub-sampled chroma.
+typedef void (QT_FASTCALL *VideoFrameConvertFunc)(const QVideoFrame &frame, uchar *output,
+                                                  int outputStride, int firstRow, int rowCount);
+
+// Stores count ARGB32 pixels in another image format.
+typedef void (QT_FASTCALL *VideoFrameStoreFunc)(uchar *output, const quint32 *argb, int count);
+
+// Adds the channels of an ARGB32 row to the per channel sums of outputWidth boxes.
+// Box x covers the pixels from xOffsets[x] up to, but not including, xOffsets[x + 1].
+// The sums are stored as blue, green, red, alpha for each box.
+typedef void (QT_FASTCALL *VideoFrameAccumulateFunc)(quint64 *sums, const quint32 *argb,
+                                                     const int *xOffsets, int outputWidth);
 
 inline quint32 qConvertBGRA32ToARGB32(quint32 bgra)
 {
@@ -85,32 +98,96 @@ inline quint32 qConvertBGR555ToARGB32(quint16 bgr)
             | ((((bgr) << 19) & 0xf80000) | (((bgr) << 11) & 0x70000));
 }
 
+#define CLAMP(n) (n > 255 ? 255 : (n < 0 ? 0 : n))
+
+#define EXPAND_UV(u, v) \
+    int uu = u - 128; \
+    int vv = v - 128; \
+    int rv = 409 * vv + 128; \
+    int guv = 100 * uu + 208 * vv + 128; \
+    int bu = 516 * uu + 128; \
+
+inline quint32 qYUVToARGB32(int y, int rv, int guv, int bu, int a = 0xff)
+{
+    int yy = (y - 16) * 298;
+    return (a << 24)
+            | CLAMP((yy + rv) >> 8) << 16
+            | CLAMP((yy - guv) >> 8) << 8
+            | CLAMP((yy + bu) >> 8);
+}
+
+// Converts count pixels of a 4:2:0 row pair. When count is odd the last column
+// has no right neighbour, so only its own luma samples are read and written.
+inline void qYUV420PixelsToARGB32(const uchar *lineY0, const uchar *lineY1,
+                                  const uchar *lineU, const uchar *lineV, int uvPixelStride,
+                                  quint32 *rgb0, quint32 *rgb1, int count)
+{
+    int i = 0;
+    for (; i < count - 1; i += 2) {
+        EXPAND_UV(*lineU, *lineV);
+        lineU += uvPixelStride;
+        lineV += uvPixelStride;
+
+        *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
+        *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
+        *rgb1++ = qYUVToARGB32(*lineY1++, rv, guv, bu);
+        *rgb1++ = qYUVToARGB32(*lineY1++, rv, guv, bu);
+    }
+
+    if (i < count) {
+        EXPAND_UV(*lineU, *lineV);
+        *rgb0 = qYUVToARGB32(*lineY0, rv, guv, bu);
+        *rgb1 = qYUVToARGB32(*lineY1, rv, guv, bu);
+    }
+}
+
+// Converts count pixels of packed 4:2:2 data, laid out as Y0 U Y1 V when
+// lumaOffset is 0 and as U Y0 V Y1 when it is 1. An odd last pixel only reads
+// its own luma and the chroma of its macropixel.
+inline void qPackedYUV422PixelsToARGB32(const uchar *src, int lumaOffset, quint32 *rgb, int count)
+{
+    const int chromaOffset = 1 - lumaOffset;
+
+    int i = 0;
+    for (; i < count - 1; i += 2) {
+        EXPAND_UV(src[chromaOffset], src[chromaOffset + 2]);
+        *rgb++ = qYUVToARGB32(src[lumaOffset], rv, guv, bu);
+        *rgb++ = qYUVToARGB32(src[lumaOffset + 2], rv, guv, bu);
+        src += 4;
+    }
+
+    if (i < count) {
+        EXPAND_UV(src[chromaOffset], src[chromaOffset + 2]);
+        *rgb = qYUVToARGB32(src[lumaOffset], rv, guv, bu);
+    }
+}
+
 #define FETCH_INFO_PACKED(frame) \
-    const uchar *src = frame.bits(); \
     int stride = frame.bytesPerLine(); \
+    const uchar *src = frame.bits() + firstRow * stride; \
     int width = frame.width(); \
-    int height = frame.height();
+    int height = rowCount;
 
 #define FETCH_INFO_BIPLANAR(frame) \
-    const uchar *plane1 = frame.bits(0); \
-    const uchar *plane2 = frame.bits(1); \
     int plane1Stride = frame.bytesPerLine(0); \
     int plane2Stride = frame.bytesPerLine(1); \
+    const uchar *plane1 = frame.bits(0) + firstRow * plane1Stride; \
+    const uchar *plane2 = frame.bits(1) + firstRow / 2 * plane2Stride; \
     int width = frame.width(); \
-    int height = frame.height();
+    int height = rowCount;
 
-#define FETCH_INFO_TRIPLANAR(frame) \
-    const uchar *plane1 = frame.bits(0); \
-    const uchar *plane2 = frame.bits(1); \
-    const uchar *plane3 = frame.bits(2); \
+#define FETCH_INFO_TRIPLANAR(frame, verticalSubsampling) \
     int plane1Stride = frame.bytesPerLine(0); \
     int plane2Stride = frame.bytesPerLine(1); \
     int plane3Stride = frame.bytesPerLine(2); \
+    const uchar *plane1 = frame.bits(0) + firstRow * plane1Stride; \
+    const uchar *plane2 = frame.bits(1) + firstRow / verticalSubsampling * plane2Stride; \
+    const uchar *plane3 = frame.bits(2) + firstRow / verticalSubsampling * plane3Stride; \
     int width = frame.width(); \
-    int height = frame.height(); \
+    int height = rowCount;
 
 #define MERGE_LOOPS(width, height, stride, bpp) \
-    if (stride == width * bpp) { \
+    if (stride == width * bpp && outputStride == width * 4) { \
         width *= height; \
         height = 1; \
         stride = 0; \
@@ -43,16 +43,17 @@
 
 QT_BEGIN_NAMESPACE
 
-void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output,
+                                                  int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
-    quint32 *argb = reinterpret_cast<quint32*>(output);
 
     const __m128i zero = _mm_setzero_si128();
 
     for (int y = 0; y < height; ++y) {
         const quint32 *bgra = reinterpret_cast<const quint32*>(src);
+        quint32 *argb = reinterpret_cast<quint32*>(output);
 
         int x = 0;
         ALIGN(16, argb, x, width) {
@@ -81,6 +82,262 @@ void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_sse2(const QVideoFrame &frame, ucha
         }
 
         src += stride;
+        output += outputStride;
+    }
+}
+
+// Computes the rv, guv and bu terms of EXPAND_UV as 32-bit lanes for four
+// (u, v) pairs stored as interleaved 16-bit lanes.
+static inline void qExpandUV_sse2(__m128i uv, __m128i &rv, __m128i &guv, __m128i &bu)
+{
+    const __m128i round = _mm_set1_epi32(128);
+    uv = _mm_sub_epi16(uv, _mm_set1_epi16(128));
+    rv = _mm_add_epi32(_mm_madd_epi16(uv, _mm_set1_epi32(409 << 16)), round);
+    guv = _mm_add_epi32(_mm_madd_epi16(uv, _mm_set1_epi32((208 << 16) | 100)), round);
+    bu = _mm_add_epi32(_mm_madd_epi16(uv, _mm_set1_epi32(516)), round);
+}
+
+// Converts eight luma samples stored as 16-bit lanes to ARGB32, each pair of
+// pixels sharing one lane of the chroma terms. Matches qYUVToARGB32() exactly.
+static inline void qYUVToARGB32x8_sse2(__m128i y, __m128i rv, __m128i guv, __m128i bu, quint32 *rgb)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i yCoeff = _mm_set1_epi32(298);
+
+    y = _mm_sub_epi16(y, _mm_set1_epi16(16));
+    const __m128i yyLo = _mm_madd_epi16(_mm_unpacklo_epi16(y, zero), yCoeff);
+    const __m128i yyHi = _mm_madd_epi16(_mm_unpackhi_epi16(y, zero), yCoeff);
+
+    const __m128i rvLo = _mm_unpacklo_epi32(rv, rv);
+    const __m128i rvHi = _mm_unpackhi_epi32(rv, rv);
+    const __m128i guvLo = _mm_unpacklo_epi32(guv, guv);
+    const __m128i guvHi = _mm_unpackhi_epi32(guv, guv);
+    const __m128i buLo = _mm_unpacklo_epi32(bu, bu);
+    const __m128i buHi = _mm_unpackhi_epi32(bu, bu);
+
+    const __m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yyLo, rvLo), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(yyHi, rvHi), 8));
+    const __m128i g = _mm_packs_epi32(_mm_srai_epi32(_mm_sub_epi32(yyLo, guvLo), 8),
+                                      _mm_srai_epi32(_mm_sub_epi32(yyHi, guvHi), 8));
+    const __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yyLo, buLo), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(yyHi, buHi), 8));
+
+    // Clamp to [0, 255] and interleave to B, G, R, A bytes
+    __m128i bg = _mm_packus_epi16(b, g);
+    __m128i ra = _mm_packus_epi16(r, _mm_set1_epi16(0xff));
+    bg = _mm_unpacklo_epi8(bg, _mm_srli_si128(bg, 8));
+    ra = _mm_unpacklo_epi8(ra, _mm_srli_si128(ra, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + 4), _mm_unpackhi_epi16(bg, ra));
+}
+
+static inline void planarYUV420_to_ARGB32_sse2(const uchar *y, int yStride,
+                                               const uchar *u, int uStride,
+                                               const uchar *v, int vStride,
+                                               int uvPixelStride,
+                                               uchar *output, int outputStride,
+                                               int width, int height)
+{
+    const __m128i zero = _mm_setzero_si128();
+    // For semi-planar formats u and v point into the same interleaved plane
+    const bool swapUV = uvPixelStride == 2 && v < u;
+
+    for (int j = 0; j < height; j += 2) {
+        const uchar *lineY0 = y;
+        // The last row of an odd height has no partner, it is converted twice in place
+        const bool lastRow = j + 1 == height;
+        const uchar *lineY1 = lastRow ? y : y + yStride;
+        const uchar *lineU = u;
+        const uchar *lineV = v;
+        quint32 *rgb0 = reinterpret_cast<quint32*>(output);
+        quint32 *rgb1 = lastRow ? rgb0 : reinterpret_cast<quint32*>(output + outputStride);
+
+        int i = 0;
+        for (; i < width - 15; i += 16) {
+            __m128i uv0;
+            __m128i uv1;
+            if (uvPixelStride == 1) {
+                const __m128i uu = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(lineU)), zero);
+                const __m128i vv = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(lineV)), zero);
+                uv0 = _mm_unpacklo_epi16(uu, vv);
+                uv1 = _mm_unpackhi_epi16(uu, vv);
+            } else {
+                const __m128i uv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(swapUV ? lineV : lineU));
+                uv0 = _mm_unpacklo_epi8(uv, zero);
+                uv1 = _mm_unpackhi_epi8(uv, zero);
+                if (swapUV) {
+                    uv0 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv0, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+                    uv1 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv1, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+                }
+            }
+            lineU += 8 * uvPixelStride;
+            lineV += 8 * uvPixelStride;
+
+            const __m128i y0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lineY0));
+            const __m128i y1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lineY1));
+            lineY0 += 16;
+            lineY1 += 16;
+
+            __m128i rv, guv, bu;
+            qExpandUV_sse2(uv0, rv, guv, bu);
+            qYUVToARGB32x8_sse2(_mm_unpacklo_epi8(y0, zero), rv, guv, bu, rgb0);
+            qYUVToARGB32x8_sse2(_mm_unpacklo_epi8(y1, zero), rv, guv, bu, rgb1);
+            qExpandUV_sse2(uv1, rv, guv, bu);
+            qYUVToARGB32x8_sse2(_mm_unpackhi_epi8(y0, zero), rv, guv, bu, rgb0 + 8);
+            qYUVToARGB32x8_sse2(_mm_unpackhi_epi8(y1, zero), rv, guv, bu, rgb1 + 8);
+            rgb0 += 16;
+            rgb1 += 16;
+        }
+
+        // leftovers
+        qYUV420PixelsToARGB32(lineY0, lineY1, lineU, lineV, uvPixelStride, rgb0, rgb1, width - i);
+
+        y += yStride << 1; // stride * 2
+        u += uStride;
+        v += vStride;
+        output += outputStride << 1;
+    }
+}
+
+// Packed 4:2:2, lumaShift selects whether luma is in the low (YUYV) or the
+// high (UYVY) byte of each 16-bit word.
+static inline void packedYUV422_to_ARGB32_sse2(const uchar *src, int stride,
+                                               int lumaShift,
+                                               uchar *output, int outputStride,
+                                               int width, int height)
+{
+    const __m128i lowBytes = _mm_set1_epi16(0xff);
+
+    for (int i = 0; i < height; ++i) {
+        const uchar *lineSrc = src;
+        quint32 *rgb = reinterpret_cast<quint32*>(output);
+
+        int j = 0;
+        for (; j < width - 7; j += 8) {
+            const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lineSrc));
+            lineSrc += 16;
+
+            __m128i y;
+            __m128i uv;
+            if (lumaShift) {
+                y = _mm_srli_epi16(data, 8);
+                uv = _mm_and_si128(data, lowBytes);
+            } else {
+                y = _mm_and_si128(data, lowBytes);
+                uv = _mm_srli_epi16(data, 8);
+            }
+
+            __m128i rv, guv, bu;
+            qExpandUV_sse2(uv, rv, guv, bu);
+            qYUVToARGB32x8_sse2(y, rv, guv, bu, rgb);
+            rgb += 8;
+        }
+
+        // leftovers
+        qPackedYUV422PixelsToARGB32(lineSrc, lumaShift ? 1 : 0, rgb, width - j);
+
+        src += stride;
+        output += outputStride;
+    }
+}
+
+void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output,
+                                                   int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_TRIPLANAR(frame, 2)
+    planarYUV420_to_ARGB32_sse2(plane1, plane1Stride,
+                                plane2, plane2Stride,
+                                plane3, plane3Stride,
+                                1,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_YV12_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_TRIPLANAR(frame, 2)
+    planarYUV420_to_ARGB32_sse2(plane1, plane1Stride,
+                                plane3, plane3Stride,
+                                plane2, plane2Stride,
+                                1,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_NV12_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    planarYUV420_to_ARGB32_sse2(plane1, plane1Stride,
+                                plane2, plane2Stride,
+                                plane2 + 1, plane2Stride,
+                                2,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_NV21_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    planarYUV420_to_ARGB32_sse2(plane1, plane1Stride,
+                                plane2 + 1, plane2Stride,
+                                plane2, plane2Stride,
+                                2,
+                                output, outputStride,
+                                width, height);
+}
+
+void QT_FASTCALL qt_convert_UYVY_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_PACKED(frame)
+    MERGE_LOOPS(width, height, stride, 2)
+    packedYUV422_to_ARGB32_sse2(src, stride, 8, output, outputStride, width, height);
+}
+
+void QT_FASTCALL qt_convert_YUYV_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output,
+                                                int outputStride, int firstRow, int rowCount)
+{
+    FETCH_INFO_PACKED(frame)
+    MERGE_LOOPS(width, height, stride, 2)
+    packedYUV422_to_ARGB32_sse2(src, stride, 0, output, outputStride, width, height);
+}
+
+void QT_FASTCALL qt_accumulate_ARGB32_box_sse2(quint64 *sums, const quint32 *argb,
+                                              const int *xOffsets, int outputWidth)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    for (int x = 0; x < outputWidth; ++x) {
+        const quint32 *pixel = argb + xOffsets[x];
+        const quint32 *end = argb + xOffsets[x + 1];
+        __m128i sum = zero;
+
+        while (end - pixel > 1) {
+            // Two pixels at a time in 16-bit lanes, widened before they can overflow
+            const quint32 *chunkEnd = pixel + qMin<qptrdiff>((end - pixel) & ~1, 256);
+            __m128i pairSum = zero;
+            for (; pixel < chunkEnd; pixel += 2) {
+                const __m128i pair = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixel));
+                pairSum = _mm_add_epi16(pairSum, _mm_unpacklo_epi8(pair, zero));
+            }
+            sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(pairSum, zero));
+            sum = _mm_add_epi32(sum, _mm_unpackhi_epi16(pairSum, zero));
+        }
+
+        // leftover
+        if (pixel < end) {
+            const __m128i single = _mm_cvtsi32_si128(int(*pixel));
+            sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(_mm_unpacklo_epi8(single, zero), zero));
+        }
+
+        // A single row fits in 32 bits, the sums over many rows need 64
+        __m128i *boxSums = reinterpret_cast<__m128i*>(sums);
+        _mm_storeu_si128(boxSums, _mm_add_epi64(_mm_loadu_si128(boxSums), _mm_unpacklo_epi32(sum, zero)));
+        _mm_storeu_si128(boxSums + 1, _mm_add_epi64(_mm_loadu_si128(boxSums + 1), _mm_unpackhi_epi32(sum, zero)));
+        sums += 4;
     }
 }
 
@@ -43,16 +43,17 @@
 
 QT_BEGIN_NAMESPACE
 
-void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_ssse3(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_ssse3(const QVideoFrame &frame, uchar *output,
+                                                   int outputStride, int firstRow, int rowCount)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
-    quint32 *argb = reinterpret_cast<quint32*>(output);
 
     __m128i shuffleMask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
 
     for (int y = 0; y < height; ++y) {
         const quint32 *bgra = reinterpret_cast<const quint32*>(src);
+        quint32 *argb = reinterpret_cast<quint32*>(output);
 
         int x = 0;
         ALIGN(16, argb, x, width) {
@@ -80,6 +81,7 @@ void QT_FASTCALL qt_convert_BGRA32_to_ARGB32_ssse3(const QVideoFrame &frame, uch
         }
 
         src += stride;
+        output += outputStride;
     }
 }
 
@@ -35,3 +35,4 @@ SOURCES += \
 SSE2_SOURCES += video/qvideoframeconversionhelper_sse2.cpp
 SSSE3_SOURCES += video/qvideoframeconversionhelper_ssse3.cpp
 AVX2_SOURCES += video/qvideoframeconversionhelper_avx2.cpp
+NEON_SOURCES += video/qvideoframeconversionhelper_neon.cpp
@@ -357,6 +357,12 @@ bool QAlsaAudioInput::open()
         }
     }
     if ( !fatal ) {
+        // Prefer mapping the device buffer, samples are then converted in place
+        if (qEnvironmentVariableIsSet("QT_ALSA_DISABLE_MMAP")
+                || snd_pcm_hw_params_test_access(handle, hwparams, SND_PCM_ACCESS_MMAP_INTERLEAVED) < 0)
+            access = SND_PCM_ACCESS_RW_INTERLEAVED;
+        else
+            access = SND_PCM_ACCESS_MMAP_INTERLEAVED;
         err = snd_pcm_hw_params_set_access( handle, hwparams, access );
         if ( err < 0 ) {
             fatal = true;
@@ -493,6 +499,60 @@ int QAlsaAudioInput::bytesReady() const
     return qMax(bytesAvailable, 0);
 }
 
+snd_pcm_sframes_t QAlsaAudioInput::mmapRead(snd_pcm_uframes_t frames)
+{
+    // Unlike snd_pcm_readi(), mapped access never starts a prepared stream,
+    // which is where xrun recovery leaves it
+    if (snd_pcm_state(handle) == SND_PCM_STATE_PREPARED) {
+        int err = snd_pcm_start(handle);
+        if (err < 0)
+            return err;
+    }
+
+    const snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+    if (avail < 0)
+        return avail;
+    frames = qMin(frames, snd_pcm_uframes_t(avail));
+
+    const int frameBytes = settings.bytesPerFrame();
+    snd_pcm_uframes_t framesRead = 0;
+    while (framesRead < frames) {
+        const snd_pcm_channel_area_t *areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t count = frames - framesRead;
+        const int err = snd_pcm_mmap_begin(handle, &areas, &offset, &count);
+        if (err < 0)
+            return framesRead > 0 ? snd_pcm_sframes_t(framesRead) : err;
+        if (count == 0)
+            break;
+
+        // Interleaved access, all channels share the first area
+        const char *src = static_cast<const char *>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8;
+        const int bytes = int(snd_pcm_frames_to_bytes(handle, count));
+        int done = 0;
+        while (done < bytes) {
+            int block = qMin(ringBuffer.freeBlockSize(), bytes - done);
+            block -= block % frameBytes;
+            if (block <= 0)
+                break;
+            if (m_volume < 1.0f)
+                QAudioHelperInternal::qMultiplySamples(m_volume, settings, src + done, ringBuffer.freeData(), block);
+            else
+                memcpy(ringBuffer.freeData(), src + done, block);
+            ringBuffer.commitBytes(block);
+            done += block;
+        }
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, snd_pcm_bytes_to_frames(handle, done));
+        if (committed < 0)
+            return framesRead > 0 ? snd_pcm_sframes_t(framesRead) : committed;
+        framesRead += committed;
+        if (done < bytes || snd_pcm_uframes_t(committed) != count)
+            break;
+    }
+    return snd_pcm_sframes_t(framesRead);
+}
+
 qint64 QAlsaAudioInput::read(char* data, qint64 len)
 {
     // Read in some audio data and write it to QIODevice, pull mode
@@ -527,22 +587,31 @@ qint64 QAlsaAudioInput::read(char* data, qint64 len)
 
         int count=0;
         int err = 0;
-        QVarLengthArray<char, 4096> buffer(bytesToRead);
+        const bool mmapped = access == SND_PCM_ACCESS_MMAP_INTERLEAVED;
+        QVarLengthArray<char, 4096> buffer(mmapped ? 0 : bytesToRead);
         while(count < 5 && bytesToRead > 0) {
             int chunks = bytesToRead / period_size;
             int frames = chunks * period_frames;
             if (frames > (int)buffer_frames)
                 frames = buffer_frames;
 
-            int readFrames = snd_pcm_readi(handle, buffer.data(), frames);
-            bytesRead = snd_pcm_frames_to_bytes(handle, readFrames);
-            if (m_volume < 1.0f)
-                QAudioHelperInternal::qMultiplySamples(m_volume, settings,
-                                                       buffer.constData(),
-                                                       buffer.data(), bytesRead);
+            int readFrames;
+            if (mmapped) {
+                // Goes straight from the DMA area into ringBuffer
+                readFrames = mmapRead(frames);
+                bytesRead = snd_pcm_frames_to_bytes(handle, readFrames);
+            } else {
+                readFrames = snd_pcm_readi(handle, buffer.data(), frames);
+                bytesRead = snd_pcm_frames_to_bytes(handle, readFrames);
+                if (m_volume < 1.0f)
+                    QAudioHelperInternal::qMultiplySamples(m_volume, settings,
+                                                           buffer.constData(),
+                                                           buffer.data(), bytesRead);
+            }
 
             if (readFrames >= 0) {
-                ringBuffer.write(buffer.data(), bytesRead);
+                if (!mmapped)
+                    ringBuffer.write(buffer.data(), bytesRead);
 #ifdef DEBUG_AUDIO
                 qDebug() << QString::fromLatin1("read in bytes = %1 (frames=%2)").arg(bytesRead).arg(readFrames).toLatin1().constData();
 #endif
@@ -867,6 +936,25 @@ void RingBuffer::write(char *data, int len)
     }
 }
 
+char *RingBuffer::freeData()
+{
+    return m_data.data() + m_tail;
+}
+
+int RingBuffer::freeBlockSize() const
+{
+    // One byte always stays free so that a full buffer differs from an empty one
+    if (m_head > m_tail)
+        return m_head - m_tail - 1;
+    else
+        return m_data.size() - m_tail - (m_head == 0 ? 1 : 0);
+}
+
+void RingBuffer::commitBytes(int bytes)
+{
+    m_tail = (m_tail + bytes) % m_data.size();
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qalsaaudioinput.cpp"
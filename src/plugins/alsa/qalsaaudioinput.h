@@ -87,6 +87,10 @@ public:
 
     void write(char *data, int len);
 
+    char *freeData();
+    int freeBlockSize() const;
+    void commitBytes(int bytes);
+
 private:
     int m_head;
     int m_tail;
@@ -137,6 +141,7 @@ private slots:
 
 private:
     int checkBytesReady();
+    snd_pcm_sframes_t mmapRead(snd_pcm_uframes_t frames);
     int xrun_recovery(int err);
     int setFormat();
     bool open();
@@ -50,11 +50,13 @@
 
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qvarlengtharray.h>
-#include <QtMultimedia/private/qaudiohelpers_p.h>
 #include "qalsaaudiooutput.h"
 #include "qalsaaudiodeviceinfo.h"
 #include <QLoggingCategory>
 
+#include <pthread.h>
+#include <sched.h>
+
 QT_BEGIN_NAMESPACE
 
 Q_LOGGING_CATEGORY(lcAlsaOutput, "qt.multimedia.alsa.output")
@@ -84,6 +86,10 @@ QAlsaAudioOutput::QAlsaAudioOutput(const QByteArray &device)
 
     m_volume = 1.0f;
 
+    m_threaded = false;
+    m_deviceThread = nullptr;
+    m_ringBuffer = nullptr;
+
     m_device = device;
 
     timer = new QTimer(this);
@@ -100,7 +106,18 @@ QAlsaAudioOutput::~QAlsaAudioOutput()
 
 void QAlsaAudioOutput::setVolume(qreal vol)
 {
+    QMutexLocker locker(&m_volumeMutex);
     m_volume = vol;
+
+    // The device thread owns the ramp while it runs and picks up m_volume itself
+    if (m_deviceThread)
+        return;
+
+    // Fade to the new volume while playing, a sudden jump is audible as a click
+    if (deviceState == QAudio::ActiveState)
+        m_volumeRamp.rampTo(m_volume);
+    else
+        m_volumeRamp.setVolume(m_volume);
 }
 
 qreal QAlsaAudioOutput::volume() const
@@ -118,6 +135,11 @@ QAudio::State QAlsaAudioOutput::state() const
     return deviceState;
 }
 
+int QAlsaAudioOutput::xrunCount() const
+{
+    return m_xrunCount.loadRelaxed();
+}
+
 int QAlsaAudioOutput::xrun_recovery(int err)
 {
     int  count = 0;
@@ -130,6 +152,7 @@ int QAlsaAudioOutput::xrun_recovery(int err)
 #endif
 
     if(err == -EPIPE) {
+        m_xrunCount.ref();
         errorState = QAudio::UnderrunError;
         emit errorChanged(errorState);
         err = snd_pcm_prepare(handle);
@@ -239,6 +262,7 @@ void QAlsaAudioOutput::start(QIODevice* device)
 
     pullMode = true;
     audioSource = device;
+    m_xrunCount.storeRelaxed(0);
 
     deviceState = QAudio::ActiveState;
 
@@ -262,14 +286,17 @@ QIODevice* QAlsaAudioOutput::start()
 
     close();
 
-    audioSource = new AlsaOutputPrivate(this);
-    audioSource->open(QIODevice::WriteOnly|QIODevice::Unbuffered);
     pullMode = false;
+    m_xrunCount.storeRelaxed(0);
 
     deviceState = QAudio::IdleState;
 
+    // The push device writes into the ring buffer open() creates
     open();
 
+    audioSource = new AlsaOutputPrivate(this);
+    audioSource->open(QIODevice::WriteOnly|QIODevice::Unbuffered);
+
     emit stateChanged(deviceState);
 
     return audioSource;
@@ -297,6 +324,11 @@ bool QAlsaAudioOutput::open()
     timeStamp.restart();
     elapsedTimeOffset = 0;
 
+    // Service the PCM from a dedicated thread blocking in snd_pcm_wait() instead of
+    // feeding it from a timer on this thread, so that stalls of the event loop are
+    // absorbed by a ring buffer in front of the device.
+    m_threaded = qEnvironmentVariableIntValue("QT_ALSA_OUTPUT_REALTIME_THREAD") > 0;
+
     int dir;
     int err = 0;
     int count=0;
@@ -360,6 +392,12 @@ bool QAlsaAudioOutput::open()
         }
     }
     if ( !fatal ) {
+        // Prefer mapping the device buffer, samples are then converted in place
+        if (qEnvironmentVariableIsSet("QT_ALSA_DISABLE_MMAP")
+                || snd_pcm_hw_params_test_access(handle, hwparams, SND_PCM_ACCESS_MMAP_INTERLEAVED) < 0)
+            access = SND_PCM_ACCESS_RW_INTERLEAVED;
+        else
+            access = SND_PCM_ACCESS_MMAP_INTERLEAVED;
         err = snd_pcm_hw_params_set_access( handle, hwparams, access );
         if ( err < 0 ) {
             fatal = true;
@@ -478,10 +516,15 @@ bool QAlsaAudioOutput::open()
     if(audioBuffer == 0)
         audioBuffer = new char[snd_pcm_frames_to_bytes(handle,buffer_frames)];
     snd_pcm_prepare( handle );
-    snd_pcm_start(handle);
+    // Push mode writes go through the ring buffer, so producers never wait for the PCM
+    if (m_threaded || !pullMode)
+        m_ringBuffer = new QAudioRingBuffer(buffer_size);
+    // In thread mode the start threshold starts the PCM once the first period is written
+    if (!m_threaded)
+        snd_pcm_start(handle);
 
     // Step 5: Setup timer
-    bytesAvailable = bytesFree();
+    bytesAvailable = deviceBytesFree();
 
     // Step 6: Start audio processing
     timer->start(period_time/1000);
@@ -491,14 +534,19 @@ bool QAlsaAudioOutput::open()
     elapsedTimeOffset = 0;
     errorState  = QAudio::NoError;
     totalTimeValue = 0;
+    m_threadFrames.storeRelaxed(0);
     opened = true;
 
+    if (m_threaded)
+        startDeviceThread();
+
     return true;
 }
 
 void QAlsaAudioOutput::close()
 {
     timer->stop();
+    stopDeviceThread();
 
     if ( handle ) {
         snd_pcm_drain( handle );
@@ -507,6 +555,8 @@ void QAlsaAudioOutput::close()
         delete [] audioBuffer;
         audioBuffer=0;
     }
+    delete m_ringBuffer;
+    m_ringBuffer = nullptr;
     if(!pullMode && audioSource) {
         delete audioSource;
         audioSource = 0;
@@ -515,6 +565,14 @@ void QAlsaAudioOutput::close()
 }
 
 int QAlsaAudioOutput::bytesFree() const
+{
+    if (m_ringBuffer)
+        return m_ringBuffer->free();
+
+    return deviceBytesFree();
+}
+
+int QAlsaAudioOutput::deviceBytesFree() const
 {
     if(resuming)
         return period_size;
@@ -540,6 +598,42 @@ int QAlsaAudioOutput::bytesFree() const
     return snd_pcm_frames_to_bytes(handle, frames);
 }
 
+template <typename Fill>
+snd_pcm_sframes_t QAlsaAudioOutput::mmapWrite(snd_pcm_uframes_t frames, Fill fill)
+{
+    // The caller has updated the available space, as snd_pcm_mmap_begin() requires
+    snd_pcm_uframes_t written = 0;
+    while (written < frames) {
+        const snd_pcm_channel_area_t *areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t count = frames - written;
+        const int err = snd_pcm_mmap_begin(handle, &areas, &offset, &count);
+        if (err < 0)
+            return written > 0 ? snd_pcm_sframes_t(written) : err;
+        if (count == 0)
+            break;
+
+        // Interleaved access, all channels share the first area
+        char *dest = static_cast<char *>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8;
+        fill(dest, int(snd_pcm_frames_to_bytes(handle, count)));
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, count);
+        if (committed < 0)
+            return written > 0 ? snd_pcm_sframes_t(written) : committed;
+        written += committed;
+        if (snd_pcm_uframes_t(committed) != count)
+            break;
+    }
+
+    // Unlike snd_pcm_writei(), committing never starts a prepared stream
+    if (written > 0 && snd_pcm_state(handle) == SND_PCM_STATE_PREPARED) {
+        const snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+        if (avail >= 0 && buffer_frames - snd_pcm_uframes_t(avail) >= period_frames)
+            snd_pcm_start(handle);
+    }
+    return snd_pcm_sframes_t(written);
+}
+
 qint64 QAlsaAudioOutput::write( const char *data, qint64 len )
 {
     // Write out some audio data
@@ -550,7 +644,7 @@ qint64 QAlsaAudioOutput::write( const char *data, qint64 len )
         snd_pcm_bytes_to_frames( handle, (int)len )<<" ("<<len<<") bytes";
 #endif
     int frames, err;
-    int space = bytesFree();
+    int space = deviceBytesFree();
 
     if (!space)
         return 0;
@@ -560,9 +654,17 @@ qint64 QAlsaAudioOutput::write( const char *data, qint64 len )
 
     frames = snd_pcm_bytes_to_frames(handle, space);
 
-    if (m_volume < 1.0f) {
+    if (access == SND_PCM_ACCESS_MMAP_INTERLEAVED) {
+        err = mmapWrite(frames, [this, &data](char *dest, int bytes) {
+            if (!m_volumeRamp.isUnity())
+                m_volumeRamp.process(settings, data, dest, bytes);
+            else
+                memcpy(dest, data, bytes);
+            data += bytes;
+        });
+    } else if (!m_volumeRamp.isUnity()) {
         QVarLengthArray<char, 4096> out(space);
-        QAudioHelperInternal::qMultiplySamples(m_volume, settings, data, out.data(), space);
+        m_volumeRamp.process(settings, data, out.data(), space);
         err = snd_pcm_writei(handle, out.constData(), frames);
     } else {
         err = snd_pcm_writei(handle, data, frames);
@@ -618,6 +720,9 @@ int QAlsaAudioOutput::notifyInterval() const
 
 qint64 QAlsaAudioOutput::processedUSecs() const
 {
+    if (m_threaded)
+        return qint64(1000000) * m_threadFrames.loadRelaxed() / settings.sampleRate();
+
     return qint64(1000000) * totalTimeValue / settings.sampleRate();
 }
 
@@ -631,9 +736,11 @@ void QAlsaAudioOutput::resume()
             if(err < 0)
                 xrun_recovery(err);
 
-            err = snd_pcm_start(handle);
-            if(err < 0)
-                xrun_recovery(err);
+            if (!m_threaded) {
+                err = snd_pcm_start(handle);
+                if(err < 0)
+                    xrun_recovery(err);
+            }
 
             bytesAvailable = (int)snd_pcm_frames_to_bytes(handle, buffer_frames);
         }
@@ -643,6 +750,8 @@ void QAlsaAudioOutput::resume()
 
         errorState = QAudio::NoError;
         timer->start(period_time/1000);
+        if (m_threaded)
+            startDeviceThread();
         emit stateChanged(deviceState);
     }
 }
@@ -661,6 +770,7 @@ QAudioFormat QAlsaAudioOutput::format() const
 void QAlsaAudioOutput::suspend()
 {
     if(deviceState == QAudio::ActiveState || deviceState == QAudio::IdleState || resuming) {
+        stopDeviceThread();
         snd_pcm_drain(handle);
         timer->stop();
         deviceState = QAudio::SuspendedState;
@@ -677,19 +787,47 @@ void QAlsaAudioOutput::userFeed()
     QTime now(QTime::currentTime());
     qDebug()<<now.second()<<"s "<<now.msec()<<"ms :userFeed() OUT";
 #endif
-    if(deviceState ==  QAudio::IdleState)
-        bytesAvailable = bytesFree();
+    // The device thread owns the PCM in thread mode
+    if(deviceState ==  QAudio::IdleState && !m_threaded)
+        bytesAvailable = deviceBytesFree();
 
     deviceReady();
 }
 
 bool QAlsaAudioOutput::deviceReady()
 {
-    if(pullMode) {
+    if (m_threaded) {
+        if (pullMode) {
+            const qint64 l = refillRingBuffer();
+
+            // reading can take a while and stream may have been stopped
+            if (!handle)
+                return false;
+
+            if (l < 0) {
+                close();
+                deviceState = QAudio::StoppedState;
+                errorState = QAudio::IOError;
+                emit errorChanged(errorState);
+                emit stateChanged(deviceState);
+            } else if (l > 0 && deviceState == QAudio::IdleState) {
+                deviceState = QAudio::ActiveState;
+                emit stateChanged(deviceState);
+            }
+        }
+        if (deviceState == QAudio::ActiveState && m_ringBuffer && m_ringBuffer->used() == 0
+                && m_deviceAvail.loadRelaxed() > int(buffer_frames - period_frames)) {
+            // Underrun
+            errorState = QAudio::UnderrunError;
+            emit errorChanged(errorState);
+            deviceState = QAudio::IdleState;
+            emit stateChanged(deviceState);
+        }
+    } else if(pullMode) {
         int l = 0;
         int chunks = bytesAvailable/period_size;
         if(chunks==0) {
-            bytesAvailable = bytesFree();
+            bytesAvailable = deviceBytesFree();
             return false;
         }
 #ifdef DEBUG_AUDIO
@@ -712,11 +850,11 @@ bool QAlsaAudioOutput::deviceReady()
             qint64 bytesWritten = write(audioBuffer,l);
             if (bytesWritten != l)
                 audioSource->seek(audioSource->pos()-(l-bytesWritten));
-            bytesAvailable = bytesFree();
+            bytesAvailable = deviceBytesFree();
 
         } else if(l == 0) {
             // Did not get any data to output
-            bytesAvailable = bytesFree();
+            bytesAvailable = deviceBytesFree();
             if(bytesAvailable > snd_pcm_frames_to_bytes(handle, buffer_frames-period_frames)) {
                 // Underrun
                 if (deviceState != QAudio::IdleState) {
@@ -735,8 +873,13 @@ bool QAlsaAudioOutput::deviceReady()
             emit stateChanged(deviceState);
         }
     } else {
-        bytesAvailable = bytesFree();
-        if(bytesAvailable > snd_pcm_frames_to_bytes(handle, buffer_frames-period_frames)) {
+        drainRingBuffer();
+        if (!handle)
+            return false;
+
+        bytesAvailable = deviceBytesFree();
+        if(m_ringBuffer->used() == 0
+                && bytesAvailable > snd_pcm_frames_to_bytes(handle, buffer_frames-period_frames)) {
             // Underrun
             if (deviceState != QAudio::IdleState) {
                 errorState = QAudio::UnderrunError;
@@ -768,44 +911,257 @@ qint64 QAlsaAudioOutput::elapsedUSecs() const
 
 void QAlsaAudioOutput::reset()
 {
+    stopDeviceThread();
     if(handle)
         snd_pcm_reset(handle);
 
     stop();
 }
 
-AlsaOutputPrivate::AlsaOutputPrivate(QAlsaAudioOutput* audio)
+void QAlsaAudioOutput::startDeviceThread()
 {
-    audioDevice = qobject_cast<QAlsaAudioOutput*>(audio);
+    if (m_deviceThread)
+        return;
+
+    m_threadQuit.storeRelaxed(0);
+    m_threadWaiting.storeRelaxed(0);
+    m_refillPending.storeRelaxed(0);
+    m_deviceAvail.storeRelaxed(int(buffer_frames));
+    m_dataReady.tryAcquire(m_dataReady.available());
+
+    m_deviceThread = QThread::create([this] { runDeviceThread(); });
+    m_deviceThread->setObjectName(QStringLiteral("QAlsaAudioOutput"));
+    m_deviceThread->start(QThread::TimeCriticalPriority);
 }
 
-AlsaOutputPrivate::~AlsaOutputPrivate() {}
+void QAlsaAudioOutput::stopDeviceThread()
+{
+    if (!m_deviceThread)
+        return;
+
+    m_threadQuit.storeRelease(1);
+    m_dataReady.release();
+    m_deviceThread->wait();
+    delete m_deviceThread;
+    m_deviceThread = nullptr;
+
+    // Hand the ramp back to setVolume()
+    m_volumeRamp.setVolume(m_volume);
 
-qint64 AlsaOutputPrivate::readData( char* data, qint64 len)
+    qCDebug(lcAlsaOutput) << "device thread stopped, xruns:" << m_xrunCount.loadRelaxed();
+}
+
+void QAlsaAudioOutput::runDeviceThread()
 {
-    Q_UNUSED(data);
-    Q_UNUSED(len);
+    // Real-time scheduling needs RLIMIT_RTPRIO or CAP_SYS_NICE, without it the
+    // thread just keeps the priority QThread gave it
+    sched_param param;
+    param.sched_priority = qMin(sched_get_priority_min(SCHED_FIFO) + 10, sched_get_priority_max(SCHED_FIFO));
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+        qCDebug(lcAlsaOutput) << "SCHED_FIFO not permitted for the device thread";
+
+    const int frameBytes = settings.bytesPerFrame();
+    const int timeout = qMax(1, int(period_time / 500)); // two periods, in ms
+
+    while (!m_threadQuit.loadAcquire()) {
+        const int ready = m_ringBuffer->used() / frameBytes;
+
+        if (ready == 0) {
+            const snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+            if (avail < 0) {
+                if (!recoverDeviceThread(int(avail)))
+                    break;
+                continue;
+            }
+            m_deviceAvail.storeRelaxed(int(avail));
+
+            requestRefill();
+            m_threadWaiting.storeRelease(1);
+            if (m_ringBuffer->used() < frameBytes && !m_threadQuit.loadAcquire())
+                m_dataReady.tryAcquire(1, timeout);
+            m_threadWaiting.storeRelease(0);
+            continue;
+        }
 
-    return 0;
+        int err = snd_pcm_wait(handle, timeout);
+        if (err == 0)
+            continue;
+        if (err < 0) {
+            if (!recoverDeviceThread(err))
+                break;
+            continue;
+        }
+
+        const snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+        if (avail < 0) {
+            if (!recoverDeviceThread(int(avail)))
+                break;
+            continue;
+        }
+
+        const int frames = qMin(int(qMin<snd_pcm_sframes_t>(avail, buffer_frames)), ready);
+        if (frames <= 0)
+            continue;
+        // Never block on the volume, a change is simply picked up on the next period
+        if (m_volumeMutex.tryLock()) {
+            if (m_volume != m_volumeRamp.volume())
+                m_volumeRamp.rampTo(m_volume);
+            m_volumeMutex.unlock();
+        }
+
+        snd_pcm_sframes_t written;
+        if (access == SND_PCM_ACCESS_MMAP_INTERLEAVED) {
+            written = mmapWrite(frames, [this](char *dest, int bytes) {
+                m_ringBuffer->read(dest, bytes);
+                if (!m_volumeRamp.isUnity())
+                    m_volumeRamp.process(settings, dest, dest, bytes);
+            });
+        } else {
+            const int bytes = frames * frameBytes;
+            m_ringBuffer->read(audioBuffer, bytes);
+            if (!m_volumeRamp.isUnity())
+                m_volumeRamp.process(settings, audioBuffer, audioBuffer, bytes);
+            written = snd_pcm_writei(handle, audioBuffer, frames);
+        }
+        if (written < 0) {
+            if (!recoverDeviceThread(int(written)))
+                break;
+            continue;
+        }
+        m_threadFrames.fetchAndAddRelaxed(written);
+        m_deviceAvail.storeRelaxed(int(avail - written));
+
+        if (m_ringBuffer->used() < m_ringBuffer->size() / 2)
+            requestRefill();
+    }
+}
+
+bool QAlsaAudioOutput::recoverDeviceThread(int err)
+{
+    if (err == -EPIPE) {
+        m_xrunCount.ref();
+        qCDebug(lcAlsaOutput) << "xrun on the device thread, count:" << m_xrunCount.loadRelaxed();
+        QMetaObject::invokeMethod(this, [this] {
+            if (deviceState == QAudio::ActiveState) {
+                errorState = QAudio::UnderrunError;
+                emit errorChanged(errorState);
+            }
+        }, Qt::QueuedConnection);
+    }
+
+    err = snd_pcm_recover(handle, err, 1);
+    if (err < 0) {
+        qCWarning(lcAlsaOutput) << "device thread failed to recover, err =" << err;
+        QMetaObject::invokeMethod(this, [this] {
+            if (!opened)
+                return;
+            close();
+            errorState = QAudio::FatalError;
+            emit errorChanged(errorState);
+            deviceState = QAudio::StoppedState;
+            emit stateChanged(deviceState);
+        }, Qt::QueuedConnection);
+        return false;
+    }
+    return true;
+}
+
+void QAlsaAudioOutput::wakeDeviceThread()
+{
+    if (m_threadWaiting.testAndSetAcquire(1, 0))
+        m_dataReady.release();
 }
 
-qint64 AlsaOutputPrivate::writeData(const char* data, qint64 len)
+void QAlsaAudioOutput::requestRefill()
 {
-    int retry = 0;
-    qint64 written = 0;
-    if((audioDevice->deviceState == QAudio::ActiveState)
-            ||(audioDevice->deviceState == QAudio::IdleState)) {
-        while(written < len) {
-            int chunk = audioDevice->write(data+written,(len-written));
-            if(chunk <= 0)
-                retry++;
-            written+=chunk;
-            if(retry > 10)
-                return written;
+    // Only the pull mode source can be asked for more data
+    if (pullMode && m_refillPending.testAndSetRelaxed(0, 1))
+        QMetaObject::invokeMethod(this, &QAlsaAudioOutput::userFeed, Qt::QueuedConnection);
+}
+
+qint64 QAlsaAudioOutput::refillRingBuffer()
+{
+    m_refillPending.storeRelaxed(0);
+
+    qint64 total = 0;
+    forever {
+        const QAudioRingBuffer::Region region = m_ringBuffer->acquireWriteRegion(m_ringBuffer->free());
+        if (region.second <= 0)
+            break;
+
+        const qint64 l = audioSource->read(region.first, region.second);
+        if (l < 0)
+            return -1;
+        // reading can take a while and stream may have been stopped
+        if (!m_ringBuffer)
+            return total;
+        if (l == 0)
+            break;
+
+        m_ringBuffer->releaseWriteRegion(QAudioRingBuffer::Region(region.first, int(l)));
+        wakeDeviceThread();
+        total += l;
+        if (l < region.second)
+            break;
+    }
+    return total;
+}
+
+void QAlsaAudioOutput::drainRingBuffer()
+{
+    // Timer driven push mode, this thread consumes the ring buffer
+    const int frameBytes = settings.bytesPerFrame();
+    while (m_ringBuffer) {
+        int bytes = qMin(m_ringBuffer->used(), deviceBytesFree());
+        bytes -= bytes % frameBytes;
+        if (bytes <= 0)
+            break;
+
+        QAudioRingBuffer::Region region = m_ringBuffer->acquireReadRegion(bytes);
+        if (region.second < frameBytes) {
+            // A frame split by the end of the ring, reassemble it
+            m_ringBuffer->read(audioBuffer, frameBytes);
+            if (write(audioBuffer, frameBytes) <= 0)
+                break;
+            continue;
         }
+
+        region.second -= region.second % frameBytes;
+        const qint64 written = write(region.first, region.second);
+        if (written <= 0 || !m_ringBuffer)
+            break;
+        m_ringBuffer->releaseReadRegion(QAudioRingBuffer::Region(region.first, int(written)));
     }
-    return written;
+}
+
+void QAlsaAudioOutput::dataPushed()
+{
+    if (m_threaded)
+        wakeDeviceThread();
+    else if (QThread::currentThread() == thread())
+        drainRingBuffer(); // same thread as the timer, no need to wait for it
+
+    if (deviceState == QAudio::IdleState) {
+        resuming = false;
+        errorState = QAudio::NoError;
+        deviceState = QAudio::ActiveState;
+        emit stateChanged(deviceState);
+    }
+}
+
+AlsaOutputPrivate::AlsaOutputPrivate(QAlsaAudioOutput* audio)
+    : QAudioRingBufferDevice(audio->m_ringBuffer)
+{
+    audioDevice = qobject_cast<QAlsaAudioOutput*>(audio);
+}
+
+AlsaOutputPrivate::~AlsaOutputPrivate() {}
+
+void AlsaOutputPrivate::dataWritten(qint64 len)
+{
+    Q_UNUSED(len);
 
+    audioDevice->dataPushed();
 }
 
 QT_END_NAMESPACE
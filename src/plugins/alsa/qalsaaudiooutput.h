@@ -60,10 +60,15 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthread.h>
 
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudiodeviceinfo.h>
 #include <QtMultimedia/qaudiosystem.h>
+#include <QtMultimedia/private/qaudiohelpers_p.h>
+#include <QtMultimedia/private/qaudioringbuffer_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -98,6 +103,7 @@ public:
     void setVolume(qreal) override;
     qreal volume() const override;
 
+    int xrunCount() const;
 
     QIODevice* audioSource;
     QAudioFormat settings;
@@ -128,6 +134,20 @@ private:
     int setFormat();
     bool open();
     void close();
+    int deviceBytesFree() const;
+    void drainRingBuffer();
+    void dataPushed();
+
+    template <typename Fill>
+    snd_pcm_sframes_t mmapWrite(snd_pcm_uframes_t frames, Fill fill);
+
+    void startDeviceThread();
+    void stopDeviceThread();
+    void runDeviceThread();
+    bool recoverDeviceThread(int err);
+    void wakeDeviceThread();
+    void requestRefill();
+    qint64 refillRingBuffer();
 
     QTimer* timer;
     QByteArray m_device;
@@ -141,9 +161,23 @@ private:
     snd_pcm_format_t pcmformat;
     snd_pcm_hw_params_t *hwparams;
     qreal m_volume;
+    QAudioHelperInternal::VolumeRamp m_volumeRamp;
+
+    // Push mode and real-time thread mode, see QT_ALSA_OUTPUT_REALTIME_THREAD
+    bool m_threaded;
+    QThread *m_deviceThread;
+    QAudioRingBuffer *m_ringBuffer;
+    QSemaphore m_dataReady;
+    QMutex m_volumeMutex;
+    QAtomicInt m_threadQuit;
+    QAtomicInt m_threadWaiting;
+    QAtomicInt m_refillPending;
+    QAtomicInt m_xrunCount;
+    QAtomicInt m_deviceAvail;
+    QAtomicInteger<qint64> m_threadFrames;
 };
 
-class AlsaOutputPrivate : public QIODevice
+class AlsaOutputPrivate : public QAudioRingBufferDevice
 {
     friend class QAlsaAudioOutput;
     Q_OBJECT
@@ -151,8 +185,8 @@ public:
     AlsaOutputPrivate(QAlsaAudioOutput* audio);
     ~AlsaOutputPrivate();
 
-    qint64 readData( char* data, qint64 len) override;
-    qint64 writeData(const char* data, qint64 len) override;
+protected:
+    void dataWritten(qint64 len) override;
 
 private:
     QAlsaAudioOutput *audioDevice;
@@ -51,7 +51,7 @@
 
 QT_BEGIN_NAMESPACE
 
-class CoreAudioRingBuffer;
+class QAudioRingBuffer;
 class CoreAudioPacketFeeder;
 class CoreAudioInputBuffer;
 class CoreAudioInputDevice;
@@ -140,7 +140,7 @@ private:
     int m_periodTime;
     QIODevice *m_device;
     QTimer *m_flushTimer;
-    CoreAudioRingBuffer *m_buffer;
+    QAudioRingBuffer *m_buffer;
     CoreAudioBufferList *m_inputBufferList;
     AudioConverterRef m_audioConverter;
     AudioStreamBasicDescription m_inputFormat;
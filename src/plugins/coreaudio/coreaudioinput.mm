@@ -50,6 +50,7 @@
 #endif
 
 #include <QtMultimedia/private/qaudiohelpers_p.h>
+#include <QtMultimedia/private/qaudioringbuffer_p.h>
 #include <QtCore/QDataStream>
 #include <QtCore/QDebug>
 
@@ -198,7 +199,7 @@ CoreAudioInputBuffer::CoreAudioInputBuffer(int bufferSize, int maxPeriodSize, co
     m_maxPeriodSize = maxPeriodSize;
     m_periodTime = m_maxPeriodSize / m_outputFormat.mBytesPerFrame * 1000 / m_outputFormat.mSampleRate;
 
-    m_buffer = new CoreAudioRingBuffer(bufferSize);
+    m_buffer = new QAudioRingBuffer(bufferSize);
 
     m_inputBufferList = new CoreAudioBufferList(m_inputFormat);
 
@@ -261,7 +262,7 @@ qint64 CoreAudioInputBuffer::renderFromDevice(AudioUnit audioUnit, AudioUnitRend
         const int available = m_buffer->free();
 
         while (err == noErr && !feeder.empty()) {
-            CoreAudioRingBuffer::Region region = m_buffer->acquireWriteRegion(available - copied);
+            QAudioRingBuffer::Region region = m_buffer->acquireWriteRegion(available - copied);
 
             if (region.second == 0)
                 break;
@@ -293,7 +294,7 @@ qint64 CoreAudioInputBuffer::renderFromDevice(AudioUnit audioUnit, AudioUnitRend
         int     copied = 0;
 
         while (wecan && copied < available) {
-            CoreAudioRingBuffer::Region region = m_buffer->acquireWriteRegion(available - copied);
+            QAudioRingBuffer::Region region = m_buffer->acquireWriteRegion(available - copied);
 
             if (region.second > 0) {
                 memcpy(region.first, m_inputBufferList->data() + copied, region.second);
@@ -321,7 +322,7 @@ qint64 CoreAudioInputBuffer::readBytes(char *data, qint64 len)
 
     len -= len % m_maxPeriodSize;
     while (wecan && bytesCopied < len) {
-        CoreAudioRingBuffer::Region region = m_buffer->acquireReadRegion(len - bytesCopied);
+        QAudioRingBuffer::Region region = m_buffer->acquireReadRegion(len - bytesCopied);
 
         if (region.second > 0) {
             memcpy(data + bytesCopied, region.first, region.second);
@@ -369,7 +370,7 @@ void CoreAudioInputBuffer::flush(bool all)
         int     flushed = 0;
 
         while (!m_deviceError && wecan && flushed < readSize) {
-            CoreAudioRingBuffer::Region region = m_buffer->acquireReadRegion(readSize - flushed);
+            QAudioRingBuffer::Region region = m_buffer->acquireReadRegion(readSize - flushed);
 
             if (region.second > 0) {
                 int bytesWritten = m_device->write(region.first, region.second);
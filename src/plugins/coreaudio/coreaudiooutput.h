@@ -56,7 +56,7 @@ QT_BEGIN_NAMESPACE
 class CoreAudioOutputBuffer;
 class QTimer;
 class CoreAudioDeviceInfo;
-class CoreAudioRingBuffer;
+class QAudioRingBuffer;
 
 class CoreAudioOutputBuffer : public QObject
 {
@@ -90,7 +90,7 @@ private:
     int m_periodTime;
     QIODevice *m_device;
     QTimer *m_fillTimer;
-    CoreAudioRingBuffer *m_buffer;
+    QAudioRingBuffer *m_buffer;
 };
 
 class CoreAudioOutputDevice : public QIODevice
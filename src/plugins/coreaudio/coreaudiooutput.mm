@@ -44,6 +44,7 @@
 #include <QtCore/QDataStream>
 #include <QtCore/QTimer>
 #include <QtCore/QDebug>
+#include <QtMultimedia/private/qaudioringbuffer_p.h>
 
 #include <AudioUnit/AudioUnit.h>
 #include <AudioToolbox/AudioToolbox.h>
@@ -64,7 +65,7 @@ CoreAudioOutputBuffer::CoreAudioOutputBuffer(int bufferSize, int maxPeriodSize,
     , m_maxPeriodSize(maxPeriodSize)
     , m_device(0)
 {
-    m_buffer = new CoreAudioRingBuffer(bufferSize + (bufferSize % maxPeriodSize == 0 ? 0 : maxPeriodSize - (bufferSize % maxPeriodSize)));
+    m_buffer = new QAudioRingBuffer(bufferSize + (bufferSize % maxPeriodSize == 0 ? 0 : maxPeriodSize - (bufferSize % maxPeriodSize)));
     m_bytesPerFrame = (audioFormat.sampleSize() / 8) * audioFormat.channelCount();
     m_periodTime = m_maxPeriodSize / m_bytesPerFrame * 1000 / audioFormat.sampleRate();
 
@@ -83,7 +84,7 @@ qint64 CoreAudioOutputBuffer::readFrames(char *data, qint64 maxFrames)
     qint64  framesRead = 0;
 
     while (wecan && framesRead < maxFrames) {
-        CoreAudioRingBuffer::Region region = m_buffer->acquireReadRegion((maxFrames - framesRead) * m_bytesPerFrame);
+        QAudioRingBuffer::Region region = m_buffer->acquireReadRegion((maxFrames - framesRead) * m_bytesPerFrame);
 
         if (region.second > 0) {
             // Ensure that we only read whole frames.
@@ -114,7 +115,7 @@ qint64 CoreAudioOutputBuffer::writeBytes(const char *data, qint64 maxSize)
 
     maxSize -= maxSize % m_bytesPerFrame;
     while (wecan && bytesWritten < maxSize) {
-        CoreAudioRingBuffer::Region region = m_buffer->acquireWriteRegion(maxSize - bytesWritten);
+        QAudioRingBuffer::Region region = m_buffer->acquireWriteRegion(maxSize - bytesWritten);
 
         if (region.second > 0) {
             memcpy(region.first, data + bytesWritten, region.second);
@@ -174,7 +175,7 @@ void CoreAudioOutputBuffer::fillBuffer()
         int     filled = 0;
 
         while (!m_deviceError && wecan && filled < writeSize) {
-            CoreAudioRingBuffer::Region region = m_buffer->acquireWriteRegion(writeSize - filled);
+            QAudioRingBuffer::Region region = m_buffer->acquireWriteRegion(writeSize - filled);
 
             if (region.second > 0) {
                 region.second = m_device->read(region.first, region.second);
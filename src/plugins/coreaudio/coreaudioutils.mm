@@ -113,86 +113,4 @@ AudioStreamBasicDescription CoreAudioUtils::toAudioStreamBasicDescription(QAudio
     return sf;
 }
 
-// QAudioRingBuffer
-CoreAudioRingBuffer::CoreAudioRingBuffer(int bufferSize):
-    m_bufferSize(bufferSize)
-{
-    m_buffer = new char[m_bufferSize];
-    reset();
-}
-
-CoreAudioRingBuffer::~CoreAudioRingBuffer()
-{
-    delete[] m_buffer;
-}
-
-CoreAudioRingBuffer::Region CoreAudioRingBuffer::acquireReadRegion(int size)
-{
-    const int used = m_bufferUsed.fetchAndAddAcquire(0);
-
-    if (used > 0) {
-        const int readSize = qMin(size, qMin(m_bufferSize - m_readPos, used));
-
-        return readSize > 0 ? Region(m_buffer + m_readPos, readSize) : Region(0, 0);
-    }
-
-    return Region(0, 0);
-}
-
-void CoreAudioRingBuffer::releaseReadRegion(const CoreAudioRingBuffer::Region &region)
-{
-    m_readPos = (m_readPos + region.second) % m_bufferSize;
-
-    m_bufferUsed.fetchAndAddRelease(-region.second);
-}
-
-CoreAudioRingBuffer::Region CoreAudioRingBuffer::acquireWriteRegion(int size)
-{
-    const int free = m_bufferSize - m_bufferUsed.fetchAndAddAcquire(0);
-
-    Region output;
-
-    if (free > 0) {
-        const int writeSize = qMin(size, qMin(m_bufferSize - m_writePos, free));
-        output =  writeSize > 0 ? Region(m_buffer + m_writePos, writeSize) : Region(0, 0);
-    } else {
-        output = Region(0, 0);
-    }
-#ifdef QT_DEBUG_COREAUDIO
-    qDebug("acquireWriteRegion(%d) free: %d returning Region(%p, %d)", size, free, output.first, output.second);
-#endif
-    return output;
-}
-void CoreAudioRingBuffer::releaseWriteRegion(const CoreAudioRingBuffer::Region &region)
-{
-    m_writePos = (m_writePos + region.second) % m_bufferSize;
-
-    m_bufferUsed.fetchAndAddRelease(region.second);
-#ifdef QT_DEBUG_COREAUDIO
-    qDebug("releaseWriteRegion(%p,%d): m_writePos:%d", region.first, region.second, m_writePos);
-#endif
-}
-
-int CoreAudioRingBuffer::used() const
-{
-    return m_bufferUsed.loadRelaxed();
-}
-
-int CoreAudioRingBuffer::free() const
-{
-    return m_bufferSize - m_bufferUsed.loadRelaxed();
-}
-
-int CoreAudioRingBuffer::size() const
-{
-    return m_bufferSize;
-}
-
-void CoreAudioRingBuffer::reset()
-{
-    m_readPos = 0;
-    m_writePos = 0;
-    m_bufferUsed.storeRelaxed(0);
-}
-
 QT_END_NAMESPACE
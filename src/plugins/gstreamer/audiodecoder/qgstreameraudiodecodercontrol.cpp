@@ -116,6 +116,36 @@ void QGstreamerAudioDecoderControl::setAudioFormat(const QAudioFormat &format)
     m_session->setAudioFormat(format);
 }
 
+int QGstreamerAudioDecoderControl::bufferQueueLimit() const
+{
+    return m_session->bufferQueueLimit();
+}
+
+void QGstreamerAudioDecoderControl::setBufferQueueLimit(int buffers)
+{
+    m_session->setBufferQueueLimit(buffers);
+}
+
+int QGstreamerAudioDecoderControl::framesPerBuffer() const
+{
+    return m_session->framesPerBuffer();
+}
+
+void QGstreamerAudioDecoderControl::setFramesPerBuffer(int frames)
+{
+    m_session->setFramesPerBuffer(frames);
+}
+
+bool QGstreamerAudioDecoderControl::fastDecoding() const
+{
+    return m_session->fastDecoding();
+}
+
+void QGstreamerAudioDecoderControl::setFastDecoding(bool enabled)
+{
+    m_session->setFastDecoding(enabled);
+}
+
 QAudioBuffer QGstreamerAudioDecoderControl::read()
 {
     return m_session->read();
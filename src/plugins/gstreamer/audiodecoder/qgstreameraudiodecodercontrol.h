@@ -78,6 +78,15 @@ public:
     QAudioFormat audioFormat() const override;
     void setAudioFormat(const QAudioFormat &format) override;
 
+    int bufferQueueLimit() const override;
+    void setBufferQueueLimit(int buffers) override;
+
+    int framesPerBuffer() const override;
+    void setFramesPerBuffer(int frames) override;
+
+    bool fastDecoding() const override;
+    void setFastDecoding(bool enabled) override;
+
     QAudioBuffer read() override;
     bool bufferAvailable() const override;
 
@@ -42,6 +42,7 @@
 #include <private/qgstreamerbushelper_p.h>
 
 #include <private/qgstutils_p.h>
+#include <private/qgstaudiobuffer_p.h>
 
 #include <gst/gstvalue.h>
 #include <gst/base/gstbasesrc.h>
@@ -56,6 +57,7 @@
 #include <QtCore/qurl.h>
 
 #define MAX_BUFFERS_IN_QUEUE 4
+#define MAX_BUFFERS_IN_QUEUE_FAST 64
 
 QT_BEGIN_NAMESPACE
 
@@ -86,6 +88,11 @@ QGstreamerAudioDecoderSession::QGstreamerAudioDecoderSession(QObject *parent)
 #endif
      mDevice(0),
      m_buffersAvailable(0),
+     m_queueLimit(0),
+     m_framesPerBuffer(0),
+     m_fastDecoding(false),
+     m_pendingBytes(0),
+     m_flushing(false),
      m_position(-1),
      m_duration(-1),
      m_durationQueries(0)
@@ -214,6 +221,7 @@ bool QGstreamerAudioDecoderSession::processBusMessage(const QGstreamerMessage &m
                 break;
 
             case GST_MESSAGE_EOS:
+                flushCoalescedBuffer();
                 m_pendingState = m_state = QAudioDecoder::StoppedState;
                 emit finished();
                 emit stateChanged(m_state);
@@ -389,6 +397,13 @@ void QGstreamerAudioDecoderSession::start()
 void QGstreamerAudioDecoderSession::stop()
 {
     if (m_playbin) {
+        {
+            // Release a streaming thread waiting for the coalesced queue
+            QMutexLocker locker(&m_buffersMutex);
+            m_flushing = true;
+            m_queueNotFull.wakeAll();
+        }
+
         gst_element_set_state(m_playbin, GST_STATE_NULL);
         removeAppSink();
 
@@ -396,6 +411,10 @@ void QGstreamerAudioDecoderSession::stop()
         m_pendingState = m_state = QAudioDecoder::StoppedState;
 
         // GStreamer thread is stopped. Can safely access m_buffersAvailable
+        m_readyBuffers.clear();
+        m_pendingBuffer = QAudioBuffer();
+        m_pendingBytes = 0;
+        m_flushing = false;
         if (m_buffersAvailable != 0) {
             m_buffersAvailable = 0;
             emit bufferAvailableChanged(false);
@@ -429,6 +448,43 @@ void QGstreamerAudioDecoderSession::setAudioFormat(const QAudioFormat &format)
     }
 }
 
+int QGstreamerAudioDecoderSession::bufferQueueLimit() const
+{
+    return m_queueLimit;
+}
+
+void QGstreamerAudioDecoderSession::setBufferQueueLimit(int buffers)
+{
+    m_queueLimit = buffers;
+}
+
+int QGstreamerAudioDecoderSession::framesPerBuffer() const
+{
+    return m_framesPerBuffer;
+}
+
+void QGstreamerAudioDecoderSession::setFramesPerBuffer(int frames)
+{
+    m_framesPerBuffer = frames;
+}
+
+bool QGstreamerAudioDecoderSession::fastDecoding() const
+{
+    return m_fastDecoding;
+}
+
+void QGstreamerAudioDecoderSession::setFastDecoding(bool enabled)
+{
+    m_fastDecoding = enabled;
+}
+
+int QGstreamerAudioDecoderSession::queueLimit() const
+{
+    if (m_queueLimit > 0)
+        return m_queueLimit;
+    return m_fastDecoding ? MAX_BUFFERS_IN_QUEUE_FAST : MAX_BUFFERS_IN_QUEUE;
+}
+
 QAudioBuffer QGstreamerAudioDecoderSession::read()
 {
     QAudioBuffer audioBuffer;
@@ -437,54 +493,56 @@ QAudioBuffer QGstreamerAudioDecoderSession::read()
     {
         QMutexLocker locker(&m_buffersMutex);
         buffersAvailable = m_buffersAvailable;
+        if (buffersAvailable <= 0)
+            return audioBuffer;
 
         // need to decrement before pulling a buffer
         // to make sure assert in QGstreamerAudioDecoderSession::new_buffer works
         m_buffersAvailable--;
-    }
-
 
-    if (buffersAvailable) {
-        if (buffersAvailable == 1)
-            emit bufferAvailableChanged(false);
+        if (m_framesPerBuffer > 0) {
+            audioBuffer = m_readyBuffers.dequeue();
+            m_queueNotFull.wakeOne();
+        }
+    }
 
-        const char* bufferData = 0;
-        int bufferSize = 0;
+    if (buffersAvailable == 1)
+        emit bufferAvailableChanged(false);
 
+    if (m_framesPerBuffer == 0) {
 #if GST_CHECK_VERSION(1,0,0)
         GstSample *sample = gst_app_sink_pull_sample(m_appSink);
         GstBuffer *buffer = gst_sample_get_buffer(sample);
-        GstMapInfo mapInfo;
-        gst_buffer_map(buffer, &mapInfo, GST_MAP_READ);
-        bufferData = (const char*)mapInfo.data;
-        bufferSize = mapInfo.size;
         QAudioFormat format = QGstUtils::audioFormatForSample(sample);
 #else
         GstBuffer *buffer = gst_app_sink_pull_buffer(m_appSink);
-        bufferData = (const char*)buffer->data;
-        bufferSize = buffer->size;
         QAudioFormat format = QGstUtils::audioFormatForBuffer(buffer);
 #endif
 
         if (format.isValid()) {
-            // XXX At the moment we have to copy data from GstBuffer into QAudioBuffer.
-            // We could improve performance by implementing QAbstractAudioBuffer for GstBuffer.
+            // The QAudioBuffer shares the decoded data, no copy is made
             qint64 position = getPositionFromBuffer(buffer);
-            audioBuffer = QAudioBuffer(QByteArray((const char*)bufferData, bufferSize), format, position);
-            position /= 1000; // convert to milliseconds
-            if (position != m_position) {
-                m_position = position;
-                emit positionChanged(m_position);
-            }
+#if GST_CHECK_VERSION(1,0,0)
+            audioBuffer = QGstAudioBuffer::wrap(sample, format, position);
+#else
+            audioBuffer = QGstAudioBuffer::wrap(buffer, format, position);
+#endif
         }
 #if GST_CHECK_VERSION(1,0,0)
-        gst_buffer_unmap(buffer, &mapInfo);
         gst_sample_unref(sample);
 #else
         gst_buffer_unref(buffer);
 #endif
     }
 
+    if (audioBuffer.isValid()) {
+        qint64 position = audioBuffer.startTime() / 1000; // convert to milliseconds
+        if (position != m_position) {
+            m_position = position;
+            emit positionChanged(m_position);
+        }
+    }
+
     return audioBuffer;
 }
 
@@ -510,25 +568,164 @@ void QGstreamerAudioDecoderSession::processInvalidMedia(QAudioDecoder::Error err
     emit error(int(errorCode), errorString);
 }
 
-GstFlowReturn QGstreamerAudioDecoderSession::new_sample(GstAppSink *, gpointer user_data)
+GstFlowReturn QGstreamerAudioDecoderSession::new_sample(GstAppSink *sink, gpointer user_data)
 {
     // "Note that the preroll buffer will also be returned as the first buffer when calling gst_app_sink_pull_buffer()."
     QGstreamerAudioDecoderSession *session = reinterpret_cast<QGstreamerAudioDecoderSession*>(user_data);
 
+    if (session->m_framesPerBuffer > 0)
+        return session->coalesceSample(sink);
+
     int buffersAvailable;
     {
         QMutexLocker locker(&session->m_buffersMutex);
         buffersAvailable = session->m_buffersAvailable;
         session->m_buffersAvailable++;
-        Q_ASSERT(session->m_buffersAvailable <= MAX_BUFFERS_IN_QUEUE);
+        Q_ASSERT(session->m_buffersAvailable <= session->queueLimit());
     }
 
-    if (!buffersAvailable)
-        QMetaObject::invokeMethod(session, "bufferAvailableChanged", Qt::QueuedConnection, Q_ARG(bool, true));
-    QMetaObject::invokeMethod(session, "bufferReady", Qt::QueuedConnection);
+    session->notifyBufferQueued(buffersAvailable);
     return GST_FLOW_OK;
 }
 
+void QGstreamerAudioDecoderSession::notifyBufferQueued(int buffersAvailable)
+{
+    if (!buffersAvailable)
+        QMetaObject::invokeMethod(this, "bufferAvailableChanged", Qt::QueuedConnection, Q_ARG(bool, true));
+
+    // When decoding fast the reader drains the queue on the first notification
+    if (!buffersAvailable || !m_fastDecoding)
+        QMetaObject::invokeMethod(this, "bufferReady", Qt::QueuedConnection);
+}
+
+/*
+    Called on the streaming thread when framesPerBuffer is set. Copies the
+    decoded sample into buffers of exactly that many frames, blocking while
+    the queue of complete buffers is full.
+*/
+GstFlowReturn QGstreamerAudioDecoderSession::coalesceSample(GstAppSink *sink)
+{
+#if GST_CHECK_VERSION(1,0,0)
+    GstSample *sample = gst_app_sink_pull_sample(sink);
+    if (!sample)
+        return GST_FLOW_OK;
+    GstBuffer *buffer = gst_sample_get_buffer(sample);
+    const QAudioFormat format = QGstUtils::audioFormatForSample(sample);
+
+    GstMapInfo mapInfo;
+    const bool mapped = buffer && gst_buffer_map(buffer, &mapInfo, GST_MAP_READ);
+    const char *data = mapped ? reinterpret_cast<const char *>(mapInfo.data) : nullptr;
+    const int size = mapped ? int(mapInfo.size) : 0;
+#else
+    GstBuffer *buffer = gst_app_sink_pull_buffer(sink);
+    if (!buffer)
+        return GST_FLOW_OK;
+    const QAudioFormat format = QGstUtils::audioFormatForBuffer(buffer);
+
+    const char *data = reinterpret_cast<const char *>(buffer->data);
+    const int size = buffer->size;
+#endif
+
+    GstFlowReturn result = GST_FLOW_OK;
+    if (format.isValid() && data) {
+        const qint64 startTime = getPositionFromBuffer(buffer);
+
+        QMutexLocker locker(&m_buffersMutex);
+
+        // A format change completes the buffer collected so far
+        if (m_pendingBytes > 0 && m_pendingBuffer.format() != format) {
+            truncatePendingBuffer();
+            queueCoalescedBuffer();
+        }
+
+        const int bufferBytes = format.bytesForFrames(m_framesPerBuffer);
+        int offset = 0;
+        while (offset < size && !m_flushing) {
+            if (m_pendingBytes == 0) {
+                const qint64 pendingStart = startTime >= 0
+                        ? startTime + format.durationForBytes(offset)
+                        : -1;
+                m_pendingBuffer = QAudioBuffer(m_framesPerBuffer, format, pendingStart);
+            }
+
+            const int bytes = qMin(size - offset, bufferBytes - m_pendingBytes);
+            memcpy(m_pendingBuffer.data<char>() + m_pendingBytes, data + offset, bytes);
+            m_pendingBytes += bytes;
+            offset += bytes;
+
+            if (m_pendingBytes == bufferBytes && !queueCoalescedBuffer())
+                break;
+        }
+
+        if (m_flushing)
+            result = GST_FLOW_FLUSHING;
+    }
+
+#if GST_CHECK_VERSION(1,0,0)
+    if (mapped)
+        gst_buffer_unmap(buffer, &mapInfo);
+    gst_sample_unref(sample);
+#else
+    gst_buffer_unref(buffer);
+#endif
+
+    return result;
+}
+
+/*
+    Moves the pending buffer to the ready queue, waiting for room unless
+    the session is stopping. Returns false if the session is stopping.
+    Must be called with m_buffersMutex locked.
+*/
+bool QGstreamerAudioDecoderSession::queueCoalescedBuffer()
+{
+    while (m_readyBuffers.size() >= queueLimit() && !m_flushing)
+        m_queueNotFull.wait(&m_buffersMutex);
+
+    if (m_flushing)
+        return false;
+
+    m_readyBuffers.enqueue(m_pendingBuffer);
+    m_pendingBuffer = QAudioBuffer();
+    m_pendingBytes = 0;
+
+    notifyBufferQueued(m_buffersAvailable++);
+    return true;
+}
+
+// Shrinks the pending buffer to the frames collected so far
+void QGstreamerAudioDecoderSession::truncatePendingBuffer()
+{
+    const QAudioBuffer pending = m_pendingBuffer;
+    m_pendingBuffer = QAudioBuffer(QByteArray(pending.constData<char>(), m_pendingBytes),
+                                   pending.format(), pending.startTime());
+    m_pendingBytes = m_pendingBuffer.byteCount();
+}
+
+/*
+    Called on end of stream to deliver the frames collected after the last
+    complete buffer. The streaming thread has finished at this point.
+*/
+void QGstreamerAudioDecoderSession::flushCoalescedBuffer()
+{
+    int buffersAvailable;
+    {
+        QMutexLocker locker(&m_buffersMutex);
+        if (m_pendingBytes == 0)
+            return;
+
+        truncatePendingBuffer();
+        m_readyBuffers.enqueue(m_pendingBuffer);
+        m_pendingBuffer = QAudioBuffer();
+        m_pendingBytes = 0;
+        buffersAvailable = m_buffersAvailable++;
+    }
+
+    if (!buffersAvailable)
+        emit bufferAvailableChanged(true);
+    emit bufferReady();
+}
+
 void QGstreamerAudioDecoderSession::setAudioFlags(bool wantNativeAudio)
 {
     int flags = 0;
@@ -559,7 +756,7 @@ void QGstreamerAudioDecoderSession::addAppSink()
     callbacks.new_buffer = &new_sample;
 #endif
     gst_app_sink_set_callbacks(m_appSink, &callbacks, this, NULL);
-    gst_app_sink_set_max_buffers(m_appSink, MAX_BUFFERS_IN_QUEUE);
+    gst_app_sink_set_max_buffers(m_appSink, queueLimit());
     gst_base_sink_set_sync(GST_BASE_SINK(m_appSink), FALSE);
 
     gst_bin_add(GST_BIN(m_outputBin), GST_ELEMENT(m_appSink));
@@ -43,6 +43,8 @@
 #include <QtMultimedia/private/qtmultimediaglobal_p.h>
 #include <QObject>
 #include <QtCore/qmutex.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qwaitcondition.h>
 #include "qgstreameraudiodecodercontrol.h"
 #include <private/qgstreamerbushelper_p.h>
 #include "qaudiodecoder.h"
@@ -93,6 +95,15 @@ public:
     QAudioFormat audioFormat() const;
     void setAudioFormat(const QAudioFormat &format);
 
+    int bufferQueueLimit() const;
+    void setBufferQueueLimit(int buffers);
+
+    int framesPerBuffer() const;
+    void setFramesPerBuffer(int frames);
+
+    bool fastDecoding() const;
+    void setFastDecoding(bool enabled);
+
     QAudioBuffer read();
     bool bufferAvailable() const;
 
@@ -126,6 +137,13 @@ private:
     void processInvalidMedia(QAudioDecoder::Error errorCode, const QString& errorString);
     static qint64 getPositionFromBuffer(GstBuffer* buffer);
 
+    int queueLimit() const;
+    void notifyBufferQueued(int buffersAvailable);
+    GstFlowReturn coalesceSample(GstAppSink *sink);
+    bool queueCoalescedBuffer();
+    void truncatePendingBuffer();
+    void flushCoalescedBuffer();
+
     QAudioDecoder::State m_state;
     QAudioDecoder::State m_pendingState;
     QGstreamerBusHelper *m_busHelper;
@@ -146,6 +164,17 @@ private:
     mutable QMutex m_buffersMutex;
     int m_buffersAvailable;
 
+    int m_queueLimit;
+    int m_framesPerBuffer;
+    bool m_fastDecoding;
+
+    // Coalesced buffers, guarded by m_buffersMutex
+    QWaitCondition m_queueNotFull;
+    QQueue<QAudioBuffer> m_readyBuffers;
+    QAudioBuffer m_pendingBuffer;
+    int m_pendingBytes;
+    bool m_flushing;
+
     qint64 m_position;
     qint64 m_duration;
 
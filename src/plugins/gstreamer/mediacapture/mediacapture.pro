@@ -14,6 +14,7 @@ HEADERS += $$PWD/qgstreamercaptureservice.h \
     $$PWD/qgstreamercapturemetadatacontrol.h \
     $$PWD/qgstreamerimagecapturecontrol.h \
     $$PWD/qgstreamerimageencode.h \
+    $$PWD/qgstreamerprerollbuffer.h \
     $$PWD/qgstreamercaptureserviceplugin.h
 
 SOURCES += $$PWD/qgstreamercaptureservice.cpp \
@@ -26,6 +27,7 @@ SOURCES += $$PWD/qgstreamercaptureservice.cpp \
     $$PWD/qgstreamercapturemetadatacontrol.cpp \
     $$PWD/qgstreamerimagecapturecontrol.cpp \
     $$PWD/qgstreamerimageencode.cpp \
+    $$PWD/qgstreamerprerollbuffer.cpp \
     $$PWD/qgstreamercaptureserviceplugin.cpp
 
 # Camera usage with gstreamer needs to have
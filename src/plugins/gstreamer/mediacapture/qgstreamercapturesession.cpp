@@ -44,6 +44,7 @@
 #include "qgstreamervideoencode.h"
 #include "qgstreamerimageencode.h"
 #include <qmediarecorder.h>
+#include <qcameraimagecapture.h>
 #include <private/qgstreamervideorendererinterface_p.h>
 #include <private/qgstreameraudioprobecontrol_p.h>
 #include <private/qgstreamerbushelper_p.h>
@@ -59,6 +60,7 @@
 #include <QCoreApplication>
 #include <QtCore/qmetaobject.h>
 #include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
 #include <QtGui/qimage.h>
 
 QT_BEGIN_NAMESPACE
@@ -89,7 +91,17 @@ QGstreamerCaptureSession::QGstreamerCaptureSession(QGstreamerCaptureSession::Cap
      m_videoPreview(0),
      m_imageCaptureBin(0),
      m_encodeBin(0),
-     m_passImage(false),
+     m_audioEncodePad(0),
+     m_videoEncodePad(0),
+     m_detachingEncodeBin(false),
+     m_preRollDuration(0),
+     m_preRollBufferSize(0),
+     m_preRollEncoding(false),
+     m_preRollMuxBin(0),
+     m_preRollBase(GST_CLOCK_TIME_NONE),
+     m_segmentDuration(0),
+     m_segmentSize(0),
+     m_queuedImageCount(0),
      m_passPrerollImage(false)
 {
     m_pipeline = gst_pipeline_new("media-capture-pipeline");
@@ -107,12 +119,17 @@ QGstreamerCaptureSession::QGstreamerCaptureSession(QGstreamerCaptureSession::Cap
         qWarning() << QMediaRecorder::Error(e) << ":" << str.toLatin1().constData();
     });
     m_mediaContainerControl = new QGstreamerMediaContainerControl(this);
+
+    // A single writer keeps the images saved in the order they were requested
+    m_imageWriter.setMaxThreadCount(1);
 }
 
 QGstreamerCaptureSession::~QGstreamerCaptureSession()
 {
     setState(StoppedState);
     gst_element_set_state(m_pipeline, GST_STATE_NULL);
+    releaseEncodeBinPads();
+    m_imageWriter.waitForDone();
     gst_object_unref(GST_OBJECT(m_bus));
     gst_object_unref(GST_OBJECT(m_pipeline));
 }
@@ -122,26 +139,163 @@ void QGstreamerCaptureSession::setCaptureMode(CaptureMode mode)
     m_captureMode = mode;
 }
 
-GstElement *QGstreamerCaptureSession::buildEncodeBin()
+// splitmuxsink numbers the segments through a printf pattern, put the number before the suffix
+static QString segmentFileName(const QString &fileName, const QString &number)
+{
+    const QFileInfo info(fileName);
+
+    QString name = info.path() + QLatin1Char('/') + info.completeBaseName() + QLatin1Char('_') + number;
+    if (!info.suffix().isEmpty())
+        name += QLatin1Char('.') + info.suffix();
+
+    return name;
+}
+
+static QByteArray segmentLocation(const QString &fileName)
+{
+    QString escaped = fileName;
+    escaped.replace(QLatin1Char('%'), QLatin1String("%%"));
+
+    return QFile::encodeName(segmentFileName(escaped, QLatin1String("%05d")));
+}
+
+// splitmuxsink accepts any caps on its pads, so the stream has to pick its pad by name
+static bool linkToOutput(GstElement *element, GstElement *output, const char *segmentPadName)
 {
-    GstElement *encodeBin = gst_bin_new("encode-bin");
+    GstElementFactory *factory = gst_element_get_factory(output);
+    if (!factory || qstrcmp(gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory)), "splitmuxsink") != 0)
+        return gst_element_link(element, output);
+
+    GstPad *srcPad = gst_element_get_static_pad(element, "src");
+    GstPad *sinkPad = gst_element_get_request_pad(output, segmentPadName);
+    const bool ok = srcPad && sinkPad && gst_pad_link(srcPad, sinkPad) == GST_PAD_LINK_OK;
+    if (sinkPad)
+        gst_object_unref(GST_OBJECT(sinkPad));
+    if (srcPad)
+        gst_object_unref(GST_OBJECT(srcPad));
 
+    return ok;
+}
+
+GstElement *QGstreamerCaptureSession::buildMuxer(GstElement *bin)
+{
     GstElement *muxer = gst_element_factory_make( m_mediaContainerControl->formatElementName().constData(), "muxer");
     if (!muxer) {
         qWarning() << "Could not create a media muxer element:" << m_mediaContainerControl->formatElementName();
-        gst_object_unref(encodeBin);
         return 0;
     }
 
+    // The file sink's EOS tells when a recording bin has finished, see processBusMessage()
+    g_object_set(G_OBJECT(bin), "message-forward", TRUE, NULL);
+
     // Output location was rejected in setOutputlocation() if not a local file
     QUrl actualSink = QUrl::fromLocalFile(QDir::currentPath()).resolved(m_sink);
     GstElement *fileSink = gst_element_factory_make("filesink", "filesink");
+
+    if (m_segmentDuration > 0 || m_segmentSize > 0) {
+        // splitmuxsink starts a new file at a key frame once a limit is reached
+        if (GstElement *splitMuxer = gst_element_factory_make("splitmuxsink", "splitmuxsink")) {
+            g_object_set(G_OBJECT(splitMuxer),
+                         "muxer", muxer,
+                         "sink", fileSink,
+                         "location", segmentLocation(actualSink.toLocalFile()).constData(),
+                         "max-size-time", guint64(m_segmentDuration * GST_MSECOND),
+                         "max-size-bytes", guint64(m_segmentSize),
+                         NULL);
+
+            // Ask the encoder for a key frame when a segment is due, instead of waiting for one
+            if (m_segmentSize == 0
+                    && g_object_class_find_property(G_OBJECT_GET_CLASS(splitMuxer), "send-keyframe-requests")) {
+                g_object_set(G_OBJECT(splitMuxer), "send-keyframe-requests", TRUE, NULL);
+            }
+
+            gst_bin_add(GST_BIN(bin), splitMuxer);
+            m_actualLocation = QUrl::fromLocalFile(segmentFileName(actualSink.toLocalFile(), QLatin1String("00000")));
+            return splitMuxer;
+        }
+
+        qWarning() << "splitmuxsink is not available, recording to a single file";
+    }
+
     g_object_set(G_OBJECT(fileSink), "location", QFile::encodeName(actualSink.toLocalFile()).constData(), NULL);
-    gst_bin_add_many(GST_BIN(encodeBin), muxer, fileSink,  NULL);
+    gst_bin_add_many(GST_BIN(bin), muxer, fileSink,  NULL);
+    m_actualLocation = m_sink;
 
-    if (!gst_element_link(muxer, fileSink)) {
-        gst_object_unref(encodeBin);
+    if (!gst_element_link(muxer, fileSink))
         return 0;
+
+    return muxer;
+}
+
+/*
+    Ends a pre-roll encoder in a fakesink which hands the encoded buffers to the
+    session. The encoder output is restricted to what the muxer accepts, so the
+    buffers can be muxed once recording starts.
+*/
+GstElement *QGstreamerCaptureSession::buildPreRollSink(GstElement *bin, GstElement *encoder,
+                                                       PreRollStream *stream, const char *name)
+{
+    GstCaps *muxerCaps = 0;
+    GstElementFactory *factory = gst_element_factory_find(m_mediaContainerControl->formatElementName().constData());
+    GstPad *pad = gst_element_get_static_pad(encoder, "src");
+    GstCaps *encoderCaps = factory && pad ? qt_gst_pad_get_caps(pad) : 0;
+    if (encoderCaps) {
+        const GList *templates = gst_element_factory_get_static_pad_templates(factory);
+        for (const GList *item = templates; item && !muxerCaps; item = item->next) {
+            GstStaticPadTemplate *padTemplate = static_cast<GstStaticPadTemplate *>(item->data);
+            if (padTemplate->direction != GST_PAD_SINK)
+                continue;
+
+            GstCaps *templateCaps = gst_static_caps_get(&padTemplate->static_caps);
+            GstCaps *caps = gst_caps_intersect(templateCaps, encoderCaps);
+            gst_caps_unref(templateCaps);
+            if (gst_caps_is_empty(caps))
+                gst_caps_unref(caps);
+            else
+                muxerCaps = caps;
+        }
+        gst_caps_unref(encoderCaps);
+    }
+    if (pad)
+        gst_object_unref(GST_OBJECT(pad));
+    if (factory)
+        gst_object_unref(GST_OBJECT(factory));
+
+    if (!muxerCaps) {
+        qWarning() << "The encoder output is not accepted by the muxer:" << m_mediaContainerControl->formatElementName();
+        return 0;
+    }
+
+    GstElement *capsFilter = gst_element_factory_make("capsfilter", NULL);
+    g_object_set(G_OBJECT(capsFilter), "caps", muxerCaps, NULL);
+    gst_caps_unref(muxerCaps);
+
+    GstElement *sink = gst_element_factory_make("fakesink", name);
+    g_object_set(G_OBJECT(sink), "sync", FALSE, "async", FALSE, "signal-handoffs", TRUE, NULL);
+#if GST_CHECK_VERSION(1,0,0)
+    g_signal_connect(G_OBJECT(sink), "handoff", G_CALLBACK(handlePreRollBuffer), this);
+#endif
+
+    gst_bin_add_many(GST_BIN(bin), capsFilter, sink, NULL);
+    if (!gst_element_link(capsFilter, sink))
+        return 0;
+
+    stream->sink = sink;
+    return capsFilter;
+}
+
+GstElement *QGstreamerCaptureSession::buildEncodeBin(bool preRoll)
+{
+    GstElement *encodeBin = gst_bin_new(preRoll ? "preroll-encode-bin" : "encode-bin");
+
+    // The pre-roll encoders end in their own sinks, the muxer is added when recording starts
+    GstElement *muxer = 0;
+    if (!preRoll) {
+        muxer = buildMuxer(encodeBin);
+        if (!muxer) {
+            gst_object_unref(encodeBin);
+            return 0;
+        }
     }
 
     if (m_captureMode & Audio) {
@@ -159,7 +313,12 @@ GstElement *QGstreamerCaptureSession::buildEncodeBin()
 
         gst_bin_add(GST_BIN(encodeBin), audioEncoder);
 
-        if (!gst_element_link_many(audioConvert, audioQueue, m_audioVolume, audioEncoder, muxer, NULL)) {
+        GstElement *audioOutput = preRoll
+                ? buildPreRollSink(encodeBin, audioEncoder, &m_audioPreRoll, "audio-preroll-sink")
+                : muxer;
+
+        if (!audioOutput || !gst_element_link_many(audioConvert, audioQueue, m_audioVolume, audioEncoder, NULL)
+                || !linkToOutput(audioEncoder, audioOutput, "audio_%u")) {
             m_audioVolume = 0;
             gst_object_unref(encodeBin);
             return 0;
@@ -189,7 +348,12 @@ GstElement *QGstreamerCaptureSession::buildEncodeBin()
 
         gst_bin_add(GST_BIN(encodeBin), videoEncoder);
 
-        if (!gst_element_link_many(videoQueue, colorspace, videoscale, videoEncoder, muxer, NULL)) {
+        GstElement *videoOutput = preRoll
+                ? buildPreRollSink(encodeBin, videoEncoder, &m_videoPreRoll, "video-preroll-sink")
+                : muxer;
+
+        if (!videoOutput || !gst_element_link_many(videoQueue, colorspace, videoscale, videoEncoder, NULL)
+                || !linkToOutput(videoEncoder, videoOutput, "video")) {
             gst_object_unref(encodeBin);
             return 0;
         }
@@ -367,16 +531,22 @@ void QGstreamerCaptureSession::probeCaps(GstCaps *caps)
 
 bool QGstreamerCaptureSession::probeBuffer(GstBuffer *buffer)
 {
+    QMutexLocker locker(&m_imageMutex);
+
     if (m_passPrerollImage) {
-        m_passImage = false;
+        // Prerolls a new image encoder, nothing is saved for this frame
         m_passPrerollImage = false;
+        m_encodingImages.enqueue({ -1, QString() });
 
         return true;
-    } else  if (!m_passImage) {
+    } else if (m_pendingImages.isEmpty()) {
         return false;
     }
 
-    m_passImage = false;
+    // One frame per request, so a burst is taken from consecutive frames
+    const ImageRequest request = m_pendingImages.dequeue();
+    m_encodingImages.enqueue(request);
+    locker.unlock();
 
 #if GST_CHECK_VERSION(1,0,0)
     QImage img = QGstUtils::bufferToImage(buffer, m_previewInfo);
@@ -390,51 +560,88 @@ bool QGstreamerCaptureSession::probeBuffer(GstBuffer *buffer)
     static QMetaMethod exposedSignal = QMetaMethod::fromSignal(&QGstreamerCaptureSession::imageExposed);
     exposedSignal.invoke(this,
                          Qt::QueuedConnection,
-                         Q_ARG(int,m_imageRequestId));
+                         Q_ARG(int,request.id));
 
     static QMetaMethod capturedSignal = QMetaMethod::fromSignal(&QGstreamerCaptureSession::imageCaptured);
     capturedSignal.invoke(this,
                           Qt::QueuedConnection,
-                          Q_ARG(int,m_imageRequestId),
+                          Q_ARG(int,request.id),
                           Q_ARG(QImage,img));
 
     return true;
 }
 
-static gboolean saveImageFilter(GstElement *element,
-                                GstBuffer *buffer,
-                                GstPad *pad,
-                                void *appdata)
+gboolean QGstreamerCaptureSession::handleEncodedImage(GstElement *sink, GstBuffer *buffer,
+                                                      GstPad *pad, gpointer user_data)
 {
-    Q_UNUSED(element);
+    Q_UNUSED(sink);
     Q_UNUSED(pad);
-    QGstreamerCaptureSession *session = (QGstreamerCaptureSession *)appdata;
+    QGstreamerCaptureSession * const session = static_cast<QGstreamerCaptureSession *>(user_data);
+
+    // The encoder returns the images in the order the frames were passed to it
+    QMutexLocker locker(&session->m_imageMutex);
+    if (session->m_encodingImages.isEmpty())
+        return TRUE;
+
+    const ImageRequest request = session->m_encodingImages.dequeue();
+    if (request.id < 0)
+        return TRUE;
+    locker.unlock();
+
+    // Slow storage must not stall the pipeline, the writer keeps a reference
+    // to the encoded image instead of a copy.
+    gst_buffer_ref(buffer);
+    session->m_imageWriter.start([session, request, buffer]() {
+        session->saveImage(request.id, request.fileName, buffer);
+    });
 
-    QString fileName = session->m_imageFileName;
+    return TRUE;
+}
 
-    if (!fileName.isEmpty()) {
-        QFile f(fileName);
-        if (f.open(QFile::WriteOnly)) {
+/*
+    Runs on the image writer thread, releases the reference to \a buffer.
+*/
+void QGstreamerCaptureSession::saveImage(int requestId, const QString &fileName, GstBuffer *buffer)
+{
+    QString errorString;
+    QFile f(fileName);
+    if (f.open(QFile::WriteOnly)) {
 #if GST_CHECK_VERSION(1,0,0)
-            GstMapInfo info;
-            if (gst_buffer_map(buffer, &info, GST_MAP_READ)) {
-                f.write(reinterpret_cast<const char *>(info.data), info.size);
-                gst_buffer_unmap(buffer, &info);
-            }
+        GstMapInfo info;
+        if (gst_buffer_map(buffer, &info, GST_MAP_READ)) {
+            if (f.write(reinterpret_cast<const char *>(info.data), info.size) != qint64(info.size))
+                errorString = f.errorString();
+            gst_buffer_unmap(buffer, &info);
+        } else {
+            errorString = tr("Could not read the encoded image");
+        }
 #else
-            f.write(reinterpret_cast<const char *>(buffer->data), buffer->size);
+        if (f.write(reinterpret_cast<const char *>(buffer->data), buffer->size) != qint64(buffer->size))
+            errorString = f.errorString();
 #endif
-            f.close();
-
-            static QMetaMethod savedSignal = QMetaMethod::fromSignal(&QGstreamerCaptureSession::imageSaved);
-            savedSignal.invoke(session,
-                               Qt::QueuedConnection,
-                               Q_ARG(int,session->m_imageRequestId),
-                               Q_ARG(QString,fileName));
-        }
+        f.close();
+    } else {
+        errorString = f.errorString();
+    }
+    gst_buffer_unref(buffer);
+
+    if (errorString.isEmpty()) {
+        static QMetaMethod savedSignal = QMetaMethod::fromSignal(&QGstreamerCaptureSession::imageSaved);
+        savedSignal.invoke(this,
+                           Qt::QueuedConnection,
+                           Q_ARG(int,requestId),
+                           Q_ARG(QString,fileName));
+    } else {
+        static QMetaMethod errorSignal = QMetaMethod::fromSignal(&QGstreamerCaptureSession::imageCaptureError);
+        errorSignal.invoke(this,
+                           Qt::QueuedConnection,
+                           Q_ARG(int,requestId),
+                           Q_ARG(int,QCameraImageCapture::ResourceError),
+                           Q_ARG(QString,errorString));
     }
 
-    return TRUE;
+    QMutexLocker locker(&m_imageMutex);
+    imageRequestsFinished(1);
 }
 
 GstElement *QGstreamerCaptureSession::buildImageCapture()
@@ -453,7 +660,7 @@ GstElement *QGstreamerCaptureSession::buildImageCapture()
     gst_object_unref(GST_OBJECT(pad));
 
     g_object_set(G_OBJECT(sink), "signal-handoffs", TRUE, NULL);
-    g_signal_connect(G_OBJECT(sink), "handoff", G_CALLBACK(saveImageFilter), this);
+    g_signal_connect(G_OBJECT(sink), "handoff", G_CALLBACK(handleEncodedImage), this);
 
     gst_bin_add_many(GST_BIN(bin), queue, colorspace, encoder, sink,  NULL);
     gst_element_link_many(queue, colorspace, encoder, sink, NULL);
@@ -464,18 +671,89 @@ GstElement *QGstreamerCaptureSession::buildImageCapture()
     gst_element_add_pad(GST_ELEMENT(bin), gst_ghost_pad_new("imagesink", pad));
     gst_object_unref(GST_OBJECT(pad));
 
-    m_passImage = false;
+    QMutexLocker locker(&m_imageMutex);
     m_passPrerollImage = true;
-    m_imageFileName = QString();
 
     return bin;
 }
 
-void QGstreamerCaptureSession::captureImage(int requestId, const QString &fileName)
+// Requests beyond this wait for a frame, the encoder or the writer
+static const int MaxQueuedImages = 16;
+
+bool QGstreamerCaptureSession::captureImage(int requestId, const QString &fileName)
+{
+    QMutexLocker locker(&m_imageMutex);
+    if (m_queuedImageCount >= MaxQueuedImages)
+        return false;
+
+    m_pendingImages.enqueue({ requestId, fileName });
+    const bool full = ++m_queuedImageCount == MaxQueuedImages;
+    locker.unlock();
+
+    if (full)
+        emit imageQueueFullChanged(true);
+
+    return true;
+}
+
+bool QGstreamerCaptureSession::isImageQueueFull() const
+{
+    QMutexLocker locker(&m_imageMutex);
+    return m_queuedImageCount >= MaxQueuedImages;
+}
+
+/*
+    Drops the requests which are still waiting for a frame. Images which are
+    already being encoded or written are saved as usual.
+*/
+void QGstreamerCaptureSession::cancelImageCapture()
+{
+    QMutexLocker locker(&m_imageMutex);
+    const int count = m_pendingImages.size();
+    m_pendingImages.clear();
+    imageRequestsFinished(count);
+}
+
+/*
+    Called with the image mutex held after \a count requests left the queue.
+*/
+void QGstreamerCaptureSession::imageRequestsFinished(int count)
 {
-    m_imageRequestId = requestId;
-    m_imageFileName = fileName;
-    m_passImage = true;
+    const bool wasFull = m_queuedImageCount >= MaxQueuedImages;
+    m_queuedImageCount -= count;
+    if (wasFull && m_queuedImageCount < MaxQueuedImages) {
+        static QMetaMethod fullSignal = QMetaMethod::fromSignal(&QGstreamerCaptureSession::imageQueueFullChanged);
+        fullSignal.invoke(this, Qt::QueuedConnection, Q_ARG(bool,false));
+    }
+}
+
+/*
+    Fails the requests which have not reached the writer, both those waiting
+    for a frame and those whose frames were in a removed image encoder.
+*/
+void QGstreamerCaptureSession::dropImageRequests()
+{
+    QMutexLocker locker(&m_imageMutex);
+    QQueue<ImageRequest> requests;
+    requests.swap(m_encodingImages);
+    requests.append(m_pendingImages);
+    m_pendingImages.clear();
+
+    int count = 0;
+    for (const ImageRequest &request : qAsConst(requests)) {
+        // Pre-roll frames of the encoder are not requests
+        if (request.id < 0)
+            continue;
+
+        static QMetaMethod errorSignal = QMetaMethod::fromSignal(&QGstreamerCaptureSession::imageCaptureError);
+        errorSignal.invoke(this,
+                           Qt::QueuedConnection,
+                           Q_ARG(int,request.id),
+                           Q_ARG(int,QCameraImageCapture::ResourceError),
+                           Q_ARG(QString,tr("The capture was interrupted")));
+        ++count;
+    }
+    imageRequestsFinished(count);
 }
 
 
@@ -485,6 +763,19 @@ void QGstreamerCaptureSession::captureImage(int requestId, const QString &fileNa
 bool QGstreamerCaptureSession::rebuildGraph(QGstreamerCaptureSession::PipelineMode newMode)
 {
     removeAudioBufferProbe();
+    releaseEncodeBinPads();
+    REMOVE_ELEMENT(m_preRollMuxBin);
+    m_preRollEncoding = false;
+    {
+        QMutexLocker locker(&m_preRollMutex);
+        PreRollStream * const streams[] = { &m_audioPreRoll, &m_videoPreRoll };
+        for (PreRollStream *stream : streams) {
+            stream->buffer.clear();
+            stream->sink = nullptr;
+            stream->source = nullptr;
+            stream->started = false;
+        }
+    }
     REMOVE_ELEMENT(m_audioSrc);
     REMOVE_ELEMENT(m_audioPreview);
     REMOVE_ELEMENT(m_audioPreviewQueue);
@@ -495,6 +786,7 @@ bool QGstreamerCaptureSession::rebuildGraph(QGstreamerCaptureSession::PipelineMo
     REMOVE_ELEMENT(m_videoTee);
     REMOVE_ELEMENT(m_encodeBin);
     REMOVE_ELEMENT(m_imageCaptureBin);
+    dropImageRequests();
     m_audioVolume = 0;
 
     bool ok = true;
@@ -504,17 +796,25 @@ bool QGstreamerCaptureSession::rebuildGraph(QGstreamerCaptureSession::PipelineMo
             break;
         case PreviewPipeline:
             if (m_captureMode & Audio) {
+                // The tee lets the encode bin be attached without rebuilding the preview
                 m_audioSrc = buildAudioSrc();
                 m_audioPreview = buildAudioPreview();
+                m_audioTee = gst_element_factory_make("tee", "audio-preview-tee");
+                m_audioPreviewQueue = gst_element_factory_make("queue", "audio-preview-queue");
 
-                ok &= m_audioSrc && m_audioPreview;
+                ok &= m_audioSrc && m_audioPreview && m_audioTee && m_audioPreviewQueue;
 
                 if (ok) {
-                    gst_bin_add_many(GST_BIN(m_pipeline), m_audioSrc, m_audioPreview, NULL);
-                    ok &= gst_element_link(m_audioSrc, m_audioPreview);
+                    gst_bin_add_many(GST_BIN(m_pipeline), m_audioSrc, m_audioTee,
+                                     m_audioPreviewQueue, m_audioPreview, NULL);
+                    ok &= gst_element_link(m_audioSrc, m_audioTee);
+                    ok &= gst_element_link(m_audioTee, m_audioPreviewQueue);
+                    ok &= gst_element_link(m_audioPreviewQueue, m_audioPreview);
                 } else {
                     UNREF_ELEMENT(m_audioSrc);
                     UNREF_ELEMENT(m_audioPreview);
+                    UNREF_ELEMENT(m_audioTee);
+                    UNREF_ELEMENT(m_audioPreviewQueue);
                 }
             }
             if (m_captureMode & Video || m_captureMode & Image) {
@@ -604,6 +904,12 @@ bool QGstreamerCaptureSession::rebuildGraph(QGstreamerCaptureSession::PipelineMo
                 m_videoTee = gst_element_factory_make("tee", NULL);
                 m_videoPreviewQueue = gst_element_factory_make("queue", NULL);
 
+                // Keep still capture available, as it is once recording is attached to a preview
+                if (m_captureMode & Image) {
+                    m_imageCaptureBin = buildImageCapture();
+                    ok &= m_imageCaptureBin != 0;
+                }
+
                 ok &= m_videoSrc && m_videoPreview && m_videoTee && m_videoPreviewQueue;
 
                 if (ok) {
@@ -612,11 +918,17 @@ bool QGstreamerCaptureSession::rebuildGraph(QGstreamerCaptureSession::PipelineMo
                     ok &= gst_element_link(m_videoSrc, m_videoTee);
                     ok &= gst_element_link(m_videoTee, m_videoPreviewQueue);
                     ok &= gst_element_link(m_videoPreviewQueue, m_videoPreview);
+
+                    if (m_imageCaptureBin) {
+                        gst_bin_add(GST_BIN(m_pipeline), m_imageCaptureBin);
+                        ok &= gst_element_link(m_videoTee, m_imageCaptureBin);
+                    }
                 } else {
                     UNREF_ELEMENT(m_videoSrc);
                     UNREF_ELEMENT(m_videoTee);
                     UNREF_ELEMENT(m_videoPreviewQueue);
                     UNREF_ELEMENT(m_videoPreview);
+                    UNREF_ELEMENT(m_imageCaptureBin);
                 }
 
                 if (ok && (m_captureMode & Video))
@@ -657,11 +969,469 @@ bool QGstreamerCaptureSession::rebuildGraph(QGstreamerCaptureSession::PipelineMo
         REMOVE_ELEMENT(m_videoPreviewQueue);
         REMOVE_ELEMENT(m_videoTee);
         REMOVE_ELEMENT(m_encodeBin);
+        REMOVE_ELEMENT(m_imageCaptureBin);
+    }
+
+    return ok;
+}
+
+#if GST_CHECK_VERSION(1,0,0)
+static GstPadProbeReturn unlinkEncodeBinPad(GstPad *pad, GstPadProbeInfo *, gpointer)
+{
+    // Runs on the streaming thread with the tee pad blocked, so nothing else can be
+    // pushed into the encode bin between unlinking it and finishing its stream.
+    if (GstPad *peer = gst_pad_get_peer(pad)) {
+        gst_pad_unlink(pad, peer);
+        gst_pad_send_event(peer, gst_event_new_eos());
+        gst_object_unref(GST_OBJECT(peer));
+    }
+    return GST_PAD_PROBE_REMOVE;
+}
+
+bool QGstreamerCaptureSession::attachEncodeBin(bool preRoll)
+{
+    m_encodeBin = buildEncodeBin(preRoll);
+    if (!m_encodeBin)
+        return false;
+
+    // The pipeline is already playing, don't let the new sink take it back through preroll
+    if (GstElement *fileSink = gst_bin_get_by_name(GST_BIN(m_encodeBin), "filesink")) {
+        g_object_set(G_OBJECT(fileSink), "async", FALSE, NULL);
+        gst_object_unref(GST_OBJECT(fileSink));
+    }
+
+    gst_bin_add(GST_BIN(m_pipeline), m_encodeBin);
+
+    if (!preRoll && !m_metaData.isEmpty())
+        setMetaData(m_metaData);
+
+    // Bring the encode bin up before linking it, so the tees never push into a flushing pad
+    // and the preview doesn't have to be blocked.
+    bool ok = gst_element_sync_state_with_parent(m_encodeBin);
+
+    // Offset the new branch by the current running time so the recording starts at zero.
+    // Pre-roll buffers keep the pipeline's running time, they're rebased when recording starts.
+    GstClockTimeDiff offset = 0;
+    GstClock *clock = preRoll ? 0 : gst_element_get_clock(m_pipeline);
+    if (clock) {
+        offset = GST_CLOCK_DIFF(gst_element_get_base_time(m_pipeline), gst_clock_get_time(clock));
+        gst_object_unref(GST_OBJECT(clock));
+    }
+
+    if (ok && (m_captureMode & Audio))
+        ok &= linkEncodeBin(m_audioTee, "audiosink", offset);
+    if (ok && (m_captureMode & Video))
+        ok &= linkEncodeBin(m_videoTee, "videosink", offset);
+
+    if (!ok) {
+        releaseEncodeBinPads();
+        gst_element_set_state(m_encodeBin, GST_STATE_NULL);
+        REMOVE_ELEMENT(m_encodeBin);
+        m_audioVolume = 0;
+        m_audioPreRoll.sink = nullptr;
+        m_videoPreRoll.sink = nullptr;
+        return false;
+    }
+
+    m_preRollEncoding = preRoll;
+    if (preRoll) {
+        m_preRollAudioSettings = m_audioEncodeControl->audioSettings();
+        m_preRollVideoSettings = m_videoEncodeControl->videoSettings();
+    }
+    dumpGraph(preRoll ? "preroll_encode_bin_attached" : "encode_bin_attached");
+
+    return true;
+}
+
+/*
+    Keeps a pre-roll encoder running alongside the preview while a pre-roll
+    duration is set, and removes it otherwise. An encoder built with other
+    settings than the current ones is rebuilt, losing its history, since
+    its stream could not be recorded with the new settings.
+*/
+void QGstreamerCaptureSession::updatePreRollEncodeBin()
+{
+    if (m_pipelineMode != PreviewPipeline || m_detachingEncodeBin)
+        return;
+
+    if (m_preRollDuration > 0 && !m_encodeBin) {
+        m_recorderControl->resolveSettings();
+        if (!attachEncodeBin(true))
+            qWarning() << "Could not start the pre-roll encoder";
+    } else if (m_preRollDuration == 0 && m_preRollEncoding) {
+        removePreRollEncodeBin();
+    } else if (m_preRollEncoding && preRollSettingsChanged()) {
+        removePreRollEncodeBin();
+        m_recorderControl->resolveSettings();
+        if (!attachEncodeBin(true))
+            qWarning() << "Could not restart the pre-roll encoder";
+    }
+}
+
+bool QGstreamerCaptureSession::preRollSettingsChanged() const
+{
+    return ((m_captureMode & Audio) && m_preRollAudioSettings != m_audioEncodeControl->audioSettings())
+            || ((m_captureMode & Video) && m_preRollVideoSettings != m_videoEncodeControl->videoSettings());
+}
+
+void QGstreamerCaptureSession::removePreRollEncodeBin()
+{
+    // Released tee pads ignore a flushing encoder, so this doesn't disturb the preview
+    releaseEncodeBinPads();
+    gst_element_set_state(m_encodeBin, GST_STATE_NULL);
+    REMOVE_ELEMENT(m_encodeBin);
+    m_audioVolume = 0;
+    m_preRollEncoding = false;
+
+    QMutexLocker locker(&m_preRollMutex);
+    m_audioPreRoll.sink = nullptr;
+    m_audioPreRoll.buffer.clear();
+    m_videoPreRoll.sink = nullptr;
+    m_videoPreRoll.buffer.clear();
+}
+
+GstElement *QGstreamerCaptureSession::buildPreRollMuxBin()
+{
+    GstElement *muxBin = gst_bin_new("preroll-mux-bin");
+
+    GstElement *muxer = buildMuxer(muxBin);
+    if (!muxer) {
+        gst_object_unref(muxBin);
+        return 0;
+    }
+
+    PreRollStream * const streams[] = { &m_audioPreRoll, &m_videoPreRoll };
+    const char * const names[] = { "audio-preroll-src", "video-preroll-src" };
+    for (int i = 0; i < 2; ++i) {
+        if (!streams[i]->sink)
+            continue;
+
+        // The encoder has produced at least one buffer, so its caps are known
+        GstPad *pad = gst_element_get_static_pad(streams[i]->sink, "sink");
+        GstCaps *caps = qt_gst_pad_get_current_caps(pad);
+        gst_object_unref(GST_OBJECT(pad));
+        if (!caps) {
+            gst_object_unref(muxBin);
+            return 0;
+        }
+
+        GstElement *source = gst_element_factory_make("appsrc", names[i]);
+        if (!source) {
+            gst_caps_unref(caps);
+            gst_object_unref(muxBin);
+            return 0;
+        }
+
+        // The history is pushed in one go, so the queue must not be limited
+        g_object_set(G_OBJECT(source), "caps", caps, "format", GST_FORMAT_TIME,
+                     "max-bytes", guint64(0), NULL);
+        gst_caps_unref(caps);
+
+        gst_bin_add(GST_BIN(muxBin), source);
+        if (!linkToOutput(source, muxer, i == 0 ? "audio_%u" : "video")) {
+            gst_object_unref(muxBin);
+            return 0;
+        }
+    }
+
+    return muxBin;
+}
+
+bool QGstreamerCaptureSession::startPreRollRecording()
+{
+    m_preRollMuxBin = buildPreRollMuxBin();
+    if (!m_preRollMuxBin)
+        return false;
+
+    // splitmuxsink adds its file sink later and turns off async itself
+    if (GstElement *fileSink = gst_bin_get_by_name(GST_BIN(m_preRollMuxBin), "filesink")) {
+        g_object_set(G_OBJECT(fileSink), "async", FALSE, NULL);
+        gst_object_unref(GST_OBJECT(fileSink));
+    }
+
+    gst_bin_add(GST_BIN(m_pipeline), m_preRollMuxBin);
+
+    if (!m_metaData.isEmpty())
+        setMetaData(m_metaData);
+
+    if (!gst_element_sync_state_with_parent(m_preRollMuxBin)) {
+        gst_element_set_state(m_preRollMuxBin, GST_STATE_NULL);
+        REMOVE_ELEMENT(m_preRollMuxBin);
+        return false;
     }
 
+    QMutexLocker locker(&m_preRollMutex);
+
+    // Start at the oldest video key frame, with the audio that goes with it
+    if (!m_videoPreRoll.buffer.isEmpty())
+        m_audioPreRoll.buffer.dropBefore(m_videoPreRoll.buffer.startTime());
+
+    m_preRollBase = GST_CLOCK_TIME_NONE;
+    PreRollStream * const streams[] = { &m_audioPreRoll, &m_videoPreRoll };
+    for (PreRollStream *stream : streams) {
+        const GstClockTime startTime = stream->buffer.startTime();
+        if (GST_CLOCK_TIME_IS_VALID(startTime)
+                && (!GST_CLOCK_TIME_IS_VALID(m_preRollBase) || startTime < m_preRollBase)) {
+            m_preRollBase = startTime;
+        }
+    }
+
+    m_audioPreRoll.source = m_audioPreRoll.sink
+            ? gst_bin_get_by_name(GST_BIN(m_preRollMuxBin), "audio-preroll-src") : 0;
+    m_videoPreRoll.source = m_videoPreRoll.sink
+            ? gst_bin_get_by_name(GST_BIN(m_preRollMuxBin), "video-preroll-src") : 0;
+
+    for (PreRollStream *stream : streams) {
+        if (!stream->source)
+            continue;
+
+        // The bin keeps the source alive until it is removed
+        gst_object_unref(GST_OBJECT(stream->source));
+
+        stream->started = !stream->buffer.isEmpty();
+        const QList<GstBuffer *> buffers = stream->buffer.takeBuffers();
+        for (GstBuffer *buffer : buffers)
+            pushPreRollBuffer(stream, buffer);
+    }
+
+    return true;
+}
+
+void QGstreamerCaptureSession::stopPreRollRecording()
+{
+    m_detachingEncodeBin = true;
+
+    // The muxer only finishes the file while the pipeline is playing
+    gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
+
+    QMutexLocker locker(&m_preRollMutex);
+    PreRollStream * const streams[] = { &m_audioPreRoll, &m_videoPreRoll };
+    for (PreRollStream *stream : streams) {
+        if (stream->source) {
+            GstFlowReturn ret;
+            g_signal_emit_by_name(stream->source, "end-of-stream", &ret);
+            stream->source = nullptr;
+        }
+        stream->started = false;
+    }
+}
+
+/*
+    Pushes a buffer to a recording stream, taking over its reference. Time stamps
+    are moved so the recording starts at zero.
+*/
+void QGstreamerCaptureSession::pushPreRollBuffer(PreRollStream *stream, GstBuffer *buffer)
+{
+    if (!stream->started) {
+        // The history was empty, a new recording starts at a key frame
+        if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+            gst_buffer_unref(buffer);
+            return;
+        }
+        stream->started = true;
+    }
+
+    if (!GST_CLOCK_TIME_IS_VALID(m_preRollBase))
+        m_preRollBase = QGstreamerPreRollBuffer::bufferTime(buffer);
+
+    buffer = gst_buffer_make_writable(buffer);
+    if (GST_BUFFER_PTS_IS_VALID(buffer))
+        GST_BUFFER_PTS(buffer) = GST_BUFFER_PTS(buffer) > m_preRollBase ? GST_BUFFER_PTS(buffer) - m_preRollBase : 0;
+    if (GST_BUFFER_DTS_IS_VALID(buffer))
+        GST_BUFFER_DTS(buffer) = GST_BUFFER_DTS(buffer) > m_preRollBase ? GST_BUFFER_DTS(buffer) - m_preRollBase : 0;
+
+    GstFlowReturn ret;
+    g_signal_emit_by_name(stream->source, "push-buffer", buffer, &ret);
+    gst_buffer_unref(buffer);
+}
+
+void QGstreamerCaptureSession::handlePreRollBuffer(GstElement *sink, GstBuffer *buffer, GstPad *, gpointer user_data)
+{
+    QGstreamerCaptureSession * const session = static_cast<QGstreamerCaptureSession *>(user_data);
+
+    QMutexLocker locker(&session->m_preRollMutex);
+    PreRollStream * const stream = sink == session->m_videoPreRoll.sink
+            ? &session->m_videoPreRoll
+            : &session->m_audioPreRoll;
+
+    if (stream->source) {
+        session->pushPreRollBuffer(stream, gst_buffer_ref(buffer));
+    } else {
+        stream->buffer.append(gst_buffer_ref(buffer));
+
+        // Keep the audio that goes with the oldest video key frame
+        if (stream == &session->m_videoPreRoll && !stream->buffer.isEmpty())
+            session->m_audioPreRoll.buffer.dropBefore(stream->buffer.startTime());
+    }
+}
+
+bool QGstreamerCaptureSession::linkEncodeBin(GstElement *tee, const char *padName, GstClockTimeDiff offset)
+{
+    if (!tee)
+        return false;
+
+    GstPad *teePad = gst_element_get_request_pad(tee, "src_%u");
+    if (!teePad)
+        return false;
+
+    if (tee == m_audioTee)
+        m_audioEncodePad = teePad;
+    else
+        m_videoEncodePad = teePad;
+
+    gst_pad_set_offset(teePad, -offset);
+
+    GstPad *sinkPad = gst_element_get_static_pad(m_encodeBin, padName);
+    const bool ok = sinkPad && gst_pad_link(teePad, sinkPad) == GST_PAD_LINK_OK;
+    if (sinkPad)
+        gst_object_unref(GST_OBJECT(sinkPad));
+
     return ok;
 }
 
+void QGstreamerCaptureSession::detachEncodeBin()
+{
+    m_detachingEncodeBin = true;
+
+    // The encode bin is removed once its file sink posts EOS, see processBusMessage()
+    GstElement *fileSink = m_encodeBin ? gst_bin_get_by_name(GST_BIN(m_encodeBin), "filesink") : 0;
+    if (!fileSink) {
+        finishEncodeBinDetach();
+        return;
+    }
+    gst_object_unref(GST_OBJECT(fileSink));
+
+    // The tees only reach the block probes while data flows
+    gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
+
+    if (m_captureMode & Audio)
+        blockEncodeBinPad(m_audioEncodePad, "audiosink");
+    if (m_captureMode & Video)
+        blockEncodeBinPad(m_videoEncodePad, "videosink");
+}
+
+void QGstreamerCaptureSession::blockEncodeBinPad(GstPad *&teePad, const char *padName)
+{
+    // An encode bin built by rebuildGraph() was linked without keeping the tee pads,
+    // hold on to them until the encode bin has been removed.
+    if (!teePad) {
+        GstPad *sinkPad = gst_element_get_static_pad(m_encodeBin, padName);
+        if (!sinkPad)
+            return;
+        teePad = gst_pad_get_peer(sinkPad);
+        gst_object_unref(GST_OBJECT(sinkPad));
+    }
+
+    if (teePad)
+        gst_pad_add_probe(teePad, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM, unlinkEncodeBinPad, 0, nullptr);
+}
+#endif
+
+void QGstreamerCaptureSession::releaseEncodeBinPads()
+{
+    if (m_audioEncodePad) {
+        if (m_audioTee)
+            gst_element_release_request_pad(m_audioTee, m_audioEncodePad);
+        gst_object_unref(GST_OBJECT(m_audioEncodePad));
+        m_audioEncodePad = 0;
+    }
+    if (m_videoEncodePad) {
+        if (m_videoTee)
+            gst_element_release_request_pad(m_videoTee, m_videoEncodePad);
+        gst_object_unref(GST_OBJECT(m_videoEncodePad));
+        m_videoEncodePad = 0;
+    }
+}
+
+// Used when no pre-roll buffer size is set, about a minute of 8 Mbit/s video
+static const qint64 DefaultPreRollBufferSize = 64 * 1024 * 1024;
+
+void QGstreamerCaptureSession::updatePreRollLimits()
+{
+    const qint64 size = m_preRollBufferSize > 0 ? m_preRollBufferSize : DefaultPreRollBufferSize;
+    const GstClockTime duration = m_preRollDuration * GST_MSECOND;
+
+    QMutexLocker locker(&m_preRollMutex);
+    if (m_captureMode & Video) {
+        // Audio is trimmed to the oldest video key frame, which may be older than the duration
+        m_audioPreRoll.buffer.setDuration(GST_CLOCK_TIME_NONE);
+        m_audioPreRoll.buffer.setMaxSize(size / 8);
+        m_videoPreRoll.buffer.setDuration(duration);
+        m_videoPreRoll.buffer.setMaxSize(size - size / 8);
+    } else {
+        m_audioPreRoll.buffer.setDuration(duration);
+        m_audioPreRoll.buffer.setMaxSize(size);
+    }
+}
+
+void QGstreamerCaptureSession::setPreRollDuration(qint64 milliseconds)
+{
+#if GST_CHECK_VERSION(1,0,0)
+    m_preRollDuration = qMax(qint64(0), milliseconds);
+    updatePreRollLimits();
+    updatePreRollEncodeBin();
+#else
+    Q_UNUSED(milliseconds);
+#endif
+}
+
+void QGstreamerCaptureSession::setPreRollBufferSize(qint64 bytes)
+{
+#if GST_CHECK_VERSION(1,0,0)
+    m_preRollBufferSize = qMax(qint64(0), bytes);
+    updatePreRollLimits();
+#else
+    Q_UNUSED(bytes);
+#endif
+}
+
+/*
+    Called once the recorder control applied new encoder settings.
+*/
+void QGstreamerCaptureSession::updatePreRollSettings()
+{
+#if GST_CHECK_VERSION(1,0,0)
+    updatePreRollEncodeBin();
+#endif
+}
+
+void QGstreamerCaptureSession::finishEncodeBinDetach()
+{
+    if (!m_detachingEncodeBin)
+        return;
+
+    m_detachingEncodeBin = false;
+
+    if (m_preRollMuxBin) {
+        // The pre-roll encoder keeps running for the next recording
+        gst_element_set_state(m_preRollMuxBin, GST_STATE_NULL);
+        REMOVE_ELEMENT(m_preRollMuxBin);
+        m_preRollBase = GST_CLOCK_TIME_NONE;
+    } else {
+        if (m_encodeBin)
+            gst_element_set_state(m_encodeBin, GST_STATE_NULL);
+        releaseEncodeBinPads();
+        REMOVE_ELEMENT(m_encodeBin);
+        m_audioVolume = 0;
+    }
+    m_pipelineMode = PreviewPipeline;
+
+    dumpGraph("encode_bin_detached");
+
+    // The preview kept running, so there's no pipeline state change to report this.
+    const State pendingState = m_pendingState;
+    m_pendingState = PreviewState;
+    if (m_state != PreviewState)
+        emit stateChanged(m_state = PreviewState);
+
+    if (pendingState != PreviewState)
+        setState(pendingState);
+#if GST_CHECK_VERSION(1,0,0)
+    else
+        updatePreRollEncodeBin();
+#endif
+}
+
 void QGstreamerCaptureSession::dumpGraph(const QString &fileName)
 {
 #ifdef QT_GST_CAPTURE_DEBUG
@@ -686,9 +1456,19 @@ bool QGstreamerCaptureSession::setOutputLocation(const QUrl& sink)
     }
 
     m_sink = sink;
+    m_actualLocation.clear();
     return true;
 }
 
+/*
+    The file the current recording is written to. A split recording starts in
+    its first segment, the following ones are reported through segmentFinished().
+*/
+QUrl QGstreamerCaptureSession::actualLocation() const
+{
+    return m_actualLocation.isEmpty() ? m_sink : m_actualLocation;
+}
+
 void QGstreamerCaptureSession::setAudioInput(QGstreamerElementFactory *audioInput)
 {
     m_audioInputFactory = audioInput;
@@ -763,6 +1543,10 @@ void QGstreamerCaptureSession::setState(QGstreamerCaptureSession::State newState
 
     m_pendingState = newState;
 
+    // The pending state is applied once the encode bin has finished its file
+    if (m_detachingEncodeBin)
+        return;
+
     PipelineMode newMode = EmptyPipeline;
 
     switch (newState) {
@@ -778,7 +1562,23 @@ void QGstreamerCaptureSession::setState(QGstreamerCaptureSession::State newState
             break;
     }
 
+    bool encodeBinAttached = false;
+
     if (newMode != m_pipelineMode) {
+#if GST_CHECK_VERSION(1,0,0)
+        if (m_preRollMuxBin) {
+            // Only the muxer gets EOS, the pre-roll encoder stays with the preview
+            stopPreRollRecording();
+            return;
+        }
+
+        if (m_pipelineMode == PreviewAndRecordingPipeline && newMode == PreviewPipeline
+                && !m_waitingForEos) {
+            // Finish the recording on its own while the preview keeps running
+            detachEncodeBin();
+            return;
+        }
+#endif
         if (m_pipelineMode == PreviewAndRecordingPipeline) {
             if (!m_waitingForEos) {
                 m_waitingForEos = true;
@@ -797,16 +1597,42 @@ void QGstreamerCaptureSession::setState(QGstreamerCaptureSession::State newState
         }
 
         //select suitable default codecs/containers, if necessary
-        m_recorderControl->applySettings();
+        m_recorderControl->resolveSettings();
+
+#if GST_CHECK_VERSION(1,0,0)
+        // Attach the encode bin to the running preview instead of restarting it
+        if (m_pipelineMode == PreviewPipeline && newMode == PreviewAndRecordingPipeline
+                && m_state == PreviewState) {
+            // A running pre-roll encoder only needs a muxer, its history goes first.
+            // One built with other settings is dropped and the recording starts now.
+            if (m_preRollEncoding && preRollSettingsChanged())
+                removePreRollEncodeBin();
+            if (m_preRollEncoding) {
+                encodeBinAttached = startPreRollRecording();
+                if (!encodeBinAttached)
+                    removePreRollEncodeBin();
+            }
+            if (!encodeBinAttached)
+                encodeBinAttached = attachEncodeBin();
+            if (encodeBinAttached)
+                m_pipelineMode = PreviewAndRecordingPipeline;
+        }
+#endif
 
-        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        if (!encodeBinAttached) {
+            gst_element_set_state(m_pipeline, GST_STATE_NULL);
 
-        if (!rebuildGraph(newMode)) {
-            m_pendingState = StoppedState;
-            m_state = StoppedState;
-            emit stateChanged(StoppedState);
+            if (!rebuildGraph(newMode)) {
+                m_pendingState = StoppedState;
+                m_state = StoppedState;
+                emit stateChanged(StoppedState);
 
-            return;
+                return;
+            }
+#if GST_CHECK_VERSION(1,0,0)
+            if (newMode == PreviewPipeline)
+                updatePreRollEncodeBin();
+#endif
         }
     }
 
@@ -824,8 +1650,13 @@ void QGstreamerCaptureSession::setState(QGstreamerCaptureSession::State newState
 
     //we have to do it here, since gstreamer will not emit bus messages any more
     if (newState == StoppedState) {
+        dropImageRequests();
         m_state = StoppedState;
         emit stateChanged(StoppedState);
+    } else if (encodeBinAttached && newState == RecordingState) {
+        //the pipeline was already playing
+        m_state = RecordingState;
+        emit stateChanged(RecordingState);
     }
 }
 
@@ -833,7 +1664,8 @@ void QGstreamerCaptureSession::setState(QGstreamerCaptureSession::State newState
 qint64 QGstreamerCaptureSession::duration() const
 {
     gint64 duration = 0;
-    if (m_encodeBin && qt_gst_element_query_position(m_encodeBin, GST_FORMAT_TIME, &duration))
+    GstElement *recordingBin = m_preRollMuxBin ? m_preRollMuxBin : m_encodeBin;
+    if (recordingBin && qt_gst_element_query_position(recordingBin, GST_FORMAT_TIME, &duration))
         return duration / 1000000;
     else
         return 0;
@@ -849,7 +1681,10 @@ void QGstreamerCaptureSession::setMetaData(const QMap<QByteArray, QVariant> &dat
     //qDebug() << "QGstreamerCaptureSession::setMetaData" << data;
     m_metaData = data;
 
-    if (m_encodeBin)
+    // The muxer is in the pre-roll mux bin while a pre-roll recording runs
+    if (m_preRollMuxBin)
+        QGstUtils::setMetaData(GST_BIN(m_preRollMuxBin), data);
+    else if (m_encodeBin)
         QGstUtils::setMetaData(GST_BIN(m_encodeBin), data);
 }
 
@@ -867,6 +1702,29 @@ bool QGstreamerCaptureSession::processBusMessage(const QGstreamerMessage &messag
             g_free (debug);
         }
 
+        if (GST_MESSAGE_TYPE(gm) == GST_MESSAGE_ELEMENT) {
+            const GstStructure *structure = gst_message_get_structure(gm);
+            if (gst_structure_has_name(structure, "splitmuxsink-fragment-closed")) {
+                if (const gchar *location = gst_structure_get_string(structure, "location"))
+                    emit segmentFinished(QUrl::fromLocalFile(QFile::decodeName(location)));
+            }
+#if GST_CHECK_VERSION(1,0,0)
+            else if (m_detachingEncodeBin && gst_structure_has_name(structure, "GstBinForwarded")) {
+                // Recording bins forward their children's messages. splitmuxsink only passes
+                // on its last EOS, so an EOS means all of the recording has been written.
+                GstElement *recordingBin = m_preRollMuxBin ? m_preRollMuxBin : m_encodeBin;
+                GstMessage *forwarded = 0;
+                if (GST_MESSAGE_SRC(gm) == GST_OBJECT_CAST(recordingBin))
+                    gst_structure_get(structure, "message", GST_TYPE_MESSAGE, &forwarded, NULL);
+                if (forwarded) {
+                    if (GST_MESSAGE_TYPE(forwarded) == GST_MESSAGE_EOS)
+                        finishEncodeBinDetach();
+                    gst_message_unref(forwarded);
+                }
+            }
+#endif
+        }
+
         if (GST_MESSAGE_SRC(gm) == GST_OBJECT_CAST(m_pipeline)) {
             switch (GST_MESSAGE_TYPE(gm))  {
             case GST_MESSAGE_DURATION:
@@ -44,6 +44,8 @@
 #include <qmediarecorder.h>
 
 #include <QtCore/qmutex.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qthreadpool.h>
 #include <QtCore/qurl.h>
 
 #include <gst/gst.h>
@@ -52,6 +54,8 @@
 #include <private/qgstreamerbushelper_p.h>
 #include <private/qgstreamerbufferprobe_p.h>
 
+#include "qgstreamerprerollbuffer.h"
+
 QT_BEGIN_NAMESPACE
 
 class QGstreamerMessage;
@@ -107,6 +111,7 @@ public:
 
     QUrl outputLocation() const;
     bool setOutputLocation(const QUrl& sink);
+    QUrl actualLocation() const;
 
     QGstreamerAudioEncode *audioEncodeControl() const { return m_audioEncodeControl; }
     QGstreamerVideoEncode *videoEncodeControl() const { return m_videoEncodeControl; }
@@ -127,7 +132,9 @@ public:
     QObject *videoPreview() const { return m_viewfinder; }
     void setVideoPreview(QObject *viewfinder);
 
-    void captureImage(int requestId, const QString &fileName);
+    bool captureImage(int requestId, const QString &fileName);
+    bool isImageQueueFull() const;
+    void cancelImageCapture();
 
     State state() const;
     State pendingState() const;
@@ -138,6 +145,17 @@ public:
 
     bool isReady() const;
 
+    qint64 preRollDuration() const { return m_preRollDuration; }
+    void setPreRollDuration(qint64 milliseconds);
+    qint64 preRollBufferSize() const { return m_preRollBufferSize; }
+    void setPreRollBufferSize(qint64 bytes);
+    void updatePreRollSettings();
+
+    qint64 segmentDuration() const { return m_segmentDuration; }
+    void setSegmentDuration(qint64 milliseconds) { m_segmentDuration = qMax(qint64(0), milliseconds); }
+    qint64 segmentSize() const { return m_segmentSize; }
+    void setSegmentSize(qint64 bytes) { m_segmentSize = qMax(qint64(0), bytes); }
+
     bool processBusMessage(const QGstreamerMessage &message) override;
 
     void addProbe(QGstreamerAudioProbeControl* probe);
@@ -147,9 +165,12 @@ signals:
     void stateChanged(QGstreamerCaptureSession::State state);
     void durationChanged(qint64 duration);
     void error(int error, const QString &errorString);
+    void segmentFinished(const QUrl &location);
     void imageExposed(int requestId);
     void imageCaptured(int requestId, const QImage &img);
     void imageSaved(int requestId, const QString &path);
+    void imageCaptureError(int requestId, int error, const QString &errorString);
+    void imageQueueFullChanged(bool full);
     void mutedChanged(bool);
     void volumeChanged(qreal);
     void readyChanged(bool);
@@ -171,7 +192,17 @@ private:
 
     enum PipelineMode { EmptyPipeline, PreviewPipeline, RecordingPipeline, PreviewAndRecordingPipeline };
 
-    GstElement *buildEncodeBin();
+    struct PreRollStream
+    {
+        QGstreamerPreRollBuffer buffer;
+        GstElement *sink = nullptr;     // fakesink at the end of the pre-roll encoder
+        GstElement *source = nullptr;   // appsrc feeding the muxer while recording
+        bool started = false;
+    };
+
+    GstElement *buildEncodeBin(bool preRoll = false);
+    GstElement *buildMuxer(GstElement *bin);
+    GstElement *buildPreRollSink(GstElement *bin, GstElement *encoder, PreRollStream *stream, const char *name);
     GstElement *buildAudioSrc();
     GstElement *buildAudioPreview();
     GstElement *buildVideoSrc();
@@ -179,12 +210,35 @@ private:
     GstElement *buildImageCapture();
 
     bool rebuildGraph(QGstreamerCaptureSession::PipelineMode newMode);
+#if GST_CHECK_VERSION(1,0,0)
+    bool attachEncodeBin(bool preRoll = false);
+    void updatePreRollEncodeBin();
+    bool preRollSettingsChanged() const;
+    void removePreRollEncodeBin();
+    GstElement *buildPreRollMuxBin();
+    bool startPreRollRecording();
+    void stopPreRollRecording();
+    void pushPreRollBuffer(PreRollStream *stream, GstBuffer *buffer);
+    static void handlePreRollBuffer(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer user_data);
+    bool linkEncodeBin(GstElement *tee, const char *padName, GstClockTimeDiff offset);
+    void detachEncodeBin();
+    void blockEncodeBinPad(GstPad *&teePad, const char *padName);
+#endif
+    void releaseEncodeBinPads();
+    void finishEncodeBinDetach();
+
+    static gboolean handleEncodedImage(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer user_data);
+    void saveImage(int requestId, const QString &fileName, GstBuffer *buffer);
+    void imageRequestsFinished(int count);
+    void dropImageRequests();
+    void updatePreRollLimits();
 
     GstPad *getAudioProbePad();
     void removeAudioBufferProbe();
     void addAudioBufferProbe();
 
     QUrl m_sink;
+    QUrl m_actualLocation;
     QString m_captureDevice;
     State m_state;
     State m_pendingState;
@@ -227,16 +281,41 @@ private:
     GstElement *m_imageCaptureBin;
 
     GstElement *m_encodeBin;
+    GstPad *m_audioEncodePad;
+    GstPad *m_videoEncodePad;
+    bool m_detachingEncodeBin;
+
+    qint64 m_preRollDuration;
+    qint64 m_preRollBufferSize;
+    bool m_preRollEncoding;
+    QAudioEncoderSettings m_preRollAudioSettings;
+    QVideoEncoderSettings m_preRollVideoSettings;
+    GstElement *m_preRollMuxBin;
+    GstClockTime m_preRollBase;
+    QMutex m_preRollMutex;
+    PreRollStream m_audioPreRoll;
+    PreRollStream m_videoPreRoll;
+
+    qint64 m_segmentDuration;
+    qint64 m_segmentSize;
 
 #if GST_CHECK_VERSION(1,0,0)
     GstVideoInfo m_previewInfo;
 #endif
 
-public:
-    bool m_passImage;
+    struct ImageRequest
+    {
+        int id;
+        QString fileName;
+    };
+
+    // Requests wait for a frame, then for the encoder, then for the writer
+    mutable QMutex m_imageMutex;
+    QQueue<ImageRequest> m_pendingImages;
+    QQueue<ImageRequest> m_encodingImages;
+    int m_queuedImageCount;
     bool m_passPrerollImage;
-    QString m_imageFileName;
-    int m_imageRequestId;
+    QThreadPool m_imageWriter;
 };
 
 QT_END_NAMESPACE
@@ -48,6 +48,8 @@ QGstreamerImageCaptureControl::QGstreamerImageCaptureControl(QGstreamerCaptureSe
     connect(m_session, SIGNAL(imageExposed(int)), this, SIGNAL(imageExposed(int)));
     connect(m_session, SIGNAL(imageCaptured(int,QImage)), this, SIGNAL(imageCaptured(int,QImage)));
     connect(m_session, SIGNAL(imageSaved(int,QString)), this, SIGNAL(imageSaved(int,QString)));
+    connect(m_session, SIGNAL(imageCaptureError(int,int,QString)), this, SIGNAL(error(int,int,QString)));
+    connect(m_session, SIGNAL(imageQueueFullChanged(bool)), SLOT(updateState()));
 }
 
 QGstreamerImageCaptureControl::~QGstreamerImageCaptureControl()
@@ -92,20 +94,26 @@ int QGstreamerImageCaptureControl::capture(const QString &fileName)
                                          QLatin1Char('0'));
     }
 
-    m_session->captureImage(m_lastId, path);
+    if (!m_session->captureImage(m_lastId, path)) {
+        QMetaObject::invokeMethod(this, "error", Qt::QueuedConnection,
+                                  Q_ARG(int, m_lastId),
+                                  Q_ARG(int, QCameraImageCapture::NotReadyError),
+                                  Q_ARG(QString,tr("Too many images are waiting to be saved")));
+    }
 
     return m_lastId;
 }
 
 void QGstreamerImageCaptureControl::cancelCapture()
 {
-
+    m_session->cancelImageCapture();
 }
 
 void QGstreamerImageCaptureControl::updateState()
 {
     bool ready = (m_session->state() == QGstreamerCaptureSession::PreviewState) &&
-            (m_session->captureMode() & QGstreamerCaptureSession::Image);
+            (m_session->captureMode() & QGstreamerCaptureSession::Image) &&
+            !m_session->isImageQueueFull();
 
     if (m_ready != ready) {
         emit readyForCaptureChanged(m_ready = ready);
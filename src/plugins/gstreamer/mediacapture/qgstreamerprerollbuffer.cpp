@@ -0,0 +1,206 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "qgstreamerprerollbuffer.h"
+
+QT_BEGIN_NAMESPACE
+
+static inline bool isKeyFrame(GstBuffer *buffer)
+{
+    return !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+}
+
+static inline qint64 bufferSize(GstBuffer *buffer)
+{
+#if GST_CHECK_VERSION(1,0,0)
+    return gst_buffer_get_size(buffer);
+#else
+    return GST_BUFFER_SIZE(buffer);
+#endif
+}
+
+QGstreamerPreRollBuffer::QGstreamerPreRollBuffer()
+    : m_duration(0)
+    , m_lastTime(GST_CLOCK_TIME_NONE)
+    , m_maxSize(0)
+    , m_size(0)
+{
+}
+
+QGstreamerPreRollBuffer::~QGstreamerPreRollBuffer()
+{
+    clear();
+}
+
+void QGstreamerPreRollBuffer::setDuration(GstClockTime duration)
+{
+    m_duration = duration;
+    trim();
+}
+
+void QGstreamerPreRollBuffer::setMaxSize(qint64 bytes)
+{
+    m_maxSize = bytes;
+    trim();
+}
+
+/*
+    Returns the presentation time of a buffer, or its decode time if the
+    presentation time is not known.
+*/
+GstClockTime QGstreamerPreRollBuffer::bufferTime(GstBuffer *buffer)
+{
+#if GST_CHECK_VERSION(1,0,0)
+    return GST_BUFFER_PTS_IS_VALID(buffer) ? GST_BUFFER_PTS(buffer) : GST_BUFFER_DTS(buffer);
+#else
+    return GST_BUFFER_TIMESTAMP(buffer);
+#endif
+}
+
+/*
+    Returns the earliest time stamp of the first buffer. With reordered frames
+    the key frame is decoded before it is presented.
+*/
+GstClockTime QGstreamerPreRollBuffer::startTime() const
+{
+    if (m_buffers.isEmpty())
+        return GST_CLOCK_TIME_NONE;
+
+    GstBuffer *buffer = m_buffers.head();
+#if GST_CHECK_VERSION(1,0,0)
+    if (GST_BUFFER_DTS_IS_VALID(buffer) && GST_BUFFER_PTS_IS_VALID(buffer))
+        return qMin(GST_BUFFER_DTS(buffer), GST_BUFFER_PTS(buffer));
+#endif
+    return bufferTime(buffer);
+}
+
+/*
+    Appends the buffer, taking over its reference. Delta frames are dropped
+    until there's a key frame to decode them from.
+*/
+void QGstreamerPreRollBuffer::append(GstBuffer *buffer)
+{
+    const bool keyFrame = isKeyFrame(buffer);
+    if (m_buffers.isEmpty() && !keyFrame) {
+        gst_buffer_unref(buffer);
+        return;
+    }
+
+    GstClockTime time = bufferTime(buffer);
+    if (!GST_CLOCK_TIME_IS_VALID(time))
+        time = m_lastTime;
+    if (GST_CLOCK_TIME_IS_VALID(time)
+            && (!GST_CLOCK_TIME_IS_VALID(m_lastTime) || time > m_lastTime)) {
+        m_lastTime = time;
+    }
+
+    if (keyFrame)
+        m_keyFrameTimes.enqueue(GST_CLOCK_TIME_IS_VALID(time) ? time : 0);
+
+    m_buffers.enqueue(buffer);
+    m_size += bufferSize(buffer);
+
+    trim();
+}
+
+/*
+    Drops the groups of pictures that end before the time, so another stream can
+    be aligned to the key frame this one starts with.
+*/
+void QGstreamerPreRollBuffer::dropBefore(GstClockTime time)
+{
+    while (m_keyFrameTimes.count() > 1 && m_keyFrameTimes.at(1) <= time)
+        dropFirstGroup();
+}
+
+/*
+    Returns the buffers in decode order and leaves the pre-roll empty. The
+    caller owns a reference to each buffer.
+*/
+QList<GstBuffer *> QGstreamerPreRollBuffer::takeBuffers()
+{
+    QList<GstBuffer *> buffers = m_buffers;
+    m_buffers.clear();
+    m_keyFrameTimes.clear();
+    m_lastTime = GST_CLOCK_TIME_NONE;
+    m_size = 0;
+    return buffers;
+}
+
+void QGstreamerPreRollBuffer::clear()
+{
+    for (GstBuffer *buffer : qAsConst(m_buffers))
+        gst_buffer_unref(buffer);
+
+    m_buffers.clear();
+    m_keyFrameTimes.clear();
+    m_lastTime = GST_CLOCK_TIME_NONE;
+    m_size = 0;
+}
+
+void QGstreamerPreRollBuffer::trim()
+{
+    // Only drop a group if what is left still covers the duration
+    while (m_keyFrameTimes.count() > 1) {
+        const GstClockTime nextKeyFrame = m_keyFrameTimes.at(1);
+        // Without any time stamp so far only the size limit applies
+        const bool covered = GST_CLOCK_TIME_IS_VALID(m_lastTime)
+                && m_lastTime >= nextKeyFrame && m_lastTime - nextKeyFrame >= m_duration;
+        const bool tooLarge = m_maxSize > 0 && m_size > m_maxSize;
+        if (!covered && !tooLarge)
+            break;
+        dropFirstGroup();
+    }
+
+    // A single group that doesn't fit can't be cut, start again at the next key frame
+    if (m_maxSize > 0 && m_size > m_maxSize)
+        clear();
+}
+
+void QGstreamerPreRollBuffer::dropFirstGroup()
+{
+    do {
+        GstBuffer *buffer = m_buffers.dequeue();
+        m_size -= bufferSize(buffer);
+        gst_buffer_unref(buffer);
+    } while (!m_buffers.isEmpty() && !isKeyFrame(m_buffers.head()));
+
+    m_keyFrameTimes.dequeue();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,93 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGSTREAMERPREROLLBUFFER_H
+#define QGSTREAMERPREROLLBUFFER_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qqueue.h>
+
+#include <gst/gst.h>
+
+QT_BEGIN_NAMESPACE
+
+// Holds the most recent encoded buffers of one stream, starting at a key frame.
+// Whole groups of pictures are dropped from the front once the rest still covers
+// the duration, or when the buffers take up more than the maximum size.
+class QGstreamerPreRollBuffer
+{
+public:
+    QGstreamerPreRollBuffer();
+    ~QGstreamerPreRollBuffer();
+
+    GstClockTime duration() const { return m_duration; }
+    void setDuration(GstClockTime duration);
+
+    qint64 maxSize() const { return m_maxSize; }
+    void setMaxSize(qint64 bytes);
+
+    bool isEmpty() const { return m_buffers.isEmpty(); }
+    int count() const { return m_buffers.count(); }
+    qint64 size() const { return m_size; }
+
+    GstClockTime startTime() const;
+    GstClockTime endTime() const { return m_lastTime; }
+
+    void append(GstBuffer *buffer);
+    void dropBefore(GstClockTime time);
+    QList<GstBuffer *> takeBuffers();
+    void clear();
+
+    static GstClockTime bufferTime(GstBuffer *buffer);
+
+private:
+    void trim();
+    void dropFirstGroup();
+
+    QQueue<GstBuffer *> m_buffers;
+    QQueue<GstClockTime> m_keyFrameTimes;
+    GstClockTime m_duration;
+    GstClockTime m_lastTime;
+    qint64 m_maxSize;
+    qint64 m_size;
+};
+
+QT_END_NAMESPACE
+
+#endif // QGSTREAMERPREROLLBUFFER_H
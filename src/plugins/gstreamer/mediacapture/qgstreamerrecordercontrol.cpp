@@ -56,6 +56,7 @@ QGstreamerRecorderControl::QGstreamerRecorderControl(QGstreamerCaptureSession *s
     connect(m_session, SIGNAL(durationChanged(qint64)), SIGNAL(durationChanged(qint64)));
     connect(m_session, SIGNAL(mutedChanged(bool)), SIGNAL(mutedChanged(bool)));
     connect(m_session, SIGNAL(volumeChanged(qreal)), SIGNAL(volumeChanged(qreal)));
+    connect(m_session, SIGNAL(segmentFinished(QUrl)), SIGNAL(segmentFinished(QUrl)));
     m_hasPreviewState = m_session->captureMode() != QGstreamerCaptureSession::Audio;
 }
 
@@ -174,7 +175,7 @@ void QGstreamerRecorderControl::record()
     emit stateChanged(m_state);
     updateStatus();
 
-    emit actualLocationChanged(m_session->outputLocation());
+    emit actualLocationChanged(m_session->actualLocation());
 }
 
 void QGstreamerRecorderControl::pause()
@@ -202,7 +203,10 @@ void QGstreamerRecorderControl::stop()
     m_state = QMediaRecorder::StoppedState;
 
     if (!m_hasPreviewState) {
-        m_session->setState(QGstreamerCaptureSession::StoppedState);
+        // Audio keeps being captured into the pre-roll between recordings
+        m_session->setState(m_session->preRollDuration() > 0
+                            ? QGstreamerCaptureSession::PreviewState
+                            : QGstreamerCaptureSession::StoppedState);
     } else {
         if (m_session->state() != QGstreamerCaptureSession::StoppedState)
             m_session->setState(QGstreamerCaptureSession::PreviewState);
@@ -211,7 +215,62 @@ void QGstreamerRecorderControl::stop()
     updateStatus();
 }
 
+qint64 QGstreamerRecorderControl::preRollDuration() const
+{
+    return m_session->preRollDuration();
+}
+
+void QGstreamerRecorderControl::setPreRollDuration(qint64 milliseconds)
+{
+    m_session->setPreRollDuration(milliseconds);
+
+    // Without a preview there is nothing capturing the pre-roll while stopped
+    if (!m_hasPreviewState && m_state == QMediaRecorder::StoppedState) {
+        m_session->setState(m_session->preRollDuration() > 0
+                            ? QGstreamerCaptureSession::PreviewState
+                            : QGstreamerCaptureSession::StoppedState);
+    }
+}
+
+qint64 QGstreamerRecorderControl::preRollBufferSize() const
+{
+    return m_session->preRollBufferSize();
+}
+
+void QGstreamerRecorderControl::setPreRollBufferSize(qint64 bytes)
+{
+    m_session->setPreRollBufferSize(bytes);
+}
+
+qint64 QGstreamerRecorderControl::segmentDuration() const
+{
+    return m_session->segmentDuration();
+}
+
+void QGstreamerRecorderControl::setSegmentDuration(qint64 milliseconds)
+{
+    m_session->setSegmentDuration(milliseconds);
+}
+
+qint64 QGstreamerRecorderControl::segmentSize() const
+{
+    return m_session->segmentSize();
+}
+
+void QGstreamerRecorderControl::setSegmentSize(qint64 bytes)
+{
+    m_session->setSegmentSize(bytes);
+}
+
 void QGstreamerRecorderControl::applySettings()
+{
+    resolveSettings();
+
+    // A running pre-roll encoder has to follow the new settings
+    m_session->updatePreRollSettings();
+}
+
+void QGstreamerRecorderControl::resolveSettings()
 {
     //Check the codecs are compatible with container,
     //and choose the compatible codecs/container if omitted
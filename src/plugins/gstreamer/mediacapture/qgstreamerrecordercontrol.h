@@ -68,6 +68,17 @@ public:
     qreal volume() const override;
 
     void applySettings() override;
+    void resolveSettings();
+
+    qint64 preRollDuration() const override;
+    void setPreRollDuration(qint64 milliseconds) override;
+    qint64 preRollBufferSize() const override;
+    void setPreRollBufferSize(qint64 bytes) override;
+
+    qint64 segmentDuration() const override;
+    void setSegmentDuration(qint64 milliseconds) override;
+    qint64 segmentSize() const override;
+    void setSegmentSize(qint64 bytes) override;
 
 public slots:
     void setState(QMediaRecorder::State state) override;
@@ -40,6 +40,7 @@
 #include "qopenslesaudiooutput.h"
 #include "qopenslesengine.h"
 #include <QDebug>
+#include <QThread>
 #include <qmath.h>
 
 #ifdef ANDROID
@@ -86,7 +87,8 @@ QOpenSLESAudioOutput::QOpenSLESAudioOutput(const QByteArray &device)
       m_processedBytes(0),
       m_availableBuffers(BUFFER_COUNT),
       m_eventMask(SL_PLAYEVENT_HEADATEND),
-      m_startRequiresInit(true)
+      m_startRequiresInit(true),
+      m_ringBuffer(nullptr)
 {
 #ifndef ANDROID
       m_streamType = -1;
@@ -99,6 +101,7 @@ QOpenSLESAudioOutput::QOpenSLESAudioOutput(const QByteArray &device)
 QOpenSLESAudioOutput::~QOpenSLESAudioOutput()
 {
     destroyPlayer();
+    delete m_ringBuffer;
 }
 
 QAudio::Error QOpenSLESAudioOutput::error() const
@@ -162,6 +165,13 @@ QIODevice *QOpenSLESAudioOutput::start()
     m_pullMode = false;
     m_processedBytes = 0;
     m_availableBuffers = BUFFER_COUNT;
+    // Nobody enqueues while stopped, the ring buffer can be swapped safely
+    if (m_ringBuffer && m_ringBuffer->size() != BUFFER_COUNT * m_bufferSize) {
+        delete m_ringBuffer;
+        m_ringBuffer = nullptr;
+    }
+    if (!m_ringBuffer)
+        m_ringBuffer = new QAudioRingBuffer(BUFFER_COUNT * m_bufferSize);
     m_audioSource = new SLIODevicePrivate(this);
     m_audioSource->open(QIODevice::WriteOnly | QIODevice::Unbuffered);
 
@@ -186,6 +196,9 @@ int QOpenSLESAudioOutput::bytesFree() const
     if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
         return 0;
 
+    if (!m_pullMode && m_ringBuffer)
+        return m_ringBuffer->free();
+
     return m_availableBuffers.loadAcquire() ? m_bufferSize : 0;
 }
 
@@ -386,9 +399,10 @@ void QOpenSLESAudioOutput::bufferAvailable(quint32 count, quint32 playIndex)
         return;
 
     if (!m_pullMode) { // We're in push mode.
-        // Signal that there is a new open slot in the buffer and return
-        const int val = m_availableBuffers.fetchAndAddRelease(1) + 1;
-        if (val == BUFFER_COUNT)
+        // Refill the slot that just opened up from what was pushed meanwhile
+        m_availableBuffers.fetchAndAddRelease(1);
+        enqueuePushedData();
+        if (m_availableBuffers.loadAcquire() == BUFFER_COUNT)
             QMetaObject::invokeMethod(this, "onEOSEvent", Qt::QueuedConnection);
 
         return;
@@ -645,6 +659,15 @@ void QOpenSLESAudioOutput::stopPlayer()
 
     if (m_bufferQueueItf && SL_RESULT_SUCCESS != (*m_bufferQueueItf)->Clear(m_bufferQueueItf))
         qWarning() << "Unable to clear buffer";
+
+    // A buffer queue callback that was already running may still be moving
+    // data, wait for it before dropping what is left in the ring buffer.
+    // The ring buffer itself is kept for the next start().
+    while (!m_enqueueing.testAndSetOrdered(0, 1))
+        QThread::yieldCurrentThread();
+    if (m_ringBuffer)
+        m_ringBuffer->reset();
+    m_enqueueing.storeRelease(0);
 }
 
 void QOpenSLESAudioOutput::startPlayer()
@@ -658,47 +681,57 @@ void QOpenSLESAudioOutput::startPlayer()
     }
 }
 
-qint64 QOpenSLESAudioOutput::writeData(const char *data, qint64 len)
+void QOpenSLESAudioOutput::enqueuePushedData()
 {
-    if (!len)
-        return 0;
-
-    if (len > m_bufferSize)
-        len = m_bufferSize;
-
-    // Acquire one slot in the buffer
-    const int before = m_availableBuffers.fetchAndAddAcquire(-1);
-
-    // If there where no vacant slots, then we just overdrew the buffer account...
-    if (before < 1) {
-        m_availableBuffers.fetchAndAddRelease(1);
-        return 0;
-    }
+    // Both the writing thread and the buffer queue callback come here, whoever
+    // holds m_enqueueing moves the data, the other one just leaves. The holder
+    // checks again after letting go, so nothing pushed meanwhile gets stuck.
+    do {
+        if (!m_enqueueing.testAndSetOrdered(0, 1))
+            return;
 
-    const int index = m_nextBuffer * m_bufferSize;
-    ::memcpy(m_buffers + index, data, len);
-    const SLuint32 res = (*m_bufferQueueItf)->Enqueue(m_bufferQueueItf,
-                                                      m_buffers + index,
-                                                      len);
+        if (!m_ringBuffer || m_state == QAudio::StoppedState) {
+            m_enqueueing.storeRelease(0);
+            return;
+        }
 
-    // If we where unable to enqueue a new buffer, give back the acquired slot.
-    if (res == SL_RESULT_BUFFER_INSUFFICIENT) {
-        m_availableBuffers.fetchAndAddRelease(1);
-        return 0;
-    }
+        bool failed = false;
+        while (m_ringBuffer->used() > 0 && m_availableBuffers.loadAcquire() > 0) {
+            const int index = m_nextBuffer * m_bufferSize;
+            const int len = m_ringBuffer->read(m_buffers + index, m_bufferSize);
+            m_availableBuffers.fetchAndAddAcquire(-1);
+
+            const SLuint32 res = (*m_bufferQueueItf)->Enqueue(m_bufferQueueItf,
+                                                              m_buffers + index,
+                                                              len);
+            if (res != SL_RESULT_SUCCESS) {
+                m_availableBuffers.fetchAndAddRelease(1);
+                qWarning() << "Unable to enqueue pushed audio data:" << res;
+                if (res != SL_RESULT_BUFFER_INSUFFICIENT) {
+                    QMetaObject::invokeMethod(this, [this] {
+                        setError(QAudio::FatalError);
+                        destroyPlayer();
+                    }, Qt::QueuedConnection);
+                }
+                failed = true;
+                break;
+            }
+
+            m_nextBuffer = (m_nextBuffer + 1) % BUFFER_COUNT;
+            QMetaObject::invokeMethod(this, "onBytesProcessed", Qt::QueuedConnection, Q_ARG(qint64, len));
+        }
 
-    if (res != SL_RESULT_SUCCESS) {
-        setError(QAudio::FatalError);
-        destroyPlayer();
-        return -1;
-    }
+        m_enqueueing.fetchAndStoreOrdered(0);
+        if (failed)
+            return;
+    } while (m_ringBuffer->used() > 0 && m_availableBuffers.loadAcquire() > 0);
+}
 
-    m_processedBytes += len;
+void QOpenSLESAudioOutput::dataPushed()
+{
+    enqueuePushedData();
     setState(QAudio::ActiveState);
     setError(QAudio::NoError);
-    m_nextBuffer = (m_nextBuffer + 1) % BUFFER_COUNT;
-
-    return len;
 }
 
 inline void QOpenSLESAudioOutput::setState(QAudio::State state)
@@ -46,6 +46,7 @@
 #include <qmap.h>
 #include <QElapsedTimer>
 #include <QIODevice>
+#include <private/qaudioringbuffer_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -96,7 +97,8 @@ private:
     void destroyPlayer();
     void stopPlayer();
     void startPlayer();
-    qint64 writeData(const char *data, qint64 len);
+    void enqueuePushedData();
+    void dataPushed();
 
     void setState(QAudio::State state);
     void setError(QAudio::Error error);
@@ -124,6 +126,8 @@ private:
     QAtomicInt m_availableBuffers;
     SLuint32 m_eventMask;
     bool m_startRequiresInit;
+    QAudioRingBuffer *m_ringBuffer;
+    QAtomicInt m_enqueueing;
 
     qint32 m_streamType;
     QElapsedTimer m_clockStamp;
@@ -132,26 +136,27 @@ private:
     static QMap<QString, qint32> m_categories;
 };
 
-class SLIODevicePrivate : public QIODevice
+class SLIODevicePrivate : public QAudioRingBufferDevice
 {
     Q_OBJECT
 
 public:
-    inline SLIODevicePrivate(QOpenSLESAudioOutput *audio) : m_audioDevice(audio) {}
+    inline SLIODevicePrivate(QOpenSLESAudioOutput *audio)
+        : QAudioRingBufferDevice(audio->m_ringBuffer), m_audioDevice(audio) {}
     inline ~SLIODevicePrivate() override {}
 
 protected:
-    inline qint64 readData(char *, qint64) override { return 0; }
-    inline qint64 writeData(const char *data, qint64 len) override;
+    inline void dataWritten(qint64 len) override;
 
 private:
     QOpenSLESAudioOutput *m_audioDevice;
 };
 
-qint64 SLIODevicePrivate::writeData(const char *data, qint64 len)
+void SLIODevicePrivate::dataWritten(qint64 len)
 {
+    Q_UNUSED(len);
     Q_ASSERT(m_audioDevice);
-    return m_audioDevice->writeData(data, len);
+    m_audioDevice->dataPushed();
 }
 
 QT_END_NAMESPACE
@@ -40,7 +40,7 @@
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qmath.h>
-#include <private/qaudiohelpers_p.h>
+#include <QtCore/qthread.h>
 
 #include "qaudiooutput_pulse.h"
 #include "qaudiodeviceinfo_pulse.h"
@@ -60,12 +60,20 @@ const int LowLatencyBufferSizeMs = 40;
 static void  outputStreamWriteCallback(pa_stream *stream, size_t length, void *userdata)
 {
     Q_UNUSED(stream);
-    Q_UNUSED(length);
-    Q_UNUSED(userdata);
+    ((QPulseAudioOutput*)userdata)->streamWriteCallback(length);
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
 }
 
+static void outputStreamWriteRetryCallback(pa_mainloop_api *api, pa_time_event *event,
+                                           const struct timeval *tv, void *userdata)
+{
+    Q_UNUSED(api);
+    Q_UNUSED(event);
+    Q_UNUSED(tv);
+    ((QPulseAudioOutput*)userdata)->streamWriteRetryCallback();
+}
+
 static void outputStreamStateCallback(pa_stream *stream, void *userdata)
 {
     Q_UNUSED(userdata);
@@ -169,6 +177,9 @@ QPulseAudioOutput::QPulseAudioOutput(const QByteArray &device)
     , m_audioBuffer(0)
     , m_resuming(false)
     , m_volume(1.0)
+    , m_callbackMode(false)
+    , m_ringBuffer(nullptr)
+    , m_writeRetry(nullptr)
 {
     connect(m_tickTimer, SIGNAL(timeout()), SLOT(userFeed()));
 }
@@ -216,6 +227,146 @@ void QPulseAudioOutput::streamUnderflowCallback()
     }
 }
 
+void QPulseAudioOutput::streamWriteCallback(size_t length)
+{
+    // Called on the mainloop thread with the mainloop locked
+    if (!m_callbackMode || !m_ringBuffer)
+        return;
+
+    const size_t frameSize = pa_frame_size(&m_spec);
+    size_t bytes = qMin(length, size_t(m_ringBuffer->used()));
+    bytes -= bytes % frameSize;
+    if (bytes < length) {
+        // Pulse does not ask again for what it already requested, come back
+        // for the rest once the ring buffer had a period to fill up
+        scheduleWriteRetry();
+        requestRefill();
+    }
+    if (bytes == 0)
+        return;
+
+    void *dest = nullptr;
+    size_t nbytes = bytes;
+    if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0 || !dest) {
+        qWarning("QAudioOutput(pulseaudio): pa_stream_begin_write, error = %s",
+                 pa_strerror(pa_context_errno(QPulseAudioEngine::instance()->context())));
+        return;
+    }
+    nbytes = qMin(nbytes, bytes);
+    nbytes -= nbytes % frameSize;
+    if (nbytes == 0) {
+        pa_stream_cancel_write(m_stream);
+        return;
+    }
+
+    m_ringBuffer->read(static_cast<char *>(dest), int(nbytes));
+    if (!m_volumeRamp.isUnity())
+        m_volumeRamp.process(m_format, dest, dest, int(nbytes));
+
+    if (pa_stream_write(m_stream, dest, nbytes, NULL, 0, PA_SEEK_RELATIVE) < 0) {
+        qWarning("QAudioOutput(pulseaudio): pa_stream_write, error = %s",
+                 pa_strerror(pa_context_errno(QPulseAudioEngine::instance()->context())));
+        return;
+    }
+    m_totalTimeValue += nbytes;
+
+    if (m_ringBuffer->used() < m_ringBuffer->size() / 2)
+        requestRefill();
+}
+
+void QPulseAudioOutput::requestRefill()
+{
+    // Only the pull mode source can be asked for more data
+    if (m_pullMode && m_refillPending.testAndSetRelaxed(0, 1))
+        QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+}
+
+void QPulseAudioOutput::scheduleWriteRetry()
+{
+    // Called on the mainloop thread with the mainloop locked
+    if (m_writeRetry) {
+        pa_context_rttime_restart(QPulseAudioEngine::instance()->context(), m_writeRetry,
+                                  pa_rtclock_now() + m_periodTime * PA_USEC_PER_MSEC);
+    }
+}
+
+void QPulseAudioOutput::streamWriteRetryCallback()
+{
+    // Called on the mainloop thread with the mainloop locked
+    if (!m_stream)
+        return;
+
+    const size_t writable = pa_stream_writable_size(m_stream);
+    if (writable != size_t(-1))
+        streamWriteCallback(writable);
+}
+
+void QPulseAudioOutput::refillRingBuffer()
+{
+    m_refillPending.storeRelaxed(0);
+
+    qint64 total = 0;
+    forever {
+        const QAudioRingBuffer::Region region = m_ringBuffer->acquireWriteRegion(m_ringBuffer->free());
+        if (region.second <= 0)
+            break;
+
+        const qint64 l = m_audioSource->read(region.first, region.second);
+        if (l <= 0 || !m_ringBuffer)
+            break;
+
+        m_ringBuffer->releaseWriteRegion(QAudioRingBuffer::Region(region.first, int(l)));
+        total += l;
+        if (l < region.second)
+            break;
+    }
+
+    if (total > 0) {
+        setError(QAudio::NoError);
+        setState(QAudio::ActiveState);
+    }
+}
+
+void QPulseAudioOutput::drainRingBuffer()
+{
+    // Timer driven push mode, this thread consumes the ring buffer.
+    // pa_stream_write() only takes whole frames.
+    const int frameSize = int(pa_frame_size(&m_spec));
+    while (m_ringBuffer) {
+        int bytes = qMin(m_ringBuffer->used(), streamBytesFree());
+        bytes -= bytes % frameSize;
+        if (bytes <= 0)
+            break;
+
+        QAudioRingBuffer::Region region = m_ringBuffer->acquireReadRegion(bytes);
+        if (region.second < frameSize) {
+            // A frame split by the end of the ring, reassemble it
+            m_ringBuffer->read(m_audioBuffer, frameSize);
+            if (write(m_audioBuffer, frameSize) <= 0)
+                break;
+            continue;
+        }
+
+        region.second -= region.second % frameSize;
+        const qint64 written = write(region.first, region.second);
+        if (written <= 0 || !m_ringBuffer)
+            break;
+        m_ringBuffer->releaseReadRegion(QAudioRingBuffer::Region(region.first, int(written)));
+    }
+}
+
+void QPulseAudioOutput::dataPushed()
+{
+    // In callback mode the mainloop thread picks the data up by itself
+    if (!m_callbackMode && QThread::currentThread() == thread())
+        drainRingBuffer(); // same thread as the tick timer, no need to wait for it
+
+    if (m_deviceState == QAudio::IdleState) {
+        setError(QAudio::NoError);
+        setState(QAudio::ActiveState);
+    }
+}
+
 void QPulseAudioOutput::start(QIODevice *device)
 {
     setState(QAudio::StoppedState);
@@ -379,6 +530,24 @@ bool QPulseAudioOutput::open()
     m_maxBufferSize = buffer->maxlength;
     m_audioBuffer = new char[m_maxBufferSize];
 
+    // Write from the mainloop thread as soon as Pulse asks for data, out of a ring
+    // buffer the application fills, instead of polling on m_tickTimer. Push mode
+    // always writes into the ring buffer, so producers never take the mainloop lock
+    // for a write. The price is that a request the ring buffer could not fully serve
+    // is only retried a period later by m_writeRetry, waking up the mainloop from a
+    // producer would need the lock again. Requests made while the stream got ready
+    // were not served yet, hence the retry is armed right away.
+    m_callbackMode = qEnvironmentVariableIntValue("QT_PA_OUTPUT_CALLBACK_MODE") > 0;
+    if (m_callbackMode || !m_pullMode) {
+        m_ringBuffer = new QAudioRingBuffer(m_bufferSize);
+        m_refillPending.storeRelaxed(0);
+    }
+    if (m_callbackMode) {
+        m_writeRetry = pa_context_rttime_new(pulseEngine->context(),
+                                             pa_rtclock_now() + m_periodTime * PA_USEC_PER_MSEC,
+                                             outputStreamWriteRetryCallback, this);
+    }
+
     const qint64 streamSize = m_audioSource ? m_audioSource->size() : 0;
     if (m_pullMode && streamSize > 0 && static_cast<qint64>(buffer->prebuf) > streamSize) {
         pa_buffer_attr newBufferAttr;
@@ -425,6 +594,11 @@ void QPulseAudioOutput::close()
     if (m_stream) {
         pulseEngine->lock();
 
+        if (m_writeRetry) {
+            pa_threaded_mainloop_get_api(pulseEngine->mainloop())->time_free(m_writeRetry);
+            m_writeRetry = nullptr;
+        }
+
         pa_stream_set_state_callback(m_stream, 0, 0);
         pa_stream_set_write_callback(m_stream, 0, 0);
         pa_stream_set_underflow_callback(m_stream, 0, 0);
@@ -442,6 +616,9 @@ void QPulseAudioOutput::close()
         pulseEngine->unlock();
     }
 
+    delete m_ringBuffer;
+    m_ringBuffer = nullptr;
+
     disconnect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioOutput::onPulseContextFailed);
 
     if (!m_pullMode && m_audioSource) {
@@ -462,8 +639,13 @@ void QPulseAudioOutput::userFeed()
 
     m_resuming = false;
 
-    if (m_pullMode) {
-        int writableSize = bytesFree();
+    if (m_callbackMode) {
+        if (m_pullMode)
+            refillRingBuffer();
+    } else if (!m_pullMode) {
+        drainRingBuffer();
+    } else {
+        int writableSize = streamBytesFree();
         int chunks = writableSize / m_periodSize;
         if (chunks == 0)
             return;
@@ -508,7 +690,7 @@ qint64 QPulseAudioOutput::write(const char *data, qint64 len)
 
     len = qMin(len, static_cast<qint64>(pa_stream_writable_size(m_stream)));
 
-    if (m_volume < 1.0f) {
+    if (!m_volumeRamp.isUnity()) {
         // Don't use PulseAudio volume, as it might affect all other streams of the same category
         // or even affect the system volume if flat volumes are enabled
         void *dest = NULL;
@@ -521,7 +703,7 @@ qint64 QPulseAudioOutput::write(const char *data, qint64 len)
         }
 
         len = int(nbytes);
-        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, dest, len);
+        m_volumeRamp.process(m_format, data, dest, len);
         data = reinterpret_cast<char *>(dest);
     }
 
@@ -553,6 +735,17 @@ void QPulseAudioOutput::stop()
 }
 
 int QPulseAudioOutput::bytesFree() const
+{
+    if (m_deviceState != QAudio::ActiveState && m_deviceState != QAudio::IdleState)
+        return 0;
+
+    if (m_ringBuffer)
+        return m_ringBuffer->free();
+
+    return streamBytesFree();
+}
+
+int QPulseAudioOutput::streamBytesFree() const
 {
     if (m_deviceState != QAudio::ActiveState && m_deviceState != QAudio::IdleState)
         return 0;
@@ -591,7 +784,18 @@ int QPulseAudioOutput::notifyInterval() const
 
 qint64 QPulseAudioOutput::processedUSecs() const
 {
-    qint64 result = qint64(1000000) * m_totalTimeValue /
+    qint64 totalTimeValue;
+    if (m_callbackMode) {
+        // Advanced by the write callback
+        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+        pulseEngine->lock();
+        totalTimeValue = m_totalTimeValue;
+        pulseEngine->unlock();
+    } else {
+        totalTimeValue = m_totalTimeValue;
+    }
+
+    qint64 result = qint64(1000000) * totalTimeValue /
         (m_format.channelCount() * (m_format.sampleSize() / 8)) /
         m_format.sampleRate();
 
@@ -669,36 +873,16 @@ void QPulseAudioOutput::reset()
 }
 
 PulseOutputPrivate::PulseOutputPrivate(QPulseAudioOutput *audio)
+    : QAudioRingBufferDevice(audio->m_ringBuffer)
 {
     m_audioDevice = qobject_cast<QPulseAudioOutput*>(audio);
 }
 
-qint64 PulseOutputPrivate::readData(char *data, qint64 len)
+void PulseOutputPrivate::dataWritten(qint64 len)
 {
-    Q_UNUSED(data);
     Q_UNUSED(len);
 
-    return 0;
-}
-
-qint64 PulseOutputPrivate::writeData(const char *data, qint64 len)
-{
-    int retry = 0;
-    qint64 written = 0;
-
-    if ((m_audioDevice->m_deviceState == QAudio::ActiveState
-         || m_audioDevice->m_deviceState == QAudio::IdleState)) {
-         while(written < len) {
-            int chunk = m_audioDevice->write(data+written, (len-written));
-            if (chunk <= 0)
-                retry++;
-            written+=chunk;
-            if (retry > 10)
-                return written;
-        }
-    }
-
-    return written;
+    m_audioDevice->dataPushed();
 }
 
 void QPulseAudioOutput::setVolume(qreal vol)
@@ -707,6 +891,20 @@ void QPulseAudioOutput::setVolume(qreal vol)
         return;
 
     m_volume = qBound(qreal(0), vol, qreal(1));
+
+    // The write callback applies the ramp on the mainloop thread
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    if (m_callbackMode)
+        pulseEngine->lock();
+
+    // Fade to the new volume while playing, a sudden jump is audible as a click
+    if (m_deviceState == QAudio::ActiveState)
+        m_volumeRamp.rampTo(m_volume);
+    else
+        m_volumeRamp.setVolume(m_volume);
+
+    if (m_callbackMode)
+        pulseEngine->unlock();
 }
 
 qreal QPulseAudioOutput::volume() const
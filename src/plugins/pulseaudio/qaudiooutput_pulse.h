@@ -62,6 +62,9 @@
 #include "qaudiodeviceinfo.h"
 #include "qaudiosystem.h"
 
+#include <private/qaudiohelpers_p.h>
+#include <private/qaudioringbuffer_p.h>
+
 #include <pulse/pulseaudio.h>
 
 QT_BEGIN_NAMESPACE
@@ -102,6 +105,8 @@ public:
 
 public:
     void streamUnderflowCallback();
+    void streamWriteCallback(size_t length);
+    void streamWriteRetryCallback();
 
 private:
     void setState(QAudio::State state);
@@ -111,6 +116,13 @@ private:
     void close();
     qint64 write(const char *data, qint64 len);
 
+    int streamBytesFree() const;
+    void refillRingBuffer();
+    void drainRingBuffer();
+    void requestRefill();
+    void scheduleWriteRetry();
+    void dataPushed();
+
 private Q_SLOTS:
     void userFeed();
     void onPulseContextFailed();
@@ -141,10 +153,17 @@ private:
     QString m_category;
 
     qreal m_volume;
+    QAudioHelperInternal::VolumeRamp m_volumeRamp;
     pa_sample_spec m_spec;
+
+    // Push mode and callback mode, see QT_PA_OUTPUT_CALLBACK_MODE
+    bool m_callbackMode;
+    QAudioRingBuffer *m_ringBuffer;
+    pa_time_event *m_writeRetry;
+    QAtomicInt m_refillPending;
 };
 
-class PulseOutputPrivate : public QIODevice
+class PulseOutputPrivate : public QAudioRingBufferDevice
 {
     friend class QPulseAudioOutput;
     Q_OBJECT
@@ -154,8 +173,7 @@ public:
     virtual ~PulseOutputPrivate() {}
 
 protected:
-    qint64 readData(char *data, qint64 len) override;
-    qint64 writeData(const char *data, qint64 len) override;
+    void dataWritten(qint64 len) override;
 
 private:
     QPulseAudioOutput *m_audioDevice;
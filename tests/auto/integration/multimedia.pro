@@ -1,5 +1,8 @@
 
 TEMPLATE = subdirs
+
+QT_FOR_CONFIG += multimedia-private
+
 SUBDIRS += \
     qaudiodecoderbackend \
     qaudiodeviceinfo \
@@ -10,6 +13,10 @@ SUBDIRS += \
     qsoundeffect \
     qsound
 
+# Drive the GStreamer sessions directly with GStreamer 1.0 test media
+qtConfig(gstreamer):!qtConfig(gstreamer_0_10): \
+    SUBDIRS += qgstreamercapturesession qgstreamerplayersession
+
 qtHaveModule(quick) {
     SUBDIRS += \
         qdeclarativevideooutput \
@@ -58,6 +58,8 @@ private slots:
     void unsupportedFileTest();
     void corruptedFileTest();
     void deviceTest();
+    void decodeThroughput_data();
+    void decodeThroughput();
 
 private:
     bool isWavSupported();
@@ -566,6 +568,77 @@ void tst_QAudioDecoderBackend::deviceTest()
     QCOMPARE(d.duration(), qint64(-1));
 }
 
+void tst_QAudioDecoderBackend::decodeThroughput_data()
+{
+    QTest::addColumn<int>("queueLimit");
+    QTest::addColumn<int>("framesPerBuffer");
+    QTest::addColumn<bool>("fastDecoding");
+
+    QTest::newRow("default") << 0 << 0 << false;
+    QTest::newRow("deep queue") << 32 << 0 << false;
+    QTest::newRow("fast") << 0 << 0 << true;
+    QTest::newRow("fast, 4096 frames") << 0 << 4096 << true;
+}
+
+void tst_QAudioDecoderBackend::decodeThroughput()
+{
+    if (!isWavSupported())
+        QSKIP("Sound format is not supported");
+
+    QFETCH(int, queueLimit);
+    QFETCH(int, framesPerBuffer);
+    QFETCH(bool, fastDecoding);
+
+    QAudioDecoder d;
+    if (d.error() == QAudioDecoder::ServiceMissingError)
+        QSKIP("There is no audio decoding support on this platform.");
+
+    d.setSourceFilename(QFileInfo(QFINDTESTDATA(TEST_FILE_NAME)).absoluteFilePath());
+    d.setBufferQueueLimit(queueLimit);
+    d.setFramesPerBuffer(framesPerBuffer);
+    d.setFastDecoding(fastDecoding);
+
+    qint64 duration = 0;
+    QList<int> frameCounts;
+    auto drain = [&d, &duration, &frameCounts]() {
+        while (d.bufferAvailable()) {
+            const QAudioBuffer buffer = d.read();
+            duration += buffer.duration();
+            frameCounts.append(buffer.frameCount());
+        }
+    };
+    connect(&d, &QAudioDecoder::bufferReady, this, drain);
+
+    QBENCHMARK {
+        duration = 0;
+        frameCounts.clear();
+
+        QEventLoop loop;
+        connect(&d, &QAudioDecoder::finished, &loop, &QEventLoop::quit);
+        connect(&d, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error),
+                &loop, &QEventLoop::quit);
+        QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+
+        d.start();
+        loop.exec();
+        drain();
+        d.stop();
+    }
+
+    QCOMPARE(d.error(), QAudioDecoder::NoError);
+    QVERIFY(qAbs(duration - 1000000) < 20000);
+
+    // Every buffer but the last holds exactly the requested frame count,
+    // backends without coalescing leave the property at 0
+    framesPerBuffer = d.framesPerBuffer();
+    if (framesPerBuffer > 0) {
+        QVERIFY(!frameCounts.isEmpty());
+        for (int i = 0; i < frameCounts.size() - 1; ++i)
+            QCOMPARE(frameCounts.at(i), framesPerBuffer);
+        QVERIFY(frameCounts.last() <= framesPerBuffer);
+    }
+}
+
 QTEST_MAIN(tst_QAudioDecoderBackend)
 
 #include "tst_qaudiodecoderbackend.moc"
@@ -0,0 +1,600 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qtemporarydir.h>
+
+#include <private/qgstreamerbushelper_p.h>
+#include <private/qgstutils_p.h>
+
+#include "qgstreamercapturesession.h"
+
+#include <gst/gst.h>
+
+// Live test sources, counting how often the session asks for a new one
+class TestAudioInput : public QGstreamerElementFactory
+{
+public:
+    GstElement *buildElement() override
+    {
+        ++buildCount;
+        return gst_parse_bin_from_description(
+                    "audiotestsrc is-live=true samplesperbuffer=441", TRUE, nullptr);
+    }
+
+    int buildCount = 0;
+};
+
+class TestVideoInput : public QGstreamerVideoInput
+{
+public:
+    GstElement *buildElement() override
+    {
+        ++buildCount;
+        element = gst_parse_bin_from_description(
+                    "videotestsrc is-live=true ! video/x-raw,width=320,height=240,framerate=30/1",
+                    TRUE, nullptr);
+        return element;
+    }
+
+    QList<qreal> supportedFrameRates(const QSize & = QSize()) const override
+    {
+        return QList<qreal>() << 30;
+    }
+
+    QList<QSize> supportedResolutions(qreal = -1) const override
+    {
+        return QList<QSize>() << QSize(320, 240);
+    }
+
+    GstElement *element = nullptr;
+    int buildCount = 0;
+};
+
+// Running time of the pipeline, the time base of the live sources' timestamps
+static qint64 runningTime(GstElement *pipeline)
+{
+    GstClock *clock = gst_element_get_clock(pipeline);
+    if (!clock)
+        return -1;
+    const qint64 time = GST_CLOCK_DIFF(gst_element_get_base_time(pipeline), gst_clock_get_time(clock));
+    gst_object_unref(clock);
+    return time;
+}
+
+// Timestamps of the buffers reaching the preview sink and the encode bin,
+// and the wall clock times they arrived at for sanity checks
+class BufferTimes
+{
+public:
+    BufferTimes() { m_clock.start(); }
+
+    qint64 now() const { return m_clock.nsecsElapsed(); }
+
+    void previewBuffer(GstBuffer *buffer)
+    {
+        const qint64 time = now();
+        QMutexLocker locker(&m_mutex);
+        if (m_lastPreview >= 0)
+            m_maxPreviewGap = qMax(m_maxPreviewGap, time - m_lastPreview);
+        m_lastPreview = time;
+        ++m_previewCount;
+
+        if (!GST_BUFFER_PTS_IS_VALID(buffer))
+            return;
+        const qint64 pts = GST_BUFFER_PTS(buffer);
+        if (m_lastPreviewPts >= 0) {
+            m_previewRestarted |= pts <= m_lastPreviewPts;
+            m_maxPreviewPtsGap = qMax(m_maxPreviewPtsGap, pts - m_lastPreviewPts);
+        }
+        m_lastPreviewPts = pts;
+    }
+
+    void encodeBuffer(GstBuffer *buffer)
+    {
+        const qint64 time = now();
+        QMutexLocker locker(&m_mutex);
+        if (m_firstEncode < 0) {
+            m_firstEncode = time;
+            m_firstEncodePts = GST_BUFFER_PTS_IS_VALID(buffer) ? qint64(GST_BUFFER_PTS(buffer)) : -1;
+        }
+    }
+
+    void resetPreviewGap()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_maxPreviewGap = 0;
+        m_maxPreviewPtsGap = 0;
+    }
+
+    qint64 maxPreviewGap() const { QMutexLocker locker(&m_mutex); return m_maxPreviewGap; }
+    qint64 maxPreviewPtsGap() const { QMutexLocker locker(&m_mutex); return m_maxPreviewPtsGap; }
+    bool previewRestarted() const { QMutexLocker locker(&m_mutex); return m_previewRestarted; }
+    int previewCount() const { QMutexLocker locker(&m_mutex); return m_previewCount; }
+    qint64 firstEncode() const { QMutexLocker locker(&m_mutex); return m_firstEncode; }
+    qint64 firstEncodePts() const { QMutexLocker locker(&m_mutex); return m_firstEncodePts; }
+
+private:
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    qint64 m_lastPreview = -1;
+    qint64 m_maxPreviewGap = 0;
+    qint64 m_lastPreviewPts = -1;
+    qint64 m_maxPreviewPtsGap = 0;
+    bool m_previewRestarted = false;
+    qint64 m_firstEncode = -1;
+    qint64 m_firstEncodePts = -1;
+    int m_previewCount = 0;
+};
+
+static GstPadProbeReturn previewProbe(GstPad *, GstPadProbeInfo *info, gpointer user_data)
+{
+    static_cast<BufferTimes *>(user_data)->previewBuffer(GST_PAD_PROBE_INFO_BUFFER(info));
+    return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn encodeProbe(GstPad *, GstPadProbeInfo *info, gpointer user_data)
+{
+    static_cast<BufferTimes *>(user_data)->encodeBuffer(GST_PAD_PROBE_INFO_BUFFER(info));
+    return GST_PAD_PROBE_REMOVE;
+}
+
+static void probeElementPad(GstElement *element, const char *padName,
+                            GstPadProbeCallback callback, BufferTimes *times)
+{
+    if (GstPad *pad = gst_element_get_static_pad(element, padName)) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, callback, times, nullptr);
+        gst_object_unref(pad);
+    }
+}
+
+// The encode bin is added with its ghost pads in place but before it is linked,
+// so the probe can't miss the first recorded buffer.
+static void encodeBinAdded(GstBin *, GstElement *element, gpointer user_data)
+{
+    gchar *name = gst_element_get_name(element);
+    if (qstrcmp(name, "encode-bin") == 0)
+        probeElementPad(element, "videosink", encodeProbe, static_cast<BufferTimes *>(user_data));
+    g_free(name);
+}
+
+// Timestamps of the buffers pushed into the recording from the pre-roll. The
+// recording is rebased to start at zero, so a buffer's timestamp minus the
+// running time elapsed since record() is how far before record() the
+// recording starts.
+class PreRollTimes
+{
+public:
+    void start(GstElement *pipeline)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pipeline = pipeline;
+        m_recordTime = runningTime(pipeline);
+    }
+
+    void pushed(GstClockTime time)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_recordTime >= 0) {
+            const qint64 elapsed = runningTime(m_pipeline) - m_recordTime;
+            m_maxLead = qMax(m_maxLead, qint64(time) - elapsed);
+        }
+        ++m_count;
+    }
+
+    qint64 maxLead() const { QMutexLocker locker(&m_mutex); return m_maxLead; }
+    int count() const { QMutexLocker locker(&m_mutex); return m_count; }
+
+private:
+    mutable QMutex m_mutex;
+    GstElement *m_pipeline = nullptr;
+    qint64 m_recordTime = -1;
+    qint64 m_maxLead = -1;
+    int m_count = 0;
+};
+
+static GstPadProbeReturn preRollProbe(GstPad *, GstPadProbeInfo *info, gpointer user_data)
+{
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (GST_BUFFER_PTS_IS_VALID(buffer))
+        static_cast<PreRollTimes *>(user_data)->pushed(GST_BUFFER_PTS(buffer));
+    return GST_PAD_PROBE_OK;
+}
+
+static void preRollMuxBinAdded(GstBin *, GstElement *element, gpointer user_data)
+{
+    gchar *name = gst_element_get_name(element);
+    if (qstrcmp(name, "preroll-mux-bin") == 0) {
+        if (GstElement *source = gst_bin_get_by_name(GST_BIN(element), "video-preroll-src")) {
+            GstPad *pad = gst_element_get_static_pad(source, "src");
+            gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, preRollProbe, user_data, nullptr);
+            gst_object_unref(pad);
+            gst_object_unref(source);
+        }
+    }
+    g_free(name);
+}
+
+// Running times at which splitmuxsink opened and closed its segments. A segment
+// opens where the previous one was closed if no media was dropped in between.
+class SegmentTimes : public QObject, public QGstreamerBusMessageFilter
+{
+    Q_OBJECT
+    Q_INTERFACES(QGstreamerBusMessageFilter)
+
+public:
+    bool processBusMessage(const QGstreamerMessage &message) override
+    {
+        GstMessage *gm = message.rawMessage();
+        if (GST_MESSAGE_TYPE(gm) != GST_MESSAGE_ELEMENT)
+            return false;
+
+        const GstStructure *structure = gst_message_get_structure(gm);
+        GstClockTime time = GST_CLOCK_TIME_NONE;
+        if (gst_structure_has_name(structure, "splitmuxsink-fragment-opened")
+                && gst_structure_get_clock_time(structure, "running-time", &time)) {
+            opened.append(time);
+        } else if (gst_structure_has_name(structure, "splitmuxsink-fragment-closed")
+                && gst_structure_get_clock_time(structure, "running-time", &time)) {
+            closed.append(time);
+        }
+        return false;
+    }
+
+    QList<qint64> opened;
+    QList<qint64> closed;
+};
+
+class tst_QGstreamerCaptureSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QGstreamerCaptureSession()
+    {
+        QGstUtils::initializeGst();
+    }
+
+private slots:
+    void recordWithoutRestartingPreview();
+    void preRollRecording();
+    void segmentedRecording();
+    void burstImageCapture();
+};
+
+// One frame at the test sources' 30 frames per second
+static const qint64 FrameInterval = 1000000000 / 30;
+
+void tst_QGstreamerCaptureSession::recordWithoutRestartingPreview()
+{
+    GstElementFactory *factory = gst_element_factory_find("videotestsrc");
+    if (!factory)
+        QSKIP("videotestsrc is not available");
+    gst_object_unref(factory);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    TestAudioInput audioInput;
+    TestVideoInput videoInput;
+    BufferTimes times;
+
+    QGstreamerCaptureSession session(QGstreamerCaptureSession::AudioAndVideo, nullptr);
+    session.setAudioInput(&audioInput);
+    session.setVideoInput(&videoInput);
+    QVERIFY(session.setOutputLocation(QUrl::fromLocalFile(dir.filePath("recording.mkv"))));
+
+    QSignalSpy errorSpy(&session, SIGNAL(error(int,QString)));
+
+    session.setState(QGstreamerCaptureSession::PreviewState);
+    QTRY_VERIFY(session.state() == QGstreamerCaptureSession::PreviewState || !errorSpy.isEmpty());
+    if (!errorSpy.isEmpty())
+        QSKIP("The preview pipeline could not be built");
+
+    // The source's parent is the session's pipeline
+    GstElement *pipeline = GST_ELEMENT_PARENT(videoInput.element);
+    QVERIFY(pipeline);
+    GstElement *preview = gst_bin_get_by_name(GST_BIN(pipeline), "video-preview");
+    QVERIFY(preview);
+    probeElementPad(preview, "sink", previewProbe, &times);
+    gst_object_unref(preview);
+    const gulong addedHandler = g_signal_connect(
+                pipeline, "element-added", G_CALLBACK(encodeBinAdded), &times);
+
+    QTRY_VERIFY(times.previewCount() > 10);
+    times.resetPreviewGap();
+
+    const qint64 recordTime = times.now();
+    const qint64 recordRunningTime = runningTime(pipeline);
+    QVERIFY(recordRunningTime >= 0);
+    session.setState(QGstreamerCaptureSession::RecordingState);
+    if (!errorSpy.isEmpty())
+        QSKIP("No suitable encoders are available");
+    QCOMPARE(session.state(), QGstreamerCaptureSession::RecordingState);
+
+    // The encode bin joined the running preview, so the first recorded frame was
+    // captured around record(). A restarted pipeline would start over at zero.
+    QTRY_VERIFY(times.firstEncode() >= 0);
+    const qint64 firstFrameOffset = times.firstEncodePts() - recordRunningTime;
+    QVERIFY2(qAbs(firstFrameOffset) < 2 * FrameInterval, qPrintable(QString::number(firstFrameOffset)));
+    // Only a sanity bound, scheduling may delay the first buffer
+    QVERIFY(times.firstEncode() - recordTime < 1000 * qint64(GST_MSECOND));
+    QCOMPARE(videoInput.buildCount, 1);
+    QCOMPARE(audioInput.buildCount, 1);
+
+    QTest::qWait(1000);
+    QVERIFY(session.duration() > 0);
+
+    session.setState(QGstreamerCaptureSession::PreviewState);
+    QTRY_COMPARE(session.state(), QGstreamerCaptureSession::PreviewState);
+    g_signal_handler_disconnect(pipeline, addedHandler);
+
+    const int previewCount = times.previewCount();
+    QTRY_VERIFY(times.previewCount() > previewCount + 10);
+
+    // The preview kept its timeline and did not lose frames, and it never
+    // stalled noticeably on the wall clock
+    QVERIFY(!times.previewRestarted());
+    QVERIFY(times.maxPreviewPtsGap() < 2 * FrameInterval);
+    QVERIFY(times.maxPreviewGap() < 500 * qint64(GST_MSECOND));
+    QCOMPARE(videoInput.buildCount, 1);
+    QCOMPARE(audioInput.buildCount, 1);
+    QVERIFY(errorSpy.isEmpty());
+
+    QVERIFY(QFileInfo(dir.filePath("recording.mkv")).size() > 0);
+
+    session.setState(QGstreamerCaptureSession::StoppedState);
+    QCOMPARE(session.state(), QGstreamerCaptureSession::StoppedState);
+}
+
+void tst_QGstreamerCaptureSession::preRollRecording()
+{
+    GstElementFactory *factory = gst_element_factory_find("videotestsrc");
+    if (!factory)
+        QSKIP("videotestsrc is not available");
+    gst_object_unref(factory);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    TestAudioInput audioInput;
+    TestVideoInput videoInput;
+    PreRollTimes times;
+
+    QGstreamerCaptureSession session(QGstreamerCaptureSession::AudioAndVideo, nullptr);
+    session.setAudioInput(&audioInput);
+    session.setVideoInput(&videoInput);
+    QVERIFY(session.setOutputLocation(QUrl::fromLocalFile(dir.filePath("recording.mkv"))));
+
+    session.setPreRollDuration(1000);
+    QCOMPARE(session.preRollDuration(), qint64(1000));
+
+    QSignalSpy errorSpy(&session, SIGNAL(error(int,QString)));
+
+    session.setState(QGstreamerCaptureSession::PreviewState);
+    QTRY_VERIFY(session.state() == QGstreamerCaptureSession::PreviewState || !errorSpy.isEmpty());
+    if (!errorSpy.isEmpty())
+        QSKIP("The preview pipeline could not be built");
+
+    GstElement *pipeline = GST_ELEMENT_PARENT(videoInput.element);
+    QVERIFY(pipeline);
+    const gulong addedHandler = g_signal_connect(
+                pipeline, "element-added", G_CALLBACK(preRollMuxBinAdded), &times);
+
+    // Let the pre-roll fill up
+    QTest::qWait(2000);
+    if (!errorSpy.isEmpty())
+        QSKIP("No suitable encoders are available");
+
+    times.start(pipeline);
+    session.setState(QGstreamerCaptureSession::RecordingState);
+    QCOMPARE(session.state(), QGstreamerCaptureSession::RecordingState);
+
+    // The recording starts with the buffered second, so its timestamps run ahead
+    // of the live running time since record() by about the pre-roll duration
+    QTRY_VERIFY(times.count() > 0);
+    QTRY_VERIFY(times.maxLead() >= 900 * qint64(GST_MSECOND));
+    QVERIFY(times.maxLead() < 3000 * qint64(GST_MSECOND));
+    QCOMPARE(videoInput.buildCount, 1);
+
+    QTest::qWait(500);
+    QVERIFY(session.duration() > 1000);
+
+    session.setState(QGstreamerCaptureSession::PreviewState);
+    QTRY_COMPARE(session.state(), QGstreamerCaptureSession::PreviewState);
+    g_signal_handler_disconnect(pipeline, addedHandler);
+    QVERIFY(errorSpy.isEmpty());
+
+    QVERIFY(QFileInfo(dir.filePath("recording.mkv")).size() > 0);
+
+    session.setState(QGstreamerCaptureSession::StoppedState);
+    QCOMPARE(session.state(), QGstreamerCaptureSession::StoppedState);
+}
+
+void tst_QGstreamerCaptureSession::segmentedRecording()
+{
+    GstElementFactory *factory = gst_element_factory_find("videotestsrc");
+    if (!factory)
+        QSKIP("videotestsrc is not available");
+    gst_object_unref(factory);
+    factory = gst_element_factory_find("splitmuxsink");
+    if (!factory)
+        QSKIP("splitmuxsink is not available");
+    gst_object_unref(factory);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    TestAudioInput audioInput;
+    TestVideoInput videoInput;
+    SegmentTimes segmentTimes;
+
+    QGstreamerCaptureSession session(QGstreamerCaptureSession::AudioAndVideo, nullptr);
+    session.setAudioInput(&audioInput);
+    session.setVideoInput(&videoInput);
+    QVERIFY(session.setOutputLocation(QUrl::fromLocalFile(dir.filePath("recording.mkv"))));
+    session.setSegmentDuration(500);
+
+    QSignalSpy errorSpy(&session, SIGNAL(error(int,QString)));
+    QSignalSpy segmentSpy(&session, SIGNAL(segmentFinished(QUrl)));
+    session.bus()->installMessageFilter(&segmentTimes);
+
+    session.setState(QGstreamerCaptureSession::PreviewState);
+    QTRY_VERIFY(session.state() == QGstreamerCaptureSession::PreviewState || !errorSpy.isEmpty());
+    if (!errorSpy.isEmpty())
+        QSKIP("The preview pipeline could not be built");
+
+    session.setState(QGstreamerCaptureSession::RecordingState);
+    if (!errorSpy.isEmpty())
+        QSKIP("No suitable encoders are available");
+    QCOMPARE(session.state(), QGstreamerCaptureSession::RecordingState);
+    QCOMPARE(session.actualLocation(), QUrl::fromLocalFile(dir.filePath("recording_00000.mkv")));
+
+    // Segments are finished while recording continues
+    QTRY_VERIFY_WITH_TIMEOUT(!segmentSpy.isEmpty(), 3000);
+    QCOMPARE(session.state(), QGstreamerCaptureSession::RecordingState);
+
+    // Stopping finishes the last segment too
+    const int finishedWhileRecording = segmentSpy.count();
+    session.setState(QGstreamerCaptureSession::PreviewState);
+    QTRY_COMPARE(session.state(), QGstreamerCaptureSession::PreviewState);
+    QVERIFY(segmentSpy.count() > finishedWhileRecording);
+    QVERIFY(errorSpy.isEmpty());
+    QCOMPARE(videoInput.buildCount, 1);
+
+    for (int i = 0; i < segmentSpy.count(); ++i) {
+        const QString fileName = dir.filePath(QString::asprintf("recording_%05d.mkv", i));
+        QCOMPARE(segmentSpy.at(i).at(0).toUrl(), QUrl::fromLocalFile(fileName));
+        QVERIFY(QFileInfo(fileName).size() > 0);
+    }
+    QVERIFY(!QFileInfo::exists(dir.filePath("recording.mkv")));
+
+    // Each segment continues the timeline where the previous one ended
+    QTRY_COMPARE(segmentTimes.closed.count(), segmentSpy.count());
+    QCOMPARE(segmentTimes.opened.count(), segmentTimes.closed.count());
+    for (int i = 0; i < segmentTimes.closed.count(); ++i) {
+        QVERIFY(segmentTimes.closed.at(i) > segmentTimes.opened.at(i));
+        if (i > 0) {
+            const qint64 gap = segmentTimes.opened.at(i) - segmentTimes.closed.at(i - 1);
+            QVERIFY2(qAbs(gap) <= FrameInterval, qPrintable(QString::number(gap)));
+        }
+    }
+
+    session.setState(QGstreamerCaptureSession::StoppedState);
+    QCOMPARE(session.state(), QGstreamerCaptureSession::StoppedState);
+}
+
+void tst_QGstreamerCaptureSession::burstImageCapture()
+{
+    GstElementFactory *factory = gst_element_factory_find("videotestsrc");
+    if (!factory)
+        QSKIP("videotestsrc is not available");
+    gst_object_unref(factory);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    TestVideoInput videoInput;
+
+    QGstreamerCaptureSession session(QGstreamerCaptureSession::CaptureMode(
+                QGstreamerCaptureSession::Video | QGstreamerCaptureSession::Image), nullptr);
+    session.setVideoInput(&videoInput);
+
+    QSignalSpy errorSpy(&session, SIGNAL(error(int,QString)));
+    QSignalSpy capturedSpy(&session, SIGNAL(imageCaptured(int,QImage)));
+    QSignalSpy savedSpy(&session, SIGNAL(imageSaved(int,QString)));
+    QSignalSpy captureErrorSpy(&session, SIGNAL(imageCaptureError(int,int,QString)));
+
+    session.setState(QGstreamerCaptureSession::PreviewState);
+    QTRY_VERIFY(session.state() == QGstreamerCaptureSession::PreviewState || !errorSpy.isEmpty());
+    if (!errorSpy.isEmpty())
+        QSKIP("The preview pipeline could not be built");
+
+    // Every request in a burst keeps its own id and file name
+    const int burstSize = 5;
+    for (int i = 0; i < burstSize; ++i)
+        QVERIFY(session.captureImage(i + 1, dir.filePath(QString::asprintf("image_%d.jpg", i + 1))));
+
+    QTRY_COMPARE(savedSpy.count(), burstSize);
+    QCOMPARE(capturedSpy.count(), burstSize);
+    QVERIFY(captureErrorSpy.isEmpty());
+
+    for (int i = 0; i < burstSize; ++i) {
+        const QString fileName = dir.filePath(QString::asprintf("image_%d.jpg", i + 1));
+        QCOMPARE(capturedSpy.at(i).at(0).toInt(), i + 1);
+        QCOMPARE(savedSpy.at(i).at(0).toInt(), i + 1);
+        QCOMPARE(savedSpy.at(i).at(1).toString(), fileName);
+        QVERIFY(QFileInfo(fileName).size() > 0);
+    }
+
+    // Requests beyond the queue limit are refused instead of being lost
+    QVERIFY(!session.isImageQueueFull());
+    int accepted = 0;
+    while (session.captureImage(100 + accepted, dir.filePath(QString::asprintf("queued_%d.jpg", accepted))))
+        ++accepted;
+    QVERIFY(accepted > burstSize);
+    QVERIFY(session.isImageQueueFull());
+    QTRY_COMPARE(savedSpy.count(), burstSize + accepted);
+    QVERIFY(!session.isImageQueueFull());
+
+    // Unwritable locations are reported per request
+    QVERIFY(session.captureImage(1000, dir.filePath("missing/image.jpg")));
+    QTRY_COMPARE(captureErrorSpy.count(), 1);
+    QCOMPARE(captureErrorSpy.at(0).at(0).toInt(), 1000);
+
+    // Each request takes its own frame, so cancelling right away drops most of
+    // a full queue. Requests which already have a frame are still saved.
+    savedSpy.clear();
+    captureErrorSpy.clear();
+    int cancelled = 0;
+    while (session.captureImage(2000 + cancelled, dir.filePath(QString::asprintf("cancelled_%d.jpg", cancelled))))
+        ++cancelled;
+    QVERIFY(session.isImageQueueFull());
+    session.cancelImageCapture();
+    QTRY_VERIFY(!session.isImageQueueFull());
+    QTest::qWait(1000);
+    QVERIFY(savedSpy.count() < cancelled);
+    QVERIFY(captureErrorSpy.isEmpty());
+
+    // Stopping fails the requests which are not written yet, nothing is left queued
+    savedSpy.clear();
+    for (int i = 0; i < burstSize; ++i)
+        QVERIFY(session.captureImage(3000 + i, dir.filePath(QString::asprintf("stopped_%d.jpg", i))));
+    session.setState(QGstreamerCaptureSession::StoppedState);
+    QCOMPARE(session.state(), QGstreamerCaptureSession::StoppedState);
+    QTRY_COMPARE(savedSpy.count() + captureErrorSpy.count(), burstSize);
+    QVERIFY(!captureErrorSpy.isEmpty());
+    QVERIFY(!session.isImageQueueFull());
+}
+
+QTEST_MAIN(tst_QGstreamerCaptureSession)
+
+#include "tst_qgstreamercapturesession.moc"
@@ -0,0 +1,9 @@
+CONFIG += testcase
+TARGET = tst_qgstreamerplayersession
+
+QT += multimedia-private multimediagsttools-private network testlib
+
+QMAKE_USE += gstreamer
+
+SOURCES += \
+    tst_qgstreamerplayersession.cpp
@@ -0,0 +1,147 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtCore/qtemporarydir.h>
+
+#include <private/qgstreamerplayersession_p.h>
+#include <private/qgstutils_p.h>
+
+#include <gst/gst.h>
+
+// Writes a seekable WAV file of \a seconds of a test tone
+static bool writeTestFile(const QString &fileName, int seconds)
+{
+    const QByteArray description = "audiotestsrc samplesperbuffer=4410 num-buffers="
+            + QByteArray::number(seconds * 10) + " ! wavenc ! filesink location=\""
+            + QFile::encodeName(fileName) + '"';
+    GstElement *pipeline = gst_parse_launch(description.constData(), nullptr);
+    if (!pipeline)
+        return false;
+
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    GstBus *bus = gst_element_get_bus(pipeline);
+    GstMessage *message = gst_bus_timed_pop_filtered(
+                bus, 10 * GST_SECOND, GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    const bool ok = message && GST_MESSAGE_TYPE(message) == GST_MESSAGE_EOS;
+    if (message)
+        gst_message_unref(message);
+    gst_object_unref(bus);
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+
+    return ok && QFileInfo(fileName).size() > 0;
+}
+
+// Counts the seek events which reach the audio sink
+static GstPadProbeReturn seekProbe(GstPad *, GstPadProbeInfo *info, gpointer user_data)
+{
+    if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) == GST_EVENT_SEEK)
+        static_cast<QAtomicInt *>(user_data)->ref();
+    return GST_PAD_PROBE_OK;
+}
+
+class tst_QGstreamerPlayerSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QGstreamerPlayerSession()
+    {
+        QGstUtils::initializeGst();
+    }
+
+private slots:
+    void initTestCase();
+    void coalescedSeeks();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_fileName;
+};
+
+void tst_QGstreamerPlayerSession::initTestCase()
+{
+    // Plays without an audio device, the sink is only there to count seeks
+    qputenv("QT_GSTREAMER_PLAYBIN_AUDIOSINK", "fakesink");
+
+    QVERIFY(m_dir.isValid());
+    m_fileName = m_dir.filePath("tone.wav");
+    if (!writeTestFile(m_fileName, 20))
+        QSKIP("Could not write a WAV file with audiotestsrc and wavenc");
+}
+
+void tst_QGstreamerPlayerSession::coalescedSeeks()
+{
+    QGstreamerPlayerSession session(nullptr);
+    QVERIFY(session.playbin());
+
+    session.loadFromUri(QNetworkRequest(QUrl::fromLocalFile(m_fileName)));
+    QVERIFY(session.pause());
+    QTRY_COMPARE(session.state(), QMediaPlayer::PausedState);
+    QTRY_VERIFY(session.isSeekable());
+
+    GstElement *sink = gst_bin_get_by_name(GST_BIN(session.playbin()), "audiosink");
+    QVERIFY(sink);
+    GstPad *pad = gst_element_get_static_pad(sink, "sink");
+    QVERIFY(pad);
+    QAtomicInt seekCount;
+    const gulong probe = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM, seekProbe, &seekCount, nullptr);
+
+    // Scrub without waiting, every request is accepted
+    const int requested = 20;
+    qint64 position = 0;
+    for (int i = 1; i <= requested; ++i) {
+        position = i * 500;
+        QVERIFY(session.seek(position));
+    }
+
+    // Only the last target has to be reached, and most requests never got to the pipeline
+    QTRY_VERIFY(qAbs(session.position() - position) < 100);
+    QTest::qWait(500);
+    QVERIFY2(qAbs(session.position() - position) < 100, QByteArray::number(session.position()).constData());
+    QVERIFY(seekCount.loadAcquire() > 0);
+    QVERIFY2(seekCount.loadAcquire() < requested, QByteArray::number(seekCount.loadAcquire()).constData());
+    QCOMPARE(session.state(), QMediaPlayer::PausedState);
+
+    // A single seek after the pipeline settled is issued right away
+    const int settled = seekCount.loadAcquire();
+    QVERIFY(session.seek(2000));
+    QCOMPARE(seekCount.loadAcquire(), settled + 1);
+    QTRY_VERIFY(qAbs(session.position() - 2000) < 100);
+
+    gst_pad_remove_probe(pad, probe);
+    gst_object_unref(pad);
+    gst_object_unref(sink);
+
+    session.stop();
+}
+
+QTEST_GUILESS_MAIN(tst_QGstreamerPlayerSession)
+
+#include "tst_qgstreamerplayersession.moc"
@@ -72,6 +72,7 @@ private slots:
     void initialVolume();
     void seekPauseSeek();
     void seekInStoppedState();
+    void coalescedSeeks();
     void subsequentPlayback();
     void probes();
     void playlist();
@@ -960,6 +961,46 @@ void tst_QMediaPlayerBackend::seekInStoppedState()
         QVERIFY(positionSpy.at(i)[0].value<qint64>() > (position - 500));
 }
 
+void tst_QMediaPlayerBackend::coalescedSeeks()
+{
+    if (localVideoFile.isNull())
+        QSKIP("No supported video file");
+
+    QMediaPlayer player;
+    player.setSeekMode(QMediaPlayer::AccurateSeek);
+    QCOMPARE(player.seekMode(), QMediaPlayer::AccurateSeek);
+
+    TestVideoSurface *surface = new TestVideoSurface;
+    player.setVideoOutput(surface);
+
+    player.setMedia(localVideoFile);
+    player.pause();
+    QTRY_COMPARE(player.state(), QMediaPlayer::PausedState);
+    QTRY_VERIFY(player.isSeekable());
+    QTRY_VERIFY_WITH_TIMEOUT(!surface->m_frameList.isEmpty(), 10000);
+
+    // Scrub without waiting, only the last target has to be reached
+    qint64 position = 0;
+    for (position = 1000; position <= 12000; position += 500)
+        player.setPosition(position);
+    position -= 500;
+
+    QTRY_VERIFY(qAbs(player.position() - position) < (qint64)500);
+    QTest::qWait(500); // let any stale seek settle before checking it did not move us
+    QVERIFY2(qAbs(player.position() - position) < (qint64)500, QByteArray::number(player.position()).constData());
+    QCOMPARE(player.state(), QMediaPlayer::PausedState);
+
+    surface->m_frameList.clear();
+    player.setPosition(7000);
+    QTRY_VERIFY_WITH_TIMEOUT(!surface->m_frameList.isEmpty(), 10000);
+
+    const QVideoFrame frame = surface->m_frameList.back();
+    if (!frame.isValid() || frame.startTime() < 0)
+        QSKIP("No timestamp");
+    const qint64 elapsed = (frame.startTime() / 1000) - 7000;
+    QVERIFY2(qAbs(elapsed) < (qint64)500, QByteArray::number(elapsed).constData());
+}
+
 void tst_QMediaPlayerBackend::subsequentPlayback()
 {
 #ifdef Q_OS_LINUX
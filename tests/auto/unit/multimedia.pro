@@ -1,10 +1,16 @@
 
 TEMPLATE = subdirs
+
+QT_FOR_CONFIG += multimedia-private
+
 SUBDIRS += \
     qabstractvideobuffer \
     qabstractvideosurface \
     qaudiorecorder \
     qaudioformat \
+    qaudiohelpers \
+    qaudioresampler \
+    qaudioringbuffer \
     qaudionamespace \
     qcamera \
     qcamerainfo \
@@ -32,3 +38,11 @@ SUBDIRS += \
     qaudioprobe \
     qvideoprobe \
     qsamplecache
+
+# The shared sound effect mixer is only built when PulseAudio does not play the effects
+!qtConfig(pulseaudio): \
+    SUBDIRS += qsoundeffectmixer
+
+# Feed GstBuffers directly to GStreamer backend helpers
+qtConfig(gstreamer):!qtConfig(gstreamer_0_10): \
+    SUBDIRS += qgstreameraudioprobecontrol qgstreamerprerollbuffer
@@ -48,7 +48,9 @@ private Q_SLOTS:
     void stop();
     void format();
     void source();
+    void decodeSettings();
     void readAll();
+    void convertedOutput();
     void nullControl();
     void nullService();
 
@@ -282,6 +284,47 @@ void tst_QAudioDecoder::source()
     QVERIFY(d.sourceDevice() == 0);
 }
 
+void tst_QAudioDecoder::decodeSettings()
+{
+    QAudioDecoder d;
+    QCOMPARE(d.bufferQueueLimit(), 0);
+    QCOMPARE(d.framesPerBuffer(), 0);
+    QVERIFY(!d.fastDecoding());
+    QCOMPARE(d.conversionQuality(), QAudioDecoder::BalancedConversion);
+
+    d.setBufferQueueLimit(16);
+    d.setFramesPerBuffer(4096);
+    d.setFastDecoding(true);
+    d.setConversionQuality(QAudioDecoder::BestConversion);
+    QCOMPARE(d.bufferQueueLimit(), 16);
+    QCOMPARE(d.framesPerBuffer(), 4096);
+    QVERIFY(d.fastDecoding());
+    QCOMPARE(d.conversionQuality(), QAudioDecoder::BestConversion);
+
+    // Negative values select the backend default
+    d.setBufferQueueLimit(-1);
+    d.setFramesPerBuffer(-1);
+    QCOMPARE(d.bufferQueueLimit(), 0);
+    QCOMPARE(d.framesPerBuffer(), 0);
+
+    // Changing settings while decoding is ignored
+    d.setSourceFilename("Blah");
+    d.start();
+    QCOMPARE(d.state(), QAudioDecoder::DecodingState);
+    d.setBufferQueueLimit(8);
+    d.setFramesPerBuffer(1024);
+    d.setFastDecoding(false);
+    d.setConversionQuality(QAudioDecoder::FastConversion);
+    QCOMPARE(d.bufferQueueLimit(), 0);
+    QCOMPARE(d.framesPerBuffer(), 0);
+    QVERIFY(d.fastDecoding());
+    QCOMPARE(d.conversionQuality(), QAudioDecoder::BestConversion);
+
+    d.stop();
+    d.setFastDecoding(false);
+    QVERIFY(!d.fastDecoding());
+}
+
 void tst_QAudioDecoder::readAll()
 {
     QAudioDecoder d;
@@ -327,6 +370,66 @@ void tst_QAudioDecoder::readAll()
     }
 }
 
+void tst_QAudioDecoder::convertedOutput()
+{
+    QAudioDecoder d;
+    const QAudioFormat target = d.audioFormat();
+    QVERIFY(target.isValid());
+
+    // The backend delivers twice the rate and other samples than requested
+    QAudioFormat delivered = target;
+    delivered.setSampleRate(target.sampleRate() * 2);
+    delivered.setSampleSize(16);
+    delivered.setSampleType(QAudioFormat::SignedInt);
+    MockAudioDecoderControl *control = mockAudioDecoderService->mockControl;
+    control->mDeliveredFormat = delivered;
+    control->mDeliveredValue = 16384;
+
+    QList<QAudioBuffer> buffers;
+    int framesAtFinish = -1;
+    connect(&d, &QAudioDecoder::bufferReady, this, [&]() {
+        while (d.bufferAvailable()) {
+            const QAudioBuffer buffer = d.read();
+            if (buffer.isValid())
+                buffers.append(buffer);
+        }
+    });
+    connect(&d, &QAudioDecoder::finished, this, [&]() {
+        framesAtFinish = 0;
+        for (const QAudioBuffer &buffer : qAsConst(buffers))
+            framesAtFinish += buffer.frameCount();
+    });
+
+    QSignalSpy finishedSpy(&d, SIGNAL(finished()));
+    d.setSourceFilename("Foo");
+    d.start();
+    QTRY_COMPARE(finishedSpy.count(), 1);
+
+    // Every frame the resampler held back was read before finished()
+    const int expectedFrames = MOCK_DECODER_MAX_BUFFERS * MOCK_DECODER_DELIVERED_FRAMES / 2;
+    QCOMPARE(framesAtFinish, expectedFrames);
+    QVERIFY(!d.bufferAvailable());
+
+    QByteArray output;
+    qint64 frames = 0;
+    for (const QAudioBuffer &buffer : qAsConst(buffers)) {
+        QCOMPARE(buffer.format(), target);
+        QCOMPARE(buffer.startTime(), target.durationForFrames(frames));
+        frames += buffer.frameCount();
+        output.append(buffer.constData<char>(), buffer.byteCount());
+    }
+
+    // Half of the 16-bit range is 192 in unsigned 8-bit samples, away from the filter edges
+    const quint8 *samples = reinterpret_cast<const quint8 *>(output.constData());
+    for (int i = 50; i < output.size() - 50; ++i)
+        QVERIFY2(qAbs(int(samples[i]) - 192) <= 1, qPrintable(QString::number(samples[i])));
+
+    // Nothing is handed out again after the end of the stream
+    QVERIFY(!d.read().isValid());
+    QTest::qWait(100);
+    QCOMPARE(finishedSpy.count(), 1);
+}
+
 void tst_QAudioDecoder::nullControl()
 {
     mockAudioDecoderService->setControlNull();
@@ -354,6 +457,16 @@ void tst_QAudioDecoder::nullControl()
     d.setAudioFormat(format);
     QVERIFY(!d.audioFormat().isValid());
 
+    QCOMPARE(d.bufferQueueLimit(), 0);
+    d.setBufferQueueLimit(16);
+    QCOMPARE(d.bufferQueueLimit(), 0);
+    QCOMPARE(d.framesPerBuffer(), 0);
+    d.setFramesPerBuffer(4096);
+    QCOMPARE(d.framesPerBuffer(), 0);
+    QVERIFY(!d.fastDecoding());
+    d.setFastDecoding(true);
+    QVERIFY(!d.fastDecoding());
+
     QVERIFY(!d.read().isValid());
     QVERIFY(!d.bufferAvailable());
 
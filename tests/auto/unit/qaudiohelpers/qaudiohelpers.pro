@@ -0,0 +1,6 @@
+CONFIG += testcase
+TARGET = tst_qaudiohelpers
+
+QT += core multimedia-private testlib
+
+SOURCES += tst_qaudiohelpers.cpp
@@ -0,0 +1,430 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//TESTED_COMPONENT=src/multimedia
+
+#include <QtTest/QtTest>
+#include <QtCore/QRandomGenerator>
+#include <QtMultimedia/qaudioformat.h>
+#include <private/qaudiohelpers_p.h>
+
+class tst_QAudioHelpers : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void multiplySamples_data();
+    void multiplySamples();
+    void multiplySamplesInPlace_data();
+    void multiplySamplesInPlace();
+    void unityGain_data();
+    void unityGain();
+    void zeroGain_data();
+    void zeroGain();
+    void mixSamples();
+    void floatToSamplesRounding();
+    void volumeRamp_data();
+    void volumeRamp();
+    void volumeRampRetarget();
+    void volumeJump();
+
+    void benchmarkMultiplySamples_data();
+    void benchmarkMultiplySamples();
+};
+
+Q_DECLARE_METATYPE(QAudioFormat::SampleType)
+Q_DECLARE_METATYPE(QAudioHelperInternal::RampShape)
+
+static QAudioFormat sampleFormat(int sampleSize, QAudioFormat::SampleType sampleType)
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(2);
+    format.setSampleSize(sampleSize);
+    format.setSampleType(sampleType);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec(QStringLiteral("audio/pcm"));
+    return format;
+}
+
+static QByteArray randomSamples(const QAudioFormat &format, int samples)
+{
+    QByteArray data(samples * format.sampleSize() / 8, Qt::Uninitialized);
+    QRandomGenerator generator(quint32(format.sampleSize() * 4 + format.sampleType()));
+    if (format.sampleType() == QAudioFormat::Float) {
+        float *values = reinterpret_cast<float *>(data.data());
+        for (int i = 0; i < samples; ++i)
+            values[i] = float(generator.bounded(2.0) - 1.0);
+    } else {
+        for (int i = 0; i < data.size(); ++i)
+            data[i] = char(generator.bounded(256));
+    }
+    return data;
+}
+
+// Returns sample \a i of an integer format centered around zero.
+static qint64 sampleValue(const QAudioFormat &format, const QByteArray &data, int i)
+{
+    const int bytes = format.sampleSize() / 8;
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData()) + i * bytes;
+    quint32 raw = 0;
+    for (int b = 0; b < bytes; ++b)
+        raw |= quint32(p[b]) << (8 * b);
+
+    const qint64 range = qint64(1) << format.sampleSize();
+    if (format.sampleType() == QAudioFormat::UnSignedInt)
+        return qint64(raw) - range / 2;
+    return raw >= range / 2 ? qint64(raw) - range : qint64(raw);
+}
+
+static void addFormatRows()
+{
+    QTest::addColumn<int>("sampleSize");
+    QTest::addColumn<QAudioFormat::SampleType>("sampleType");
+
+    QTest::newRow("int8") << 8 << QAudioFormat::SignedInt;
+    QTest::newRow("uint8") << 8 << QAudioFormat::UnSignedInt;
+    QTest::newRow("int16") << 16 << QAudioFormat::SignedInt;
+    QTest::newRow("uint16") << 16 << QAudioFormat::UnSignedInt;
+    QTest::newRow("int24") << 24 << QAudioFormat::SignedInt;
+    QTest::newRow("uint24") << 24 << QAudioFormat::UnSignedInt;
+    QTest::newRow("int32") << 32 << QAudioFormat::SignedInt;
+    QTest::newRow("uint32") << 32 << QAudioFormat::UnSignedInt;
+    QTest::newRow("float") << 32 << QAudioFormat::Float;
+}
+
+void tst_QAudioHelpers::multiplySamples_data()
+{
+    QTest::addColumn<int>("sampleSize");
+    QTest::addColumn<QAudioFormat::SampleType>("sampleType");
+    QTest::addColumn<qreal>("factor");
+
+    const qreal factors[] = { 0.5, 0.3, 0.999, 0.001 };
+    for (qreal factor : factors) {
+        const QByteArray suffix = " x" + QByteArray::number(factor);
+        QTest::newRow("int8" + suffix) << 8 << QAudioFormat::SignedInt << factor;
+        QTest::newRow("uint8" + suffix) << 8 << QAudioFormat::UnSignedInt << factor;
+        QTest::newRow("int16" + suffix) << 16 << QAudioFormat::SignedInt << factor;
+        QTest::newRow("uint16" + suffix) << 16 << QAudioFormat::UnSignedInt << factor;
+        QTest::newRow("int24" + suffix) << 24 << QAudioFormat::SignedInt << factor;
+        QTest::newRow("uint24" + suffix) << 24 << QAudioFormat::UnSignedInt << factor;
+        QTest::newRow("int32" + suffix) << 32 << QAudioFormat::SignedInt << factor;
+        QTest::newRow("uint32" + suffix) << 32 << QAudioFormat::UnSignedInt << factor;
+        QTest::newRow("float" + suffix) << 32 << QAudioFormat::Float << factor;
+    }
+}
+
+void tst_QAudioHelpers::multiplySamples()
+{
+    QFETCH(int, sampleSize);
+    QFETCH(QAudioFormat::SampleType, sampleType);
+    QFETCH(qreal, factor);
+
+    // An odd count exercises the scalar tail after the vector loop
+    const int samples = 1003;
+    const QAudioFormat format = sampleFormat(sampleSize, sampleType);
+    const QByteArray input = randomSamples(format, samples);
+    QByteArray output(input.size(), Qt::Uninitialized);
+
+    QAudioHelperInternal::qMultiplySamples(factor, format, input.constData(), output.data(), input.size());
+
+    for (int i = 0; i < samples; ++i) {
+        if (sampleType == QAudioFormat::Float) {
+            const float expected = reinterpret_cast<const float *>(input.constData())[i] * float(factor);
+            QCOMPARE(reinterpret_cast<const float *>(output.constData())[i], expected);
+        } else {
+            // Integer formats may round either way, but never by more than one step
+            const qreal expected = sampleValue(format, input, i) * factor;
+            const qint64 actual = sampleValue(format, output, i);
+            if (qAbs(actual - expected) >= 1.0)
+                QFAIL(qPrintable(QString::fromLatin1("Sample %1: got %2, expected %3").arg(i).arg(actual).arg(expected)));
+        }
+    }
+}
+
+void tst_QAudioHelpers::multiplySamplesInPlace_data()
+{
+    addFormatRows();
+}
+
+void tst_QAudioHelpers::multiplySamplesInPlace()
+{
+    QFETCH(int, sampleSize);
+    QFETCH(QAudioFormat::SampleType, sampleType);
+
+    const QAudioFormat format = sampleFormat(sampleSize, sampleType);
+    const QByteArray input = randomSamples(format, 517);
+
+    QByteArray expected(input.size(), Qt::Uninitialized);
+    QAudioHelperInternal::qMultiplySamples(0.25, format, input.constData(), expected.data(), input.size());
+
+    QByteArray data = input;
+    QAudioHelperInternal::qMultiplySamples(0.25, format, data.constData(), data.data(), data.size());
+    QCOMPARE(data, expected);
+}
+
+void tst_QAudioHelpers::unityGain_data()
+{
+    addFormatRows();
+}
+
+void tst_QAudioHelpers::unityGain()
+{
+    QFETCH(int, sampleSize);
+    QFETCH(QAudioFormat::SampleType, sampleType);
+
+    const QAudioFormat format = sampleFormat(sampleSize, sampleType);
+    const QByteArray input = randomSamples(format, 517);
+    QByteArray output(input.size(), Qt::Uninitialized);
+
+    QAudioHelperInternal::qMultiplySamples(1.0, format, input.constData(), output.data(), input.size());
+    QCOMPARE(output, input);
+}
+
+void tst_QAudioHelpers::zeroGain_data()
+{
+    QTest::addColumn<int>("sampleSize");
+    QTest::addColumn<QAudioFormat::SampleType>("sampleType");
+    QTest::addColumn<QByteArray>("silence");
+
+    QTest::newRow("int8") << 8 << QAudioFormat::SignedInt << QByteArray(1, '\0');
+    QTest::newRow("uint8") << 8 << QAudioFormat::UnSignedInt << QByteArray(1, '\x80');
+    QTest::newRow("int16") << 16 << QAudioFormat::SignedInt << QByteArray(2, '\0');
+    QTest::newRow("uint16") << 16 << QAudioFormat::UnSignedInt << QByteArray("\x00\x80", 2);
+    QTest::newRow("int24") << 24 << QAudioFormat::SignedInt << QByteArray(3, '\0');
+    QTest::newRow("uint24") << 24 << QAudioFormat::UnSignedInt << QByteArray("\x00\x00\x80", 3);
+    QTest::newRow("int32") << 32 << QAudioFormat::SignedInt << QByteArray(4, '\0');
+    QTest::newRow("uint32") << 32 << QAudioFormat::UnSignedInt << QByteArray("\x00\x00\x00\x80", 4);
+    QTest::newRow("float") << 32 << QAudioFormat::Float << QByteArray(4, '\0');
+}
+
+void tst_QAudioHelpers::zeroGain()
+{
+    QFETCH(int, sampleSize);
+    QFETCH(QAudioFormat::SampleType, sampleType);
+    QFETCH(QByteArray, silence);
+
+    const int samples = 517;
+    const QAudioFormat format = sampleFormat(sampleSize, sampleType);
+    const QByteArray input = randomSamples(format, samples);
+    QByteArray output(input.size(), Qt::Uninitialized);
+
+    QAudioHelperInternal::qMultiplySamples(0.0, format, input.constData(), output.data(), input.size());
+    QCOMPARE(output, silence.repeated(samples));
+
+    // Silence is the center of the range for signed and unsigned formats alike
+    if (sampleType != QAudioFormat::Float) {
+        for (int i = 0; i < samples; ++i)
+            QCOMPARE(sampleValue(format, output, i), qint64(0));
+    }
+
+    // Muting in place gives the same silence
+    QByteArray data = input;
+    QAudioHelperInternal::qMultiplySamples(0.0, format, data.constData(), data.data(), data.size());
+    QCOMPARE(data, output);
+}
+
+void tst_QAudioHelpers::mixSamples()
+{
+    const QAudioFormat format = sampleFormat(16, QAudioFormat::SignedInt);
+    QVERIFY(QAudioHelperInternal::qCanMixSamples(format));
+    QVERIFY(!QAudioHelperInternal::qCanMixSamples(sampleFormat(24, QAudioFormat::SignedInt)));
+
+    // Enough samples for the vector loop and a scalar tail
+    const int samples = 35;
+    const QVector<qint16> voice(samples, 20000);
+    const QVector<qint16> quiet(samples, -4000);
+
+    QVector<qint16> mixed(samples, 1000);
+    QAudioHelperInternal::qMixSamples(0.5, format, voice.constData(), mixed.data(), samples * int(sizeof(qint16)));
+    QCOMPARE(mixed, QVector<qint16>(samples, 11000));
+
+    // Integer mixing saturates instead of wrapping around
+    QAudioHelperInternal::qMixSamples(1.0, format, voice.constData(), mixed.data(), samples * int(sizeof(qint16)));
+    QCOMPARE(mixed, QVector<qint16>(samples, 32767));
+
+    QAudioHelperInternal::qMixSamples(1.0, format, quiet.constData(), mixed.data(), samples * int(sizeof(qint16)));
+    QCOMPARE(mixed, QVector<qint16>(samples, 28767));
+}
+
+void tst_QAudioHelpers::floatToSamplesRounding()
+{
+    const QAudioFormat format = sampleFormat(16, QAudioFormat::SignedInt);
+
+    // Halfway values, enough of them for the vector loop and a scalar tail
+    const float halfways[] = { 0.5f, 1.5f, 2.5f, 3.5f, -0.5f, -1.5f, -2.5f, -3.5f, 100.5f, -100.5f, 0.25f };
+    const int samples = 35;
+    QVector<float> source(samples);
+    QVector<qint16> expected(samples);
+    for (int i = 0; i < samples; ++i) {
+        const float value = halfways[i % int(sizeof(halfways) / sizeof(halfways[0]))];
+        source[i] = value / 32768.0f;
+        expected[i] = qint16(qRound(value));
+    }
+    // Out of range values saturate
+    source[samples - 2] = 2.0f;
+    expected[samples - 2] = 32767;
+    source[samples - 1] = -2.0f;
+    expected[samples - 1] = -32768;
+
+    // Every code path rounds half away from zero
+    QVector<qint16> converted(samples);
+    QAudioHelperInternal::qFloatToSamples(format, source.constData(), converted.data(), samples);
+    QCOMPARE(converted, expected);
+    QCOMPARE(converted.at(0), qint16(1));
+    QCOMPARE(converted.at(2), qint16(3));
+    QCOMPARE(converted.at(4), qint16(-1));
+    QCOMPARE(converted.at(6), qint16(-3));
+}
+
+void tst_QAudioHelpers::volumeRamp_data()
+{
+    QTest::addColumn<QAudioHelperInternal::RampShape>("shape");
+
+    QTest::newRow("linear") << QAudioHelperInternal::LinearRamp;
+    QTest::newRow("exponential") << QAudioHelperInternal::ExponentialRamp;
+}
+
+void tst_QAudioHelpers::volumeRamp()
+{
+    QFETCH(QAudioHelperInternal::RampShape, shape);
+
+    const QAudioFormat format = sampleFormat(16, QAudioFormat::SignedInt);
+    QAudioHelperInternal::VolumeRamp ramp;
+    ramp.setShape(shape);
+    ramp.setDuration(20);
+    ramp.rampTo(0.0);
+    QVERIFY(ramp.isRamping());
+    QCOMPARE(ramp.volume(), qreal(0));
+
+    // 20 ms at 48 kHz is 960 frames, fed in chunks which do not divide it evenly
+    const int chunkFrames = 300;
+    const QVector<qint16> input(chunkFrames * format.channelCount(), 10000);
+    QVector<qint16> output(input.size());
+
+    qint16 previous = input.first();
+    for (int chunk = 0; chunk < 4; ++chunk) {
+        ramp.process(format, input.constData(), output.data(), input.size() * int(sizeof(qint16)));
+        for (int i = 0; i < output.size(); i += format.channelCount()) {
+            // Both channels of a frame share the gain, which never increases
+            QCOMPARE(output.at(i), output.at(i + 1));
+            QVERIFY(output.at(i) <= previous);
+            previous = output.at(i);
+        }
+        QCOMPARE(ramp.isRamping(), chunk < 3);
+    }
+
+    QCOMPARE(output.last(), qint16(0));
+    QCOMPARE(ramp.currentVolume(), qreal(0));
+}
+
+void tst_QAudioHelpers::volumeRampRetarget()
+{
+    const QAudioFormat format = sampleFormat(16, QAudioFormat::SignedInt);
+    QAudioHelperInternal::VolumeRamp ramp;
+    ramp.rampTo(0.5);
+
+    const QVector<qint16> input(100 * format.channelCount(), 10000);
+    QVector<qint16> output(input.size());
+    ramp.process(format, input.constData(), output.data(), input.size() * int(sizeof(qint16)));
+
+    // A new target starts from the gain reached so far rather than jumping
+    const qreal reached = ramp.currentVolume();
+    QVERIFY(reached < 1.0 && reached > 0.5);
+    ramp.rampTo(1.0);
+    QCOMPARE(ramp.currentVolume(), reached);
+
+    const qint16 last = output.last();
+    ramp.process(format, input.constData(), output.data(), input.size() * int(sizeof(qint16)));
+    QVERIFY(output.first() >= last);
+    QVERIFY(output.first() - last < 100);
+}
+
+void tst_QAudioHelpers::volumeJump()
+{
+    const QAudioFormat format = sampleFormat(16, QAudioFormat::SignedInt);
+    QAudioHelperInternal::VolumeRamp ramp;
+    QVERIFY(ramp.isUnity());
+
+    ramp.setVolume(0.5);
+    QVERIFY(!ramp.isRamping());
+    QVERIFY(!ramp.isUnity());
+
+    const QVector<qint16> input(64, 10000);
+    QVector<qint16> output(input.size());
+    ramp.process(format, input.constData(), output.data(), input.size() * int(sizeof(qint16)));
+    QCOMPARE(output, QVector<qint16>(input.size(), 5000));
+}
+
+void tst_QAudioHelpers::benchmarkMultiplySamples_data()
+{
+    QTest::addColumn<int>("sampleSize");
+    QTest::addColumn<QAudioFormat::SampleType>("sampleType");
+    QTest::addColumn<qreal>("factor");
+
+    const qreal factors[] = { 1.0, 0.0, 0.7 };
+    for (qreal factor : factors) {
+        const QByteArray suffix = " x" + QByteArray::number(factor);
+        QTest::newRow("int8" + suffix) << 8 << QAudioFormat::SignedInt << factor;
+        QTest::newRow("int16" + suffix) << 16 << QAudioFormat::SignedInt << factor;
+        QTest::newRow("uint16" + suffix) << 16 << QAudioFormat::UnSignedInt << factor;
+        QTest::newRow("int24" + suffix) << 24 << QAudioFormat::SignedInt << factor;
+        QTest::newRow("int32" + suffix) << 32 << QAudioFormat::SignedInt << factor;
+        QTest::newRow("float" + suffix) << 32 << QAudioFormat::Float << factor;
+    }
+}
+
+void tst_QAudioHelpers::benchmarkMultiplySamples()
+{
+    QFETCH(int, sampleSize);
+    QFETCH(QAudioFormat::SampleType, sampleType);
+    QFETCH(qreal, factor);
+
+    // One second of 48 kHz stereo audio per iteration
+    const int samples = 2 * 48000;
+    const QAudioFormat format = sampleFormat(sampleSize, sampleType);
+    const QByteArray input = randomSamples(format, samples);
+    QByteArray output(input.size(), Qt::Uninitialized);
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 iterations = 0;
+    QBENCHMARK {
+        QAudioHelperInternal::qMultiplySamples(factor, format, input.constData(), output.data(), input.size());
+        ++iterations;
+    }
+
+    const qint64 elapsed = timer.nsecsElapsed();
+    if (elapsed > 0)
+        qDebug("%.1f Msamples/s", double(samples) * iterations * 1000.0 / elapsed);
+}
+
+QTEST_MAIN(tst_QAudioHelpers)
+
+#include "tst_qaudiohelpers.moc"
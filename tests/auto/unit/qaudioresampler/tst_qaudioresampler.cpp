@@ -0,0 +1,318 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//TESTED_COMPONENT=src/multimedia
+
+#include <QtTest/QtTest>
+#include <QtCore/qmath.h>
+#include <QtMultimedia/qaudioformat.h>
+#include <private/qaudioresampler_p.h>
+
+class tst_QAudioResampler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void invalidFormats();
+    void sampleTypeOnly();
+    void downmixStereo();
+    void downmixSurround();
+    void upmixMono();
+    void frameCount_data();
+    void frameCount();
+    void chunkedProcessing_data();
+    void chunkedProcessing();
+    void sineAccuracy();
+    void antiAliasing_data();
+    void antiAliasing();
+
+    void benchmarkResample_data();
+    void benchmarkResample();
+};
+
+Q_DECLARE_METATYPE(QAudioResampler::Quality)
+
+static QAudioFormat audioFormat(int sampleRate, int channels, int sampleSize = 32,
+                                QAudioFormat::SampleType sampleType = QAudioFormat::Float)
+{
+    QAudioFormat format;
+    format.setSampleRate(sampleRate);
+    format.setChannelCount(channels);
+    format.setSampleSize(sampleSize);
+    format.setSampleType(sampleType);
+    format.setByteOrder(QAudioFormat::Endian(QSysInfo::ByteOrder));
+    format.setCodec(QStringLiteral("audio/pcm"));
+    return format;
+}
+
+// Interleaved float frames with \a frequency on the first channel and silence elsewhere
+static QByteArray sine(const QAudioFormat &format, int frames, double frequency, float amplitude = 0.5f)
+{
+    QByteArray data(frames * format.bytesPerFrame(), 0);
+    float *samples = reinterpret_cast<float *>(data.data());
+    for (int i = 0; i < frames; ++i)
+        samples[i * format.channelCount()] = amplitude * float(qSin(2 * M_PI * frequency * i / format.sampleRate()));
+    return data;
+}
+
+static const float *floatData(const QByteArray &data)
+{
+    return reinterpret_cast<const float *>(data.constData());
+}
+
+static void addQualityRows()
+{
+    QTest::addColumn<QAudioResampler::Quality>("quality");
+
+    QTest::newRow("fast") << QAudioResampler::FastQuality;
+    QTest::newRow("medium") << QAudioResampler::MediumQuality;
+    QTest::newRow("high") << QAudioResampler::HighQuality;
+}
+
+void tst_QAudioResampler::invalidFormats()
+{
+    QAudioFormat compressed = audioFormat(44100, 2);
+    compressed.setSampleType(QAudioFormat::Unknown);
+
+    QVERIFY(!QAudioResampler::canConvert(compressed, audioFormat(48000, 2)));
+    QAudioResampler resampler(compressed, audioFormat(48000, 2));
+    QVERIFY(!resampler.isValid());
+    QVERIFY(resampler.process(QByteArray(64, 0)).isEmpty());
+    QVERIFY(resampler.flush().isEmpty());
+}
+
+void tst_QAudioResampler::sampleTypeOnly()
+{
+    const QAudioFormat source = audioFormat(44100, 2, 16, QAudioFormat::SignedInt);
+    const QAudioFormat target = audioFormat(44100, 2);
+    QAudioResampler resampler(source, target);
+    QVERIFY(resampler.isValid());
+
+    const qint16 input[] = { 0, 16384, -16384, 32767, -32768, 8192 };
+    const QByteArray output = resampler.process(input, sizeof(input));
+    QCOMPARE(output.size(), 6 * int(sizeof(float)));
+    for (int i = 0; i < 6; ++i)
+        QCOMPARE(floatData(output)[i], input[i] / 32768.0f);
+
+    // Nothing is held back without rate conversion
+    QVERIFY(!resampler.hasPendingFrames());
+    QVERIFY(resampler.flush().isEmpty());
+}
+
+void tst_QAudioResampler::downmixStereo()
+{
+    QAudioResampler resampler(audioFormat(48000, 2), audioFormat(48000, 1));
+
+    const float input[] = { 1.0f, 0.0f, 0.5f, 0.5f, -0.25f, 0.75f };
+    const QByteArray output = resampler.process(input, sizeof(input));
+    QCOMPARE(output.size(), 3 * int(sizeof(float)));
+    QCOMPARE(floatData(output)[0], 0.5f);
+    QCOMPARE(floatData(output)[1], 0.5f);
+    QCOMPARE(floatData(output)[2], 0.25f);
+}
+
+void tst_QAudioResampler::downmixSurround()
+{
+    QAudioResampler resampler(audioFormat(48000, 6), audioFormat(48000, 2));
+
+    // FL FR C LFE SL SR
+    const float front[] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    const float centre[] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f };
+    const float lfe[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+    const float all[] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+    const float scale = 1.0f / (1.0f + 2 * float(M_SQRT1_2));
+
+    QByteArray output = resampler.process(front, sizeof(front));
+    QCOMPARE(floatData(output)[0], scale);
+    QCOMPARE(floatData(output)[1], 0.0f);
+
+    output = resampler.process(centre, sizeof(centre));
+    QCOMPARE(floatData(output)[0], floatData(output)[1]);
+    QVERIFY(qAbs(floatData(output)[0] - float(M_SQRT1_2) * scale) < 1e-6f);
+
+    output = resampler.process(lfe, sizeof(lfe));
+    QCOMPARE(floatData(output)[0], 0.0f);
+    QCOMPARE(floatData(output)[1], 0.0f);
+
+    // Full scale on every channel does not clip
+    output = resampler.process(all, sizeof(all));
+    QVERIFY(qAbs(floatData(output)[0] - 1.0f) < 1e-6f);
+    QVERIFY(qAbs(floatData(output)[1] - 1.0f) < 1e-6f);
+}
+
+void tst_QAudioResampler::upmixMono()
+{
+    QAudioResampler resampler(audioFormat(48000, 1), audioFormat(48000, 2));
+
+    const float input[] = { 0.25f, -0.5f };
+    const QByteArray output = resampler.process(input, sizeof(input));
+    QCOMPARE(output.size(), 4 * int(sizeof(float)));
+    QCOMPARE(floatData(output)[0], 0.25f);
+    QCOMPARE(floatData(output)[1], 0.25f);
+    QCOMPARE(floatData(output)[2], -0.5f);
+    QCOMPARE(floatData(output)[3], -0.5f);
+}
+
+void tst_QAudioResampler::frameCount_data()
+{
+    QTest::addColumn<int>("sourceRate");
+    QTest::addColumn<int>("targetRate");
+    QTest::addColumn<int>("frames");
+    QTest::addColumn<int>("expectedFrames");
+
+    QTest::newRow("44100 to 48000") << 44100 << 48000 << 44094 << 47993;
+    QTest::newRow("48000 to 44100") << 48000 << 44100 << 48000 << 44100;
+    QTest::newRow("48000 to 16000") << 48000 << 16000 << 1000 << 333;
+    QTest::newRow("8000 to 48000") << 8000 << 48000 << 100 << 600;
+    // Too many phases for an exact table
+    QTest::newRow("44100 to 48001") << 44100 << 48001 << 20000 << 21769;
+}
+
+void tst_QAudioResampler::frameCount()
+{
+    QFETCH(int, sourceRate);
+    QFETCH(int, targetRate);
+    QFETCH(int, frames);
+    QFETCH(int, expectedFrames);
+
+    for (int q = QAudioResampler::FastQuality; q <= QAudioResampler::HighQuality; ++q) {
+        const QAudioFormat source = audioFormat(sourceRate, 2);
+        const QAudioFormat target = audioFormat(targetRate, 2);
+        QAudioResampler resampler(source, target, QAudioResampler::Quality(q));
+
+        QByteArray output = resampler.process(sine(source, frames, 440));
+        QVERIFY(output.size() <= expectedFrames * target.bytesPerFrame());
+        output += resampler.flush();
+        QCOMPARE(output.size(), expectedFrames * target.bytesPerFrame());
+        QVERIFY(!resampler.hasPendingFrames());
+    }
+}
+
+void tst_QAudioResampler::chunkedProcessing_data()
+{
+    addQualityRows();
+}
+
+void tst_QAudioResampler::chunkedProcessing()
+{
+    QFETCH(QAudioResampler::Quality, quality);
+
+    const QAudioFormat source = audioFormat(44100, 2);
+    const QAudioFormat target = audioFormat(48000, 2, 16, QAudioFormat::SignedInt);
+    const QByteArray input = sine(source, 10000, 1000);
+
+    QAudioResampler whole(source, target, quality);
+    QByteArray expected = whole.process(input);
+    expected += whole.flush();
+
+    // Uneven chunk sizes exercise the history carried between calls
+    QAudioResampler chunked(source, target, quality);
+    QByteArray output;
+    const int chunkSizes[] = { 1, 7, 64, 333, 1024 };
+    int offset = 0;
+    for (int i = 0; offset < input.size(); ++i) {
+        const int bytes = qMin(chunkSizes[i % 5] * source.bytesPerFrame(), input.size() - offset);
+        output += chunked.process(input.constData() + offset, bytes);
+        offset += bytes;
+    }
+    output += chunked.flush();
+
+    QCOMPARE(output, expected);
+}
+
+void tst_QAudioResampler::sineAccuracy()
+{
+    const QAudioFormat source = audioFormat(44100, 1);
+    const QAudioFormat target = audioFormat(48000, 1);
+    QAudioResampler resampler(source, target, QAudioResampler::HighQuality);
+
+    QByteArray output = resampler.process(sine(source, 44100, 1000));
+    output += resampler.flush();
+
+    // Skip the edges, where the filter sees the silence before and after the stream
+    const int frames = output.size() / target.bytesPerFrame();
+    float maxError = 0.0f;
+    for (int i = 100; i < frames - 100; ++i) {
+        const float expected = 0.5f * float(qSin(2 * M_PI * 1000 * i / 48000));
+        maxError = qMax(maxError, qAbs(floatData(output)[i] - expected));
+    }
+    QVERIFY2(maxError < 1e-4f, QByteArray::number(maxError));
+}
+
+void tst_QAudioResampler::antiAliasing_data()
+{
+    QTest::addColumn<QAudioResampler::Quality>("quality");
+    QTest::addColumn<float>("maxPeak");
+
+    // A 12 kHz tone is above the 8 kHz Nyquist frequency of the target
+    QTest::newRow("medium") << QAudioResampler::MediumQuality << 0.005f;
+    QTest::newRow("high") << QAudioResampler::HighQuality << 0.0005f;
+}
+
+void tst_QAudioResampler::antiAliasing()
+{
+    QFETCH(QAudioResampler::Quality, quality);
+    QFETCH(float, maxPeak);
+
+    const QAudioFormat source = audioFormat(48000, 1);
+    const QAudioFormat target = audioFormat(16000, 1);
+    QAudioResampler resampler(source, target, quality);
+
+    QByteArray output = resampler.process(sine(source, 48000, 12000));
+    output += resampler.flush();
+
+    const int frames = output.size() / target.bytesPerFrame();
+    float peak = 0.0f;
+    for (int i = 500; i < frames - 500; ++i)
+        peak = qMax(peak, qAbs(floatData(output)[i]));
+    QVERIFY2(peak < maxPeak, QByteArray::number(peak));
+}
+
+void tst_QAudioResampler::benchmarkResample_data()
+{
+    addQualityRows();
+}
+
+void tst_QAudioResampler::benchmarkResample()
+{
+    QFETCH(QAudioResampler::Quality, quality);
+
+    const QAudioFormat source = audioFormat(44100, 2, 16, QAudioFormat::SignedInt);
+    const QAudioFormat target = audioFormat(48000, 2, 16, QAudioFormat::SignedInt);
+    const QByteArray input(4096 * source.bytesPerFrame(), 0);
+    QAudioResampler resampler(source, target, quality);
+
+    QBENCHMARK {
+        resampler.process(input);
+    }
+}
+
+QTEST_MAIN(tst_QAudioResampler)
+
+#include "tst_qaudioresampler.moc"
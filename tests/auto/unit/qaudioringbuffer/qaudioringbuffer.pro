@@ -0,0 +1,6 @@
+CONFIG += testcase
+TARGET = tst_qaudioringbuffer
+
+QT += core multimedia-private testlib
+
+SOURCES += tst_qaudioringbuffer.cpp
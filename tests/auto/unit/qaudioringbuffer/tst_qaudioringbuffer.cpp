@@ -0,0 +1,212 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/multimedia
+
+#include <QtTest/QtTest>
+#include <QtCore/QThread>
+#include <private/qaudioringbuffer_p.h>
+
+class tst_QAudioRingBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void readWrite();
+    void wrapAround();
+    void regions();
+    void reset();
+    void producerConsumer();
+    void device();
+};
+
+class RingBufferDevice : public QAudioRingBufferDevice
+{
+public:
+    RingBufferDevice(QAudioRingBuffer *buffer)
+        : QAudioRingBufferDevice(buffer)
+    {
+    }
+
+    qint64 notified = 0;
+
+protected:
+    void dataWritten(qint64 len) override { notified += len; }
+};
+
+void tst_QAudioRingBuffer::readWrite()
+{
+    QAudioRingBuffer buffer(16);
+    QCOMPARE(buffer.size(), 16);
+    QCOMPARE(buffer.used(), 0);
+    QCOMPARE(buffer.free(), 16);
+
+    const QByteArray data("0123456789abcdefghij");
+    QCOMPARE(buffer.write(data.constData(), 10), 10);
+    QCOMPARE(buffer.used(), 10);
+    QCOMPARE(buffer.free(), 6);
+
+    // Only what fits is accepted
+    QCOMPARE(buffer.write(data.constData() + 10, 10), 6);
+    QCOMPARE(buffer.free(), 0);
+    QCOMPARE(buffer.write(data.constData(), 1), 0);
+
+    QByteArray out(20, 0);
+    QCOMPARE(buffer.read(out.data(), 20), 16);
+    QCOMPARE(out.left(16), data.left(16));
+    QCOMPARE(buffer.used(), 0);
+    QCOMPARE(buffer.read(out.data(), 1), 0);
+}
+
+void tst_QAudioRingBuffer::wrapAround()
+{
+    QAudioRingBuffer buffer(10);
+    QByteArray out(10, 0);
+
+    QCOMPARE(buffer.write("abcdefg", 7), 7);
+    QCOMPARE(buffer.read(out.data(), 5), 5);
+    QCOMPARE(out.left(5), QByteArray("abcde"));
+
+    // Crosses the end of the storage
+    QCOMPARE(buffer.write("hijklmn", 7), 7);
+    QCOMPARE(buffer.used(), 9);
+    QCOMPARE(buffer.read(out.data(), 10), 9);
+    QCOMPARE(out.left(9), QByteArray("fghijklmn"));
+    QCOMPARE(buffer.used(), 0);
+}
+
+void tst_QAudioRingBuffer::regions()
+{
+    QAudioRingBuffer buffer(8);
+
+    QAudioRingBuffer::Region region = buffer.acquireWriteRegion(6);
+    QCOMPARE(region.second, 6);
+    memcpy(region.first, "ABCDEF", 6);
+    buffer.releaseWriteRegion(region);
+
+    region = buffer.acquireReadRegion(4);
+    QCOMPARE(region.second, 4);
+    QCOMPARE(QByteArray(region.first, 4), QByteArray("ABCD"));
+    buffer.releaseReadRegion(region);
+
+    // A region never wraps, the remainder comes from the start of the storage
+    region = buffer.acquireWriteRegion(6);
+    QCOMPARE(region.second, 2);
+    buffer.releaseWriteRegion(region);
+    region = buffer.acquireWriteRegion(6);
+    QCOMPARE(region.second, 4);
+
+    // A partial release only commits what was actually produced
+    buffer.releaseWriteRegion(QAudioRingBuffer::Region(region.first, 1));
+    QCOMPARE(buffer.used(), 5);
+
+    region = buffer.acquireReadRegion(8);
+    QCOMPARE(region.second, 4);
+}
+
+void tst_QAudioRingBuffer::reset()
+{
+    QAudioRingBuffer buffer(8);
+    QCOMPARE(buffer.write("12345", 5), 5);
+    buffer.reset();
+    QCOMPARE(buffer.used(), 0);
+    QCOMPARE(buffer.free(), 8);
+
+    QByteArray out(8, 0);
+    QCOMPARE(buffer.write("xyz", 3), 3);
+    QCOMPARE(buffer.read(out.data(), 8), 3);
+    QCOMPARE(out.left(3), QByteArray("xyz"));
+}
+
+void tst_QAudioRingBuffer::producerConsumer()
+{
+    const int total = 4 * 1024 * 1024;
+    QAudioRingBuffer buffer(1000);
+
+    QScopedPointer<QThread> producer(QThread::create([&buffer, total] {
+        char chunk[333];
+        int written = 0;
+        int size = 1;
+        while (written < total) {
+            size = size % 333 + 1;
+            const int count = qMin(size, total - written);
+            for (int i = 0; i < count; ++i)
+                chunk[i] = char(written + i);
+            const int accepted = buffer.write(chunk, count);
+            if (accepted == 0)
+                QThread::yieldCurrentThread();
+            written += accepted;
+        }
+    }));
+    producer->start();
+
+    char chunk[517];
+    int received = 0;
+    int size = 1;
+    bool ok = true;
+    while (received < total) {
+        size = size % 517 + 1;
+        const int count = buffer.read(chunk, size);
+        if (count == 0)
+            QThread::yieldCurrentThread();
+        for (int i = 0; i < count; ++i)
+            ok &= chunk[i] == char(received + i);
+        received += count;
+    }
+
+    QVERIFY(producer->wait());
+    QVERIFY(ok);
+    QCOMPARE(received, total);
+    QCOMPARE(buffer.used(), 0);
+}
+
+void tst_QAudioRingBuffer::device()
+{
+    QAudioRingBuffer buffer(8);
+    RingBufferDevice device(&buffer);
+    QCOMPARE(device.ringBuffer(), &buffer);
+    QVERIFY(device.open(QIODevice::WriteOnly | QIODevice::Unbuffered));
+
+    // Writes never block, only what fits is taken
+    QCOMPARE(device.write("0123456789", 10), qint64(8));
+    QCOMPARE(device.notified, qint64(8));
+    QCOMPARE(device.write("a", 1), qint64(0));
+    QCOMPARE(device.notified, qint64(8));
+
+    QByteArray out(8, 0);
+    QCOMPARE(buffer.read(out.data(), 8), 8);
+    QCOMPARE(out, QByteArray("01234567"));
+
+    QCOMPARE(device.write("ab", 2), qint64(2));
+    QCOMPARE(device.notified, qint64(10));
+    QCOMPARE(buffer.used(), 2);
+}
+
+QTEST_APPLESS_MAIN(tst_QAudioRingBuffer)
+
+#include "tst_qaudioringbuffer.moc"
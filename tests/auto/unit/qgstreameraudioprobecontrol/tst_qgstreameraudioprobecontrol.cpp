@@ -0,0 +1,209 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/gsttools
+
+#include <QtTest/QtTest>
+
+#include <private/qgstreameraudioprobecontrol_p.h>
+#include <private/qgstutils_p.h>
+
+#include <gst/gst.h>
+
+// Feeds buffers to the control as if they were probed on a streaming thread
+class AudioProbe : public QGstreamerAudioProbeControl
+{
+public:
+    AudioProbe()
+        : QGstreamerAudioProbeControl(nullptr)
+    {
+        GstCaps *caps = gst_caps_from_string(
+                    "audio/x-raw,format=S16LE,layout=interleaved,rate=44100,channels=2");
+        probeCaps(caps);
+        gst_caps_unref(caps);
+
+        connect(this, &QMediaAudioProbeControl::audioBufferProbed,
+                this, [this](const QAudioBuffer &buffer) {
+            delivered.append(int(buffer.startTime() / BufferDuration));
+        });
+    }
+
+    // Buffer n starts at n * BufferDuration microseconds
+    void push(int index)
+    {
+        GstBuffer *buffer = gst_buffer_new_allocate(nullptr, 441 * 4, nullptr);
+        GST_BUFFER_TIMESTAMP(buffer) = index * BufferDuration * GST_USECOND;
+        probeBuffer(buffer);
+        gst_buffer_unref(buffer);
+    }
+
+    static const int BufferDuration = 10000;
+
+    QList<int> delivered;
+};
+
+class tst_QGstreamerAudioProbeControl : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QGstreamerAudioProbeControl()
+    {
+        QGstUtils::initializeGst();
+    }
+
+private slots:
+    void initTestCase();
+
+    void latestOnly();
+    void queueDropsOldest();
+    void raiseLimit();
+    void lowerLimit();
+    void disableQueue();
+};
+
+void tst_QGstreamerAudioProbeControl::initTestCase()
+{
+    AudioProbe probe;
+    if (probe.queueLimit() != 0)
+        QSKIP("QT_GSTREAMER_AUDIO_PROBE_QUEUE overrides the default queue limit");
+}
+
+void tst_QGstreamerAudioProbeControl::latestOnly()
+{
+    AudioProbe probe;
+    QCOMPARE(probe.queueLimit(), 0);
+
+    for (int i = 0; i < 3; ++i)
+        probe.push(i);
+    QCOMPARE(probe.droppedBufferCount(), quint64(2));
+
+    QTRY_COMPARE(probe.delivered, QList<int>({ 2 }));
+
+    // Nothing is pending any more, the next buffer is delivered as well
+    probe.push(3);
+    QTRY_COMPARE(probe.delivered, QList<int>({ 2, 3 }));
+    QCOMPARE(probe.droppedBufferCount(), quint64(2));
+}
+
+void tst_QGstreamerAudioProbeControl::queueDropsOldest()
+{
+    AudioProbe probe;
+    probe.setQueueLimit(3);
+    QCOMPARE(probe.queueLimit(), 3);
+
+    for (int i = 0; i < 3; ++i)
+        probe.push(i);
+    QCOMPARE(probe.droppedBufferCount(), quint64(0));
+
+    // Each buffer over the limit drops the oldest queued one
+    probe.push(3);
+    QCOMPARE(probe.droppedBufferCount(), quint64(1));
+    probe.push(4);
+    QCOMPARE(probe.droppedBufferCount(), quint64(2));
+
+    QTRY_COMPARE(probe.delivered, QList<int>({ 2, 3, 4 }));
+    QCOMPARE(probe.droppedBufferCount(), quint64(2));
+
+    // The queue was emptied by the delivery
+    probe.push(5);
+    QTRY_COMPARE(probe.delivered, QList<int>({ 2, 3, 4, 5 }));
+    QCOMPARE(probe.droppedBufferCount(), quint64(2));
+}
+
+void tst_QGstreamerAudioProbeControl::raiseLimit()
+{
+    AudioProbe probe;
+
+    probe.push(0);
+    probe.push(1);
+    QCOMPARE(probe.droppedBufferCount(), quint64(1));
+
+    // The pending buffer moves to the head of the queue
+    probe.setQueueLimit(3);
+    QCOMPARE(probe.droppedBufferCount(), quint64(1));
+
+    probe.push(2);
+    probe.push(3);
+    probe.push(4);
+    QCOMPARE(probe.droppedBufferCount(), quint64(2));
+
+    QTRY_COMPARE(probe.delivered, QList<int>({ 2, 3, 4 }));
+
+    // Queued buffers stay in order when nothing is dropped
+    probe.setQueueLimit(4);
+    probe.push(5);
+    probe.push(6);
+    QTRY_COMPARE(probe.delivered, QList<int>({ 2, 3, 4, 5, 6 }));
+    QCOMPARE(probe.droppedBufferCount(), quint64(2));
+}
+
+void tst_QGstreamerAudioProbeControl::lowerLimit()
+{
+    AudioProbe probe;
+    probe.setQueueLimit(5);
+
+    for (int i = 0; i < 5; ++i)
+        probe.push(i);
+    QCOMPARE(probe.droppedBufferCount(), quint64(0));
+
+    // The oldest buffers are dropped down to the new limit
+    probe.setQueueLimit(2);
+    QCOMPARE(probe.queueLimit(), 2);
+    QCOMPARE(probe.droppedBufferCount(), quint64(3));
+
+    probe.push(5);
+    QCOMPARE(probe.droppedBufferCount(), quint64(4));
+
+    QTRY_COMPARE(probe.delivered, QList<int>({ 4, 5 }));
+    QCOMPARE(probe.droppedBufferCount(), quint64(4));
+}
+
+void tst_QGstreamerAudioProbeControl::disableQueue()
+{
+    AudioProbe probe;
+    probe.setQueueLimit(4);
+
+    for (int i = 0; i < 3; ++i)
+        probe.push(i);
+
+    // Only the most recent queued buffer is kept
+    probe.setQueueLimit(-1);
+    QCOMPARE(probe.queueLimit(), 0);
+    QCOMPARE(probe.droppedBufferCount(), quint64(2));
+
+    probe.push(3);
+    QCOMPARE(probe.droppedBufferCount(), quint64(3));
+
+    QTRY_COMPARE(probe.delivered, QList<int>({ 3 }));
+    QCOMPARE(probe.droppedBufferCount(), quint64(3));
+}
+
+QTEST_GUILESS_MAIN(tst_QGstreamerAudioProbeControl)
+
+#include "tst_qgstreameraudioprobecontrol.moc"
@@ -0,0 +1,17 @@
+CONFIG += testcase
+TARGET = tst_qgstreamerprerollbuffer
+
+QT += testlib
+
+QMAKE_USE += gstreamer
+
+# The buffer lives in the media capture plugin, build it into the test
+CAPTURE_PLUGIN = ../../../../src/plugins/gstreamer/mediacapture
+INCLUDEPATH += $$CAPTURE_PLUGIN
+
+HEADERS += \
+    $$CAPTURE_PLUGIN/qgstreamerprerollbuffer.h
+
+SOURCES += \
+    tst_qgstreamerprerollbuffer.cpp \
+    $$CAPTURE_PLUGIN/qgstreamerprerollbuffer.cpp
@@ -0,0 +1,237 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/plugins/gstreamer/mediacapture
+
+#include <QtTest/QtTest>
+
+#include "qgstreamerprerollbuffer.h"
+
+#include <gst/gst.h>
+
+// Frames are 100 ms apart with a key frame every fifth frame, so a group of
+// pictures lasts 500 ms
+static const GstClockTime FrameDuration = 100 * GST_MSECOND;
+static const int GroupLength = 5;
+static const gsize FrameSize = 1000;
+
+static GstBuffer *newFrame(GstClockTime pts, bool keyFrame)
+{
+    GstBuffer *buffer = gst_buffer_new_allocate(nullptr, FrameSize, nullptr);
+    GST_BUFFER_PTS(buffer) = pts;
+    if (!keyFrame)
+        GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    return buffer;
+}
+
+static void appendFrames(QGstreamerPreRollBuffer *preRoll, int first, int count)
+{
+    for (int i = first; i < first + count; ++i)
+        preRoll->append(newFrame(i * FrameDuration, i % GroupLength == 0));
+}
+
+static QList<GstClockTime> takeTimes(QGstreamerPreRollBuffer *preRoll)
+{
+    QList<GstClockTime> times;
+    const QList<GstBuffer *> buffers = preRoll->takeBuffers();
+    for (GstBuffer *buffer : buffers) {
+        times.append(GST_BUFFER_PTS(buffer));
+        gst_buffer_unref(buffer);
+    }
+    return times;
+}
+
+class tst_QGstreamerPreRollBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void keyFrameAlignment();
+    void durationLimit();
+    void sizeLimit();
+    void sizeLimitClear();
+    void dropBefore();
+    void invalidTimestamps();
+    void takeBuffers();
+};
+
+void tst_QGstreamerPreRollBuffer::initTestCase()
+{
+    gst_init(nullptr, nullptr);
+}
+
+void tst_QGstreamerPreRollBuffer::keyFrameAlignment()
+{
+    QGstreamerPreRollBuffer preRoll;
+    preRoll.setDuration(10 * GST_SECOND);
+
+    // Delta frames can't be decoded without the key frame before them
+    appendFrames(&preRoll, 1, GroupLength - 1);
+    QVERIFY(preRoll.isEmpty());
+    QCOMPARE(preRoll.size(), qint64(0));
+    QVERIFY(!GST_CLOCK_TIME_IS_VALID(preRoll.startTime()));
+    QVERIFY(!GST_CLOCK_TIME_IS_VALID(preRoll.endTime()));
+
+    appendFrames(&preRoll, GroupLength, 3);
+    QCOMPARE(preRoll.count(), 3);
+    QCOMPARE(preRoll.size(), qint64(3 * FrameSize));
+    QCOMPARE(preRoll.startTime(), GroupLength * FrameDuration);
+    QCOMPARE(preRoll.endTime(), (GroupLength + 2) * FrameDuration);
+}
+
+void tst_QGstreamerPreRollBuffer::durationLimit()
+{
+    QGstreamerPreRollBuffer preRoll;
+    preRoll.setDuration(GST_SECOND);
+
+    // Whole groups are dropped as long as the rest still covers a second
+    appendFrames(&preRoll, 0, 30);
+    QCOMPARE(preRoll.startTime(), 15 * FrameDuration);
+    QCOMPARE(preRoll.endTime(), 29 * FrameDuration);
+    QCOMPARE(preRoll.count(), 15);
+    QCOMPARE(preRoll.size(), qint64(15 * FrameSize));
+
+    // A shorter duration drops more groups right away
+    preRoll.setDuration(300 * GST_MSECOND);
+    QCOMPARE(preRoll.startTime(), 25 * FrameDuration);
+    QCOMPARE(preRoll.count(), 5);
+}
+
+void tst_QGstreamerPreRollBuffer::sizeLimit()
+{
+    QGstreamerPreRollBuffer preRoll;
+    preRoll.setDuration(10 * GST_SECOND);
+    preRoll.setMaxSize(12 * FrameSize);
+
+    // The oldest groups go once the frames take up more than the limit
+    appendFrames(&preRoll, 0, 3 * GroupLength);
+    QCOMPARE(preRoll.startTime(), GroupLength * FrameDuration);
+    QCOMPARE(preRoll.count(), 2 * GroupLength);
+    QCOMPARE(preRoll.size(), qint64(2 * GroupLength * FrameSize));
+    QVERIFY(preRoll.size() <= preRoll.maxSize());
+}
+
+void tst_QGstreamerPreRollBuffer::sizeLimitClear()
+{
+    QGstreamerPreRollBuffer preRoll;
+    preRoll.setDuration(10 * GST_SECOND);
+    preRoll.setMaxSize(3 * FrameSize + FrameSize / 2);
+
+    // A single group that doesn't fit can't be cut
+    appendFrames(&preRoll, 0, 4);
+    QVERIFY(preRoll.isEmpty());
+    QCOMPARE(preRoll.size(), qint64(0));
+    QVERIFY(!GST_CLOCK_TIME_IS_VALID(preRoll.endTime()));
+
+    // The rest of the group is dropped too, the pre-roll starts again at the next key frame
+    appendFrames(&preRoll, 4, 1);
+    QVERIFY(preRoll.isEmpty());
+    appendFrames(&preRoll, GroupLength, 2);
+    QCOMPARE(preRoll.count(), 2);
+    QCOMPARE(preRoll.startTime(), GroupLength * FrameDuration);
+
+    // Lowering the limit applies to what is already there
+    preRoll.setMaxSize(FrameSize);
+    QVERIFY(preRoll.isEmpty());
+}
+
+void tst_QGstreamerPreRollBuffer::dropBefore()
+{
+    QGstreamerPreRollBuffer preRoll;
+    preRoll.setDuration(10 * GST_SECOND);
+    appendFrames(&preRoll, 0, 3 * GroupLength);
+
+    // Only groups that end before the time are dropped
+    preRoll.dropBefore(GroupLength * FrameDuration - 1);
+    QCOMPARE(preRoll.startTime(), GstClockTime(0));
+
+    preRoll.dropBefore(GroupLength * FrameDuration + 2 * FrameDuration);
+    QCOMPARE(preRoll.startTime(), GroupLength * FrameDuration);
+    QCOMPARE(preRoll.count(), 2 * GroupLength);
+
+    // The last group is always kept
+    preRoll.dropBefore(100 * GST_SECOND);
+    QCOMPARE(preRoll.startTime(), 2 * GroupLength * FrameDuration);
+    QCOMPARE(preRoll.count(), GroupLength);
+    QCOMPARE(preRoll.endTime(), (3 * GroupLength - 1) * FrameDuration);
+}
+
+void tst_QGstreamerPreRollBuffer::invalidTimestamps()
+{
+    QGstreamerPreRollBuffer preRoll;
+    preRoll.setDuration(GST_SECOND);
+
+    // Without any time stamp there's nothing to tell the duration covered
+    for (int i = 0; i < 3 * GroupLength; ++i)
+        preRoll.append(newFrame(GST_CLOCK_TIME_NONE, i % GroupLength == 0));
+    QCOMPARE(preRoll.count(), 3 * GroupLength);
+    QVERIFY(!GST_CLOCK_TIME_IS_VALID(preRoll.endTime()));
+
+    // The size limit still applies
+    preRoll.setMaxSize(2 * GroupLength * FrameSize);
+    QCOMPARE(preRoll.count(), 2 * GroupLength);
+    preRoll.clear();
+    preRoll.setMaxSize(0);
+
+    // Frames without a time stamp take the latest one
+    appendFrames(&preRoll, 0, 3);
+    preRoll.append(newFrame(GST_CLOCK_TIME_NONE, false));
+    QCOMPARE(preRoll.count(), 4);
+    QCOMPARE(preRoll.endTime(), 2 * FrameDuration);
+
+    // Time stamps going back don't move the end backwards
+    preRoll.append(newFrame(FrameDuration, false));
+    QCOMPARE(preRoll.endTime(), 2 * FrameDuration);
+}
+
+void tst_QGstreamerPreRollBuffer::takeBuffers()
+{
+    QGstreamerPreRollBuffer preRoll;
+    preRoll.setDuration(GST_SECOND);
+    appendFrames(&preRoll, 0, 7);
+
+    const QList<GstClockTime> times = takeTimes(&preRoll);
+    QCOMPARE(times.count(), 7);
+    for (int i = 0; i < times.count(); ++i)
+        QCOMPARE(times.at(i), i * FrameDuration);
+
+    QVERIFY(preRoll.isEmpty());
+    QCOMPARE(preRoll.size(), qint64(0));
+    QVERIFY(!GST_CLOCK_TIME_IS_VALID(preRoll.endTime()));
+
+    // The next recording starts at a key frame again
+    appendFrames(&preRoll, 7, 4);
+    QCOMPARE(preRoll.count(), 1);
+    QCOMPARE(preRoll.startTime(), 2 * GroupLength * FrameDuration);
+}
+
+QTEST_GUILESS_MAIN(tst_QGstreamerPreRollBuffer)
+
+#include "tst_qgstreamerprerollbuffer.moc"
@@ -30,10 +30,13 @@
 
 #include <QtTest/QtTest>
 
+#include <QtCore/qthread.h>
 #include <QtCore/qtimer.h>
 
 #include <QtMultimedia/qmediametadata.h>
 #include <qmediaobject.h>
+#include <private/qmediaobject_p.h>
+#include <private/qmedianotifyscheduler_p.h>
 #include <qmediaservice.h>
 #include <qmetadatareadercontrol.h>
 #include <qaudioinputselectorcontrol.h>
@@ -87,6 +90,9 @@ private slots:
     void notifySignals();
     void notifyInterval_data();
     void notifyInterval();
+    void sharedNotifyTimer();
+    void notifyAfterMoveToThread();
+    void notifyOnChange();
 
     void nullMetaDataControl();
     void isMetaDataAvailable();
@@ -321,6 +327,104 @@ void tst_QMediaObject::notifyInterval()
     QCOMPARE(spy.count(), 1);
 }
 
+void tst_QMediaObject::sharedNotifyTimer()
+{
+    QMediaNotifyScheduler *scheduler = QMediaNotifyScheduler::instance();
+    const int timers = scheduler->timerCount();
+
+    QtTestMediaObject first;
+    QtTestMediaObject second;
+    first.setNotifyInterval(250);
+    second.setNotifyInterval(250);
+
+    // Nothing is scheduled until a property is watched
+    QCOMPARE(scheduler->timerCount(), timers);
+
+    QSignalSpy firstSpy(&first, SIGNAL(aChanged(int)));
+    QSignalSpy secondSpy(&second, SIGNAL(aChanged(int)));
+    first.addPropertyWatch("a");
+    second.addPropertyWatch("a");
+    QCOMPARE(scheduler->timerCount(), timers + 1);
+
+    // Both objects are notified on the same tick
+    QTRY_COMPARE(firstSpy.count(), 1);
+    QCOMPARE(secondSpy.count(), 1);
+
+    second.setNotifyInterval(300);
+    QCOMPARE(scheduler->timerCount(), timers + 2);
+
+    first.removePropertyWatch("a");
+    QCOMPARE(scheduler->timerCount(), timers + 1);
+
+    {
+        QtTestMediaObject third;
+        third.setNotifyInterval(300);
+        third.addPropertyWatch("a");
+        QCOMPARE(scheduler->timerCount(), timers + 1);
+    }
+
+    second.removePropertyWatch("a");
+    QCOMPARE(scheduler->timerCount(), timers);
+}
+
+void tst_QMediaObject::notifyAfterMoveToThread()
+{
+    QMediaNotifyScheduler *scheduler = QMediaNotifyScheduler::instance();
+    const int timers = scheduler->timerCount();
+
+    QThread thread;
+    thread.start();
+
+    QtTestMediaObject *object = new QtTestMediaObject;
+    QAtomicPointer<QThread> notifyThread;
+    connect(object, &QtTestMediaObject::aChanged, object, [&notifyThread] {
+        notifyThread.storeRelease(QThread::currentThread());
+    }, Qt::DirectConnection);
+
+    object->setNotifyInterval(10);
+    object->addPropertyWatch("a");
+    QCOMPARE(scheduler->timerCount(), timers + 1);
+
+    // The watch follows the object instead of ticking on this thread
+    object->moveToThread(&thread);
+    QCOMPARE(scheduler->timerCount(), timers);
+    notifyThread.storeRelease(nullptr);
+    QTRY_COMPARE(notifyThread.loadAcquire(), &thread);
+
+    object->deleteLater();
+    thread.quit();
+    QVERIFY(thread.wait());
+    QCOMPARE(scheduler->timerCount(), timers);
+}
+
+void tst_QMediaObject::notifyOnChange()
+{
+    QtTestMediaObject object;
+    object.setNotifyInterval(10);
+    QSignalSpy spy(&object, SIGNAL(aChanged(int)));
+
+    QMediaObjectPrivate::get(&object)->addPropertyWatch("a", QMediaObjectPrivate::NotifyOnChange);
+
+    // The first tick always notifies, later ones only when the value moved
+    QTRY_COMPARE(spy.count(), 1);
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 1);
+
+    object.setA(12);
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(spy.last().value(0).toInt(), 12);
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 2);
+
+    // Watching again forces a notification
+    QMediaObjectPrivate::get(&object)->addPropertyWatch("a", QMediaObjectPrivate::NotifyOnChange);
+    QTRY_COMPARE(spy.count(), 3);
+
+    // Plain watches notify on every tick
+    object.addPropertyWatch("a");
+    QTRY_VERIFY(spy.count() > 4);
+}
+
 void tst_QMediaObject::nullMetaDataControl()
 {
     const QString titleKey(QLatin1String("Title"));
@@ -101,6 +101,7 @@ private slots:
     void testSeekable();
     void testPlaybackRate_data();
     void testPlaybackRate();
+    void testSeekMode();
     void testError_data();
     void testError();
     void testErrorString_data();
@@ -120,6 +121,7 @@ private slots:
     void testSetVideoOutputNoControl();
     void testSetVideoOutputDestruction();
     void testPositionPropertyWatch();
+    void testClockDrivenPosition();
     void debugEnums();
     void testPlayerFlags();
     void testDestructor();
@@ -229,6 +231,7 @@ void tst_QMediaPlayer::testNullService()
     QCOMPARE(player.bufferStatus(), 0);
     QCOMPARE(player.isSeekable(), false);
     QCOMPARE(player.playbackRate(), qreal(0));
+    QCOMPARE(player.seekMode(), QMediaPlayer::DefaultSeek);
     QCOMPARE(player.error(), QMediaPlayer::ServiceMissingError);
     QCOMPARE(player.isAvailable(), false);
     QCOMPARE(player.availability(), QMultimedia::ServiceMissing);
@@ -295,6 +298,9 @@ void tst_QMediaPlayer::testNullService()
         player.setPlaybackRate(playbackRate);
         QCOMPARE(player.playbackRate(), qreal(0));
         QCOMPARE(spy.count(), 0);
+    } {
+        player.setSeekMode(QMediaPlayer::AccurateSeek);
+        QCOMPARE(player.seekMode(), QMediaPlayer::DefaultSeek);
     } {
         QMediaPlaylist playlist;
         player.setPlaylist(&playlist);
@@ -536,6 +542,21 @@ void tst_QMediaPlayer::testPlaybackRate()
     }
 }
 
+void tst_QMediaPlayer::testSeekMode()
+{
+    QCOMPARE(player->seekMode(), QMediaPlayer::DefaultSeek);
+
+    player->setSeekMode(QMediaPlayer::AccurateSeek);
+    QCOMPARE(player->seekMode(), QMediaPlayer::AccurateSeek);
+    QCOMPARE(mockService->mockControl->_seekMode, QMediaPlayer::AccurateSeek);
+
+    player->setSeekMode(QMediaPlayer::PreviousKeyFrameSeek);
+    QCOMPARE(player->seekMode(), QMediaPlayer::PreviousKeyFrameSeek);
+
+    player->setSeekMode(QMediaPlayer::DefaultSeek);
+    QCOMPARE(player->seekMode(), QMediaPlayer::DefaultSeek);
+}
+
 void tst_QMediaPlayer::testError_data()
 {
     setupCommonTestData();
@@ -1165,6 +1186,45 @@ void tst_QMediaPlayer::testPositionPropertyWatch()
     delete playlist;
 }
 
+void tst_QMediaPlayer::testClockDrivenPosition()
+{
+    QMediaContent content(QUrl(QLatin1String("test://audio/song1.mp3")));
+
+    mockService->setIsValid(true);
+    mockService->setClockDrivenPosition(true);
+    mockService->setState(QMediaPlayer::StoppedState, QMediaPlayer::NoMedia);
+    player->setMedia(content);
+
+    // Slow intervals are polled, skipping ticks where the position is unchanged
+    player->setNotifyInterval(100);
+    QSignalSpy positionSpy(player, SIGNAL(positionChanged(qint64)));
+    player->play();
+    QCOMPARE(player->state(), QMediaPlayer::PlayingState);
+    QCOMPARE(mockService->mockControl->_positionUpdateInterval, 0);
+    QTRY_COMPARE(positionSpy.count(), 1);
+    QTest::qWait(300);
+    QCOMPARE(positionSpy.count(), 1);
+
+    // High rate updates are left to the control
+    player->setNotifyInterval(20);
+    QCOMPARE(mockService->mockControl->_positionUpdateInterval, 20);
+    positionSpy.clear();
+    mockService->setPosition(500);
+    QTest::qWait(100);
+    QCOMPARE(positionSpy.count(), 0);
+
+    player->pause();
+    QCOMPARE(mockService->mockControl->_positionUpdateInterval, 0);
+
+    // Controls without clock support keep being polled
+    mockService->setClockDrivenPosition(false);
+    player->play();
+    QTRY_VERIFY(positionSpy.count() > 0);
+    QCOMPARE(positionSpy.last().value(0).toLongLong(), qint64(500));
+
+    player->stop();
+}
+
 void tst_QMediaPlayer::debugEnums()
 {
     QTest::ignoreMessage(QtDebugMsg, "QMediaPlayer::PlayingState");
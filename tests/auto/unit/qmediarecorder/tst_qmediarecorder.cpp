@@ -65,6 +65,8 @@ private slots:
     void testRecord();
     void testMute();
     void testVolume();
+    void testPreRoll();
+    void testSegments();
     void testAudioDeviceControl();
     void testAudioEncodeControl();
     void testMediaFormatsControl();
@@ -196,6 +198,10 @@ void tst_QMediaRecorder::testNullControls()
     QCOMPARE(recorder.audioSettings(), QAudioEncoderSettings());
     QCOMPARE(recorder.videoSettings(), QVideoEncoderSettings());
     QCOMPARE(recorder.containerFormat(), QString());
+    QCOMPARE(recorder.preRollDuration(), qint64(0));
+    QCOMPARE(recorder.preRollBufferSize(), qint64(0));
+    QCOMPARE(recorder.segmentDuration(), qint64(0));
+    QCOMPARE(recorder.segmentSize(), qint64(0));
 
     recorder.setOutputLocation(QUrl("file://test/save/file.mp4"));
     QCOMPARE(recorder.outputLocation(), QUrl());
@@ -382,6 +388,62 @@ void tst_QMediaRecorder::testVolume()
     QCOMPARE(volumeChanged.size(), 2);
 }
 
+void tst_QMediaRecorder::testPreRoll()
+{
+    QCOMPARE(capture->preRollDuration(), qint64(0));
+    QCOMPARE(capture->preRollBufferSize(), qint64(0));
+
+    QSignalSpy durationSpy(capture, SIGNAL(preRollDurationChanged(qint64)));
+    QSignalSpy sizeSpy(capture, SIGNAL(preRollBufferSizeChanged(qint64)));
+
+    capture->setPreRollDuration(5000);
+    capture->setPreRollBufferSize(16 * 1024 * 1024);
+    QCOMPARE(capture->preRollDuration(), qint64(5000));
+    QCOMPARE(capture->preRollBufferSize(), qint64(16 * 1024 * 1024));
+    QCOMPARE(durationSpy.count(), 1);
+    QCOMPARE(durationSpy.last().value(0).toLongLong(), qint64(5000));
+    QCOMPARE(sizeSpy.count(), 1);
+    QCOMPARE(sizeSpy.last().value(0).toLongLong(), qint64(16 * 1024 * 1024));
+
+    // Setting the same values again is not a change
+    capture->setPreRollDuration(5000);
+    capture->setPreRollBufferSize(16 * 1024 * 1024);
+    QCOMPARE(durationSpy.count(), 1);
+    QCOMPARE(sizeSpy.count(), 1);
+
+    // Negative values are clamped
+    capture->setPreRollDuration(-1);
+    capture->setPreRollBufferSize(-1);
+    QCOMPARE(capture->preRollDuration(), qint64(0));
+    QCOMPARE(capture->preRollBufferSize(), qint64(0));
+    QCOMPARE(durationSpy.count(), 2);
+    QCOMPARE(durationSpy.last().value(0).toLongLong(), qint64(0));
+    QCOMPARE(sizeSpy.count(), 2);
+    QCOMPARE(sizeSpy.last().value(0).toLongLong(), qint64(0));
+}
+
+void tst_QMediaRecorder::testSegments()
+{
+    QCOMPARE(capture->segmentDuration(), qint64(0));
+    QCOMPARE(capture->segmentSize(), qint64(0));
+
+    capture->setSegmentDuration(60000);
+    capture->setSegmentSize(100 * 1024 * 1024);
+    QCOMPARE(capture->segmentDuration(), qint64(60000));
+    QCOMPARE(capture->segmentSize(), qint64(100 * 1024 * 1024));
+
+    // Negative values are clamped
+    capture->setSegmentDuration(-1);
+    capture->setSegmentSize(-1);
+    QCOMPARE(capture->segmentDuration(), qint64(0));
+    QCOMPARE(capture->segmentSize(), qint64(0));
+
+    QSignalSpy segmentSignal(capture, SIGNAL(segmentFinished(QUrl)));
+    emit mock->segmentFinished(QUrl::fromLocalFile("segment_00000.mp4"));
+    QCOMPARE(segmentSignal.count(), 1);
+    QCOMPARE(segmentSignal.at(0).at(0).toUrl(), QUrl::fromLocalFile("segment_00000.mp4"));
+}
+
 void tst_QMediaRecorder::testAudioDeviceControl()
 {
     QSignalSpy readSignal(audio,SIGNAL(activeInputChanged(QString)));
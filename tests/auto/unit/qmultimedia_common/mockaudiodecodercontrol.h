@@ -39,6 +39,7 @@
 #include <QIODevice>
 
 #define MOCK_DECODER_MAX_BUFFERS 10
+#define MOCK_DECODER_DELIVERED_FRAMES 100
 
 QT_BEGIN_NAMESPACE
 
@@ -51,7 +52,11 @@ public:
         : QAudioDecoderControl(parent)
         , mState(QAudioDecoder::StoppedState)
         , mDevice(0)
+        , mDeliveredValue(0)
         , mPosition(-1)
+        , mQueueLimit(0)
+        , mFramesPerBuffer(0)
+        , mFastDecoding(false)
         , mSerial(0)
     {
         mFormat.setChannelCount(1);
@@ -84,6 +89,36 @@ public:
         }
     }
 
+    int bufferQueueLimit() const
+    {
+        return mQueueLimit;
+    }
+
+    void setBufferQueueLimit(int buffers)
+    {
+        mQueueLimit = buffers;
+    }
+
+    int framesPerBuffer() const
+    {
+        return mFramesPerBuffer;
+    }
+
+    void setFramesPerBuffer(int frames)
+    {
+        mFramesPerBuffer = frames;
+    }
+
+    bool fastDecoding() const
+    {
+        return mFastDecoding;
+    }
+
+    void setFastDecoding(bool enabled)
+    {
+        mFastDecoding = enabled;
+    }
+
     void setSourceFilename(const QString &fileName)
     {
         mSource = fileName;
@@ -179,11 +214,22 @@ private slots:
 
         // We just keep the length of mBuffers to 3 or less.
         if (mBuffers.length() < 3) {
-            QByteArray b(sizeof(mSerial), 0);
-            memcpy(b.data(), &mSerial, sizeof(mSerial));
-            qint64 position = (sizeof(mSerial) * mSerial * qint64(1000000)) / (mFormat.sampleRate() * mFormat.channelCount());
-            mSerial++;
-            mBuffers.push_back(QAudioBuffer(b, mFormat, position));
+            if (mDeliveredFormat.isValid()) {
+                // Pretend the backend cannot decode to the requested format
+                QByteArray b(mDeliveredFormat.bytesForFrames(MOCK_DECODER_DELIVERED_FRAMES), 0);
+                qint16 *samples = reinterpret_cast<qint16 *>(b.data());
+                for (int i = 0; i < b.size() / int(sizeof(qint16)); ++i)
+                    samples[i] = mDeliveredValue;
+                qint64 position = mDeliveredFormat.durationForFrames(qint64(MOCK_DECODER_DELIVERED_FRAMES) * mSerial);
+                mSerial++;
+                mBuffers.push_back(QAudioBuffer(b, mDeliveredFormat, position));
+            } else {
+                QByteArray b(sizeof(mSerial), 0);
+                memcpy(b.data(), &mSerial, sizeof(mSerial));
+                qint64 position = (sizeof(mSerial) * mSerial * qint64(1000000)) / (mFormat.sampleRate() * mFormat.channelCount());
+                mSerial++;
+                mBuffers.push_back(QAudioBuffer(b, mFormat, position));
+            }
             emit bufferReady();
             if (mBuffers.count() == 1)
                 emit bufferAvailableChanged(true);
@@ -195,7 +241,12 @@ public:
     QString mSource;
     QIODevice *mDevice;
     QAudioFormat mFormat;
+    QAudioFormat mDeliveredFormat; // 16-bit signed, filled with mDeliveredValue
+    qint16 mDeliveredValue;
     qint64 mPosition;
+    int mQueueLimit;
+    int mFramesPerBuffer;
+    bool mFastDecoding;
 
     int mSerial;
     QList<QAudioBuffer> mBuffers;
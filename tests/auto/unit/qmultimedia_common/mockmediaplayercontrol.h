@@ -50,8 +50,11 @@ public:
         , _videoAvailable(false)
         , _isSeekable(true)
         , _playbackRate(qreal(1.0))
+        , _seekMode(QMediaPlayer::DefaultSeek)
         , _stream(0)
         , _isValid(false)
+        , _clockDrivenPosition(false)
+        , _positionUpdateInterval(0)
     {}
 
     QMediaPlayer::State state() const { return _state; }
@@ -81,6 +84,9 @@ public:
     qreal playbackRate() const { return _playbackRate; }
     void setPlaybackRate(qreal rate) { if (rate != _playbackRate) emit playbackRateChanged(_playbackRate = rate); }
 
+    QMediaPlayer::SeekMode seekMode() const { return _seekMode; }
+    void setSeekMode(QMediaPlayer::SeekMode mode) { _seekMode = mode; }
+
     QMediaContent media() const { return _media; }
     void setMedia(const QMediaContent &content, QIODevice *stream)
     {
@@ -98,6 +104,8 @@ public:
     void pause() { if (_isValid && !_media.isNull() && _state != QMediaPlayer::PausedState) emit stateChanged(_state = QMediaPlayer::PausedState); }
     void stop() { if (_state != QMediaPlayer::StoppedState) emit stateChanged(_state = QMediaPlayer::StoppedState); }
 
+    bool setPositionUpdateInterval(int milliseconds) { _positionUpdateInterval = milliseconds; return _clockDrivenPosition; }
+
     QMediaPlayer::State _state;
     QMediaPlayer::MediaStatus _mediaStatus;
     QMediaPlayer::Error _error;
@@ -111,9 +119,12 @@ public:
     bool _isSeekable;
     QPair<qint64, qint64> _seekRange;
     qreal _playbackRate;
+    QMediaPlayer::SeekMode _seekMode;
     QMediaContent _media;
     QIODevice *_stream;
     bool _isValid;
+    bool _clockDrivenPosition;
+    int _positionUpdateInterval;
     QString _errorString;
 };
 
@@ -125,6 +125,8 @@ public:
     void setError(QMediaPlayer::Error error) { mockControl->_error = error; emit mockControl->error(mockControl->_error, mockControl->_errorString); }
     void setErrorString(QString errorString) { mockControl->_errorString = errorString; emit mockControl->error(mockControl->_error, mockControl->_errorString); }
 
+    void setClockDrivenPosition(bool enable) { mockControl->_clockDrivenPosition = enable; }
+
     void setHasAudioRole(bool enable) { enableAudioRole = enable; }
     void setHasCustomAudioRole(bool enable) { enableCustomAudioRole = enable; }
 
@@ -144,6 +146,8 @@ public:
         mockControl->_media = QMediaContent();
         mockControl->_stream = 0;
         mockControl->_isValid = false;
+        mockControl->_clockDrivenPosition = false;
+        mockControl->_positionUpdateInterval = 0;
         mockControl->_errorString = QString();
 
         enableAudioRole = true;
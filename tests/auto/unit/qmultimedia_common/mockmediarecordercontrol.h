@@ -45,7 +45,11 @@ public:
         m_position(0),
         m_muted(false),
         m_volume(1.0),
-        m_settingAppliedCount(0)
+        m_settingAppliedCount(0),
+        m_preRollDuration(0),
+        m_preRollBufferSize(0),
+        m_segmentDuration(0),
+        m_segmentSize(0)
     {
     }
 
@@ -90,6 +94,46 @@ public:
         m_settingAppliedCount++;
     }
 
+    qint64 preRollDuration() const
+    {
+        return m_preRollDuration;
+    }
+
+    void setPreRollDuration(qint64 milliseconds)
+    {
+        m_preRollDuration = milliseconds;
+    }
+
+    qint64 preRollBufferSize() const
+    {
+        return m_preRollBufferSize;
+    }
+
+    void setPreRollBufferSize(qint64 bytes)
+    {
+        m_preRollBufferSize = bytes;
+    }
+
+    qint64 segmentDuration() const
+    {
+        return m_segmentDuration;
+    }
+
+    void setSegmentDuration(qint64 milliseconds)
+    {
+        m_segmentDuration = milliseconds;
+    }
+
+    qint64 segmentSize() const
+    {
+        return m_segmentSize;
+    }
+
+    void setSegmentSize(qint64 bytes)
+    {
+        m_segmentSize = bytes;
+    }
+
     using QMediaRecorderControl::error;
 
 public slots:
@@ -159,6 +203,10 @@ public:
     bool m_muted;
     qreal m_volume;
     int m_settingAppliedCount;
+    qint64 m_preRollDuration;
+    qint64 m_preRollBufferSize;
+    qint64 m_segmentDuration;
+    qint64 m_segmentSize;
 };
 
 #endif // MOCKRECORDERCONTROL_H
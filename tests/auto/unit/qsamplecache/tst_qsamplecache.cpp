@@ -44,6 +44,12 @@ private slots:
     void testEnoughCapacity();
     void testNotEnoughCapacity();
     void testInvalidFile();
+    void testSampleFormat();
+    void testLocalFileData();
+    void testLoadPriority();
+
+    void benchmarkLoadSamples_data();
+    void benchmarkLoadSamples();
 
 private:
 
@@ -181,6 +187,171 @@ void tst_QSampleCache::testInvalidFile()
     QVERIFY(!cache.isCached(QUrl::fromLocalFile("invalid")));
 }
 
+void tst_QSampleCache::testSampleFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(2);
+    format.setSampleSize(32);
+    format.setSampleType(QAudioFormat::Float);
+    format.setByteOrder(QAudioFormat::Endian(QSysInfo::ByteOrder));
+    format.setCodec(QLatin1String("audio/pcm"));
+
+    QSampleCache cache;
+    cache.setSampleFormat(format);
+    QCOMPARE(cache.sampleFormat(), format);
+    QCOMPARE(cache.conversionQuality(), QAudioResampler::MediumQuality);
+    cache.setConversionQuality(QAudioResampler::HighQuality);
+    QCOMPARE(cache.conversionQuality(), QAudioResampler::HighQuality);
+
+    // test.wav holds 44094 frames of mono 16 bit samples at 44.1 kHz
+    QSample* sample = cache.requestSample(QUrl::fromLocalFile(QFINDTESTDATA("testdata/test.wav")));
+    QVERIFY(sample);
+    QTRY_COMPARE(sample->state(), QSample::Ready);
+    QCOMPARE(sample->format(), format);
+    QCOMPARE(sample->data().size(), 47993 * format.bytesPerFrame());
+    QTRY_VERIFY(!cache.isLoading());
+
+    // Capacity is accounted for by the converted size
+    cache.setCapacity(sample->data().size() + 1);
+    sample->release();
+    QVERIFY(cache.isCached(QUrl::fromLocalFile(QFINDTESTDATA("testdata/test.wav"))));
+}
+
+void tst_QSampleCache::testLocalFileData()
+{
+    QFile file(QFINDTESTDATA("testdata/test.wav"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    // The data chunk of test.wav directly follows a 44 byte header
+    const QByteArray expected = file.readAll().mid(44, 0x1587c);
+
+    QSampleCache cache;
+    QSample* sample = cache.requestSample(QUrl::fromLocalFile(file.fileName()));
+    QVERIFY(sample);
+    QTRY_COMPARE(sample->state(), QSample::Ready);
+    QCOMPARE(sample->data(), expected);
+    QTRY_VERIFY(!cache.isLoading());
+    sample->release();
+}
+
+void tst_QSampleCache::testLoadPriority()
+{
+#ifdef QT_BUILD_INTERNAL
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QList<QUrl> urls;
+    for (int i = 0; i < 8; ++i) {
+        const QString fileName = dir.filePath(QString::fromLatin1("sample%1.wav").arg(i));
+        QVERIFY(QFile::copy(QFINDTESTDATA("testdata/test.wav"), fileName));
+        urls.append(QUrl::fromLocalFile(fileName));
+    }
+
+    QSampleCache cache;
+    cache.setMaxLoadingThreads(1);
+    QCOMPARE(cache.maxLoadingThreads(), 1);
+
+    // Nothing is loaded until the priority has been raised
+    qt_samplecache_set_loading_paused(&cache, true);
+
+    QMutex orderMutex;
+    QList<int> order;
+    QList<QSample*> samples;
+    for (int i = 0; i < urls.size(); ++i) {
+        QSample* sample = cache.requestSample(urls.at(i), QSampleCache::LowPriority);
+        QVERIFY(sample);
+        connect(sample, &QSample::ready, sample, [&orderMutex, &order, i]() {
+            QMutexLocker locker(&orderMutex);
+            order.append(i);
+        }, Qt::DirectConnection);
+        samples.append(sample);
+    }
+
+    // Samples are queued for the loader from the loading thread, wait until it got to all of them
+    QMetaObject::invokeMethod(samples.last(), []() {}, Qt::BlockingQueuedConnection);
+    QTest::qWait(50);
+    {
+        QMutexLocker locker(&orderMutex);
+        QVERIFY(order.isEmpty());
+    }
+
+    const int urgent = 5;
+    cache.setLoadPriority(urls.at(urgent), QSampleCache::HighPriority);
+    cache.setLoadPriority(QUrl::fromLocalFile(dir.filePath(QLatin1String("unknown.wav"))),
+                          QSampleCache::HighPriority);
+
+    qt_samplecache_set_loading_paused(&cache, false);
+
+    for (QSample* sample : qAsConst(samples))
+        QTRY_COMPARE(sample->state(), QSample::Ready);
+    QTRY_VERIFY(!cache.isLoading());
+
+    // The raised sample overtakes the ones requested before it, the rest keep their order
+    {
+        QMutexLocker locker(&orderMutex);
+        QCOMPARE(order, QList<int>({ urgent, 0, 1, 2, 3, 4, 6, 7 }));
+    }
+
+    for (QSample* sample : qAsConst(samples))
+        sample->release();
+#else
+    QSKIP("Needs the internal hook to pause the loader threads");
+#endif
+}
+
+void tst_QSampleCache::benchmarkLoadSamples_data()
+{
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("ideal threads") << QThread::idealThreadCount();
+}
+
+void tst_QSampleCache::benchmarkLoadSamples()
+{
+    QFETCH(int, threads);
+
+    // Measures the time until all samples of an application preloading its sounds are ready
+    const int sampleCount = 64;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QList<QUrl> urls;
+    for (int i = 0; i < sampleCount; ++i) {
+        const QString fileName = dir.filePath(QString::fromLatin1("sample%1.wav").arg(i));
+        QVERIFY(QFile::copy(QFINDTESTDATA("testdata/test.wav"), fileName));
+        urls.append(QUrl::fromLocalFile(fileName));
+    }
+
+    QBENCHMARK {
+        QSampleCache cache;
+        cache.setMaxLoadingThreads(threads);
+
+        // Wait on the ready signals rather than polling, which would measure the poll interval
+        QEventLoop loop;
+        QList<QSample*> samples;
+        const auto allReady = [&samples]() {
+            for (QSample* sample : qAsConst(samples)) {
+                if (sample->state() != QSample::Ready)
+                    return false;
+            }
+            return true;
+        };
+        for (const QUrl &url : qAsConst(urls)) {
+            QSample* sample = cache.requestSample(url);
+            connect(sample, &QSample::ready, &loop, [&loop, &allReady]() {
+                if (allReady())
+                    loop.quit();
+            });
+            samples.append(sample);
+        }
+        if (!allReady())
+            loop.exec();
+
+        for (QSample* sample : qAsConst(samples))
+            sample->release();
+    }
+}
+
 QTEST_MAIN(tst_QSampleCache)
 
 #include "tst_qsamplecache.moc"
@@ -0,0 +1,212 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//TESTED_COMPONENT=src/multimedia
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qaudioformat.h>
+#include <QtMultimedia/qsoundeffect.h>
+#include <private/qsoundeffect_qaudio_p.h>
+
+class tst_QSoundEffectMixer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void noVoices();
+    void mixTwoVoices();
+    void loopCount();
+    void partialLoop();
+    void infiniteLoops();
+    void stopOneVoice();
+    void mutedVoice();
+    void clipping();
+    void floatMixing();
+};
+
+static QAudioFormat sampleFormat(int sampleSize, QAudioFormat::SampleType sampleType)
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(1);
+    format.setSampleSize(sampleSize);
+    format.setSampleType(sampleType);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setCodec(QStringLiteral("audio/pcm"));
+    return format;
+}
+
+static QByteArray int16Samples(const QVector<qint16> &values)
+{
+    return QByteArray(reinterpret_cast<const char *>(values.constData()), values.size() * int(sizeof(qint16)));
+}
+
+static QSoundEffectVoice voice(const QByteArray &sample, int loops, qreal gain = 1.0)
+{
+    QSoundEffectVoice v;
+    v.sample = sample;
+    v.loopsRemaining = loops;
+    v.gain = gain;
+    return v;
+}
+
+// Mixes into a buffer of \a samples 16-bit samples which starts out as garbage.
+static QVector<qint16> mix(QSoundEffectVoice *voices, int count, int samples)
+{
+    QVector<qint16> output(samples, qint16(0x5a5a));
+    qt_soundeffect_mix_voices(sampleFormat(16, QAudioFormat::SignedInt), voices, count,
+                              reinterpret_cast<char *>(output.data()), samples * int(sizeof(qint16)));
+    return output;
+}
+
+void tst_QSoundEffectMixer::noVoices()
+{
+    QCOMPARE(mix(nullptr, 0, 35), QVector<qint16>(35, 0));
+}
+
+void tst_QSoundEffectMixer::mixTwoVoices()
+{
+    QSoundEffectVoice voices[] = {
+        voice(int16Samples(QVector<qint16>(35, 1000)), 1),
+        voice(int16Samples(QVector<qint16>(35, 2000)), 1, 0.5)
+    };
+
+    QCOMPARE(mix(voices, 2, 35), QVector<qint16>(35, 2000));
+    QCOMPARE(voices[0].loopsRemaining, 0);
+    QCOMPARE(voices[1].loopsRemaining, 0);
+}
+
+void tst_QSoundEffectMixer::loopCount()
+{
+    QSoundEffectVoice voices[] = {
+        voice(int16Samples({ 100, 200, 300, 400 }), 2)
+    };
+
+    // Two loops, then silence for the rest of the buffer
+    QCOMPARE(mix(voices, 1, 12), QVector<qint16>({ 100, 200, 300, 400, 100, 200, 300, 400, 0, 0, 0, 0 }));
+    QCOMPARE(voices[0].loopsRemaining, 0);
+    QCOMPARE(voices[0].offset, qint64(0));
+}
+
+void tst_QSoundEffectMixer::partialLoop()
+{
+    QSoundEffectVoice voices[] = {
+        voice(int16Samples({ 100, 200, 300, 400 }), 2)
+    };
+
+    // A loop that does not fit into one buffer continues in the next one
+    QCOMPARE(mix(voices, 1, 3), QVector<qint16>({ 100, 200, 300 }));
+    QCOMPARE(voices[0].loopsRemaining, 2);
+    QCOMPARE(voices[0].offset, qint64(3 * sizeof(qint16)));
+
+    QCOMPARE(mix(voices, 1, 3), QVector<qint16>({ 400, 100, 200 }));
+    QCOMPARE(voices[0].loopsRemaining, 1);
+
+    QCOMPARE(mix(voices, 1, 3), QVector<qint16>({ 300, 400, 0 }));
+    QCOMPARE(voices[0].loopsRemaining, 0);
+}
+
+void tst_QSoundEffectMixer::infiniteLoops()
+{
+    QSoundEffectVoice voices[] = {
+        voice(int16Samples({ 100, 200, 300 }), QSoundEffect::Infinite)
+    };
+
+    QCOMPARE(mix(voices, 1, 7), QVector<qint16>({ 100, 200, 300, 100, 200, 300, 100 }));
+    QCOMPARE(voices[0].loopsRemaining, int(QSoundEffect::Infinite));
+    QCOMPARE(voices[0].offset, qint64(sizeof(qint16)));
+}
+
+void tst_QSoundEffectMixer::stopOneVoice()
+{
+    // The short voice comes first, so the long one is mixed on top of its padding
+    QSoundEffectVoice voices[] = {
+        voice(int16Samples({ 100, 100, 100 }), 1),
+        voice(int16Samples({ 10, 20, 30, 40, 50, 60 }), QSoundEffect::Infinite)
+    };
+
+    QCOMPARE(mix(voices, 2, 6), QVector<qint16>({ 110, 120, 130, 40, 50, 60 }));
+    QCOMPARE(voices[0].loopsRemaining, 0);
+    QCOMPARE(voices[1].loopsRemaining, int(QSoundEffect::Infinite));
+
+    // Once the mixer drops the finished voice the other one carries on alone
+    QCOMPARE(mix(voices + 1, 1, 4), QVector<qint16>({ 10, 20, 30, 40 }));
+
+    // A stopped voice that is still listed contributes nothing
+    QCOMPARE(mix(voices, 2, 2), QVector<qint16>({ 50, 60 }));
+}
+
+void tst_QSoundEffectMixer::mutedVoice()
+{
+    QSoundEffectVoice voices[] = {
+        voice(int16Samples(QVector<qint16>(9, 1000)), 1, 0.0),
+        voice(int16Samples(QVector<qint16>(9, 300)), 1)
+    };
+
+    // A muted voice keeps its position but is not heard
+    QCOMPARE(mix(voices, 2, 9), QVector<qint16>(9, 300));
+    QCOMPARE(voices[0].loopsRemaining, 0);
+}
+
+void tst_QSoundEffectMixer::clipping()
+{
+    QSoundEffectVoice loud[] = {
+        voice(int16Samples(QVector<qint16>(35, 30000)), 1),
+        voice(int16Samples(QVector<qint16>(35, 30000)), 1)
+    };
+    QCOMPARE(mix(loud, 2, 35), QVector<qint16>(35, 32767));
+
+    QSoundEffectVoice negative[] = {
+        voice(int16Samples(QVector<qint16>(35, -30000)), 1),
+        voice(int16Samples(QVector<qint16>(35, -30000)), 1),
+        voice(int16Samples(QVector<qint16>(35, 20000)), 1)
+    };
+    // Each voice saturates as it is added, rather than the sum at the end
+    QCOMPARE(mix(negative, 3, 35), QVector<qint16>(35, -32768 + 20000));
+}
+
+void tst_QSoundEffectMixer::floatMixing()
+{
+    const QVector<float> a(13, 0.75f);
+    const QVector<float> b(13, 0.5f);
+    QSoundEffectVoice voices[] = {
+        voice(QByteArray(reinterpret_cast<const char *>(a.constData()), a.size() * int(sizeof(float))), 1),
+        voice(QByteArray(reinterpret_cast<const char *>(b.constData()), b.size() * int(sizeof(float))), 1)
+    };
+
+    QVector<float> output(13, 42.0f);
+    qt_soundeffect_mix_voices(sampleFormat(32, QAudioFormat::Float), voices, 2,
+                              reinterpret_cast<char *>(output.data()), output.size() * int(sizeof(float)));
+
+    // Float samples are not clipped, the output stage deals with values outside [-1, 1]
+    QCOMPARE(output, QVector<float>(13, 1.25f));
+}
+
+QTEST_MAIN(tst_QSoundEffectMixer)
+
+#include "tst_qsoundeffectmixer.moc"
@@ -34,8 +34,16 @@
 #include "private/qmemoryvideobuffer_p.h"
 #include <QtGui/QImage>
 #include <QtCore/QPointer>
+#include <QtCore/QRandomGenerator>
 #include <QtMultimedia/private/qtmultimedia-config_p.h>
 
+#ifdef QT_BUILD_INTERNAL
+QT_BEGIN_NAMESPACE
+extern Q_AUTOTEST_EXPORT void qt_videoframe_set_conversion_striping(int maximumThreads, int minimumStripePixels);
+extern Q_AUTOTEST_EXPORT int qt_videoframe_conversion_stripe_count();
+QT_END_NAMESPACE
+#endif
+
 // Adds an enum, and the stringized version
 #define ADD_ENUM_TEST(x) \
     QTest::newRow(#x) \
@@ -90,6 +98,19 @@ private slots:
 
     void image_data();
     void image();
+    void imageYuvConversion_data();
+    void imageYuvConversion();
+    void imageWithFormat_data();
+    void imageWithFormat();
+    void imageGrayscaleFromLuma();
+    void convertTo();
+    void convertToOddSize_data();
+    void convertToOddSize();
+    void stripedConversion_data();
+    void stripedConversion();
+    void scaledImage_data();
+    void scaledImage();
+    void scaledImageLargeBox();
 
     void emptyData();
 };
@@ -150,6 +171,8 @@ tst_QVideoFrame::~tst_QVideoFrame()
 
 void tst_QVideoFrame::initTestCase()
 {
+    // Opts in to converting large frames in stripes on the thread pool
+    qputenv("QT_VIDEOFRAME_CONVERSION_THREADS", "4");
 }
 
 void tst_QVideoFrame::cleanupTestCase()
@@ -162,6 +185,9 @@ void tst_QVideoFrame::init()
 
 void tst_QVideoFrame::cleanup()
 {
+#ifdef QT_BUILD_INTERNAL
+    qt_videoframe_set_conversion_striping(-1, -1);
+#endif
 }
 
 void tst_QVideoFrame::create_data()
@@ -1282,6 +1308,55 @@ void tst_QVideoFrame::image_data()
             << 16384
             << 256
             << QImage::Format_ARGB32;
+
+    QTest::newRow("64x64 YUV422P")
+            << QSize(64, 64)
+            << QVideoFrame::Format_YUV422P
+            << 8192
+            << 64
+            << QImage::Format_ARGB32;
+
+    QTest::newRow("64x64 IMC1")
+            << QSize(64, 64)
+            << QVideoFrame::Format_IMC1
+            << 8192
+            << 64
+            << QImage::Format_ARGB32;
+
+    QTest::newRow("64x64 IMC2")
+            << QSize(64, 64)
+            << QVideoFrame::Format_IMC2
+            << 6144
+            << 64
+            << QImage::Format_ARGB32;
+
+    QTest::newRow("64x64 IMC3")
+            << QSize(64, 64)
+            << QVideoFrame::Format_IMC3
+            << 8192
+            << 64
+            << QImage::Format_ARGB32;
+
+    QTest::newRow("64x64 IMC4")
+            << QSize(64, 64)
+            << QVideoFrame::Format_IMC4
+            << 6144
+            << 64
+            << QImage::Format_ARGB32;
+
+    QTest::newRow("64x64 Y8")
+            << QSize(64, 64)
+            << QVideoFrame::Format_Y8
+            << 4096
+            << 64
+            << QImage::Format_ARGB32;
+
+    QTest::newRow("64x64 Y16")
+            << QSize(64, 64)
+            << QVideoFrame::Format_Y16
+            << 8192
+            << 128
+            << QImage::Format_ARGB32;
 #endif
 }
 
@@ -1299,7 +1374,495 @@ void tst_QVideoFrame::image()
     QVERIFY(!img.isNull());
     QCOMPARE(img.format(), imageFormat);
     QCOMPARE(img.size(), size);
-    QCOMPARE(img.bytesPerLine(), bytesPerLine);
+    if (imageFormat == QImage::Format_ARGB32)
+        QCOMPARE(img.bytesPerLine(), size.width() * 4);
+    else
+        QCOMPARE(img.bytesPerLine(), bytesPerLine);
+}
+
+static quint32 referenceYuvToArgb(int y, int u, int v)
+{
+    const int yy = (y - 16) * 298;
+    const int uu = u - 128;
+    const int vv = v - 128;
+    return qRgb(qBound(0, (yy + 409 * vv + 128) >> 8, 255),
+                qBound(0, (yy - 100 * uu - 208 * vv - 128) >> 8, 255),
+                qBound(0, (yy + 516 * uu + 128) >> 8, 255));
+}
+
+void tst_QVideoFrame::imageYuvConversion_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<QVideoFrame::PixelFormat>("pixelFormat");
+    QTest::addColumn<int>("bytes");
+    QTest::addColumn<int>("bytesPerLine");
+
+#if !QT_CONFIG(directshow)
+    // Widths which are not a multiple of the vector size exercise the scalar tail.
+    QTest::newRow("70x34 YUV420P")
+            << QSize(70, 34)
+            << QVideoFrame::Format_YUV420P
+            << 76 * 34 * 3 / 2
+            << 76;
+
+    QTest::newRow("70x34 YV12")
+            << QSize(70, 34)
+            << QVideoFrame::Format_YV12
+            << 76 * 34 * 3 / 2
+            << 76;
+
+    QTest::newRow("70x34 NV12")
+            << QSize(70, 34)
+            << QVideoFrame::Format_NV12
+            << 76 * 34 * 3 / 2
+            << 76;
+
+    QTest::newRow("70x34 NV21")
+            << QSize(70, 34)
+            << QVideoFrame::Format_NV21
+            << 76 * 34 * 3 / 2
+            << 76;
+
+    QTest::newRow("70x34 UYVY")
+            << QSize(70, 34)
+            << QVideoFrame::Format_UYVY
+            << 152 * 34
+            << 152;
+
+    QTest::newRow("70x34 YUYV")
+            << QSize(70, 34)
+            << QVideoFrame::Format_YUYV
+            << 152 * 34
+            << 152;
+
+    // Odd sizes have a last column without a right neighbour and a last row
+    // without a row below it sharing their chroma.
+    QTest::newRow("1x1 YUV420P")
+            << QSize(1, 1)
+            << QVideoFrame::Format_YUV420P
+            << 1 + 2
+            << 1;
+
+    QTest::newRow("3x3 YUV420P")
+            << QSize(3, 3)
+            << QVideoFrame::Format_YUV420P
+            << 4 * 3 + 2 * 2 * 2
+            << 4;
+
+    QTest::newRow("71x35 YV12")
+            << QSize(71, 35)
+            << QVideoFrame::Format_YV12
+            << 72 * 35 + 2 * 36 * 18
+            << 72;
+
+    QTest::newRow("3x3 NV12")
+            << QSize(3, 3)
+            << QVideoFrame::Format_NV12
+            << 4 * 3 + 4 * 2
+            << 4;
+
+    QTest::newRow("71x35 NV21")
+            << QSize(71, 35)
+            << QVideoFrame::Format_NV21
+            << 72 * 35 + 72 * 18
+            << 72;
+
+    QTest::newRow("3x3 UYVY")
+            << QSize(3, 3)
+            << QVideoFrame::Format_UYVY
+            << 8 * 3
+            << 8;
+
+    QTest::newRow("71x35 YUYV")
+            << QSize(71, 35)
+            << QVideoFrame::Format_YUYV
+            << 144 * 35
+            << 144;
+
+    QTest::newRow("64x64 UYVY unpadded")
+            << QSize(64, 64)
+            << QVideoFrame::Format_UYVY
+            << 128 * 64
+            << 128;
+
+    // Large enough to be split into stripes across threads.
+    QTest::newRow("1280x722 YUV420P striped")
+            << QSize(1280, 722)
+            << QVideoFrame::Format_YUV420P
+            << 1280 * 722 * 3 / 2
+            << 1280;
+
+    QTest::newRow("1282x720 UYVY striped")
+            << QSize(1282, 720)
+            << QVideoFrame::Format_UYVY
+            << 2564 * 720
+            << 2564;
+
+    // The last stripe gets an odd number of rows.
+    QTest::newRow("1281x721 NV12 striped")
+            << QSize(1281, 721)
+            << QVideoFrame::Format_NV12
+            << 1282 * 721 + 1282 * 361
+            << 1282;
+#endif
+}
+
+void tst_QVideoFrame::imageYuvConversion()
+{
+    QFETCH(QSize, size);
+    QFETCH(QVideoFrame::PixelFormat, pixelFormat);
+    QFETCH(int, bytes);
+    QFETCH(int, bytesPerLine);
+
+    QVideoFrame frame(bytes, size, bytesPerLine, pixelFormat);
+    QVERIFY(frame.map(QAbstractVideoBuffer::WriteOnly));
+    QRandomGenerator generator(quint32(pixelFormat));
+    for (int i = 0; i < frame.mappedBytes(); ++i)
+        frame.bits()[i] = uchar(generator.bounded(256));
+    frame.unmap();
+
+    const QImage img = frame.image();
+    QVERIFY(!img.isNull());
+    QCOMPARE(img.format(), QImage::Format_ARGB32);
+    QCOMPARE(img.size(), size);
+
+    QVERIFY(frame.map(QAbstractVideoBuffer::ReadOnly));
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x) {
+            int luma = 0;
+            int u = 0;
+            int v = 0;
+            switch (pixelFormat) {
+            case QVideoFrame::Format_YUV420P:
+            case QVideoFrame::Format_YV12: {
+                const int uPlane = pixelFormat == QVideoFrame::Format_YUV420P ? 1 : 2;
+                const int vPlane = pixelFormat == QVideoFrame::Format_YUV420P ? 2 : 1;
+                luma = frame.bits(0)[y * frame.bytesPerLine(0) + x];
+                u = frame.bits(uPlane)[y / 2 * frame.bytesPerLine(uPlane) + x / 2];
+                v = frame.bits(vPlane)[y / 2 * frame.bytesPerLine(vPlane) + x / 2];
+                break;
+            }
+            case QVideoFrame::Format_NV12:
+            case QVideoFrame::Format_NV21: {
+                const uchar *uv = frame.bits(1) + y / 2 * frame.bytesPerLine(1) + x / 2 * 2;
+                luma = frame.bits(0)[y * frame.bytesPerLine(0) + x];
+                u = uv[pixelFormat == QVideoFrame::Format_NV12 ? 0 : 1];
+                v = uv[pixelFormat == QVideoFrame::Format_NV12 ? 1 : 0];
+                break;
+            }
+            case QVideoFrame::Format_UYVY:
+            case QVideoFrame::Format_YUYV: {
+                const uchar *pair = frame.bits() + y * frame.bytesPerLine() + x / 2 * 4;
+                const bool uyvy = pixelFormat == QVideoFrame::Format_UYVY;
+                luma = pair[(uyvy ? 1 : 0) + (x % 2) * 2];
+                u = pair[uyvy ? 0 : 1];
+                v = pair[uyvy ? 2 : 3];
+                break;
+            }
+            default:
+                QFAIL("Unexpected pixel format");
+            }
+
+            if (img.pixel(x, y) != referenceYuvToArgb(luma, u, v)) {
+                frame.unmap();
+                QFAIL(qPrintable(QString::fromLatin1("Pixel mismatch at (%1, %2): got %3, expected %4")
+                                 .arg(x).arg(y)
+                                 .arg(img.pixel(x, y), 8, 16, QLatin1Char('0'))
+                                 .arg(referenceYuvToArgb(luma, u, v), 8, 16, QLatin1Char('0'))));
+            }
+        }
+    }
+    frame.unmap();
+}
+
+static QVideoFrame randomFrame(const QSize &size, QVideoFrame::PixelFormat pixelFormat, int bytes, int bytesPerLine)
+{
+    QVideoFrame frame(bytes, size, bytesPerLine, pixelFormat);
+    if (frame.map(QAbstractVideoBuffer::WriteOnly)) {
+        QRandomGenerator generator(quint32(pixelFormat));
+        for (int i = 0; i < frame.mappedBytes(); ++i)
+            frame.bits()[i] = uchar(generator.bounded(256));
+        frame.unmap();
+    }
+    return frame;
+}
+
+void tst_QVideoFrame::imageWithFormat_data()
+{
+    QTest::addColumn<QVideoFrame::PixelFormat>("pixelFormat");
+    QTest::addColumn<int>("bytes");
+    QTest::addColumn<int>("bytesPerLine");
+    QTest::addColumn<QImage::Format>("imageFormat");
+
+    const QImage::Format formats[] = {
+        QImage::Format_ARGB32,
+        QImage::Format_ARGB32_Premultiplied,
+        QImage::Format_RGB32,
+        QImage::Format_RGB888,
+        QImage::Format_BGR888,
+        QImage::Format_RGBX8888,
+        QImage::Format_RGBA8888,
+        QImage::Format_RGB16
+    };
+
+    for (QImage::Format format : formats) {
+        const QByteArray name = QByteArray::number(int(format));
+        QTest::newRow("YUV420P to " + name)
+                << QVideoFrame::Format_YUV420P << 64 * 34 * 3 / 2 << 64 << format;
+        QTest::newRow("UYVY to " + name)
+                << QVideoFrame::Format_UYVY << 140 * 34 << 140 << format;
+        QTest::newRow("BGR24 to " + name)
+                << QVideoFrame::Format_BGR24 << 212 * 34 << 212 << format;
+        QTest::newRow("RGB32 to " + name)
+                << QVideoFrame::Format_RGB32 << 280 * 34 << 280 << format;
+    }
+}
+
+void tst_QVideoFrame::imageWithFormat()
+{
+    QFETCH(QVideoFrame::PixelFormat, pixelFormat);
+    QFETCH(int, bytes);
+    QFETCH(int, bytesPerLine);
+    QFETCH(QImage::Format, imageFormat);
+
+    const QVideoFrame frame = randomFrame(QSize(70, 34), pixelFormat, bytes, bytesPerLine);
+
+    const QImage expected = frame.image().convertToFormat(imageFormat);
+    const QImage img = frame.image(imageFormat);
+
+    QVERIFY(!img.isNull());
+    QCOMPARE(img.format(), imageFormat);
+    QCOMPARE(img, expected);
+}
+
+void tst_QVideoFrame::imageGrayscaleFromLuma()
+{
+    const QVideoFrame frame = randomFrame(QSize(70, 34), QVideoFrame::Format_NV12, 76 * 34 * 3 / 2, 76);
+    const QImage img = frame.image(QImage::Format_Grayscale8);
+
+    QVERIFY(!img.isNull());
+    QCOMPARE(img.format(), QImage::Format_Grayscale8);
+    QCOMPARE(img.size(), frame.size());
+
+    QVideoFrame mapped = frame;
+    QVERIFY(mapped.map(QAbstractVideoBuffer::ReadOnly));
+    for (int y = 0; y < img.height(); ++y) {
+        const uchar *luma = mapped.bits(0) + y * mapped.bytesPerLine(0);
+        const uchar *gray = img.constScanLine(y);
+        for (int x = 0; x < img.width(); ++x)
+            QCOMPARE(int(gray[x]), qBound(0, ((luma[x] - 16) * 298 + 128) >> 8, 255));
+    }
+    mapped.unmap();
+}
+
+void tst_QVideoFrame::convertTo()
+{
+    const QSize size(70, 34);
+    const QVideoFrame frame = randomFrame(size, QVideoFrame::Format_NV21, 76 * 34 * 3 / 2, 76);
+    const QImage expected = frame.image(QImage::Format_RGB888);
+
+    // Padded lines must be left untouched
+    const int bytesPerLine = size.width() * 3 + 10;
+    QByteArray buffer(bytesPerLine * size.height(), char(0x5a));
+    QVERIFY(frame.convertTo(QImage::Format_RGB888, reinterpret_cast<uchar *>(buffer.data()), bytesPerLine));
+
+    for (int y = 0; y < size.height(); ++y) {
+        const char *line = buffer.constData() + y * bytesPerLine;
+        QCOMPARE(QByteArray(line, size.width() * 3),
+                 QByteArray(reinterpret_cast<const char *>(expected.constScanLine(y)), size.width() * 3));
+        QCOMPARE(QByteArray(line + size.width() * 3, 10), QByteArray(10, char(0x5a)));
+    }
+
+    // Too small stride
+    QVERIFY(!frame.convertTo(QImage::Format_RGB888, reinterpret_cast<uchar *>(buffer.data()), size.width() * 2));
+    QVERIFY(!frame.convertTo(QImage::Format_RGB888, nullptr, bytesPerLine));
+    QVERIFY(!QVideoFrame().convertTo(QImage::Format_RGB888, reinterpret_cast<uchar *>(buffer.data()), bytesPerLine));
+}
+
+void tst_QVideoFrame::convertToOddSize_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<QVideoFrame::PixelFormat>("pixelFormat");
+    QTest::addColumn<int>("bytes");
+    QTest::addColumn<int>("bytesPerLine");
+
+    QTest::newRow("1x1 YUV420P") << QSize(1, 1) << QVideoFrame::Format_YUV420P << 1 + 2 << 1;
+    QTest::newRow("3x3 YUV420P") << QSize(3, 3) << QVideoFrame::Format_YUV420P << 4 * 3 + 2 * 2 * 2 << 4;
+    QTest::newRow("3x3 YUV422P") << QSize(3, 3) << QVideoFrame::Format_YUV422P << 4 * 3 + 2 * 2 * 3 << 4;
+    QTest::newRow("3x3 NV12") << QSize(3, 3) << QVideoFrame::Format_NV12 << 4 * 3 + 4 * 2 << 4;
+    QTest::newRow("3x3 UYVY") << QSize(3, 3) << QVideoFrame::Format_UYVY << 8 * 3 << 8;
+    QTest::newRow("1x1 YUYV") << QSize(1, 1) << QVideoFrame::Format_YUYV << 4 << 4;
+    QTest::newRow("17x3 NV21") << QSize(17, 3) << QVideoFrame::Format_NV21 << 18 * 3 + 18 * 2 << 18;
+}
+
+void tst_QVideoFrame::convertToOddSize()
+{
+    QFETCH(QSize, size);
+    QFETCH(QVideoFrame::PixelFormat, pixelFormat);
+    QFETCH(int, bytes);
+    QFETCH(int, bytesPerLine);
+
+    const QVideoFrame frame = randomFrame(size, pixelFormat, bytes, bytesPerLine);
+    const QImage expected = frame.image();
+    QVERIFY(!expected.isNull());
+
+    // The output is sized exactly, anything written past it lands in the guard bytes
+    const int outputStride = size.width() * 4;
+    const int outputBytes = outputStride * size.height();
+    const int guardBytes = 64;
+    QByteArray buffer(outputBytes + guardBytes, char(0x5a));
+    QVERIFY(frame.convertTo(QImage::Format_ARGB32, reinterpret_cast<uchar *>(buffer.data()), outputStride));
+
+    QCOMPARE(buffer.mid(outputBytes), QByteArray(guardBytes, char(0x5a)));
+    for (int y = 0; y < size.height(); ++y) {
+        QCOMPARE(buffer.mid(y * outputStride, outputStride),
+                 QByteArray(reinterpret_cast<const char *>(expected.constScanLine(y)), outputStride));
+    }
+}
+
+void tst_QVideoFrame::stripedConversion_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<QVideoFrame::PixelFormat>("pixelFormat");
+    QTest::addColumn<int>("bytes");
+    QTest::addColumn<int>("bytesPerLine");
+    QTest::addColumn<QImage::Format>("imageFormat");
+
+    const QImage::Format formats[] = {
+        QImage::Format_ARGB32,
+        QImage::Format_RGB888,
+        QImage::Format_Grayscale8
+    };
+
+    for (QImage::Format format : formats) {
+        const QByteArray name = QByteArray::number(int(format));
+        QTest::newRow("YUV420P to " + name)
+                << QSize(70, 34) << QVideoFrame::Format_YUV420P << 76 * 34 * 3 / 2 << 76 << format;
+        QTest::newRow("odd YV12 to " + name)
+                << QSize(71, 35) << QVideoFrame::Format_YV12 << 72 * 35 + 2 * 36 * 18 << 72 << format;
+        QTest::newRow("NV21 to " + name)
+                << QSize(70, 34) << QVideoFrame::Format_NV21 << 76 * 34 * 3 / 2 << 76 << format;
+        QTest::newRow("UYVY to " + name)
+                << QSize(70, 34) << QVideoFrame::Format_UYVY << 140 * 34 << 140 << format;
+    }
+}
+
+void tst_QVideoFrame::stripedConversion()
+{
+#ifndef QT_BUILD_INTERNAL
+    QSKIP("Needs the internal striping hooks of a developer build");
+#else
+    QFETCH(QSize, size);
+    QFETCH(QVideoFrame::PixelFormat, pixelFormat);
+    QFETCH(int, bytes);
+    QFETCH(int, bytesPerLine);
+    QFETCH(QImage::Format, imageFormat);
+
+    const QVideoFrame frame = randomFrame(size, pixelFormat, bytes, bytesPerLine);
+
+    qt_videoframe_set_conversion_striping(1, -1);
+    const QImage single = frame.image(imageFormat);
+    QVERIFY(!single.isNull());
+    QCOMPARE(qt_videoframe_conversion_stripe_count(), 1);
+
+    // A tiny threshold forces this small frame into four stripes
+    qt_videoframe_set_conversion_striping(4, 64);
+    const QImage striped = frame.image(imageFormat);
+    QCOMPARE(qt_videoframe_conversion_stripe_count(), 4);
+
+    QCOMPARE(striped, single);
+#endif
+}
+
+void tst_QVideoFrame::scaledImage_data()
+{
+    QTest::addColumn<QVideoFrame::PixelFormat>("pixelFormat");
+    QTest::addColumn<int>("bytes");
+    QTest::addColumn<int>("bytesPerLine");
+    QTest::addColumn<QSize>("scaledSize");
+
+    QTest::newRow("YUV420P half")
+            << QVideoFrame::Format_YUV420P << 76 * 34 * 3 / 2 << 76 << QSize(35, 17);
+    QTest::newRow("YUV420P uneven")
+            << QVideoFrame::Format_YUV420P << 76 * 34 * 3 / 2 << 76 << QSize(9, 5);
+    QTest::newRow("NV12 single pixel")
+            << QVideoFrame::Format_NV12 << 76 * 34 * 3 / 2 << 76 << QSize(1, 1);
+    QTest::newRow("YUYV width only")
+            << QVideoFrame::Format_YUYV << 152 * 34 << 152 << QSize(16, 34);
+}
+
+void tst_QVideoFrame::scaledImage()
+{
+    QFETCH(QVideoFrame::PixelFormat, pixelFormat);
+    QFETCH(int, bytes);
+    QFETCH(int, bytesPerLine);
+    QFETCH(QSize, scaledSize);
+
+    const QSize size(70, 34);
+    const QVideoFrame frame = randomFrame(size, pixelFormat, bytes, bytesPerLine);
+    const QImage full = frame.image();
+    const QImage scaled = frame.scaledImage(scaledSize);
+
+    QVERIFY(!scaled.isNull());
+    QCOMPARE(scaled.format(), QImage::Format_ARGB32);
+    QCOMPARE(scaled.size(), scaledSize);
+
+    // Each output pixel is the rounded average of the source pixels it covers
+    for (int y = 0; y < scaledSize.height(); ++y) {
+        const int top = y * size.height() / scaledSize.height();
+        const int bottom = (y + 1) * size.height() / scaledSize.height();
+        for (int x = 0; x < scaledSize.width(); ++x) {
+            const int left = x * size.width() / scaledSize.width();
+            const int right = (x + 1) * size.width() / scaledSize.width();
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            for (int sy = top; sy < bottom; ++sy) {
+                for (int sx = left; sx < right; ++sx) {
+                    const QRgb pixel = full.pixel(sx, sy);
+                    r += qRed(pixel);
+                    g += qGreen(pixel);
+                    b += qBlue(pixel);
+                }
+            }
+            const int count = (bottom - top) * (right - left);
+            const QRgb expected = qRgb((r + count / 2) / count, (g + count / 2) / count, (b + count / 2) / count);
+            QCOMPARE(scaled.pixel(x, y), expected);
+        }
+    }
+
+    const QImage rgb888 = frame.scaledImage(scaledSize, QImage::Format_RGB888);
+    QCOMPARE(rgb888.format(), QImage::Format_RGB888);
+    QCOMPARE(rgb888, scaled.convertToFormat(QImage::Format_RGB888));
+
+    // Upscaling falls back to smooth scaling of the converted frame
+    QCOMPARE(frame.scaledImage(size * 2).size(), size * 2);
+    QVERIFY(frame.scaledImage(QSize()).isNull());
+}
+
+// Filled with one colour in the luma and chroma planes
+static QVideoFrame uniformNV12Frame(const QSize &size, uchar luma, uchar chroma)
+{
+    const int lumaBytes = size.width() * size.height();
+    QVideoFrame frame(lumaBytes * 3 / 2, size, size.width(), QVideoFrame::Format_NV12);
+    if (frame.map(QAbstractVideoBuffer::WriteOnly)) {
+        memset(frame.bits(), luma, lumaBytes);
+        memset(frame.bits() + lumaBytes, chroma, frame.mappedBytes() - lumaBytes);
+        frame.unmap();
+    }
+    return frame;
+}
+
+void tst_QVideoFrame::scaledImageLargeBox()
+{
+    // A single box of more than 2^32 / 255 bright pixels overflows 32-bit channel sums
+    const QSize size(4608, 3840);
+    const QVideoFrame frame = uniformNV12Frame(size, 235, 128);
+    const QRgb expected = uniformNV12Frame(QSize(2, 2), 235, 128).image().pixel(0, 0);
+
+    const QImage scaled = frame.scaledImage(QSize(1, 1));
+    QCOMPARE(scaled.size(), QSize(1, 1));
+    QCOMPARE(scaled.pixel(0, 0), expected);
 }
 
 void tst_QVideoFrame::emptyData()
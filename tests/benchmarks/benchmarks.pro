@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+QT_FOR_CONFIG += multimedia-private
+
+# The GStreamer benchmarks build their pipelines with GStreamer 1.0 caps
+qtConfig(gstreamer):!qtConfig(gstreamer_0_10): \
+    SUBDIRS += qgstreamerprobe qgstreamerimagecapture
@@ -0,0 +1,29 @@
+TARGET = tst_bench_qgstreamerimagecapture
+
+QT += multimedia-private multimediagsttools-private testlib
+CONFIG += release
+
+QMAKE_USE += gstreamer
+
+# The session lives in the media capture plugin, build it into the benchmark
+CAPTURE_PLUGIN = ../../../src/plugins/gstreamer/mediacapture
+INCLUDEPATH += $$CAPTURE_PLUGIN
+
+HEADERS += \
+    $$CAPTURE_PLUGIN/qgstreamercapturesession.h \
+    $$CAPTURE_PLUGIN/qgstreamerprerollbuffer.h \
+    $$CAPTURE_PLUGIN/qgstreameraudioencode.h \
+    $$CAPTURE_PLUGIN/qgstreamervideoencode.h \
+    $$CAPTURE_PLUGIN/qgstreamerimageencode.h \
+    $$CAPTURE_PLUGIN/qgstreamerrecordercontrol.h \
+    $$CAPTURE_PLUGIN/qgstreamermediacontainercontrol.h
+
+SOURCES += \
+    tst_bench_qgstreamerimagecapture.cpp \
+    $$CAPTURE_PLUGIN/qgstreamercapturesession.cpp \
+    $$CAPTURE_PLUGIN/qgstreamerprerollbuffer.cpp \
+    $$CAPTURE_PLUGIN/qgstreameraudioencode.cpp \
+    $$CAPTURE_PLUGIN/qgstreamervideoencode.cpp \
+    $$CAPTURE_PLUGIN/qgstreamerimageencode.cpp \
+    $$CAPTURE_PLUGIN/qgstreamerrecordercontrol.cpp \
+    $$CAPTURE_PLUGIN/qgstreamermediacontainercontrol.cpp
@@ -0,0 +1,148 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qtemporarydir.h>
+
+#include <private/qgstutils_p.h>
+
+#include "qgstreamercapturesession.h"
+
+#include <gst/gst.h>
+
+// A video source that isn't live, so the burst is limited by capturing rather than by the frame rate
+class TestVideoInput : public QGstreamerVideoInput
+{
+public:
+    explicit TestVideoInput(const QSize &size) : m_size(size) {}
+
+    GstElement *buildElement() override
+    {
+        const QByteArray description = "videotestsrc pattern=ball ! video/x-raw,width="
+                + QByteArray::number(m_size.width()) + ",height=" + QByteArray::number(m_size.height())
+                + ",framerate=120/1";
+        return gst_parse_bin_from_description(description.constData(), TRUE, nullptr);
+    }
+
+    QList<qreal> supportedFrameRates(const QSize & = QSize()) const override
+    {
+        return QList<qreal>() << 120;
+    }
+
+    QList<QSize> supportedResolutions(qreal = -1) const override
+    {
+        return QList<QSize>() << m_size;
+    }
+
+private:
+    QSize m_size;
+};
+
+class tst_QGstreamerImageCapture : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QGstreamerImageCapture()
+    {
+        QGstUtils::initializeGst();
+    }
+
+private slots:
+    void burstThroughput_data();
+    void burstThroughput();
+};
+
+// Bursts per row, each waits until all of its images have been saved
+static const int Rounds = 5;
+
+void tst_QGstreamerImageCapture::burstThroughput_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("burstSize");
+
+    QTest::newRow("640x480, 1 image") << QSize(640, 480) << 1;
+    QTest::newRow("640x480, 10 images") << QSize(640, 480) << 10;
+    QTest::newRow("1280x720, 1 image") << QSize(1280, 720) << 1;
+    QTest::newRow("1280x720, 10 images") << QSize(1280, 720) << 10;
+}
+
+void tst_QGstreamerImageCapture::burstThroughput()
+{
+    QFETCH(QSize, size);
+    QFETCH(int, burstSize);
+
+    GstElementFactory *factory = gst_element_factory_find("videotestsrc");
+    if (!factory)
+        QSKIP("videotestsrc is not available");
+    gst_object_unref(factory);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    TestVideoInput videoInput(size);
+
+    QGstreamerCaptureSession session(QGstreamerCaptureSession::CaptureMode(
+                QGstreamerCaptureSession::Video | QGstreamerCaptureSession::Image), nullptr);
+    session.setVideoInput(&videoInput);
+
+    QSignalSpy errorSpy(&session, SIGNAL(error(int,QString)));
+    QSignalSpy savedSpy(&session, SIGNAL(imageSaved(int,QString)));
+
+    session.setState(QGstreamerCaptureSession::PreviewState);
+    QTRY_VERIFY(session.state() == QGstreamerCaptureSession::PreviewState || !errorSpy.isEmpty());
+    if (!errorSpy.isEmpty())
+        QSKIP("The preview pipeline could not be built");
+
+    int requestId = 0;
+    qint64 elapsed = 0;
+
+    for (int round = 0; round < Rounds; ++round) {
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int i = 0; i < burstSize; ++i) {
+            ++requestId;
+            QVERIFY(session.captureImage(requestId, dir.filePath(QString::asprintf("image_%d.jpg", requestId))));
+        }
+        while (savedSpy.count() < requestId)
+            QVERIFY(savedSpy.wait(5000));
+
+        elapsed += timer.nsecsElapsed();
+    }
+
+    session.setState(QGstreamerCaptureSession::StoppedState);
+
+    QTest::setBenchmarkResult(requestId * 1e9 / elapsed, QTest::FramesPerSecond);
+}
+
+QTEST_MAIN(tst_QGstreamerImageCapture)
+
+#include "tst_bench_qgstreamerimagecapture.moc"
@@ -0,0 +1,8 @@
+TARGET = tst_bench_qgstreamerprobe
+
+QT += multimedia-private multimediagsttools-private testlib
+CONFIG += release
+
+QMAKE_USE += gstreamer
+
+SOURCES += tst_bench_qgstreamerprobe.cpp
@@ -0,0 +1,290 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qtimer.h>
+
+#include <private/qgstreameraudioprobecontrol_p.h>
+#include <private/qgstreamervideoprobecontrol_p.h>
+#include <private/qgstutils_p.h>
+
+#include <gst/gst.h>
+
+// Records when each buffer reaches the probe on the streaming thread and
+// when it is delivered, matching them by start time in microseconds.
+class LatencyRecorder
+{
+public:
+    LatencyRecorder() { m_clock.start(); }
+
+    void probed(GstBuffer *buffer)
+    {
+        const qint64 startTime = GST_BUFFER_TIMESTAMP(buffer) / G_GINT64_CONSTANT(1000);
+        const qint64 now = m_clock.nsecsElapsed();
+        QMutexLocker locker(&m_mutex);
+        m_probed.insert(startTime, now);
+    }
+
+    void delivered(qint64 startTime)
+    {
+        const qint64 now = m_clock.nsecsElapsed();
+        QMutexLocker locker(&m_mutex);
+        const auto it = m_probed.find(startTime);
+        if (it == m_probed.end())
+            return;
+        m_totalLatency += now - it.value();
+        ++m_delivered;
+        m_probed.erase(it);
+    }
+
+    int deliveredCount() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_delivered;
+    }
+
+    qreal meanLatency() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_delivered > 0 ? qreal(m_totalLatency) / m_delivered : 0;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QHash<qint64, qint64> m_probed;
+    qint64 m_totalLatency = 0;
+    int m_delivered = 0;
+};
+
+class VideoProbe : public QGstreamerVideoProbeControl
+{
+public:
+    explicit VideoProbe(LatencyRecorder *recorder)
+        : QGstreamerVideoProbeControl(nullptr)
+        , m_recorder(recorder)
+    {
+    }
+
+    bool probeBuffer(GstBuffer *buffer) override
+    {
+        m_recorder->probed(buffer);
+        return QGstreamerVideoProbeControl::probeBuffer(buffer);
+    }
+
+private:
+    LatencyRecorder *m_recorder;
+};
+
+class AudioProbe : public QGstreamerAudioProbeControl
+{
+public:
+    explicit AudioProbe(LatencyRecorder *recorder)
+        : QGstreamerAudioProbeControl(nullptr)
+        , m_recorder(recorder)
+    {
+    }
+
+protected:
+    bool probeBuffer(GstBuffer *buffer) override
+    {
+        m_recorder->probed(buffer);
+        return QGstreamerAudioProbeControl::probeBuffer(buffer);
+    }
+
+private:
+    LatencyRecorder *m_recorder;
+};
+
+class tst_QGstreamerProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QGstreamerProbe()
+    {
+        QGstUtils::initializeGst();
+    }
+
+private slots:
+    void videoLatency_data();
+    void videoLatency();
+    void audioLatency_data();
+    void audioLatency();
+
+private:
+    bool runPipeline(const char *description, QGstreamerBufferProbe *probe,
+                     LatencyRecorder *recorder);
+};
+
+// Buffer count per run; the sink is synchronised so the streaming thread
+// runs at the media rate and the queued path is not flooded.
+static const int BufferCount = 100;
+
+// Upper bound for one run of a pipeline, which plays for about a second
+static const int PipelineTimeout = 30000;
+
+namespace {
+struct BusWatch
+{
+    QEventLoop *loop;
+    bool ok;
+};
+}
+
+// Called on the thread posting the message, leaves the event loop once the pipeline is done
+static GstBusSyncReply busSyncHandler(GstBus *, GstMessage *message, gpointer data)
+{
+    BusWatch *watch = static_cast<BusWatch *>(data);
+    switch (GST_MESSAGE_TYPE(message)) {
+    case GST_MESSAGE_EOS:
+        watch->ok = true;
+        QMetaObject::invokeMethod(watch->loop, "quit", Qt::QueuedConnection);
+        break;
+    case GST_MESSAGE_ERROR:
+        QMetaObject::invokeMethod(watch->loop, "quit", Qt::QueuedConnection);
+        break;
+    default:
+        break;
+    }
+    return GST_BUS_PASS;
+}
+
+bool tst_QGstreamerProbe::runPipeline(const char *description, QGstreamerBufferProbe *probe,
+                                      LatencyRecorder *recorder)
+{
+    GstElement *pipeline = gst_parse_launch(description, nullptr);
+    if (!pipeline)
+        return false;
+
+    GstElement *sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    GstPad *pad = gst_element_get_static_pad(sink, "sink");
+    probe->addProbeToPad(pad);
+
+    // Queued deliveries are processed by the loop while it waits for the end of the stream
+    QEventLoop loop;
+    BusWatch watch = { &loop, false };
+    GstBus *bus = gst_element_get_bus(pipeline);
+    gst_bus_set_sync_handler(bus, busSyncHandler, &watch, nullptr);
+    QTimer::singleShot(PipelineTimeout, &loop, &QEventLoop::quit);
+
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    loop.exec();
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_bus_set_sync_handler(bus, nullptr, nullptr, nullptr);
+    probe->removeProbeFromPad(pad);
+
+    // Deliver what is still queued
+    QCoreApplication::processEvents();
+
+    gst_object_unref(bus);
+    gst_object_unref(pad);
+    gst_object_unref(sink);
+    gst_object_unref(pipeline);
+
+    return watch.ok && recorder->deliveredCount() > 0;
+}
+
+void tst_QGstreamerProbe::videoLatency_data()
+{
+    QTest::addColumn<bool>("direct");
+
+    QTest::newRow("queued") << false;
+    QTest::newRow("direct") << true;
+}
+
+void tst_QGstreamerProbe::videoLatency()
+{
+    QFETCH(bool, direct);
+
+    LatencyRecorder recorder;
+    VideoProbe probe(&recorder);
+    if (direct) {
+        probe.setDirectCallback([&recorder](const QVideoFrame &frame) {
+            recorder.delivered(frame.startTime());
+        });
+    } else {
+        connect(&probe, &QMediaVideoProbeControl::videoFrameProbed, this,
+                [&recorder](const QVideoFrame &frame) {
+            recorder.delivered(frame.startTime());
+        });
+    }
+
+    const QByteArray description = "videotestsrc num-buffers=" + QByteArray::number(BufferCount)
+            + " ! video/x-raw,format=RGBA,width=640,height=480,framerate=100/1"
+            + " ! fakesink name=sink sync=true";
+    if (!runPipeline(description.constData(), &probe, &recorder))
+        QSKIP("The videotestsrc pipeline could not be run");
+
+    QTest::setBenchmarkResult(recorder.meanLatency(), QTest::WalltimeNanoseconds);
+}
+
+void tst_QGstreamerProbe::audioLatency_data()
+{
+    QTest::addColumn<bool>("direct");
+
+    QTest::newRow("queued") << false;
+    QTest::newRow("direct") << true;
+}
+
+void tst_QGstreamerProbe::audioLatency()
+{
+    QFETCH(bool, direct);
+
+    LatencyRecorder recorder;
+    AudioProbe probe(&recorder);
+    if (direct) {
+        probe.setDirectCallback([&recorder](const QAudioBuffer &buffer) {
+            recorder.delivered(buffer.startTime());
+        });
+    } else {
+        probe.setQueueLimit(BufferCount);
+        connect(&probe, &QMediaAudioProbeControl::audioBufferProbed, this,
+                [&recorder](const QAudioBuffer &buffer) {
+            recorder.delivered(buffer.startTime());
+        });
+    }
+
+    const QByteArray description = "audiotestsrc num-buffers=" + QByteArray::number(BufferCount)
+            + " samplesperbuffer=441"
+            + " ! audio/x-raw,format=S16LE,rate=44100,channels=2"
+            + " ! fakesink name=sink sync=true";
+    if (!runPipeline(description.constData(), &probe, &recorder))
+        QSKIP("The audiotestsrc pipeline could not be run");
+
+    QTest::setBenchmarkResult(recorder.meanLatency(), QTest::WalltimeNanoseconds);
+}
+
+QTEST_MAIN(tst_QGstreamerProbe)
+
+#include "tst_bench_qgstreamerprobe.moc"
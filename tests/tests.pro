@@ -1,5 +1,5 @@
 TEMPLATE = subdirs
-SUBDIRS += auto
+SUBDIRS += auto benchmarks
 
 # Disabled since we don't have any source.
-# SUBDIRS +=  benchmarks manual
+# SUBDIRS += manual